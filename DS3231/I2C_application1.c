@@ -6,16 +6,23 @@
  * This program will interface the DS3231 RTC by utilizing
  * a uart to print the current time upon Power-On Reset (POR).
  * 
- * The program turns on the pico LED every second which will 
- * act as a heartbeat for this program. The program will toggle
+ * The program blinks the pico LED once a second which will 
+ * act as a heartbeat for this program. The blink runs from
+ * PWM and DMA (led_pwm.c) so it costs no interrupts. The program will toggle
  * LED3 every 5 seconds and indicate the current state of LED3 
  * on the uart. The program will turn on LED2 2-3 seconds after
  * the watchdog timer implemented in this program activates.
  *
+ * The DS3231 1Hz SQW output disciplines the system timer (see
+ * clock_discipline.c). LED3 is toggled from the SQW edges so it
+ * follows the RTC instead of the 100ms polling loop. Sending
+ * "TYYMMDDhhmmss.uuuuuu" followed by a return sets the RTC, and
+ * "C" prints the corrected time and the measured clock offset.
+ *
  * Side Effects:
- * The timing between the DS 3231 differs from the system clock
- * causing LED3 to toggle earlier than expected or to miss its 
- * timing. 
+ * The timing between the DS 3231 differs from the system clock.
+ * The offset is measured once 2 SQW edges have been seen and is
+ * averaged over CLK_BASELINE_SECONDS.
  * The Uart RX and TX interrupts were not implemented 
  * because the I2C can only block for read and write. 
  * After running for a long time, the uart disconnects upon POR. 
@@ -33,36 +40,24 @@
 #include "hardware/timer.h"
 #include "hardware/watchdog.h"
 #include "hardware/i2c.h"
+#include "clock_discipline.h"
+#include "led_pwm.h"
 
 #define DS3231_ADDRESS 0x68 // RTC I2C Address
+#define DS3231_I2C_BAUD (100 * 1000)
+#define DS3231_CONTROL_REG 0x0E
 #define SDA_PIN 4           // GPIO for SDA
 #define SCL_PIN 5           // GPIO for SCL
-#define LED_PIN 25          // GPIO for onboard LED
 #define PICOEDUB_LED3_PIN      3
 #define PICOEDUB_LED2_PIN      2
 
-// The function below allows me to access clock time 
-// to use in the timer.
-static uint64_t get_time(void) {
-    // Reading low latches the high value
-    uint32_t lo = timer_hw->timelr;
-    uint32_t hi = timer_hw->timehr;
-    return ((uint64_t) hi << 32u) | lo;
-}
-/// \end::get_time[]
-
-/// \tag::alarm_standalone[]
-// Use alarm 0. Like the above UART values, this configures my timers
-#define ALARM_NUM 0
-#define ALARM_IRQ timer_hardware_alarm_get_irq_num(timer_hw, ALARM_NUM)
+// stdio runs on the UART at this rate. One character (8N1) is 10 bits.
+#define STDIO_BAUD_RATE 115200
+#define UART_CHAR_US ((10 * CLK_US_PER_SECOND) / STDIO_BAUD_RATE)
 
-// This global variable controls the length of my timer and the period 
-// of the LED toggling. It's default is a second (half on, half off)
+// Period of the heartbeat blink (half on, half off)
 uint16_t u16_period = 1000;
 
-
-bool pico_led_state = true; //pico led state upon POR
-
 // Write to a DS3231 register
 void ds3231_write_register(uint8_t reg, uint8_t data){
     uint8_t buf[2] = {reg, data};
@@ -75,6 +70,34 @@ void ds3231_read_register(uint8_t reg, uint8_t *data){
     i2c_read_blocking(i2c0, DS3231_ADDRESS, data, 1, false);
 }
 
+// Read consecutive DS3231 registers in one transfer. The register
+// pointer auto increments so this is one address phase for all of them.
+void ds3231_read_registers(uint8_t reg, uint8_t *data, uint8_t len){
+    i2c_write_blocking(i2c0, DS3231_ADDRESS, &reg, 1, true);
+    i2c_read_blocking(i2c0, DS3231_ADDRESS, data, len, false);
+}
+
+static uint8_t bcd_to_bin(uint8_t bcd){
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+static uint8_t bin_to_bcd(uint8_t bin){
+    return ((bin / 10) << 4) | (bin % 10);
+}
+
+// Read the full date and time. Registers 0x00-0x06 are seconds,
+// minutes, hours, day of week, date, month/century and year.
+void read_datetime(clk_datetime_t *dt){
+    uint8_t regs[7];
+    ds3231_read_registers(0x00, regs, 7);
+    dt->u8_seconds = bcd_to_bin(regs[0] & 0x7F);
+    dt->u8_minutes = bcd_to_bin(regs[1] & 0x7F);
+    dt->u8_hours = bcd_to_bin(regs[2] & 0x3F);
+    dt->u8_date = bcd_to_bin(regs[4] & 0x3F);
+    dt->u8_month = bcd_to_bin(regs[5] & 0x1F);
+    dt->u8_year = bcd_to_bin(regs[6]);
+}
+
 // Read the current time (seconds, minutes, hours) from the DS3231
 void read_time(uint8_t *hours, uint8_t *minutes, uint8_t *seconds){
     uint8_t time[3]; // Seconds, Minutes, Hours
@@ -102,47 +125,119 @@ void read_time(uint8_t *hours, uint8_t *minutes, uint8_t *seconds){
  *****************************************************************/
 void ds3231_init(){
 
-    i2c_init(i2c0, 100 * 1000);
+    i2c_init(i2c0, DS3231_I2C_BAUD);
     gpio_set_function(SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(SDA_PIN);
     gpio_pull_up(SCL_PIN);
 
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
-    gpio_put(LED_PIN, 1); // Start with LED ON
+    // INTCN = 0 and RS2:RS1 = 00 puts a 1Hz square wave on INT/SQW
+    ds3231_write_register(DS3231_CONTROL_REG, 0x00);
+    clk_discipline_init(DS3231_SQW_PIN);
 }
 
 /*****************************************************************
- * Function: void alarm_irq(void)
+ * Function: void set_time_command(void)
  * 
- * PreCondition: Timer is initialized
+ * PreCondition: A 'T' was just received from the host
  * 
  * Input: None
  * 
  * Output: None
  * 
- * Side Effects: None
+ * Side Effects: Writes the RTC and restarts the clock discipline
  * 
- * Overview: This routine changes the state of the pico LED upon 
-             timer end.
+ * Overview: The host sends "TYYMMDDhhmmss.uuuuuu" and a return,
+ *           stamped with its own clock at the moment the return is
+ *           sent. The DS3231 restarts its 1Hz countdown when the
+ *           seconds register is written, so instead of writing right
+ *           away we wait for the next whole host second, minus the
+ *           time it takes to clock the seconds byte out on I2C, and
+ *           write that second. The RTC second edges then line up
+ *           with the host's.
  *****************************************************************/
-static void alarm_irq(void) {
-    // Clear the alarm irq
-    hw_clear_bits(&timer_hw->intr, 1u << ALARM_NUM);
-    
-    //turn on pico LED whenever timer goes off
-    pico_led_state = !pico_led_state;         // Toggle LED state
-    gpio_put(LED_PIN, pico_led_state);  // Update LED
-
-    // This computes the next clock intstance at which the
-    // alarm will "fire". The 500 * modifies u16_period to fit 
-    // the how the alarm works
-    uint64_t target = timer_hw->timerawl + (500 * u16_period);
-
-    // Write the lower 32 bits of the target time to the alarm which
-    // will arm it
-    timer_hw->alarm[ALARM_NUM] = (uint32_t) target;
+void set_time_command(void){
+    char line[20];
+    uint8_t len = 0;
+    int c;
+    // Read the line in a tight loop so the return is stamped as it arrives
+    while(true){
+        c = getchar_timeout_us(100 * 1000);
+        if(c == PICO_ERROR_TIMEOUT){
+            printf("Set time timed out\n");
+            return;
+        }
+        if(c == '\r' || c == '\n'){
+            break;
+        }
+        if(len < sizeof(line)){
+            line[len++] = (char)c;
+        }
+    }
+    uint64_t rx_us = time_us_64();
+
+    bool valid = len == 19 && line[12] == '.';
+    for(uint8_t i = 0; i < 19 && valid; i++){
+        valid = i == 12 || (line[i] >= '0' && line[i] <= '9');
+    }
+    uint8_t fields[6] = {0};
+    uint32_t frac_us = 0;
+    if(valid){
+        for(uint8_t i = 0; i < 6; i++){
+            fields[i] = (line[2 * i] - '0') * 10 + (line[2 * i + 1] - '0');
+        }
+        for(uint8_t i = 13; i < 19; i++){
+            frac_us = frac_us * 10 + (line[i] - '0');
+        }
+    }
+    clk_datetime_t dt = {fields[0], fields[1], fields[2], fields[3], fields[4], fields[5]};
+    // Month 13 or minute 75 would index past the month table or write a
+    // time the RTC cannot hold
+    if(!valid || !clk_datetime_valid(&dt)){
+        printf("Use TYYMMDDhhmmss.uuuuuu\n");
+        return;
+    }
+
+    // Host time at rx_us. The return took one character time to arrive.
+    uint64_t host_us = (uint64_t)clk_datetime_to_seconds(&dt) * CLK_US_PER_SECOND + frac_us + UART_CHAR_US;
+    // Address, register pointer and seconds byte go out before the seconds register latches
+    uint32_t latency_us = clk_i2c_transfer_us(3, DS3231_I2C_BAUD);
+    uint32_t next_second = (uint32_t)(host_us / CLK_US_PER_SECOND) + 1;
+    uint64_t wait_us = (uint64_t)next_second * CLK_US_PER_SECOND - host_us;
+    if(wait_us < latency_us){
+        next_second++;
+        wait_us += CLK_US_PER_SECOND;
+    }
+
+    clk_seconds_to_datetime(next_second, &dt);
+    uint32_t days = next_second / 86400;
+    uint8_t buf[8] = {
+        0x00,
+        bin_to_bcd(dt.u8_seconds),
+        bin_to_bcd(dt.u8_minutes),
+        bin_to_bcd(dt.u8_hours),
+        (uint8_t)((days + 6) % 7 + 1), // 2000-01-01 was a Saturday, Sunday is 1
+        bin_to_bcd(dt.u8_date),
+        bin_to_bcd(dt.u8_month),
+        bin_to_bcd(dt.u8_year)
+    };
+
+    busy_wait_until(from_us_since_boot(rx_us + wait_us - latency_us));
+    i2c_write_blocking(i2c0, DS3231_ADDRESS, buf, 8, false);
+    clk_discipline_reset();
+    printf("RTC set to 20%02u-%02u-%02u %02u:%02u:%02u\n", dt.u8_year, dt.u8_month, dt.u8_date,
+           dt.u8_hours, dt.u8_minutes, dt.u8_seconds);
+}
+
+// Prints the disciplined time and the current estimates
+void print_clock_status(void){
+    uint64_t now_us = clk_now_us();
+    clk_datetime_t dt;
+    clk_seconds_to_datetime((uint32_t)(now_us / CLK_US_PER_SECOND), &dt);
+    printf("Now 20%02u-%02u-%02u %02u:%02u:%02u.%06u %s offset %.3f ppm drift %.4f ppm/s\n",
+           dt.u8_year, dt.u8_month, dt.u8_date, dt.u8_hours, dt.u8_minutes, dt.u8_seconds,
+           (uint32_t)(now_us % CLK_US_PER_SECOND), clk_is_locked() ? "locked" : "unlocked",
+           clk_offset_ppm(), clk_drift_ppm_per_s());
 }
 
 int main() {
@@ -154,25 +249,9 @@ int main() {
     watchdog_enable(12000, 1); //enable watchdog every 12 seconds.
     ds3231_init();
     
-    // Enable the interrupt for our alarm (the timer outputs 4 alarm irqs)
-    hw_set_bits(&timer_hw->inte, 1u << ALARM_NUM);
-
-    // Set irq handler for alarm irq
-    irq_set_exclusive_handler(ALARM_IRQ, alarm_irq);
-
-    // Enable the alarm irq
-    irq_set_enabled(ALARM_IRQ, true);
-
-    // This is the first time the alarmed will be armed.
-    // Afterwards, it'll be alarmed through the isr.
-    // Alarm is only 32 bits so if trying to delay more
-    // than that need to be careful and keep track of the upper
-    // bits
-    uint64_t target = timer_hw->timerawl + (500 * u16_period);
-
-    // Write the lower 32 bits of the target time to the alarm which
-    // will arm it
-    timer_hw->alarm[ALARM_NUM] = (uint32_t) target;
+    // Heartbeat on the pico LED, no timer interrupt needed
+    led_init(LED_MASK(LED_PICO));
+    led_set_pattern(LED_PICO, LED_PATTERN_BLINK, u16_period);
 
     uint8_t previous_seconds = 0xFF; // Initialize to an invalid value to force the first display
     uint8_t previous_minutes = 0xFF;
@@ -192,17 +271,37 @@ int main() {
     bool led3_state = true; // LED3 starts as ON
     gpio_put(PICOEDUB_LED3_PIN, led3_state);
     uint8_t watchdog_on = 0; // Incremental value until LED2 turns on
+    uint64_t last_read_us = time_us_64();
 
     while (true) {
         //Keep track of previous time
         previous_minutes = minutes; 
         previous_hours = hours;
         
-        read_time(&hours, &minutes, &seconds);
-        
+        // The RTC only changes on a SQW edge, so it is read once per edge
+        // and that read also labels the edge for the clock discipline.
+        if(clk_discipline_edge_pending()){
+            clk_datetime_t dt;
+            uint32_t edges = clk_discipline_edge_count();
+            read_datetime(&dt);
+            // A read the bus garbled is not a time to label the edge with
+            if(edges == clk_discipline_edge_count() && clk_datetime_valid(&dt)){
+                clk_discipline_update(clk_datetime_to_seconds(&dt));
+            }
+            hours = bin_to_bcd(dt.u8_hours);
+            minutes = bin_to_bcd(dt.u8_minutes);
+            seconds = bin_to_bcd(dt.u8_seconds);
+            last_read_us = time_us_64();
+        }
+        else if(clk_discipline_edge_count() == 0 && time_us_64() - last_read_us >= 100 * 1000){
+            // SQW is not wired, fall back to polling the RTC
+            read_time(&hours, &minutes, &seconds);
+            last_read_us = time_us_64();
+        }
             
-        // Toggle LED every 5 seconds
-        if (previous_seconds != seconds && seconds % 5 == 0) {
+        // Toggle LED every 5 seconds. The registers are BCD so convert
+        // before taking the modulo.
+        if (previous_seconds != seconds && bcd_to_bin(seconds) % 5 == 0) {
             printf("LED %s at seconds: %02X\n", led3_state ? "ON" : "OFF", seconds);
             previous_seconds = seconds; 
             led3_state = !led3_state;
@@ -223,7 +322,13 @@ int main() {
         }
 
         
-        sleep_ms(100); // Polling interval
+        int c = getchar_timeout_us(10 * 1000); // Polling interval
+        if(c == 'T'){
+            set_time_command();
+        }
+        else if(c == 'C'){
+            print_clock_status();
+        }
     }
 
     return 0;
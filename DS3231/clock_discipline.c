@@ -0,0 +1,265 @@
+#include "clock_discipline.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+// An offset bigger than this cannot come from crystal error, it means
+// the RTC was written or an edge was mislabelled, so we start over.
+#define CLK_MAX_OFFSET_PPM 500
+
+//Written by the SQW ISR
+static volatile uint64_t u64_edgeUs = 0;
+static volatile uint32_t u32_edgeCount = 0;
+
+//Labelled edges (system time of the edge, RTC seconds at that edge)
+static uint64_t au64_sampleUs[CLK_BASELINE_SECONDS + 1];
+static uint32_t au32_sampleSeconds[CLK_BASELINE_SECONDS + 1];
+static uint32_t u32_numSamples = 0;
+static uint32_t u32_newestSample = 0;
+static uint32_t u32_labelledCount = 0;
+
+//Estimates. The offset is kept in parts per billion so the now()
+//correction can be done with integer math.
+static int32_t i32_offsetPpb = 0;
+static bool b_haveOffset = false;
+static float f_driftPpmPerS = 0.0f;
+static int32_t i32_prevOffsetPpb = 0;
+static uint32_t u32_prevOffsetSeconds = 0;
+static bool b_havePrevOffset = false;
+
+static const uint16_t au16_daysBeforeMonth[12] =
+    {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+/*****************************************************************
+ * Function: static void clk_sqw_callback(uint gpio, uint32_t events)
+ *
+ * PreCondition: clk_discipline_init() has been called
+ *
+ * Input: gpio - pin that caused the interrupt
+ *        events - GPIO_IRQ_* event mask
+ *
+ * Output: None
+ *
+ * Side Effects: None
+ *
+ * Overview: The DS3231 updates its seconds register on the falling
+ *           edge of the 1Hz SQW output. The timestamp is taken
+ *           first so the only error is the interrupt entry latency.
+ *****************************************************************/
+static void clk_sqw_callback(uint gpio, uint32_t events){
+    uint64_t u64_now = time_us_64();
+    if(gpio != DS3231_SQW_PIN || !(events & GPIO_IRQ_EDGE_FALL)){
+        return;
+    }
+    u64_edgeUs = u64_now;
+    u32_edgeCount++;
+}
+
+void clk_discipline_init(uint u_sqw_pin){
+    clk_discipline_reset();
+    gpio_init(u_sqw_pin);
+    gpio_set_dir(u_sqw_pin, GPIO_IN);
+    gpio_pull_up(u_sqw_pin);
+    gpio_set_irq_enabled_with_callback(u_sqw_pin, GPIO_IRQ_EDGE_FALL, true, &clk_sqw_callback);
+}
+
+//Throws away every labelled edge. Called after the RTC is written.
+void clk_discipline_reset(void){
+    u32_numSamples = 0;
+    u32_newestSample = 0;
+    u32_labelledCount = u32_edgeCount;
+    b_haveOffset = false;
+    b_havePrevOffset = false;
+    i32_offsetPpb = 0;
+    f_driftPpmPerS = 0.0f;
+}
+
+uint32_t clk_discipline_edge_count(void){
+    return u32_edgeCount;
+}
+
+bool clk_discipline_edge_pending(void){
+    return u32_edgeCount != u32_labelledCount;
+}
+
+/*****************************************************************
+ * Function: void clk_discipline_update(uint32_t u32_rtcSeconds)
+ *
+ * PreCondition: An edge is pending and the RTC was read after it
+ *
+ * Input: u32_rtcSeconds - RTC time read after the edge, in seconds
+ *                         since 2000-01-01
+ *
+ * Output: None
+ *
+ * Side Effects: Updates the offset and drift estimates
+ *
+ * Overview: The offset is measured across the oldest and newest
+ *           labelled edges instead of edge to edge. Using the RTC
+ *           labels for the span means a missed edge or a late
+ *           main loop does not corrupt the estimate.
+ *****************************************************************/
+void clk_discipline_update(uint32_t u32_rtcSeconds){
+    uint32_t u32_status = save_and_disable_interrupts();
+    uint64_t u64_edge = u64_edgeUs;
+    uint32_t u32_count = u32_edgeCount;
+    restore_interrupts(u32_status);
+
+    if(u32_count == u32_labelledCount){
+        return;
+    }
+    u32_labelledCount = u32_count;
+
+    if(u32_numSamples > 0 && u32_rtcSeconds <= au32_sampleSeconds[u32_newestSample]){
+        //RTC went backwards or did not advance, it was written
+        clk_discipline_reset();
+    }
+
+    u32_newestSample = (u32_newestSample + 1) % (CLK_BASELINE_SECONDS + 1);
+    au64_sampleUs[u32_newestSample] = u64_edge;
+    au32_sampleSeconds[u32_newestSample] = u32_rtcSeconds;
+    if(u32_numSamples < CLK_BASELINE_SECONDS + 1){
+        u32_numSamples++;
+    }
+    if(u32_numSamples < 2){
+        return;
+    }
+
+    //oldest sample still in the ring
+    uint32_t u32_oldest = (u32_newestSample + CLK_BASELINE_SECONDS + 2 - u32_numSamples) % (CLK_BASELINE_SECONDS + 1);
+    uint32_t u32_spanSeconds = u32_rtcSeconds - au32_sampleSeconds[u32_oldest];
+    uint64_t u64_spanUs = u64_edge - au64_sampleUs[u32_oldest];
+
+    //system microseconds per RTC second, minus one second, in ppb
+    int64_t i64_errorNs = ((int64_t)u64_spanUs - (int64_t)u32_spanSeconds * CLK_US_PER_SECOND) * 1000;
+    int32_t i32_measuredPpb = (int32_t)(i64_errorNs / (int64_t)u32_spanSeconds);
+    if(i32_measuredPpb > CLK_MAX_OFFSET_PPM * 1000 || i32_measuredPpb < -CLK_MAX_OFFSET_PPM * 1000){
+        clk_discipline_reset();
+        return;
+    }
+    i32_offsetPpb = i32_measuredPpb;
+    b_haveOffset = true;
+
+    //drift is taken once per full baseline so the estimates compared
+    //do not share any edges
+    if(!b_havePrevOffset){
+        i32_prevOffsetPpb = i32_offsetPpb;
+        u32_prevOffsetSeconds = u32_rtcSeconds;
+        b_havePrevOffset = (u32_spanSeconds >= CLK_BASELINE_SECONDS);
+    }
+    else if(u32_rtcSeconds - u32_prevOffsetSeconds >= CLK_BASELINE_SECONDS){
+        f_driftPpmPerS = (float)(i32_offsetPpb - i32_prevOffsetPpb) / 1000.0f
+                         / (float)(u32_rtcSeconds - u32_prevOffsetSeconds);
+        i32_prevOffsetPpb = i32_offsetPpb;
+        u32_prevOffsetSeconds = u32_rtcSeconds;
+    }
+}
+
+bool clk_is_locked(void){
+    return b_haveOffset;
+}
+
+/*****************************************************************
+ * Function: uint64_t clk_now_us(void)
+ *
+ * PreCondition: None
+ *
+ * Input: None
+ *
+ * Output: Microseconds since 2000-01-01 00:00:00. Until the first
+ *         edge has been labelled this is just time_us_64().
+ *
+ * Side Effects: None
+ *
+ * Overview: RTC seconds of the newest labelled edge plus the system
+ *           time elapsed since it, with the elapsed time scaled
+ *           from system microseconds to RTC microseconds.
+ *****************************************************************/
+uint64_t clk_now_us(void){
+    if(u32_numSamples == 0){
+        return time_us_64();
+    }
+    uint64_t u64_elapsed = time_us_64() - au64_sampleUs[u32_newestSample];
+    int64_t i64_correction = ((int64_t)u64_elapsed * i32_offsetPpb) / 1000000000;
+    return (uint64_t)au32_sampleSeconds[u32_newestSample] * CLK_US_PER_SECOND
+           + (uint64_t)((int64_t)u64_elapsed - i64_correction);
+}
+
+float clk_offset_ppm(void){
+    return (float)i32_offsetPpb / 1000.0f;
+}
+
+float clk_drift_ppm_per_s(void){
+    return f_driftPpmPerS;
+}
+
+static uint8_t clk_days_in_month(uint8_t u8_year, uint8_t u8_month){
+    if(u8_month == 12){
+        return 31;
+    }
+    uint8_t u8_days = au16_daysBeforeMonth[u8_month] - au16_daysBeforeMonth[u8_month - 1];
+    return u8_month == 2 && (u8_year % 4) == 0 ? u8_days + 1 : u8_days;
+}
+
+bool clk_datetime_valid(const clk_datetime_t *p_dt){
+    if(p_dt->u8_year > 99 || p_dt->u8_month < 1 || p_dt->u8_month > 12){
+        return false;
+    }
+    if(p_dt->u8_date < 1 || p_dt->u8_date > clk_days_in_month(p_dt->u8_year, p_dt->u8_month)){
+        return false;
+    }
+    return p_dt->u8_hours < 24 && p_dt->u8_minutes < 60 && p_dt->u8_seconds < 60;
+}
+
+//Valid for the DS3231 range, 2000 to 2099, where every 4th year is a leap year
+uint32_t clk_datetime_to_seconds(const clk_datetime_t *p_dt){
+    //the month indexes the table, a bad one would read past it
+    if(!clk_datetime_valid(p_dt)){
+        return CLK_SECONDS_INVALID;
+    }
+    uint32_t u32_days = (uint32_t)p_dt->u8_year * 365 + (p_dt->u8_year + 3) / 4;
+    u32_days += au16_daysBeforeMonth[p_dt->u8_month - 1];
+    if(p_dt->u8_month > 2 && (p_dt->u8_year % 4) == 0){
+        u32_days++;
+    }
+    u32_days += p_dt->u8_date - 1;
+    return ((u32_days * 24 + p_dt->u8_hours) * 60 + p_dt->u8_minutes) * 60 + p_dt->u8_seconds;
+}
+
+void clk_seconds_to_datetime(uint32_t u32_seconds, clk_datetime_t *p_dt){
+    uint32_t u32_days = u32_seconds / 86400;
+    uint32_t u32_rem = u32_seconds % 86400;
+    p_dt->u8_hours = u32_rem / 3600;
+    p_dt->u8_minutes = (u32_rem / 60) % 60;
+    p_dt->u8_seconds = u32_rem % 60;
+
+    uint8_t u8_year = 0;
+    while(true){
+        uint32_t u32_yearDays = (u8_year % 4) == 0 ? 366 : 365;
+        if(u32_days < u32_yearDays){
+            break;
+        }
+        u32_days -= u32_yearDays;
+        u8_year++;
+    }
+    p_dt->u8_year = u8_year;
+
+    uint8_t u8_month = 12;
+    while(u8_month > 1){
+        uint32_t u32_before = au16_daysBeforeMonth[u8_month - 1];
+        if(u8_month > 2 && (u8_year % 4) == 0){
+            u32_before++;
+        }
+        if(u32_days >= u32_before){
+            u32_days -= u32_before;
+            break;
+        }
+        u8_month--;
+    }
+    p_dt->u8_month = u8_month;
+    p_dt->u8_date = u32_days + 1;
+}
+
+uint32_t clk_i2c_transfer_us(uint32_t u32_numBytes, uint32_t u32_baud){
+    uint32_t u32_bits = 1 + u32_numBytes * 9;
+    return (u32_bits * CLK_US_PER_SECOND + u32_baud - 1) / u32_baud;
+}
@@ -0,0 +1,73 @@
+/**************************************************************
+ * FileName:         clock_discipline.h
+ * Dependencies:     pico/stdlib.h
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Purpose:
+ * Disciplines the RP2350 microsecond timer to the DS3231. The
+ * DS3231 1Hz SQW output is wired to a GPIO and every falling
+ * edge (the RTC seconds update) is timestamped against
+ * timer_hw. From those edges we estimate how fast the system
+ * timer runs compared to the RTC (offset, in ppm) and how that
+ * offset changes (drift). clk_now_us() then gives wall-clock
+ * time with microsecond resolution.
+ *
+ * Times are kept as seconds since 2000-01-01 00:00:00, which is
+ * the first date the DS3231 calendar can hold.
+ **************************************************************/
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include "pico/stdlib.h"
+
+// GPIO that the DS3231 INT/SQW pin is wired to. SQW is open drain,
+// so the pin gets a pull-up in clk_discipline_init().
+#ifndef DS3231_SQW_PIN
+#define DS3231_SQW_PIN 14
+#endif
+
+// Number of RTC seconds the offset estimate is averaged over. A
+// longer baseline divides the ISR entry jitter by the same amount.
+#define CLK_BASELINE_SECONDS 16
+
+#define CLK_US_PER_SECOND 1000000u
+
+// What clk_datetime_to_seconds() gives for a date outside the ranges below
+#define CLK_SECONDS_INVALID 0xFFFFFFFFu
+
+typedef struct {
+    uint8_t u8_year;    // 0-99, years since 2000
+    uint8_t u8_month;   // 1-12
+    uint8_t u8_date;    // 1-31
+    uint8_t u8_hours;   // 0-23
+    uint8_t u8_minutes; // 0-59
+    uint8_t u8_seconds; // 0-59
+} clk_datetime_t;
+
+void clk_discipline_init(uint u_sqw_pin);
+void clk_discipline_reset(void);
+
+// Returns the number of SQW edges seen so far. The main loop compares
+// this before and after reading the RTC to be sure the time it read
+// belongs to the most recent edge.
+uint32_t clk_discipline_edge_count(void);
+bool clk_discipline_edge_pending(void);
+
+// Labels the most recent SQW edge with the RTC time read after it.
+void clk_discipline_update(uint32_t u32_rtcSeconds);
+
+bool clk_is_locked(void);
+uint64_t clk_now_us(void);
+float clk_offset_ppm(void);
+float clk_drift_ppm_per_s(void);
+
+// True if every field is in its range and the date is in its month
+bool clk_datetime_valid(const clk_datetime_t *p_dt);
+// CLK_SECONDS_INVALID unless clk_datetime_valid()
+uint32_t clk_datetime_to_seconds(const clk_datetime_t *p_dt);
+void clk_seconds_to_datetime(uint32_t u32_seconds, clk_datetime_t *p_dt);
+
+// Time for an I2C master to clock out a start condition and n bytes
+// (8 data bits + ACK each) at the given bus rate.
+uint32_t clk_i2c_transfer_us(uint32_t u32_numBytes, uint32_t u32_baud);
+
+#endif
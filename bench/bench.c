@@ -0,0 +1,201 @@
+/**
+ * On-device microbenchmarks for the eduboard apps.
+ *
+ * Runs a fixed suite and prints, for each case, the cycles per operation
+ * and the operations per second at the current clk_sys:
+ *   - both ring buffers, push + pop
+ *   - cb_print_float_to_buffer against snprintf and a fixed-point formatter
+ *   - the LM45 conversion in float and in fixed point (lm45.h)
+ *   - the MCP4725 write done by DACInput, at 100 kHz, 400 kHz and 1 MHz
+ *   - DS3231 register reads, one register and the 7-byte time burst
+ *
+ * Cycles come from the M33 DWT cycle counter. The loop overhead is measured
+ * first and taken off every result. Press any key to run the suite again.
+ *
+ * The CPU cases are in bench_cases.c, which the host build (host/) runs too.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/m33.h"
+#include "hardware/sync.h"
+#include "bench_cases.h"
+
+//same bus the DS3231 and MCP4725 apps use
+#define BENCH_I2C               i2c0
+#define BENCH_SDA_PIN           4
+#define BENCH_SCL_PIN           5
+#define MCP4725_ADDRESS         0x60
+#define DS3231_ADDRESS          0x68
+#define BENCH_I2C_TIMEOUT_US    50000
+
+#define BENCH_CPU_ITERATIONS    10000
+#define BENCH_I2C_ITERATIONS    200
+
+//set by build_profile.cmake, so each run says which build it timed
+#ifndef EDUB_BUILD_PROFILE
+#define EDUB_BUILD_PROFILE      "unknown profile"
+#endif
+
+static uint32_t u32_loopOverhead = 0;
+
+static inline uint32_t bench_cycles(void){
+    return m33_hw->dwt_cyccnt;
+}
+
+static void bench_cycles_init(void){
+    //the DWT only counts once trace is enabled in DEMCR
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+
+//cycles for the whole run, less the empty loop
+static uint32_t bench_measure(bench_fn_t pf_fn, uint32_t u32_iterations){
+    uint32_t u32_start = bench_cycles();
+    pf_fn(u32_iterations);
+    uint32_t u32_cycles = bench_cycles() - u32_start;
+    uint32_t u32_overhead = (uint32_t)(((uint64_t)u32_loopOverhead * u32_iterations) / BENCH_CPU_ITERATIONS);
+    return u32_cycles > u32_overhead ? u32_cycles - u32_overhead : 0;
+}
+
+static void bench_report(const char *pc_name, uint32_t u32_iterations, uint32_t u32_cycles){
+    uint32_t u32_sysHz = clock_get_hz(clk_sys);
+    //cycles per op with one decimal
+    uint32_t u32_tenths = (uint32_t)(((uint64_t)u32_cycles * 10 + u32_iterations / 2) / u32_iterations);
+    uint32_t u32_opsPerSec = u32_cycles == 0 ? 0 : (uint32_t)(((uint64_t)u32_iterations * u32_sysHz) / u32_cycles);
+    printf("%-34s %8lu.%lu cyc/op %10lu op/s\n", pc_name,
+           (unsigned long)(u32_tenths / 10), (unsigned long)(u32_tenths % 10), (unsigned long)u32_opsPerSec);
+}
+
+static void bench_run(const char *pc_name, bench_fn_t pf_fn, uint32_t u32_iterations){
+    //interrupts off so a USB or timer IRQ does not land in one run
+    uint32_t status = save_and_disable_interrupts();
+    uint32_t u32_cycles = bench_measure(pf_fn, u32_iterations);
+    restore_interrupts(status);
+    bench_report(pc_name, u32_iterations, u32_cycles);
+}
+
+/*****************************************************************
+ * I2C cases. A device that does not ACK is reported and skipped.
+ *****************************************************************/
+static uint32_t u32_i2cFails;
+
+//the write DACInput does: fast mode, power down off, 12-bit code
+static int bench_dac_write(uint16_t u16_code){
+    uint8_t au8_data[2];
+    au8_data[0] = (uint8_t)((u16_code >> 8) & 0x0F);
+    au8_data[1] = (uint8_t)(u16_code & 0xFF);
+    return i2c_write_timeout_us(BENCH_I2C, MCP4725_ADDRESS, au8_data, 2, true, BENCH_I2C_TIMEOUT_US);
+}
+
+static void bench_dac(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        if(bench_dac_write((uint16_t)((u32_i * 64) & 0xFFF)) < 1){
+            u32_i2cFails++;
+        }
+    }
+}
+
+static int bench_ds3231_read(uint8_t u8_reg, uint8_t *pu8_data, uint8_t u8_len){
+    if(i2c_write_timeout_us(BENCH_I2C, DS3231_ADDRESS, &u8_reg, 1, true, BENCH_I2C_TIMEOUT_US) < 1){
+        return PICO_ERROR_GENERIC;
+    }
+    return i2c_read_timeout_us(BENCH_I2C, DS3231_ADDRESS, pu8_data, u8_len, false, BENCH_I2C_TIMEOUT_US);
+}
+
+static void bench_ds3231_one(uint32_t u32_iterations){
+    uint8_t u8_data;
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        if(bench_ds3231_read(0x00, &u8_data, 1) < 1){
+            u32_i2cFails++;
+        }
+    }
+}
+
+static void bench_ds3231_burst(uint32_t u32_iterations){
+    uint8_t au8_data[7];
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        if(bench_ds3231_read(0x00, au8_data, 7) < 1){
+            u32_i2cFails++;
+        }
+    }
+}
+
+//I2C runs with interrupts on, a transfer is long enough that it does not matter
+static void bench_run_i2c(const char *pc_name, bench_fn_t pf_fn, uint8_t u8_address){
+    uint8_t u8_probe;
+    if(i2c_read_timeout_us(BENCH_I2C, u8_address, &u8_probe, 1, false, BENCH_I2C_TIMEOUT_US) < 1){
+        printf("%-34s no ACK from 0x%02x, skipped\n", pc_name, u8_address);
+        return;
+    }
+    u32_i2cFails = 0;
+    uint32_t u32_cycles = bench_measure(pf_fn, BENCH_I2C_ITERATIONS);
+    bench_report(pc_name, BENCH_I2C_ITERATIONS, u32_cycles);
+    if(u32_i2cFails != 0){
+        printf("%-34s %lu of %u transfers failed\n", "", (unsigned long)u32_i2cFails, BENCH_I2C_ITERATIONS);
+    }
+}
+
+static void bench_i2c_suite(void){
+    static const uint32_t au32_bauds[] = {100 * 1000, 400 * 1000, 1000 * 1000};
+    char ac_name[40];
+    for(uint8_t u8_i = 0; u8_i < count_of(au32_bauds); u8_i++){
+        uint32_t u32_actual = i2c_init(BENCH_I2C, au32_bauds[u8_i]);
+        printf("-- I2C at %lu Hz (asked for %lu)\n", (unsigned long)u32_actual, (unsigned long)au32_bauds[u8_i]);
+        snprintf(ac_name, sizeof(ac_name), "MCP4725 write @%luk", (unsigned long)(au32_bauds[u8_i] / 1000));
+        bench_run_i2c(ac_name, bench_dac, MCP4725_ADDRESS);
+        //the DS3231 is only rated to 400 kHz
+        if(au32_bauds[u8_i] <= 400 * 1000){
+            snprintf(ac_name, sizeof(ac_name), "DS3231 read 1 reg @%luk", (unsigned long)(au32_bauds[u8_i] / 1000));
+            bench_run_i2c(ac_name, bench_ds3231_one, DS3231_ADDRESS);
+            snprintf(ac_name, sizeof(ac_name), "DS3231 read 7 regs @%luk", (unsigned long)(au32_bauds[u8_i] / 1000));
+            bench_run_i2c(ac_name, bench_ds3231_burst, DS3231_ADDRESS);
+        }
+    }
+}
+
+static void bench_suite(void){
+    printf("\nbench: %s build, clk_sys %lu Hz, %u iterations per CPU case\n",
+           EDUB_BUILD_PROFILE, (unsigned long)clock_get_hz(clk_sys), BENCH_CPU_ITERATIONS);
+
+    //the empty loop is what every other case has on top of its work
+    u32_loopOverhead = 0;
+    uint32_t status = save_and_disable_interrupts();
+    u32_loopOverhead = bench_measure(bench_empty, BENCH_CPU_ITERATIONS);
+    restore_interrupts(status);
+    printf("%-34s %8lu cycles, taken off every result\n", "loop overhead", (unsigned long)u32_loopOverhead);
+
+    bench_cases_init();
+    for(uint8_t u8_i = 0; u8_i < u8_benchNumCpuCases; u8_i++){
+        const bench_case_t *ps_case = &as_benchCpuCases[u8_i];
+        if(ps_case->pc_group != NULL){
+            printf("-- %s\n", ps_case->pc_group);
+        }
+        bench_run(ps_case->pc_name, ps_case->pf_fn, BENCH_CPU_ITERATIONS / ps_case->u8_divisor);
+    }
+
+    bench_i2c_suite();
+    printf("bench: done, press any key to run again\n");
+}
+
+int main(){
+    stdio_init_all();
+    bench_cycles_init();
+
+    gpio_set_function(BENCH_SDA_PIN, GPIO_FUNC_I2C);
+    gpio_set_function(BENCH_SCL_PIN, GPIO_FUNC_I2C);
+    gpio_pull_up(BENCH_SDA_PIN);
+    gpio_pull_up(BENCH_SCL_PIN);
+
+    //time to open a terminal
+    sleep_ms(2000);
+
+    while(true){
+        bench_suite();
+        getchar();
+    }
+}
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include "bench_cases.h"
+#include "picoedub.h"
+#include "lm45.h"
+#include "dac_ring.h"
+#include "filter.h"
+#include "fft.h"
+#include "../i2c_to_MCP4725/sinusoidal_wave/sine_step.h"
+#include "../i2c_to_MCP4725/triangle_wave/triangle_step.h"
+
+volatile uint32_t u32_sink;
+volatile float f_sink;
+
+circular_buffer cb_bench;
+dac_circular_buffer dac_cb_bench;
+char ac_text[32];
+
+//the filters go over a DMA-sized block at a time, an operation is one sample
+#define BENCH_FILT_BLOCK 256
+int16_t ai16_benchSamples[BENCH_FILT_BLOCK];
+int32_t ai32_benchSamples[BENCH_FILT_BLOCK];
+filt_biquad_q15 s_benchBiquadQ15;
+filt_biquad_q31 s_benchBiquadQ31;
+filt_fir_q15 s_benchFir;
+filt_ma_q15 s_benchMa;
+//the LM45 app's 'F', an operation is a whole block
+#define BENCH_FFT_POINTS 1024
+int16_t ai16_benchFftIn[BENCH_FFT_POINTS];
+int32_t ai32_benchFftBins[BENCH_FFT_POINTS];
+
+void bench_empty(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        u32_sink = u32_i;
+    }
+}
+
+static void bench_cb_push_pop(uint32_t u32_iterations){
+    char c_item = 'a';
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        cb_push_back(&cb_bench, &c_item);
+        cb_pop_front(&cb_bench, &c_item);
+    }
+    u32_sink = c_item;
+}
+
+static void bench_dac_cb_push_pop(uint32_t u32_iterations){
+    uint8_t u8_item = 'a';
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        dac_cb_push(&dac_cb_bench, &u8_item);
+        dac_cb_pop_next(&dac_cb_bench, &u8_item);
+    }
+    u32_sink = u8_item;
+}
+
+//the buffer is emptied the same way after every print, so each case pays for it
+static void bench_cb_drain(void){
+    cb_bench.pc_tail = cb_bench.pc_head;
+    cb_bench.u32_count = 0;
+}
+
+static void bench_print_float(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        cb_print_float_to_buffer(&cb_bench, 72.4f + (float)(u32_i & 7));
+        bench_cb_drain();
+    }
+}
+
+static void bench_print_snprintf(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        snprintf(ac_text, sizeof(ac_text), "%.1f", 72.4f + (float)(u32_i & 7));
+        cb_print_cstring_to_buffer(&cb_bench, ac_text);
+        bench_cb_drain();
+    }
+}
+
+void bench_format_tenths(char *pc_out, int32_t i32_tenths){
+    char ac_rev[12];
+    uint8_t u8_len = 0;
+    uint32_t u32_value = i32_tenths < 0 ? (uint32_t)(-i32_tenths) : (uint32_t)i32_tenths;
+    do{
+        ac_rev[u8_len++] = '0' + (u32_value % 10);
+        u32_value /= 10;
+        if(u8_len == 1){
+            ac_rev[u8_len++] = '.';
+        }
+    } while(u32_value != 0 || u8_len < 3);
+    if(i32_tenths < 0){
+        *pc_out++ = '-';
+    }
+    while(u8_len > 0){
+        *pc_out++ = ac_rev[--u8_len];
+    }
+    *pc_out = '\0';
+}
+
+static void bench_print_fixed(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        bench_format_tenths(ac_text, 724 + (int32_t)(u32_i & 7) * 10);
+        cb_print_cstring_to_buffer(&cb_bench, ac_text);
+        bench_cb_drain();
+    }
+}
+
+static void bench_lm45_float(uint32_t u32_iterations){
+    float f_sum = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        f_sum += lm45_raw_to_degF((uint16_t)(u32_i & 0xFFF));
+    }
+    f_sink = f_sum;
+}
+
+static void bench_lm45_fixed(uint32_t u32_iterations){
+    int32_t i32_sum = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        i32_sum += lm45_raw_to_tenthsF((uint16_t)(u32_i & 0xFFF));
+    }
+    u32_sink = (uint32_t)i32_sum;
+}
+
+static void bench_sine_step(uint32_t u32_iterations){
+    uint16_t u16_index = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        u16_index = sine_step(u16_index, (uint8_t)(u32_i & 31) + 1);
+    }
+    u32_sink = u16_index;
+}
+
+static void bench_triangle_step(uint32_t u32_iterations){
+    int16_t i16_code = 0;
+    bool b_down = false;
+    uint32_t u32_sum = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        u32_sum += triangle_step(&i16_code, &b_down, 37);
+    }
+    u32_sink = u32_sum;
+}
+
+//in place, so each block filters the last one's output, which is as good as any
+static void bench_biquad_q15(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i += BENCH_FILT_BLOCK){
+        uint32_t u32_n = MIN(BENCH_FILT_BLOCK, u32_iterations - u32_i);
+        filt_biquad_q15_block(&s_benchBiquadQ15, ai16_benchSamples, ai16_benchSamples, u32_n);
+    }
+    u32_sink = (uint32_t)ai16_benchSamples[0];
+}
+
+static void bench_biquad_q31(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i += BENCH_FILT_BLOCK){
+        uint32_t u32_n = MIN(BENCH_FILT_BLOCK, u32_iterations - u32_i);
+        filt_biquad_q31_block(&s_benchBiquadQ31, ai32_benchSamples, ai32_benchSamples, u32_n);
+    }
+    u32_sink = (uint32_t)ai32_benchSamples[0];
+}
+
+static void bench_fir_q15(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i += BENCH_FILT_BLOCK){
+        uint32_t u32_n = MIN(BENCH_FILT_BLOCK, u32_iterations - u32_i);
+        filt_fir_q15_block(&s_benchFir, ai16_benchSamples, ai16_benchSamples, u32_n);
+    }
+    u32_sink = (uint32_t)ai16_benchSamples[0];
+}
+
+static void bench_ma_q15(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i += BENCH_FILT_BLOCK){
+        uint32_t u32_n = MIN(BENCH_FILT_BLOCK, u32_iterations - u32_i);
+        filt_ma_q15_block(&s_benchMa, ai16_benchSamples, ai16_benchSamples, u32_n);
+    }
+    u32_sink = (uint32_t)ai16_benchSamples[0];
+}
+
+static void bench_fft_1024(uint32_t u32_iterations){
+    for(uint32_t u32_i = 0; u32_i < u32_iterations; u32_i++){
+        fft_real_q15(ai16_benchFftIn, ai32_benchFftBins, BENCH_FFT_POINTS);
+    }
+    u32_sink = (uint32_t)ai32_benchFftBins[2];
+}
+
+void bench_cases_init(void){
+    cb_init(&cb_bench);
+    dac_cb_init(&dac_cb_bench);
+
+    //a 4th-order lowpass at 50 kHz for 500 kS/s, a 16-tap boxcar as the FIR
+    double aad_coef[2][5];
+    filt_design_lowpass(aad_coef[0], 50000, 500000, 0.5412);
+    filt_design_lowpass(aad_coef[1], 50000, 500000, 1.3066);
+    filt_biquad_q15_init(&s_benchBiquadQ15, 2, (const double (*)[5])aad_coef);
+    filt_biquad_q31_init(&s_benchBiquadQ31, 1, (const double (*)[5])aad_coef);
+    double ad_taps[16];
+    for(uint8_t u8_i = 0; u8_i < 16; u8_i++){
+        ad_taps[u8_i] = 1.0 / 16;
+    }
+    filt_fir_q15_init(&s_benchFir, 16, ad_taps);
+    filt_ma_q15_init(&s_benchMa, 16, 0);
+    //ADC readings, as the Q15 filters get them
+    for(uint32_t u32_i = 0; u32_i < BENCH_FILT_BLOCK; u32_i++){
+        ai16_benchSamples[u32_i] = (int16_t)(((u32_i * 2654435761u) >> 20) << 3);
+        ai32_benchSamples[u32_i] = (int32_t)(((u32_i * 2654435761u) >> 20) << 16);
+    }
+    for(uint32_t u32_i = 0; u32_i < BENCH_FFT_POINTS; u32_i++){
+        ai16_benchFftIn[u32_i] = (int16_t)(((u32_i * 2654435761u) >> 20) << 3);
+    }
+    //the first call builds the sine table, not something to time
+    fft_real_q15(ai16_benchFftIn, ai32_benchFftBins, BENCH_FFT_POINTS);
+}
+
+const bench_case_t as_benchCpuCases[] = {
+    {"ring buffers",            "cb.c push_back + pop_front",           bench_cb_push_pop,      1},
+    {NULL,                      "circular_buffer.c push + pop_next",    bench_dac_cb_push_pop,  1},
+    {"printing a temperature",  "cb_print_float_to_buffer (%f)",        bench_print_float,      10},
+    {NULL,                      "snprintf %.1f + print_cstring",        bench_print_snprintf,   10},
+    {NULL,                      "fixed tenths + print_cstring",         bench_print_fixed,      1},
+    {"LM45 conversion",         "lm45_raw_to_degF (float)",             bench_lm45_float,       1},
+    {NULL,                      "lm45_raw_to_tenthsF (fixed)",          bench_lm45_fixed,       1},
+    {"waveforms",               "sine_step",                            bench_sine_step,        1},
+    {NULL,                      "triangle_step",                        bench_triangle_step,    1},
+    {"filters, per sample",     "biquad q15, 2 sections",               bench_biquad_q15,       1},
+    {NULL,                      "biquad q31, 1 section",                bench_biquad_q31,       1},
+    {NULL,                      "fir q15, 16 taps",                     bench_fir_q15,          1},
+    {NULL,                      "moving average q15, 16",               bench_ma_q15,           1},
+    {"FFT, per block",          "fft_real_q15, 1024 points",            bench_fft_1024,         200},
+};
+const uint8_t u8_benchNumCpuCases = count_of(as_benchCpuCases);
@@ -0,0 +1,39 @@
+/**
+ * Benchmark cases that are plain C.
+ *
+ * Each case runs its operation u32_iterations times in its own loop, so the
+ * call through the table is paid once per run, not once per operation.
+ * bench.c times these on the Pico, host/host_bench.c on a PC.
+ */
+#ifndef BENCH_CASES_H
+#define BENCH_CASES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*bench_fn_t)(uint32_t u32_iterations);
+
+typedef struct {
+    const char *pc_group;     // printed as a heading before the case, NULL to continue the group
+    const char *pc_name;
+    bench_fn_t pf_fn;
+    uint8_t u8_divisor;       // slow cases run the base iteration count divided by this
+} bench_case_t;
+
+extern const bench_case_t as_benchCpuCases[];
+extern const uint8_t u8_benchNumCpuCases;
+
+//results land here so the compiler cannot drop the work
+extern volatile uint32_t u32_sink;
+extern volatile float f_sink;
+
+//sets up the buffers the cases use, call before running them
+void bench_cases_init(void);
+
+//the loop alone, for the overhead
+void bench_empty(uint32_t u32_iterations);
+
+//tenths as "-ddd.d" with no float, the fixed-point alternative to %f
+void bench_format_tenths(char *pc_out, int32_t i32_tenths);
+
+#endif
@@ -1,4 +1,5 @@
 #include "circular_buffer.h"
+#include "edub_ram.h"
 
 void cb_init(circular_buffer *cb) { 
     cb->last_index = &cb->buffer[BUFFER_SIZE - 1];        //I set the size
@@ -6,14 +7,17 @@ void cb_init(circular_buffer *cb) {
     cb->tail = cb->buffer;
     cb->full = 0;       //full is false
     cb->empty = 1;       //empty is true
+    cb->u32_drops = 0;
+    cb->u32_highWater = 0;
 }
 
-int cb_push(circular_buffer *cb, uint8_t *data){
+int EDUB_RAM_FUNC(cb_push)(circular_buffer *cb, uint8_t *data){
     //This should protect the code from interrupts
     uint32_t u32_register = save_and_disable_interrupts(); 
 
    // Check if the buffer is full
     if (cb->full) {
+        cb->u32_drops++;
         restore_interrupts(u32_register);
         return -1; // Buffer is full
     }
@@ -35,12 +39,18 @@ int cb_push(circular_buffer *cb, uint8_t *data){
         cb->full = 1;       // Buffer is full
     }
 
+    // Track the fullest the buffer has been
+    uint32_t u32_count = cb->full ? BUFFER_SIZE : (uint32_t)((cb->head - cb->tail + BUFFER_SIZE) % BUFFER_SIZE);
+    if (u32_count > cb->u32_highWater) {
+        cb->u32_highWater = u32_count;
+    }
+
     restore_interrupts(u32_register);
 
     return(0);
 };
 
-int cb_pop_next(circular_buffer *cb, uint8_t *data){
+int EDUB_RAM_FUNC(cb_pop_next)(circular_buffer *cb, uint8_t *data){
     //This should protect the code from interrupts
     uint32_t u32_register = save_and_disable_interrupts();
     
@@ -104,7 +114,7 @@ int cb_pop_recent(circular_buffer *cb, uint8_t *data){
 };
 
 //simply return empty var
-uint8_t cb_is_empty(circular_buffer *cb){
+uint8_t EDUB_RAM_FUNC(cb_is_empty)(circular_buffer *cb){
     return(cb->empty);
 };
 
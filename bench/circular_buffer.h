@@ -17,6 +17,8 @@ typedef struct {
     uint8_t *last_index;       // Size of the buffer (must be a power of 2)
     uint8_t full;          // Is the buffer full?
     uint8_t empty;         // Is the buffer empty?
+    uint32_t u32_drops;     // pushes lost because the buffer was full
+    uint32_t u32_highWater; // most items the buffer has held since cb_init
 }circular_buffer;
 
 void cb_init(circular_buffer *cb);
@@ -0,0 +1,3 @@
+#define DAC_RING_KEEP_NAMES
+#include "dac_ring.h"
+#include "circular_buffer.c"
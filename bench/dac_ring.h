@@ -0,0 +1,33 @@
+/**
+ * The ring buffer the MCP4725 apps had before they moved to cb.c
+ * (circular_buffer.c, kept here as the baseline) under other names.
+ *
+ * It has the same type name and cb_init() as cb.c in picoedub/, so both
+ * cannot be linked into one program as they are. Every name is given a
+ * dac_ prefix here, and dac_ring.c builds the unchanged source with them.
+ */
+#ifndef DAC_RING_H
+#define DAC_RING_H
+
+#define circular_buffer dac_circular_buffer
+#define cb_init         dac_cb_init
+#define cb_push         dac_cb_push
+#define cb_pop_next     dac_cb_pop_next
+#define cb_pop_recent   dac_cb_pop_recent
+#define cb_is_empty     dac_cb_is_empty
+#define cb_is_full      dac_cb_is_full
+
+#include "circular_buffer.h"
+
+//dac_ring.c keeps the names so circular_buffer.c is renamed as it compiles
+#ifndef DAC_RING_KEEP_NAMES
+#undef circular_buffer
+#undef cb_init
+#undef cb_push
+#undef cb_pop_next
+#undef cb_pop_recent
+#undef cb_is_empty
+#undef cb_is_full
+#endif
+
+#endif
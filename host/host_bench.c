@@ -0,0 +1,152 @@
+/**
+ * The bench/ CPU cases, timed on the host.
+ *
+ * Runs every case in bench_cases.c a few times, keeps the fastest run and
+ * prints ns per operation. The same results are written as JSON so runs
+ * from different commits can be compared by a script:
+ *
+ *   host_bench [--iterations N] [--runs N] [--json FILE]
+ *
+ * A PC is not a Pico, so only compare host numbers with host numbers. They
+ * are good for spotting a change that makes a case slower or faster.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_cases.h"
+
+#ifndef HOST_BENCH_COMMIT
+#define HOST_BENCH_COMMIT "unknown"
+#endif
+
+#define HOST_BENCH_ITERATIONS   1000000
+#define HOST_BENCH_RUNS         5
+
+typedef struct {
+    const char *pc_name;
+    uint32_t u32_iterations;
+    double d_nsPerOp;
+} host_result_t;
+
+static uint64_t host_now_ns(void){
+    struct timespec s_now;
+    clock_gettime(CLOCK_MONOTONIC, &s_now);
+    return (uint64_t)s_now.tv_sec * 1000000000u + (uint64_t)s_now.tv_nsec;
+}
+
+//fastest of u32_runs, the others were slowed by something else on the machine
+static uint64_t host_time(bench_fn_t pf_fn, uint32_t u32_iterations, uint32_t u32_runs){
+    uint64_t u64_best = UINT64_MAX;
+    for(uint32_t u32_run = 0; u32_run < u32_runs; u32_run++){
+        uint64_t u64_start = host_now_ns();
+        pf_fn(u32_iterations);
+        uint64_t u64_ns = host_now_ns() - u64_start;
+        if(u64_ns < u64_best){
+            u64_best = u64_ns;
+        }
+    }
+    return u64_best;
+}
+
+//the case names have no control characters, only quotes and backslashes need escaping
+static void host_json_string(FILE *ps_file, const char *pc_text){
+    fputc('"', ps_file);
+    for(; *pc_text != '\0'; pc_text++){
+        if(*pc_text == '"' || *pc_text == '\\'){
+            fputc('\\', ps_file);
+        }
+        fputc(*pc_text, ps_file);
+    }
+    fputc('"', ps_file);
+}
+
+static int host_write_json(const char *pc_path, const host_result_t *as_results, uint8_t u8_count,
+                           uint32_t u32_runs){
+    FILE *ps_file = fopen(pc_path, "w");
+    if(ps_file == NULL){
+        perror(pc_path);
+        return 1;
+    }
+    fprintf(ps_file, "{\n  \"commit\": ");
+    host_json_string(ps_file, HOST_BENCH_COMMIT);
+    fprintf(ps_file, ",\n  \"compiler\": ");
+    host_json_string(ps_file, __VERSION__);
+    fprintf(ps_file, ",\n  \"runs\": %lu,\n  \"results\": [\n", (unsigned long)u32_runs);
+    for(uint8_t u8_i = 0; u8_i < u8_count; u8_i++){
+        double d_opsPerSec = as_results[u8_i].d_nsPerOp > 0 ? 1e9 / as_results[u8_i].d_nsPerOp : 0;
+        fprintf(ps_file, "    {\"name\": ");
+        host_json_string(ps_file, as_results[u8_i].pc_name);
+        fprintf(ps_file, ", \"iterations\": %lu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f}%s\n",
+                (unsigned long)as_results[u8_i].u32_iterations, as_results[u8_i].d_nsPerOp, d_opsPerSec,
+                u8_i + 1 < u8_count ? "," : "");
+    }
+    fprintf(ps_file, "  ]\n}\n");
+    return fclose(ps_file) == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv){
+    uint32_t u32_iterations = HOST_BENCH_ITERATIONS;
+    uint32_t u32_runs = HOST_BENCH_RUNS;
+    const char *pc_json = "host_bench.json";
+
+    for(int i_arg = 1; i_arg < argc; i_arg++){
+        if(strcmp(argv[i_arg], "--iterations") == 0 && i_arg + 1 < argc){
+            u32_iterations = (uint32_t)strtoul(argv[++i_arg], NULL, 0);
+        }
+        else if(strcmp(argv[i_arg], "--runs") == 0 && i_arg + 1 < argc){
+            u32_runs = (uint32_t)strtoul(argv[++i_arg], NULL, 0);
+        }
+        else if(strcmp(argv[i_arg], "--json") == 0 && i_arg + 1 < argc){
+            pc_json = argv[++i_arg];
+        }
+        else {
+            fprintf(stderr, "usage: %s [--iterations N] [--runs N] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(u32_iterations == 0 || u32_runs == 0){
+        fprintf(stderr, "iterations and runs must be at least 1\n");
+        return 2;
+    }
+
+    printf("host_bench: commit %s, %lu iterations, best of %lu runs\n",
+           HOST_BENCH_COMMIT, (unsigned long)u32_iterations, (unsigned long)u32_runs);
+
+    //the empty loop is taken off every case, as on the Pico
+    uint64_t u64_overhead = host_time(bench_empty, u32_iterations, u32_runs);
+    printf("%-34s %10.3f ns/op, taken off every result\n", "loop overhead", (double)u64_overhead / u32_iterations);
+
+    host_result_t *as_results = calloc(u8_benchNumCpuCases, sizeof(host_result_t));
+    if(as_results == NULL){
+        return 1;
+    }
+    bench_cases_init();
+    for(uint8_t u8_i = 0; u8_i < u8_benchNumCpuCases; u8_i++){
+        const bench_case_t *ps_case = &as_benchCpuCases[u8_i];
+        uint32_t u32_caseIterations = u32_iterations / ps_case->u8_divisor;
+        if(u32_caseIterations == 0){
+            u32_caseIterations = 1;
+        }
+        uint64_t u64_ns = host_time(ps_case->pf_fn, u32_caseIterations, u32_runs);
+        uint64_t u64_caseOverhead = u64_overhead * u32_caseIterations / u32_iterations;
+        u64_ns = u64_ns > u64_caseOverhead ? u64_ns - u64_caseOverhead : 0;
+
+        as_results[u8_i].pc_name = ps_case->pc_name;
+        as_results[u8_i].u32_iterations = u32_caseIterations;
+        as_results[u8_i].d_nsPerOp = (double)u64_ns / u32_caseIterations;
+
+        if(ps_case->pc_group != NULL){
+            printf("-- %s\n", ps_case->pc_group);
+        }
+        printf("%-34s %10.3f ns/op\n", ps_case->pc_name, as_results[u8_i].d_nsPerOp);
+    }
+
+    int i_result = host_write_json(pc_json, as_results, u8_benchNumCpuCases, u32_runs);
+    if(i_result == 0){
+        printf("host_bench: results in %s\n", pc_json);
+    }
+    free(as_results);
+    return i_result;
+}
@@ -0,0 +1,3 @@
+#include "hardware/sync.h"
+
+volatile uint32_t host_irq_disabled = 0;
@@ -0,0 +1,153 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include <string.h>
+#include <ucontext.h>
+#include "preempt.h"
+#include "hardware/sync.h"
+
+static uint32_t u32_preemptTaken = 0;
+static uint32_t u32_preemptDeferred = 0;
+
+uint32_t preempt_taken(void){
+    return u32_preemptTaken;
+}
+
+uint32_t preempt_deferred(void){
+    return u32_preemptDeferred;
+}
+
+#if defined(__x86_64__) && defined(__linux__)
+#define PREEMPT_TRAP_FLAG   0x100u
+
+static preempt_fn_t pf_preemptIsr;
+static const uint32_t *pu32_preemptPoints;
+static uint32_t u32_preemptNumPoints;
+static uint32_t u32_preemptNext;        // index of the next point
+static volatile uint32_t u32_preemptStep;
+static volatile bool b_preemptStepping = false;
+static bool b_preemptPending = false;
+static bool b_preemptInstalled = false;
+
+static void preempt_take(void){
+    b_preemptPending = false;
+    u32_preemptTaken++;
+    pf_preemptIsr();
+}
+
+//one instruction of pf_main has run. The kernel clears the trap flag for
+//the handler, so the ISR runs at full speed and is never stepped itself.
+static void preempt_on_trap(int i_signal, siginfo_t *ps_info, void *pv_context){
+    (void)i_signal;
+    (void)ps_info;
+    ucontext_t *ps_context = pv_context;
+    if(!b_preemptStepping){
+        ps_context->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)PREEMPT_TRAP_FLAG;
+        return;
+    }
+    uint32_t u32_step = u32_preemptStep++;
+    while(u32_preemptNext < u32_preemptNumPoints && pu32_preemptPoints[u32_preemptNext] <= u32_step){
+        u32_preemptNext++;
+        if(host_irq_disabled){
+            u32_preemptDeferred++;
+        }
+        //a second request while one is pending is the same pending bit
+        b_preemptPending = true;
+    }
+    if(b_preemptPending && !host_irq_disabled){
+        preempt_take();
+        //nothing more to land, so the rest need not be stepped
+        if(u32_preemptNumPoints != 0 && u32_preemptNext == u32_preemptNumPoints){
+            b_preemptStepping = false;
+            ps_context->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)PREEMPT_TRAP_FLAG;
+        }
+    }
+}
+
+static void preempt_install(void){
+    struct sigaction s_action;
+    memset(&s_action, 0, sizeof(s_action));
+    s_action.sa_sigaction = preempt_on_trap;
+    s_action.sa_flags = SA_SIGINFO;
+    sigemptyset(&s_action.sa_mask);
+    sigaction(SIGTRAP, &s_action, NULL);
+    b_preemptInstalled = true;
+}
+
+//sets the trap flag, the instruction after the popfq is the first one trapped.
+//The pushfq writes below the stack pointer, so step over the red zone first.
+static __attribute__((noinline)) void preempt_trace_on(void){
+    __asm__ volatile(
+        "sub $128, %%rsp\n\t"
+        "pushfq\n\t"
+        "orq $0x100, (%%rsp)\n\t"
+        "popfq\n\t"
+        "add $128, %%rsp"
+        ::: "memory", "cc");
+}
+
+bool preempt_supported(void){
+    return true;
+}
+
+static void preempt_step(preempt_fn_t pf_main, preempt_fn_t pf_isr, const uint32_t *pu32_points, uint32_t u32_numPoints){
+    if(!b_preemptInstalled){
+        preempt_install();
+    }
+    pf_preemptIsr = pf_isr;
+    pu32_preemptPoints = pu32_points;
+    u32_preemptNumPoints = u32_numPoints;
+    u32_preemptNext = 0;
+    u32_preemptStep = 0;
+    b_preemptPending = false;
+    u32_preemptTaken = 0;
+    u32_preemptDeferred = 0;
+
+    b_preemptStepping = true;
+    preempt_trace_on();
+    pf_main();
+    //the next trap, if it is still stepping, sees this and clears the flag
+    b_preemptStepping = false;
+    __asm__ volatile("nop" ::: "memory");
+
+    //points past the end, and one still held off, are taken now
+    if(u32_preemptNext < u32_preemptNumPoints){
+        b_preemptPending = true;
+    }
+    if(b_preemptPending){
+        preempt_take();
+    }
+}
+
+uint32_t preempt_count(preempt_fn_t pf_main){
+    preempt_step(pf_main, NULL, NULL, 0);
+    //includes the few boundaries of the call into pf_main and back out
+    return u32_preemptStep;
+}
+
+void preempt_run(preempt_fn_t pf_main, preempt_fn_t pf_isr, const uint32_t *pu32_points, uint32_t u32_numPoints){
+    preempt_step(pf_main, pf_isr, pu32_points, u32_numPoints);
+}
+
+#else
+
+bool preempt_supported(void){
+    return false;
+}
+
+uint32_t preempt_count(preempt_fn_t pf_main){
+    pf_main();
+    return 0;
+}
+
+void preempt_run(preempt_fn_t pf_main, preempt_fn_t pf_isr, const uint32_t *pu32_points, uint32_t u32_numPoints){
+    (void)pu32_points;
+    u32_preemptTaken = 0;
+    u32_preemptDeferred = 0;
+    pf_main();
+    if(u32_numPoints != 0){
+        u32_preemptTaken = 1;
+        pf_isr();
+    }
+}
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * A virtual interrupt that can land at any instruction boundary.
+ *
+ * preempt_run() runs a function one machine instruction at a time (the
+ * x86-64 trap flag, so only on x86-64 Linux) and calls an "ISR" between
+ * two of its instructions, at the boundaries it is given. The boundaries
+ * are counted from the start of the function, so the same list gives the
+ * same interleaving every run. While host_irq_disabled is set
+ * (save_and_disable_interrupts() in stubs/hardware/sync.h) the ISR is
+ * held pending and taken at the first boundary after the critical region,
+ * as PRIMASK holds off a real one. A pending ISR still not taken when the
+ * function returns is taken then.
+ *
+ * The host's instructions are not the M33's, but the loads and stores of
+ * shared state are separate instructions on both, so every place an ISR
+ * can split an update on the Pico has a boundary here too.
+ */
+#ifndef PREEMPT_H
+#define PREEMPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef void (*preempt_fn_t)(void);
+
+//false where the trap flag cannot be used, preempt_run() then only runs pf_main
+bool preempt_supported(void);
+
+//runs pf_main stepping, but with no ISR, and returns how many boundaries it had
+uint32_t preempt_count(preempt_fn_t pf_main);
+
+//runs pf_main with pf_isr at each boundary in pu32_points (ascending). The
+//stepping stops once the last ISR has been taken, the rest runs at full speed.
+void preempt_run(preempt_fn_t pf_main, preempt_fn_t pf_isr, const uint32_t *pu32_points, uint32_t u32_numPoints);
+
+//ISRs taken in the last run, and how many of them had to wait for a critical region
+uint32_t preempt_taken(void);
+uint32_t preempt_deferred(void);
+
+#endif
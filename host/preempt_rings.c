@@ -0,0 +1,4 @@
+//The ring buffers preempt_stress runs, compiled on their own so CMakeLists.txt
+//can build just them at -O0. The sources are the apps' own, unchanged.
+#include "../picoedub/cb.c"
+#include "../bench/dac_ring.c"
@@ -0,0 +1,11 @@
+/**
+ * Both apps' ring buffers in one program, for preempt_stress. The MCP4725
+ * apps' one is renamed with a dac_ prefix, as bench/dac_ring.h does it.
+ */
+#ifndef PREEMPT_RINGS_H
+#define PREEMPT_RINGS_H
+
+#include "cb.h"
+#include "dac_ring.h"
+
+#endif
@@ -0,0 +1,500 @@
+/**
+ * Preemption stress test for the ring buffers.
+ *
+ * Each buffer is shared between a UART ISR and a main loop, one side
+ * pushing and the other popping:
+ *   TX  main pushes, the ISR pops (uartCallback in the LM45 app)
+ *   RX  the ISR pushes, main pops (on_uart_rx in the MCP4725 apps)
+ * The main side runs a list of operations under preempt_run(), and the
+ * ISR side runs a burst of its own at the chosen instruction boundaries.
+ * Every item the producer had accepted must come out of the consumer once
+ * and in order, with nothing else, once the buffer is drained at the end.
+ *
+ * First every boundary of a set of fixed cases is tried, one ISR at each;
+ * the cases start empty, nearly full, full and at the wrap. The buffers
+ * themselves are built at -O0 (preempt_rings.c) so that, as on the M33, a
+ * read-modify-write is a load, an add and a store, each a boundary. Then each
+ * random seed picks a start, an operation list, a burst size and up to
+ * four boundaries. A failure prints the seed or boundary, which replays
+ * it exactly:
+ *
+ *   preempt_stress [--seeds N] [--seed S] [--verbose]
+ *
+ * A buffer variant is a row in as_variants. The last row has no critical
+ * regions at all and has to fail, which shows races are being found.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "preempt_rings.h"
+#include "preempt.h"
+#include "hardware/sync.h"
+
+#define PREEMPT_SEEDS           1000
+#define PREEMPT_MAX_OPS         8
+#define PREEMPT_MAX_POINTS      4
+#define PREEMPT_MAX_BURST       4
+#define PREEMPT_MANY_LEN        3
+#define PREEMPT_LOG_SIZE        2048
+
+typedef struct {
+    const char *pc_name;
+    uint32_t u32_capacity;
+    void (*pf_init)(void);
+    bool (*pf_push)(uint8_t u8_item);                               // false when it was dropped
+    uint32_t (*pf_push_many)(const uint8_t *pu8_items, uint32_t u32_num); // items kept, NULL if it has none
+    bool (*pf_pop)(uint8_t *pu8_item);                              // false when empty
+    bool b_unprotected;                                             // expected to fail
+} ring_variant_t;
+
+typedef enum {
+    RING_TX,        // main pushes, the ISR pops
+    RING_RX         // the ISR pushes, main pops
+} ring_scenario_t;
+
+typedef enum {
+    OP_PUSH,
+    OP_PUSH_MANY,
+    OP_POP
+} ring_op_t;
+
+typedef struct {
+    uint32_t u32_rotate;        // items through the buffer before the start, moves the wrap
+    uint32_t u32_prefill;       // items in it at the start
+    ring_op_t ae_ops[PREEMPT_MAX_OPS];
+    uint8_t u8_numOps;
+    uint8_t u8_burst;           // operations per ISR
+} ring_case_t;
+
+/*****************************************************************
+ * The variants
+ *****************************************************************/
+static circular_buffer cb_ring;
+
+static void cb_ring_init(void){
+    cb_init(&cb_ring);
+}
+
+//cb.c drops quietly, a dropped item shows in u32_drops
+static bool cb_ring_push(uint8_t u8_item){
+    uint32_t u32_drops = cb_ring.u32_drops;
+    char c_item = (char)u8_item;
+    cb_push_back(&cb_ring, &c_item);
+    return cb_ring.u32_drops == u32_drops;
+}
+
+static uint32_t cb_ring_push_many(const uint8_t *pu8_items, uint32_t u32_num){
+    char ac_string[PREEMPT_MANY_LEN + 1];
+    memcpy(ac_string, pu8_items, u32_num);
+    ac_string[u32_num] = '\0';
+    uint32_t u32_drops = cb_ring.u32_drops;
+    cb_print_cstring_to_buffer(&cb_ring, ac_string);
+    return u32_num - (cb_ring.u32_drops - u32_drops);
+}
+
+static bool cb_ring_pop(uint8_t *pu8_item){
+    if(cb_isEmpty(&cb_ring)){
+        return false;
+    }
+    char c_item;
+    cb_pop_front(&cb_ring, &c_item);
+    *pu8_item = (uint8_t)c_item;
+    return true;
+}
+
+static dac_circular_buffer dac_ring;
+
+static void dac_ring_init(void){
+    dac_cb_init(&dac_ring);
+}
+
+static bool dac_ring_push(uint8_t u8_item){
+    return dac_cb_push(&dac_ring, &u8_item) == 0;
+}
+
+//as the apps do it, a look at empty and then the pop
+static bool dac_ring_pop(uint8_t *pu8_item){
+    if(dac_cb_is_empty(&dac_ring)){
+        return false;
+    }
+    return dac_cb_pop_next(&dac_ring, pu8_item) == 0;
+}
+
+//no critical regions, and the count is read, changed and written back as
+//three instructions, as the M33 does it
+#define BARE_SIZE 16
+static uint8_t au8_bare[BARE_SIZE];
+static uint32_t u32_bareHead;
+static uint32_t u32_bareTail;
+static volatile uint32_t u32_bareCount;
+
+static void bare_ring_init(void){
+    u32_bareHead = 0;
+    u32_bareTail = 0;
+    u32_bareCount = 0;
+}
+
+static bool bare_ring_push(uint8_t u8_item){
+    uint32_t u32_count = u32_bareCount;
+    if(u32_count == BARE_SIZE){
+        return false;
+    }
+    au8_bare[u32_bareHead] = u8_item;
+    u32_bareHead = (u32_bareHead + 1) % BARE_SIZE;
+    u32_bareCount = u32_count + 1;
+    return true;
+}
+
+static bool bare_ring_pop(uint8_t *pu8_item){
+    uint32_t u32_count = u32_bareCount;
+    if(u32_count == 0){
+        return false;
+    }
+    *pu8_item = au8_bare[u32_bareTail];
+    u32_bareTail = (u32_bareTail + 1) % BARE_SIZE;
+    u32_bareCount = u32_count - 1;
+    return true;
+}
+
+static const ring_variant_t as_variants[] = {
+    {"cb.c",              CD_BUFFER_SIZE, cb_ring_init,   cb_ring_push,   cb_ring_push_many, cb_ring_pop,   false},
+    {"circular_buffer.c", BUFFER_SIZE,    dac_ring_init,  dac_ring_push,  NULL,              dac_ring_pop,  false},
+    {"unprotected ring",  BARE_SIZE,      bare_ring_init, bare_ring_push, NULL,              bare_ring_pop, true},
+};
+
+/*****************************************************************
+ * One run
+ *****************************************************************/
+static const ring_variant_t *ps_variant;
+static ring_scenario_t e_scenario;
+static const ring_case_t *ps_case;
+static uint8_t u8_nextItem;
+static uint8_t au8_accepted[PREEMPT_LOG_SIZE];
+static uint32_t u32_numAccepted;
+static uint8_t au8_popped[PREEMPT_LOG_SIZE];
+static uint32_t u32_numPopped;
+static bool b_verbose = false;
+
+//1..255, cb_print_cstring_to_buffer() stops at a zero
+static uint8_t ring_item(void){
+    u8_nextItem = (uint8_t)(u8_nextItem % 255 + 1);
+    return u8_nextItem;
+}
+
+static void ring_accepted(uint8_t u8_item){
+    if(u32_numAccepted < PREEMPT_LOG_SIZE){
+        au8_accepted[u32_numAccepted] = u8_item;
+    }
+    u32_numAccepted++;
+}
+
+static void ring_produce(void){
+    uint8_t u8_item = ring_item();
+    if(ps_variant->pf_push(u8_item)){
+        ring_accepted(u8_item);
+    }
+}
+
+static void ring_produce_many(void){
+    uint8_t au8_items[PREEMPT_MANY_LEN];
+    for(uint8_t u8_i = 0; u8_i < PREEMPT_MANY_LEN; u8_i++){
+        au8_items[u8_i] = ring_item();
+    }
+    //the ones kept are the first ones
+    uint32_t u32_kept = ps_variant->pf_push_many(au8_items, PREEMPT_MANY_LEN);
+    for(uint32_t u32_i = 0; u32_i < u32_kept; u32_i++){
+        ring_accepted(au8_items[u32_i]);
+    }
+}
+
+static void ring_consume(void){
+    uint8_t u8_item;
+    if(ps_variant->pf_pop(&u8_item)){
+        if(u32_numPopped < PREEMPT_LOG_SIZE){
+            au8_popped[u32_numPopped] = u8_item;
+        }
+        u32_numPopped++;
+    }
+}
+
+static void ring_main(void){
+    for(uint8_t u8_i = 0; u8_i < ps_case->u8_numOps; u8_i++){
+        switch(ps_case->ae_ops[u8_i]){
+        case OP_PUSH:
+            ring_produce();
+            break;
+        case OP_PUSH_MANY:
+            ring_produce_many();
+            break;
+        case OP_POP:
+            ring_consume();
+            break;
+        }
+    }
+}
+
+static void ring_isr(void){
+    for(uint8_t u8_i = 0; u8_i < ps_case->u8_burst; u8_i++){
+        if(e_scenario == RING_TX){
+            ring_consume();
+        }else{
+            ring_produce();
+        }
+    }
+}
+
+static void ring_setup(void){
+    ps_variant->pf_init();
+    u8_nextItem = 0;
+    u32_numAccepted = 0;
+    u32_numPopped = 0;
+    uint8_t u8_item;
+    for(uint32_t u32_i = 0; u32_i < ps_case->u32_rotate; u32_i++){
+        ps_variant->pf_push(0xFF);
+        ps_variant->pf_pop(&u8_item);
+    }
+    for(uint32_t u32_i = 0; u32_i < ps_case->u32_prefill; u32_i++){
+        ring_produce();
+    }
+}
+
+//drains the buffer and compares what went in with what came out, NULL when they match
+static const char *ring_check(char *pc_detail, size_t u32_size){
+    while(u32_numPopped < PREEMPT_LOG_SIZE && ps_variant->pf_pop(&au8_popped[u32_numPopped])){
+        u32_numPopped++;
+    }
+    if(host_irq_disabled){
+        return "interrupts left disabled";
+    }
+    uint32_t u32_num = MIN(u32_numAccepted, u32_numPopped);
+    for(uint32_t u32_i = 0; u32_i < u32_num && u32_i < PREEMPT_LOG_SIZE; u32_i++){
+        if(au8_popped[u32_i] != au8_accepted[u32_i]){
+            snprintf(pc_detail, u32_size, "item %lu is %u, expected %u",
+                     (unsigned long)u32_i, au8_popped[u32_i], au8_accepted[u32_i]);
+            return u32_i + 1 < u32_num && au8_popped[u32_i] == au8_accepted[u32_i + 1] ? "lost" : "wrong item";
+        }
+    }
+    snprintf(pc_detail, u32_size, "%lu accepted, %lu popped", (unsigned long)u32_numAccepted, (unsigned long)u32_numPopped);
+    if(u32_numPopped < u32_numAccepted){
+        return "lost";
+    }
+    if(u32_numPopped > u32_numAccepted){
+        return "duplicated";
+    }
+    return NULL;
+}
+
+static void ring_run(const uint32_t *pu32_points, uint32_t u32_numPoints, const char **ppc_fault, char *pc_detail, size_t u32_size){
+    ring_setup();
+    preempt_run(ring_main, ring_isr, pu32_points, u32_numPoints);
+    *ppc_fault = ring_check(pc_detail, u32_size);
+}
+
+static uint32_t ring_count(void){
+    ring_setup();
+    return preempt_count(ring_main);
+}
+
+/*****************************************************************
+ * Exhaustive and random runs
+ *****************************************************************/
+static const char *apc_scenarioNames[] = {"TX main push / ISR pop", "RX ISR push / main pop"};
+
+typedef struct {
+    uint32_t u32_runs;
+    uint32_t u32_taken;
+    uint32_t u32_deferred;
+    uint32_t u32_failures;
+} ring_tally_t;
+
+static void ring_report_fault(const char *pc_fault, const char *pc_detail, const char *pc_where){
+    printf("  %s, %s: %s (%s) %s\n", ps_variant->pc_name, apc_scenarioNames[e_scenario], pc_fault, pc_detail, pc_where);
+}
+
+//empty, nearly full, full, and empty with the next item the last before the wrap
+static void ring_fixed_cases(ring_case_t *as_cases, uint8_t *pu8_num){
+    uint32_t u32_cap = ps_variant->u32_capacity;
+    uint8_t u8_num = 0;
+    for(uint8_t u8_start = 0; u8_start < 4; u8_start++){
+        ring_case_t *ps_c = &as_cases[u8_num++];
+        memset(ps_c, 0, sizeof(*ps_c));
+        if(u8_start == 1){
+            ps_c->u32_prefill = u32_cap - 2;
+        }else if(u8_start == 2){
+            ps_c->u32_prefill = u32_cap;
+        }else if(u8_start == 3){
+            ps_c->u32_rotate = u32_cap - 1;
+        }
+        ps_c->u8_burst = 2;
+        if(e_scenario == RING_TX){
+            ps_c->ae_ops[ps_c->u8_numOps++] = OP_PUSH;
+            if(ps_variant->pf_push_many != NULL){
+                ps_c->ae_ops[ps_c->u8_numOps++] = OP_PUSH_MANY;
+            }
+            ps_c->ae_ops[ps_c->u8_numOps++] = OP_PUSH;
+        }else{
+            for(uint8_t u8_i = 0; u8_i < 3; u8_i++){
+                ps_c->ae_ops[ps_c->u8_numOps++] = OP_POP;
+            }
+        }
+    }
+    *pu8_num = u8_num;
+}
+
+static void ring_exhaustive(ring_tally_t *ps_tally){
+    ring_case_t as_cases[8];
+    uint8_t u8_numCases;
+    ring_fixed_cases(as_cases, &u8_numCases);
+    for(uint8_t u8_c = 0; u8_c < u8_numCases; u8_c++){
+        ps_case = &as_cases[u8_c];
+        const char *pc_fault;
+        char ac_detail[96];
+        char ac_where[64];
+        uint32_t u32_steps = ring_count();
+        if(b_verbose){
+            printf("  %s, %s: case %u, %lu boundaries\n", ps_variant->pc_name, apc_scenarioNames[e_scenario],
+                   u8_c, (unsigned long)u32_steps);
+        }
+        //one past the last is the ISR taken after main is done
+        for(uint32_t u32_point = 0; u32_point <= u32_steps; u32_point++){
+            ring_run(&u32_point, 1, &pc_fault, ac_detail, sizeof(ac_detail));
+            ps_tally->u32_runs++;
+            ps_tally->u32_taken += preempt_taken();
+            ps_tally->u32_deferred += preempt_deferred();
+            if(pc_fault != NULL){
+                if(ps_tally->u32_failures++ == 0 || b_verbose){
+                    snprintf(ac_where, sizeof(ac_where), "at case %u boundary %lu", u8_c, (unsigned long)u32_point);
+                    ring_report_fault(pc_fault, ac_detail, ac_where);
+                }
+            }
+        }
+    }
+}
+
+static uint32_t ring_rand(uint32_t *pu32_state){
+    //xorshift32, the same numbers on every machine
+    uint32_t u32_x = *pu32_state;
+    u32_x ^= u32_x << 13;
+    u32_x ^= u32_x >> 17;
+    u32_x ^= u32_x << 5;
+    *pu32_state = u32_x;
+    return u32_x;
+}
+
+static int ring_compare_points(const void *pv_a, const void *pv_b){
+    uint32_t u32_a = *(const uint32_t *)pv_a;
+    uint32_t u32_b = *(const uint32_t *)pv_b;
+    return u32_a < u32_b ? -1 : u32_a > u32_b;
+}
+
+static void ring_random(uint32_t u32_seed, ring_tally_t *ps_tally){
+    uint32_t u32_state = u32_seed * 2654435761u + 1;
+    uint32_t u32_cap = ps_variant->u32_capacity;
+    ring_case_t s_case;
+    memset(&s_case, 0, sizeof(s_case));
+    ps_case = &s_case;
+
+    s_case.u32_rotate = ring_rand(&u32_state) % u32_cap;
+    //most starts near empty or near full, where the edge cases are
+    switch(ring_rand(&u32_state) % 3){
+    case 0:
+        s_case.u32_prefill = ring_rand(&u32_state) % 4;
+        break;
+    case 1:
+        s_case.u32_prefill = u32_cap - ring_rand(&u32_state) % 4;
+        break;
+    default:
+        s_case.u32_prefill = ring_rand(&u32_state) % (u32_cap + 1);
+        break;
+    }
+    s_case.u8_burst = (uint8_t)(1 + ring_rand(&u32_state) % PREEMPT_MAX_BURST);
+    s_case.u8_numOps = (uint8_t)(1 + ring_rand(&u32_state) % PREEMPT_MAX_OPS);
+    for(uint8_t u8_i = 0; u8_i < s_case.u8_numOps; u8_i++){
+        if(e_scenario == RING_RX){
+            s_case.ae_ops[u8_i] = OP_POP;
+        }else if(ps_variant->pf_push_many != NULL && ring_rand(&u32_state) % 3 == 0){
+            s_case.ae_ops[u8_i] = OP_PUSH_MANY;
+        }else{
+            s_case.ae_ops[u8_i] = OP_PUSH;
+        }
+    }
+
+    const char *pc_fault;
+    char ac_detail[96];
+    char ac_where[64];
+    uint32_t u32_steps = ring_count();
+    uint32_t au32_points[PREEMPT_MAX_POINTS];
+    uint32_t u32_numPoints = 1 + ring_rand(&u32_state) % PREEMPT_MAX_POINTS;
+    for(uint32_t u32_i = 0; u32_i < u32_numPoints; u32_i++){
+        au32_points[u32_i] = ring_rand(&u32_state) % (u32_steps + 1);
+    }
+    qsort(au32_points, u32_numPoints, sizeof(au32_points[0]), ring_compare_points);
+
+    ring_run(au32_points, u32_numPoints, &pc_fault, ac_detail, sizeof(ac_detail));
+    ps_tally->u32_runs++;
+    ps_tally->u32_taken += preempt_taken();
+    ps_tally->u32_deferred += preempt_deferred();
+    if(pc_fault != NULL){
+        if(ps_tally->u32_failures++ == 0 || b_verbose){
+            snprintf(ac_where, sizeof(ac_where), "with --seed %lu", (unsigned long)u32_seed);
+            ring_report_fault(pc_fault, ac_detail, ac_where);
+        }
+    }
+}
+
+int main(int argc, char **argv){
+    uint32_t u32_seeds = PREEMPT_SEEDS;
+    uint32_t u32_firstSeed = 1;
+    bool b_exhaustive = true;
+    for(int i_arg = 1; i_arg < argc; i_arg++){
+        if(strcmp(argv[i_arg], "--seeds") == 0 && i_arg + 1 < argc){
+            u32_seeds = (uint32_t)strtoul(argv[++i_arg], NULL, 10);
+        }else if(strcmp(argv[i_arg], "--seed") == 0 && i_arg + 1 < argc){
+            u32_firstSeed = (uint32_t)strtoul(argv[++i_arg], NULL, 10);
+            u32_seeds = 1;
+            b_exhaustive = false;
+            b_verbose = true;
+        }else if(strcmp(argv[i_arg], "--verbose") == 0){
+            b_verbose = true;
+        }else{
+            printf("usage: %s [--seeds N] [--seed S] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(!preempt_supported()){
+        printf("preempt_stress needs x86-64 Linux to single-step, nothing was tested\n");
+        return 0;
+    }
+
+    int i_result = 0;
+    for(uint8_t u8_v = 0; u8_v < count_of(as_variants); u8_v++){
+        ps_variant = &as_variants[u8_v];
+        ring_tally_t s_total;
+        memset(&s_total, 0, sizeof(s_total));
+        for(e_scenario = RING_TX; e_scenario <= RING_RX; e_scenario++){
+            ring_tally_t s_tally;
+            memset(&s_tally, 0, sizeof(s_tally));
+            if(b_exhaustive){
+                ring_exhaustive(&s_tally);
+            }
+            for(uint32_t u32_s = 0; u32_s < u32_seeds; u32_s++){
+                ring_random(u32_firstSeed + u32_s, &s_tally);
+            }
+            printf("%-18s %-24s %7lu runs, %7lu ISRs, %6lu held off, %lu failed\n", ps_variant->pc_name,
+                   apc_scenarioNames[e_scenario], (unsigned long)s_tally.u32_runs, (unsigned long)s_tally.u32_taken,
+                   (unsigned long)s_tally.u32_deferred, (unsigned long)s_tally.u32_failures);
+            s_total.u32_failures += s_tally.u32_failures;
+        }
+        if(ps_variant->b_unprotected){
+            //the check of the checker: this one has to have been caught
+            if(b_exhaustive && s_total.u32_failures == 0){
+                printf("%s never failed, races are not being found\n", ps_variant->pc_name);
+                i_result = 1;
+            }
+        }else if(s_total.u32_failures != 0){
+            i_result = 1;
+        }
+    }
+    printf("%s\n", i_result == 0 ? "no item lost or duplicated" : "FAILED");
+    return i_result;
+}
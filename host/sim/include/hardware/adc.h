@@ -0,0 +1,37 @@
+/**
+ * Simulator version of hardware/adc.h.
+ *
+ * The ADC runs from the 48 MHz clk_adc. A conversion takes 96 cycles and
+ * free-running mode starts one every (1 + DIV.INT + DIV.FRAC/256) cycles,
+ * never faster than 96, stepping through RROBIN. Samples go through a
+ * SIM_ADC_FIFO_DEPTH FIFO that sets FCS.OVER when a sample is lost. The
+ * input voltages come from SIM_ADC0..SIM_ADC4.
+ */
+#ifndef SIM_HARDWARE_ADC_H
+#define SIM_HARDWARE_ADC_H
+
+#include "pico.h"
+#include "hardware/structs/adc.h"
+
+#define NUM_ADC_CHANNELS        5
+#define ADC_TEMPERATURE_CHANNEL_NUM 4
+#define ADC_BASE_PIN            26
+
+void adc_init(void);
+void adc_gpio_init(uint u_gpio);
+void adc_select_input(uint u_input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint u_inputMask);
+void adc_set_temp_sensor_enabled(bool b_enable);
+uint16_t adc_read(void);
+void adc_run(bool b_run);
+void adc_set_clkdiv(float f_clkdiv);
+void adc_fifo_setup(bool b_en, bool b_dreqEn, uint16_t u16_dreqThresh, bool b_errInFifo, bool b_byteShift);
+bool adc_fifo_is_empty(void);
+uint8_t adc_fifo_get_level(void);
+uint16_t adc_fifo_get(void);
+uint16_t adc_fifo_get_blocking(void);
+void adc_fifo_drain(void);
+void adc_irq_set_enabled(bool b_enabled);
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * Simulator version of hardware/address_mapped.h.
+ *
+ * The register blocks are plain structs in host memory and the models
+ * read them back on every SDK call. The SDK's set/clear aliases do not
+ * exist here, so the atomic helpers are functions. That also lets the
+ * models see write-1-to-clear bits, which a plain store cannot show.
+ */
+#ifndef SIM_HARDWARE_ADDRESS_MAPPED_H
+#define SIM_HARDWARE_ADDRESS_MAPPED_H
+
+#include "pico.h"
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+typedef volatile uint16_t io_rw_16;
+typedef volatile uint8_t io_rw_8;
+
+void hw_set_bits(io_rw_32 *pu32_addr, uint32_t u32_mask);
+void hw_clear_bits(io_rw_32 *pu32_addr, uint32_t u32_mask);
+void hw_xor_bits(io_rw_32 *pu32_addr, uint32_t u32_mask);
+void hw_write_masked(io_rw_32 *pu32_addr, uint32_t u32_values, uint32_t u32_writeMask);
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * Simulator version of hardware/clocks.h, fixed at the Pico 2 defaults.
+ */
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_hstx,
+    clk_usb,
+    clk_adc,
+    CLK_COUNT
+};
+typedef enum clock_index clock_handle_t;
+
+#define SYS_CLK_HZ  150000000u
+#define USB_CLK_HZ  48000000u
+#define XOSC_HZ     12000000u
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t u32_freqKhz, bool b_required);
+
+#endif
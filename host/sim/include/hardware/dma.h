@@ -0,0 +1,42 @@
+/**
+ * Simulator version of hardware/dma.h. Channels can be claimed and
+ * configured, but no transfers run.
+ */
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+#include "pico.h"
+#include "hardware/structs/dma.h"
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool b_required);
+void dma_channel_claim(uint u_channel);
+void dma_channel_unclaim(uint u_channel);
+bool dma_channel_is_claimed(uint u_channel);
+dma_channel_config dma_channel_get_default_config(uint u_channel);
+void channel_config_set_read_increment(dma_channel_config *ps_config, bool b_incr);
+void channel_config_set_write_increment(dma_channel_config *ps_config, bool b_incr);
+void channel_config_set_dreq(dma_channel_config *ps_config, uint u_dreq);
+void channel_config_set_chain_to(dma_channel_config *ps_config, uint u_chainTo);
+void channel_config_set_transfer_data_size(dma_channel_config *ps_config, enum dma_channel_transfer_size e_size);
+void channel_config_set_ring(dma_channel_config *ps_config, bool b_write, uint u_sizeBits);
+void channel_config_set_enable(dma_channel_config *ps_config, bool b_enable);
+void dma_channel_configure(uint u_channel, const dma_channel_config *ps_config, volatile void *pv_writeAddr,
+                           const volatile void *pv_readAddr, uint u_transferCount, bool b_trigger);
+void dma_channel_start(uint u_channel);
+void dma_channel_abort(uint u_channel);
+bool dma_channel_is_busy(uint u_channel);
+void dma_channel_wait_for_finish_blocking(uint u_channel);
+void dma_channel_set_irq0_enabled(uint u_channel, bool b_enabled);
+void dma_channel_acknowledge_irq0(uint u_channel);
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * Simulator version of hardware/gpio.h for the RP2350A (30 GPIOs).
+ *
+ * A pin reads its own output when SIO drives it, otherwise whatever
+ * SIM_GPIO drives onto it or connects it to, otherwise its pull. Edges
+ * are latched for IO_IRQ_BANK0 the moment a level changes.
+ */
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+#define NUM_BANK0_GPIOS 30
+
+enum gpio_dir {
+    GPIO_OUT = 1u,
+    GPIO_IN = 0u
+};
+
+typedef enum gpio_function_rp2350 {
+    GPIO_FUNC_HSTX = 0,
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_PIO2 = 8,
+    GPIO_FUNC_GPCK = 9,
+    GPIO_FUNC_USB = 10,
+    GPIO_FUNC_UART_AUX = 11,
+    GPIO_FUNC_NULL = 0x1f,
+} gpio_function_t;
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint u_gpio, uint32_t u32_eventMask);
+
+void gpio_init(uint u_gpio);
+void gpio_deinit(uint u_gpio);
+void gpio_init_mask(uint32_t u32_mask);
+void gpio_set_function(uint u_gpio, gpio_function_t e_fn);
+gpio_function_t gpio_get_function(uint u_gpio);
+void gpio_set_dir(uint u_gpio, bool b_out);
+void gpio_set_dir_out_masked(uint32_t u32_mask);
+void gpio_set_dir_in_masked(uint32_t u32_mask);
+void gpio_set_dir_masked(uint32_t u32_mask, uint32_t u32_value);
+void gpio_set_dir_all_bits(uint32_t u32_values);
+bool gpio_is_dir_out(uint u_gpio);
+void gpio_set_pulls(uint u_gpio, bool b_up, bool b_down);
+void gpio_pull_up(uint u_gpio);
+void gpio_pull_down(uint u_gpio);
+void gpio_disable_pulls(uint u_gpio);
+bool gpio_is_pulled_up(uint u_gpio);
+bool gpio_is_pulled_down(uint u_gpio);
+void gpio_set_input_enabled(uint u_gpio, bool b_enabled);
+
+void gpio_put(uint u_gpio, bool b_value);
+bool gpio_get(uint u_gpio);
+bool gpio_get_out_level(uint u_gpio);
+uint32_t gpio_get_all(void);
+void gpio_set_mask(uint32_t u32_mask);
+void gpio_clr_mask(uint32_t u32_mask);
+void gpio_xor_mask(uint32_t u32_mask);
+void gpio_put_masked(uint32_t u32_mask, uint32_t u32_value);
+void gpio_put_all(uint32_t u32_value);
+
+void gpio_set_irq_enabled(uint u_gpio, uint32_t u32_events, bool b_enabled);
+void gpio_set_irq_callback(gpio_irq_callback_t pf_callback);
+void gpio_set_irq_enabled_with_callback(uint u_gpio, uint32_t u32_events, bool b_enabled, gpio_irq_callback_t pf_callback);
+void gpio_acknowledge_irq(uint u_gpio, uint32_t u32_events);
+uint32_t gpio_get_irq_event_mask(uint u_gpio);
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * Simulator version of hardware/i2c.h. Transfers take their time on the
+ * bus at the rate i2c_init() picked. An address with no device behind it
+ * is NACKed, which the blocking calls return as PICO_ERROR_GENERIC.
+ */
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+#include "pico.h"
+#include "pico/time.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+#define i2c_default i2c0
+
+#define I2C_NUM(i2c)    ((i2c) == i2c1 ? 1 : 0)
+
+uint i2c_init(i2c_inst_t *i2c, uint u_baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint u_baudrate);
+uint i2c_get_index(i2c_inst_t *i2c);
+
+int i2c_write_blocking_until(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop, absolute_time_t until);
+int i2c_read_blocking_until(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop, absolute_time_t until);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop, uint u_timeoutUs);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop, uint u_timeoutUs);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop);
+
+#endif
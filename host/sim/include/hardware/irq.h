@@ -0,0 +1,77 @@
+/**
+ * Simulator version of hardware/irq.h, with the RP2350 IRQ numbers.
+ *
+ * Priorities work as on the M33 NVIC: lower is more urgent, only the top
+ * four bits count, a pending IRQ preempts a running one of lower priority,
+ * and among equal priorities the lower IRQ number goes first.
+ */
+#ifndef SIM_HARDWARE_IRQ_H
+#define SIM_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+typedef void (*irq_handler_t)(void);
+
+enum irq_num_rp2350 {
+    TIMER0_IRQ_0 = 0,
+    TIMER0_IRQ_1 = 1,
+    TIMER0_IRQ_2 = 2,
+    TIMER0_IRQ_3 = 3,
+    TIMER1_IRQ_0 = 4,
+    TIMER1_IRQ_1 = 5,
+    TIMER1_IRQ_2 = 6,
+    TIMER1_IRQ_3 = 7,
+    PWM_IRQ_WRAP_0 = 8,
+    PWM_IRQ_WRAP_1 = 9,
+    DMA_IRQ_0 = 10,
+    DMA_IRQ_1 = 11,
+    DMA_IRQ_2 = 12,
+    DMA_IRQ_3 = 13,
+    USBCTRL_IRQ = 14,
+    PIO0_IRQ_0 = 15,
+    PIO0_IRQ_1 = 16,
+    PIO1_IRQ_0 = 17,
+    PIO1_IRQ_1 = 18,
+    PIO2_IRQ_0 = 19,
+    PIO2_IRQ_1 = 20,
+    IO_IRQ_BANK0 = 21,
+    IO_IRQ_BANK0_NS = 22,
+    IO_IRQ_QSPI = 23,
+    IO_IRQ_QSPI_NS = 24,
+    SIO_IRQ_FIFO = 25,
+    SIO_IRQ_BELL = 26,
+    SIO_IRQ_FIFO_NS = 27,
+    SIO_IRQ_BELL_NS = 28,
+    SIO_IRQ_MTIMECMP = 29,
+    CLOCKS_IRQ = 30,
+    SPI0_IRQ = 31,
+    SPI1_IRQ = 32,
+    UART0_IRQ = 33,
+    UART1_IRQ = 34,
+    ADC_IRQ_FIFO = 35,
+    I2C0_IRQ = 36,
+    I2C1_IRQ = 37,
+    OTP_IRQ = 38,
+    TRNG_IRQ = 39,
+    NUM_IRQS = 52
+};
+#define PWM_IRQ_WRAP PWM_IRQ_WRAP_0
+
+#define PICO_HIGHEST_IRQ_PRIORITY   0x00
+#define PICO_DEFAULT_IRQ_PRIORITY   0x80
+#define PICO_LOWEST_IRQ_PRIORITY    0xff
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_exclusive_handler(uint u_num, irq_handler_t pf_handler);
+void irq_add_shared_handler(uint u_num, irq_handler_t pf_handler, uint8_t u8_orderPriority);
+void irq_remove_handler(uint u_num, irq_handler_t pf_handler);
+irq_handler_t irq_get_exclusive_handler(uint u_num);
+void irq_set_enabled(uint u_num, bool b_enabled);
+bool irq_is_enabled(uint u_num);
+void irq_set_mask_enabled(uint32_t u32_mask, bool b_enabled);
+void irq_set_priority(uint u_num, uint8_t u8_priority);
+uint irq_get_priority(uint u_num);
+void irq_set_pending(uint u_num);
+void irq_clear(uint u_num);
+
+#endif
@@ -0,0 +1,7 @@
+//Simulator version of hardware/pll.h, the clocks are fixed (hardware/clocks.h)
+#ifndef SIM_HARDWARE_PLL_H
+#define SIM_HARDWARE_PLL_H
+
+#include "pico.h"
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * Simulator version of hardware/pwm.h. The slices keep their registers
+ * in pwm_hw but do not count, so nothing is driven onto the pins.
+ */
+#ifndef SIM_HARDWARE_PWM_H
+#define SIM_HARDWARE_PWM_H
+
+#include "pico.h"
+#include "hardware/structs/pwm.h"
+
+enum pwm_chan {
+    PWM_CHAN_A = 0,
+    PWM_CHAN_B = 1
+};
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+static inline uint pwm_gpio_to_slice_num(uint u_gpio){
+    return (u_gpio >> 1u) & 7u;
+}
+
+static inline uint pwm_gpio_to_channel(uint u_gpio){
+    return u_gpio & 1u;
+}
+
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_phase_correct(pwm_config *ps_config, bool b_phaseCorrect);
+void pwm_config_set_clkdiv(pwm_config *ps_config, float f_div);
+void pwm_config_set_clkdiv_int_frac(pwm_config *ps_config, uint8_t u8_integer, uint8_t u8_fract);
+void pwm_config_set_clkdiv_int(pwm_config *ps_config, uint u_div);
+void pwm_config_set_wrap(pwm_config *ps_config, uint16_t u16_wrap);
+void pwm_init(uint u_slice, pwm_config *ps_config, bool b_start);
+void pwm_set_wrap(uint u_slice, uint16_t u16_wrap);
+void pwm_set_chan_level(uint u_slice, uint u_chan, uint16_t u16_level);
+void pwm_set_both_levels(uint u_slice, uint16_t u16_levelA, uint16_t u16_levelB);
+void pwm_set_gpio_level(uint u_gpio, uint16_t u16_level);
+void pwm_set_counter(uint u_slice, uint16_t u16_count);
+void pwm_set_enabled(uint u_slice, bool b_enabled);
+void pwm_set_mask_enabled(uint32_t u32_mask);
+void pwm_set_clkdiv(uint u_slice, float f_div);
+void pwm_set_clkdiv_int_frac(uint u_slice, uint8_t u8_integer, uint8_t u8_fract);
+void pwm_set_irq_enabled(uint u_slice, bool b_enabled);
+void pwm_clear_irq(uint u_slice);
+uint pwm_get_dreq(uint u_slice);
+
+#endif
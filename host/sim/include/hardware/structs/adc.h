@@ -0,0 +1,57 @@
+//Simulator version of hardware/structs/adc.h, RP2350 field positions
+#ifndef SIM_HARDWARE_STRUCTS_ADC_H
+#define SIM_HARDWARE_STRUCTS_ADC_H
+
+#include "hardware/address_mapped.h"
+
+typedef struct {
+    io_rw_32 cs;
+    io_ro_32 result;
+    io_rw_32 fcs;
+    io_ro_32 fifo;
+    io_rw_32 div;
+    io_ro_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_ro_32 ints;
+} adc_hw_t;
+
+#define ADC_CS_EN_BITS              0x00000001u
+#define ADC_CS_TS_EN_BITS           0x00000002u
+#define ADC_CS_START_ONCE_BITS      0x00000004u
+#define ADC_CS_START_MANY_BITS      0x00000008u
+#define ADC_CS_READY_BITS           0x00000100u
+#define ADC_CS_ERR_BITS             0x00000200u
+#define ADC_CS_ERR_STICKY_BITS      0x00000400u
+#define ADC_CS_AINSEL_LSB           12
+#define ADC_CS_AINSEL_BITS          0x0000f000u
+#define ADC_CS_RROBIN_LSB           16
+#define ADC_CS_RROBIN_BITS          0x01ff0000u
+
+#define ADC_FCS_EN_BITS             0x00000001u
+#define ADC_FCS_SHIFT_BITS          0x00000002u
+#define ADC_FCS_ERR_BITS            0x00000004u
+#define ADC_FCS_DREQ_EN_BITS        0x00000008u
+#define ADC_FCS_EMPTY_BITS          0x00000100u
+#define ADC_FCS_FULL_BITS           0x00000200u
+#define ADC_FCS_UNDER_BITS          0x00000400u
+#define ADC_FCS_OVER_BITS           0x00000800u
+#define ADC_FCS_LEVEL_LSB           16
+#define ADC_FCS_LEVEL_BITS          0x000f0000u
+#define ADC_FCS_THRESH_LSB          24
+#define ADC_FCS_THRESH_BITS         0x0f000000u
+
+#define ADC_FIFO_ERR_BITS           0x00008000u
+#define ADC_FIFO_VAL_BITS           0x00000fffu
+
+#define ADC_DIV_INT_LSB             8
+#define ADC_DIV_INT_BITS            0x00ffff00u
+#define ADC_DIV_FRAC_LSB            0
+#define ADC_DIV_FRAC_BITS           0x000000ffu
+
+#define ADC_INTE_FIFO_BITS          0x00000001u
+
+extern adc_hw_t sim_adc_hw;
+#define adc_hw (&sim_adc_hw)
+
+#endif
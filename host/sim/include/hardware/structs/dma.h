@@ -0,0 +1,39 @@
+//Simulator version of hardware/structs/dma.h
+#ifndef SIM_HARDWARE_STRUCTS_DMA_H
+#define SIM_HARDWARE_STRUCTS_DMA_H
+
+#include "hardware/address_mapped.h"
+
+#define NUM_DMA_CHANNELS 16
+
+typedef struct {
+    io_rw_32 read_addr;
+    io_rw_32 write_addr;
+    io_rw_32 transfer_count;
+    io_rw_32 ctrl_trig;
+    io_rw_32 al1_ctrl;
+    io_rw_32 al1_read_addr;
+    io_rw_32 al1_write_addr;
+    io_rw_32 al1_transfer_count_trig;
+    io_rw_32 al2_ctrl;
+    io_rw_32 al2_transfer_count;
+    io_rw_32 al2_read_addr;
+    io_rw_32 al2_write_addr_trig;
+    io_rw_32 al3_ctrl;
+    io_rw_32 al3_write_addr;
+    io_rw_32 al3_transfer_count;
+    io_rw_32 al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    io_rw_32 intr;
+    io_rw_32 inte0;
+    io_rw_32 intf0;
+    io_rw_32 ints0;
+} dma_hw_t;
+
+extern dma_hw_t sim_dma_hw;
+#define dma_hw (&sim_dma_hw)
+
+#endif
@@ -0,0 +1,36 @@
+//Simulator version of hardware/structs/pwm.h
+#ifndef SIM_HARDWARE_STRUCTS_PWM_H
+#define SIM_HARDWARE_STRUCTS_PWM_H
+
+#include "hardware/address_mapped.h"
+
+#define NUM_PWM_SLICES 12
+
+typedef struct {
+    io_rw_32 csr;
+    io_rw_32 div;
+    io_rw_32 ctr;
+    io_rw_32 cc;
+    io_rw_32 top;
+} pwm_slice_hw_t;
+
+typedef struct {
+    pwm_slice_hw_t slice[NUM_PWM_SLICES];
+    io_rw_32 en;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_ro_32 ints;
+} pwm_hw_t;
+
+#define PWM_CH0_CSR_EN_BITS     0x00000001u
+#define PWM_CH0_CSR_PH_CORRECT_BITS 0x00000002u
+#define PWM_CH0_DIV_INT_LSB     4
+#define PWM_CH0_DIV_FRAC_LSB    0
+#define PWM_CH0_CC_A_LSB        0
+#define PWM_CH0_CC_B_LSB        16
+
+extern pwm_hw_t sim_pwm_hw;
+#define pwm_hw (&sim_pwm_hw)
+
+#endif
@@ -0,0 +1,30 @@
+//Simulator version of hardware/structs/timer.h
+#ifndef SIM_HARDWARE_STRUCTS_TIMER_H
+#define SIM_HARDWARE_STRUCTS_TIMER_H
+
+#include "hardware/address_mapped.h"
+
+typedef struct {
+    io_wo_32 timehw;
+    io_wo_32 timelw;
+    io_ro_32 timehr;
+    io_ro_32 timelr;
+    io_rw_32 alarm[4];
+    io_rw_32 armed;
+    io_ro_32 timerawh;
+    io_ro_32 timerawl;
+    io_rw_32 dbgpause;
+    io_rw_32 pause;
+    io_rw_32 locked;
+    io_rw_32 source;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_ro_32 ints;
+} timer_hw_t;
+
+extern timer_hw_t sim_timer_hw;
+#define timer0_hw (&sim_timer_hw)
+#define timer_hw  timer0_hw
+
+#endif
@@ -0,0 +1,47 @@
+//Simulator version of hardware/structs/uart.h, the PL011 register layout
+#ifndef SIM_HARDWARE_STRUCTS_UART_H
+#define SIM_HARDWARE_STRUCTS_UART_H
+
+#include "hardware/address_mapped.h"
+
+typedef struct {
+    io_rw_32 dr;
+    io_rw_32 rsr;
+    uint32_t _pad0[4];
+    io_ro_32 fr;
+    uint32_t _pad1;
+    io_rw_32 ilpr;
+    io_rw_32 ibrd;
+    io_rw_32 fbrd;
+    io_rw_32 lcr_h;
+    io_rw_32 cr;
+    io_rw_32 ifls;
+    io_rw_32 imsc;
+    io_ro_32 ris;
+    io_ro_32 mis;
+    io_wo_32 icr;
+    io_rw_32 dmacr;
+} uart_hw_t;
+
+#define UART_UARTFR_TXFE_BITS   0x00000080u
+#define UART_UARTFR_RXFF_BITS   0x00000040u
+#define UART_UARTFR_TXFF_BITS   0x00000020u
+#define UART_UARTFR_RXFE_BITS   0x00000010u
+#define UART_UARTFR_BUSY_BITS   0x00000008u
+
+#define UART_UARTLCR_H_FEN_BITS 0x00000010u
+
+#define UART_UARTCR_RXE_BITS    0x00000200u
+#define UART_UARTCR_TXE_BITS    0x00000100u
+#define UART_UARTCR_UARTEN_BITS 0x00000001u
+
+#define UART_UARTIMSC_OEIM_BITS 0x00000400u
+#define UART_UARTIMSC_RTIM_BITS 0x00000040u
+#define UART_UARTIMSC_TXIM_BITS 0x00000020u
+#define UART_UARTIMSC_RXIM_BITS 0x00000010u
+
+extern uart_hw_t sim_uart_hw[2];
+#define uart0_hw (&sim_uart_hw[0])
+#define uart1_hw (&sim_uart_hw[1])
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * Simulator version of hardware/sync.h. PRIMASK is one flag. Turning
+ * interrupts back on takes any that came pending while they were off.
+ */
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t u32_status);
+void restore_interrupts_from_disabled(uint32_t u32_status);
+
+//one simulated core, so a spin lock is only the interrupt mask
+typedef volatile uint32_t spin_lock_t;
+static inline int spin_lock_claim_unused(bool required){ (void)required; return 0; }
+static inline spin_lock_t *spin_lock_init(uint lock_num){ static spin_lock_t s_lock; (void)lock_num; return &s_lock; }
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock){ (void)lock; return save_and_disable_interrupts(); }
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq){ (void)lock; restore_interrupts(saved_irq); }
+
+//sleeps until the next simulated event
+void __wfi(void);
+void __wfe(void);
+void __sev(void);
+
+static inline void __nop(void){}
+static inline void __dmb(void){ __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void){ __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __isb(void){ __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __compiler_memory_barrier(void){ __asm__ volatile ("" ::: "memory"); }
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * Simulator version of hardware/timer.h: the 1 MHz system timer and its
+ * four alarms (TIMER0_IRQ_0..3). The raw count registers are kept up to
+ * date on every SDK call, so code that reads timer_hw->timerawl directly
+ * sees the time of the last call.
+ */
+#ifndef SIM_HARDWARE_TIMER_H
+#define SIM_HARDWARE_TIMER_H
+
+#include "pico.h"
+#include "hardware/structs/timer.h"
+
+typedef uint64_t absolute_time_t;
+
+#define NUM_GENERIC_TIMERS  2
+#define NUM_ALARMS          4
+#define TIMER_ALARM_IRQ_NUM(timer, alarm_num) (alarm_num)
+#define timer_hardware_alarm_get_irq_num(timer, alarm_num) (alarm_num)
+
+typedef void (*hardware_alarm_callback_t)(uint u_alarmNum);
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+void busy_wait_us_32(uint32_t u32_delayUs);
+void busy_wait_us(uint64_t u64_delayUs);
+void busy_wait_ms(uint32_t u32_delayMs);
+void busy_wait_until(absolute_time_t t);
+
+void hardware_alarm_claim(uint u_alarmNum);
+int hardware_alarm_claim_unused(bool b_required);
+void hardware_alarm_unclaim(uint u_alarmNum);
+bool hardware_alarm_is_claimed(uint u_alarmNum);
+void hardware_alarm_set_callback(uint u_alarmNum, hardware_alarm_callback_t pf_callback);
+//true if t has already passed, the alarm is then not armed
+bool hardware_alarm_set_target(uint u_alarmNum, absolute_time_t t);
+void hardware_alarm_cancel(uint u_alarmNum);
+void hardware_alarm_force_irq(uint u_alarmNum);
+
+#endif
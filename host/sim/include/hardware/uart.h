@@ -0,0 +1,62 @@
+/**
+ * Simulator version of hardware/uart.h.
+ *
+ * uart0 is connected to the host (SIM_UART: a pseudo-terminal by default).
+ * Characters take their real time on the line at the configured baud rate
+ * and format, the FIFOs are 32 deep, or 1 with uart_set_fifo_enabled(false),
+ * and RX/TX/RX-timeout interrupts follow the PL011. A byte written straight
+ * to uart_get_hw(uart)->dr is picked up at the next SDK call.
+ */
+#ifndef SIM_HARDWARE_UART_H
+#define SIM_HARDWARE_UART_H
+
+#include "pico.h"
+#include "hardware/structs/uart.h"
+#include "hardware/gpio.h"
+
+typedef struct uart_inst uart_inst_t;
+
+#define uart0 ((uart_inst_t *)uart0_hw)
+#define uart1 ((uart_inst_t *)uart1_hw)
+
+#define UART_NUM(uart)          ((uart) == uart1 ? 1 : 0)
+#define UART_INSTANCE(num)      ((num) ? uart1 : uart0)
+#define UART_IRQ_NUM(uart)      (33 + UART_NUM(uart))
+#define UART_FUNCSEL_NUM(uart, gpio) GPIO_FUNC_UART
+
+typedef enum {
+    UART_PARITY_NONE,
+    UART_PARITY_EVEN,
+    UART_PARITY_ODD
+} uart_parity_t;
+
+static inline uart_hw_t *uart_get_hw(uart_inst_t *uart){
+    return (uart_hw_t *)uart;
+}
+
+static inline uint uart_get_index(uart_inst_t *uart){
+    return UART_NUM(uart);
+}
+
+uint uart_init(uart_inst_t *uart, uint u_baudrate);
+void uart_deinit(uart_inst_t *uart);
+uint uart_set_baudrate(uart_inst_t *uart, uint u_baudrate);
+void uart_set_hw_flow(uart_inst_t *uart, bool b_cts, bool b_rts);
+void uart_set_format(uart_inst_t *uart, uint u_dataBits, uint u_stopBits, uart_parity_t e_parity);
+void uart_set_fifo_enabled(uart_inst_t *uart, bool b_enabled);
+void uart_set_irqs_enabled(uart_inst_t *uart, bool b_rxHasData, bool b_txNeedsData);
+//the SDK's older name for uart_set_irqs_enabled
+void uart_set_irq_enables(uart_inst_t *uart, bool b_rxHasData, bool b_txNeedsData);
+bool uart_is_enabled(uart_inst_t *uart);
+bool uart_is_writable(uart_inst_t *uart);
+bool uart_is_readable(uart_inst_t *uart);
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t u32_us);
+void uart_tx_wait_blocking(uart_inst_t *uart);
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *pu8_src, size_t len);
+void uart_read_blocking(uart_inst_t *uart, uint8_t *pu8_dst, size_t len);
+void uart_putc_raw(uart_inst_t *uart, char c);
+void uart_putc(uart_inst_t *uart, char c);
+void uart_puts(uart_inst_t *uart, const char *pc_s);
+char uart_getc(uart_inst_t *uart);
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * Simulator version of hardware/watchdog.h. When the watchdog runs out
+ * the simulator restarts the program, so everything is reset as on the
+ * chip, and watchdog_caused_reboot() is true in the new run.
+ */
+#ifndef SIM_HARDWARE_WATCHDOG_H
+#define SIM_HARDWARE_WATCHDOG_H
+
+#include "pico.h"
+
+void watchdog_enable(uint32_t u32_delayMs, bool b_pauseOnDebug);
+void watchdog_disable(void);
+void watchdog_update(void);
+uint32_t watchdog_get_time_remaining_ms(void);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+void watchdog_reboot(uint32_t u32_pc, uint32_t u32_sp, uint32_t u32_delayMs);
+
+#endif
@@ -0,0 +1,13 @@
+/**
+ * Simulator version of hardware/xip_cache.h. The simulated apps are not
+ * fetched from flash, so there is no cache to empty and this does nothing.
+ */
+#ifndef SIM_HARDWARE_XIP_CACHE_H
+#define SIM_HARDWARE_XIP_CACHE_H
+
+#include "pico.h"
+
+static inline void xip_cache_invalidate_all(void){
+}
+
+#endif
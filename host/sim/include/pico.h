@@ -0,0 +1,62 @@
+/**
+ * Simulator version of the SDK's pico.h: base types, section attributes
+ * (which do nothing on the host) and the error codes.
+ */
+#ifndef SIM_PICO_H
+#define SIM_PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+//the Pico 2 board file
+#define PICO_DEFAULT_LED_PIN        25
+#define PICO_DEFAULT_UART           0
+#define PICO_DEFAULT_UART_TX_PIN    0
+#define PICO_DEFAULT_UART_RX_PIN    1
+#define PICO_DEFAULT_I2C            0
+#define PICO_DEFAULT_I2C_SDA_PIN    4
+#define PICO_DEFAULT_I2C_SCL_PIN    5
+
+//code and data placement, everything is in host RAM
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name)  func_name
+#define __time_critical_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) __attribute__((noinline)) func_name
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __uninitialized_ram(name) name
+#define __aligned(x)    __attribute__((aligned(x)))
+#define __packed        __attribute__((packed))
+#define __unused        __attribute__((unused))
+#define __noinline      __attribute__((noinline))
+#define __force_inline  inline __attribute__((always_inline))
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_TIMEOUT = -1,
+    PICO_ERROR_GENERIC = -2,
+    PICO_ERROR_NO_DATA = -3,
+    PICO_ERROR_NOT_PERMITTED = -4,
+    PICO_ERROR_INVALID_ARG = -5,
+    PICO_ERROR_IO = -6,
+};
+
+//the SDK's is an empty inline, here it lets simulated time and interrupts move on
+void tight_loop_contents(void);
+
+void panic(const char *pc_format, ...) __attribute__((noreturn));
+#define hard_assert(x) do { if (!(x)) panic("hard_assert failed: %s", #x); } while (0)
+
+#endif
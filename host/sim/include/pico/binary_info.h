@@ -0,0 +1,12 @@
+//Simulator version of pico/binary_info.h, there is no binary to annotate
+#ifndef SIM_PICO_BINARY_INFO_H
+#define SIM_PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+#define bi_decl_if_func_used(...)
+#define bi_1pin_with_func(...)      0
+#define bi_2pins_with_func(...)     0
+#define bi_1pin_with_name(...)      0
+#define bi_program_description(...) 0
+
+#endif
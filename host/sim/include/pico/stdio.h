@@ -0,0 +1,15 @@
+/**
+ * Simulator version of pico/stdio.h. After stdio_init_all() printf and
+ * friends go out on the simulated uart0 at 115200, as stdio_uart does.
+ */
+#ifndef SIM_PICO_STDIO_H
+#define SIM_PICO_STDIO_H
+
+#include <stdio.h>
+#include "pico.h"
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t u32_timeoutUs);
+void stdio_flush(void);
+
+#endif
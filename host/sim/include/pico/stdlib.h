@@ -0,0 +1,13 @@
+/**
+ * Simulator version of pico/stdlib.h.
+ */
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "pico/stdio.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#endif
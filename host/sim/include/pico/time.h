@@ -0,0 +1,44 @@
+/**
+ * Simulator version of pico/time.h. absolute_time_t is the plain 64-bit
+ * microsecond count the SDK uses in release builds.
+ */
+#ifndef SIM_PICO_TIME_H
+#define SIM_PICO_TIME_H
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+static inline absolute_time_t from_us_since_boot(uint64_t u64_us){
+    return u64_us;
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t){
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t){
+    return (uint32_t)(t / 1000);
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t u64_us){
+    return t + u64_us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t u32_ms){
+    return t + (uint64_t)u32_ms * 1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to){
+    return (int64_t)(to - from);
+}
+
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t u64_us);
+absolute_time_t make_timeout_time_ms(uint32_t u32_ms);
+bool time_reached(absolute_time_t t);
+
+void sleep_until(absolute_time_t t);
+void sleep_us(uint64_t u64_us);
+void sleep_ms(uint32_t u32_ms);
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * Simulator core: virtual time, the NVIC and the device models.
+ *
+ * Simulated time only moves inside SDK calls. Every call costs SIM_HAL_NS,
+ * a busy wait or sleep costs what it asks for, and the app's own code
+ * between calls takes no time at all. Each time it moves, every model
+ * catches up to the new time, and any interrupt that became pending and
+ * may preempt the running code is taken right there, inside the SDK call.
+ * So ISRs can only land at SDK calls; anything that needs finer grained
+ * preemption has to be tested another way.
+ *
+ * Settings are environment variables, read before main() runs, so the
+ * apps run as they are:
+ *   SIM_SECONDS   stop after this much simulated time (default: never)
+ *   SIM_SPEED     simulated seconds per real second, 0 for flat out (default 1)
+ *   SIM_HAL_NS    cost of one SDK call in ns (default 100)
+ *   SIM_TRACE     file to log every ISR entry and exit to
+ * and the ones the models read, listed in their headers.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define SIM_NEVER           UINT64_MAX
+#define SIM_NS_PER_US       1000u
+#define SIM_NS_PER_MS       1000000u
+#define SIM_NS_PER_S        1000000000u
+
+//scripts are "ms:text|ms:text|...", times counted from the first boot
+#define SIM_SCRIPT_MAX      64
+#define SIM_SCRIPT_TEXT     64
+
+//lets a model write the registers the app only reads
+#define SIM_REG(reg)        (*(volatile uint32_t *)&(reg))
+
+typedef struct {
+    const char *pc_name;
+    void (*pf_init)(void);                  // reads the model's SIM_* settings, runs before main
+    uint64_t (*pf_next)(void);              // when the model next does something on its own, SIM_NEVER if it will not
+    void (*pf_update)(uint64_t u64_nowNs);  // catches up to now, never calls back into the app
+    void (*pf_report)(FILE *ps_file);       // end of run summary, may be NULL
+    void (*pf_save)(void);                  // before a chip reset, keeps what lives outside the chip, may be NULL
+} sim_device_t;
+
+//a part on an I2C bus, see sim_i2c.c
+typedef struct {
+    const char *pc_name;
+    uint u_maxBaud;                         // fastest SCL it is rated for, it does not answer above that
+    uint8_t (*pf_init)(void);               // reads its settings, returns its 7-bit address
+    uint64_t (*pf_next)(void);              // as in sim_device_t, may be NULL
+    void (*pf_update)(uint64_t u64_nowNs);  // may be NULL
+    void (*pf_start)(bool b_read);          // START or repeated START with its address
+    bool (*pf_write)(uint8_t u8_data);      // a byte from the controller, false NACKs it
+    uint8_t (*pf_read)(void);               // a byte for the controller
+    void (*pf_stop)(void);
+    void (*pf_report)(FILE *ps_file);       // may be NULL
+    void (*pf_save)(void);                  // may be NULL
+} sim_i2c_target_t;
+
+typedef struct {
+    uint64_t u64_ns;
+    char ac_text[SIM_SCRIPT_TEXT];
+} sim_script_item_t;
+
+extern const sim_device_t sim_timer_device;
+extern const sim_device_t sim_watchdog_device;
+extern const sim_device_t sim_gpio_device;
+extern const sim_device_t sim_uart_device;
+extern const sim_device_t sim_adc_device;
+extern const sim_device_t sim_i2c_device;
+
+extern const sim_i2c_target_t sim_mcp4725_target;
+extern const sim_i2c_target_t sim_ds3231_target;
+
+//time since this boot, which is what the timer shows
+uint64_t sim_now_ns(void);
+//time since the first boot, what scripts and SIM_SECONDS count
+uint64_t sim_elapsed_ns(void);
+
+//every SDK call starts with this
+void sim_hal_call(void);
+void sim_advance_ns(uint64_t u64_ns);
+void sim_wait_until_ns(uint64_t u64_ns);
+//__wfi, skips ahead to whatever happens next
+void sim_idle(void);
+//the same, but never past u64_limitNs
+void sim_idle_until(uint64_t u64_limitNs);
+//brings the models up to date without moving time, after the app has touched a register
+void sim_sync(void);
+
+//a model's interrupt output, the NVIC latches it as pending while it is high
+void sim_irq_set_line(uint u_irq, bool b_level);
+//true while an ISR is running
+bool sim_in_isr(void);
+
+//drives a pin from outside the chip, 0 or 1, or SIM_GPIO_RELEASE to let it go
+#define SIM_GPIO_RELEASE    (-1)
+void sim_gpio_drive(uint u_gpio, int i_level);
+
+//write-1-to-clear registers, from hw_set_bits()
+void sim_adc_set_bits(io_rw_32 *pu32_addr, uint32_t u32_mask);
+
+const char *sim_env(const char *pc_name, const char *pc_default);
+double sim_env_double(const char *pc_name, double d_default);
+uint8_t sim_script_parse(const char *pc_script, sim_script_item_t *as_items, uint8_t u8_max);
+
+//writes "sim: ..." to stderr
+void sim_log(const char *pc_format, ...) __attribute__((format(printf, 1, 2)));
+//one line to the SIM_TRACE file, stamped with the time
+void sim_trace(const char *pc_format, ...) __attribute__((format(printf, 1, 2)));
+bool sim_tracing(void);
+
+//restarts the program as a chip reset would, keeping simulated time going
+void sim_reboot(const char *pc_reason) __attribute__((noreturn));
+//why this boot happened, NULL for power on
+const char *sim_boot_reason(void);
+
+#endif
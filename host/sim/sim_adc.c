@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "hardware/adc.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+/**
+ * Each input is set with SIM_ADC<n>, either a raw 12-bit code ("310") or
+ * a triangle between two codes with its period in ms ("250..400@2000").
+ * The temperature sensor reads 876 (about 27 deg C) unless SIM_ADC4 says
+ * otherwise. SIM_ADC_FIFO_DEPTH sets the sample FIFO depth (default 4,
+ * at most 15).
+ *
+ * Timing is kept in 1/256ths of a clk_adc cycle, the resolution of
+ * DIV.FRAC. Only adc_fifo_get() pops the FIFO, a read of adc_hw->fifo
+ * does not.
+ */
+
+#define SIM_ADC_CLK_HZ          48000000u
+#define SIM_ADC_CONVERSION_CYC  96u
+#define SIM_ADC_FIFO_MAX        15u
+#define SIM_ADC_TEMP_DEFAULT    876u
+//1/256 cycle ticks at 48 MHz, 1536 ticks are 125 ns
+#define SIM_ADC_TICKS_PER_125NS 1536u
+
+typedef struct {
+    uint16_t u16_lo;
+    uint16_t u16_hi;
+    uint64_t u64_periodNs;    // 0 for a fixed code
+} sim_adc_input_t;
+
+adc_hw_t sim_adc_hw;
+
+static sim_adc_input_t as_inputs[NUM_ADC_CHANNELS];
+static uint16_t au16_fifo[SIM_ADC_FIFO_MAX];
+static uint8_t u8_fifoHead = 0;
+static uint8_t u8_fifoLevel = 0;
+static uint8_t u8_fifoDepth = 4;
+static bool b_busy = false;
+static uint64_t u64_startTicks = 0;     // when the conversion in progress started
+static uint64_t u64_nowTicks = 0;       // the time of the last update
+static uint8_t u8_convInput = 0;
+static uint32_t u32_conversions = 0;
+static uint32_t u32_fifoOverflows = 0;
+static uint32_t u32_fifoUnderflows = 0;
+static uint8_t u8_fifoPeak = 0;
+static uint64_t u64_firstSampleNs = 0;
+static uint64_t u64_lastSampleNs = 0;
+
+static uint64_t sim_adc_ticks(uint64_t u64_ns){
+    return u64_ns * SIM_ADC_TICKS_PER_125NS / 125;
+}
+
+//rounded up, so the update at that time sees the conversion finished
+static uint64_t sim_adc_ns(uint64_t u64_ticks){
+    return (u64_ticks * 125 + SIM_ADC_TICKS_PER_125NS - 1) / SIM_ADC_TICKS_PER_125NS;
+}
+
+static uint64_t sim_adc_done_ticks(void){
+    return u64_startTicks + SIM_ADC_CONVERSION_CYC * 256;
+}
+
+//start to start in free-running mode, never shorter than one conversion
+static uint64_t sim_adc_period_ticks(void){
+    uint64_t u64_period = 256 + (sim_adc_hw.div & (ADC_DIV_INT_BITS | ADC_DIV_FRAC_BITS));
+    return MAX(u64_period, SIM_ADC_CONVERSION_CYC * 256);
+}
+
+static uint16_t sim_adc_value(uint8_t u8_input, uint64_t u64_nowNs){
+    const sim_adc_input_t *ps_input = &as_inputs[u8_input];
+    if(ps_input->u64_periodNs == 0){
+        return ps_input->u16_lo;
+    }
+    uint64_t u64_phase = (sim_elapsed_ns() - sim_now_ns() + u64_nowNs) % ps_input->u64_periodNs;
+    uint64_t u64_half = ps_input->u64_periodNs / 2;
+    uint64_t u64_span = (uint64_t)(ps_input->u16_hi - ps_input->u16_lo);
+    uint64_t u64_pos = u64_phase < u64_half ? u64_phase : ps_input->u64_periodNs - u64_phase;
+    return (uint16_t)(ps_input->u16_lo + u64_span * u64_pos / MAX(u64_half, 1));
+}
+
+static void sim_adc_parse_input(uint8_t u8_input, const char *pc_value){
+    sim_adc_input_t *ps_input = &as_inputs[u8_input];
+    char *pc_end;
+    unsigned long u_code = strtoul(pc_value, &pc_end, 10);
+    ps_input->u16_lo = (uint16_t)MIN(u_code, ADC_FIFO_VAL_BITS);
+    ps_input->u16_hi = ps_input->u16_lo;
+    ps_input->u64_periodNs = 0;
+    if(strncmp(pc_end, "..", 2) == 0){
+        u_code = strtoul(pc_end + 2, &pc_end, 10);
+        ps_input->u16_hi = (uint16_t)MIN(u_code, ADC_FIFO_VAL_BITS);
+        if(*pc_end == '@'){
+            ps_input->u64_periodNs = (uint64_t)(strtod(pc_end + 1, NULL) * SIM_NS_PER_MS);
+        }
+        if(ps_input->u16_hi < ps_input->u16_lo || ps_input->u64_periodNs == 0){
+            sim_log("SIM_ADC%u: \"%s\" should be lo..hi@ms with lo <= hi", u8_input, pc_value);
+            ps_input->u16_hi = ps_input->u16_lo;
+            ps_input->u64_periodNs = 0;
+        }
+    }
+}
+
+static void sim_adc_fifo_push(uint16_t u16_value){
+    if(u8_fifoLevel >= u8_fifoDepth){
+        //the FIFO keeps what it has, the new sample is lost
+        sim_adc_hw.fcs |= ADC_FCS_OVER_BITS;
+        u32_fifoOverflows++;
+        sim_trace("adc fifo overflow");
+        return;
+    }
+    au16_fifo[(u8_fifoHead + u8_fifoLevel) % SIM_ADC_FIFO_MAX] = u16_value;
+    u8_fifoLevel++;
+    u8_fifoPeak = MAX(u8_fifoPeak, u8_fifoLevel);
+}
+
+//LEVEL, EMPTY, FULL, READY and the FIFO interrupt from the model's state
+static void sim_adc_refresh(void){
+    uint32_t u32_fcs = sim_adc_hw.fcs & ~(ADC_FCS_LEVEL_BITS | ADC_FCS_EMPTY_BITS | ADC_FCS_FULL_BITS);
+    u32_fcs |= (uint32_t)u8_fifoLevel << ADC_FCS_LEVEL_LSB;
+    u32_fcs |= u8_fifoLevel == 0 ? ADC_FCS_EMPTY_BITS : 0;
+    u32_fcs |= u8_fifoLevel >= u8_fifoDepth ? ADC_FCS_FULL_BITS : 0;
+    sim_adc_hw.fcs = u32_fcs;
+    SIM_REG(sim_adc_hw.fifo) = u8_fifoLevel != 0 ? au16_fifo[u8_fifoHead] : 0;
+    //free running, the next start is already set and READY until it comes
+    if((b_busy && u64_nowTicks >= u64_startTicks) || !(sim_adc_hw.cs & ADC_CS_EN_BITS)){
+        sim_adc_hw.cs &= ~ADC_CS_READY_BITS;
+    }else{
+        sim_adc_hw.cs |= ADC_CS_READY_BITS;
+    }
+    uint32_t u32_thresh = (sim_adc_hw.fcs & ADC_FCS_THRESH_BITS) >> ADC_FCS_THRESH_LSB;
+    uint32_t u32_intr = u8_fifoLevel >= u32_thresh ? ADC_INTE_FIFO_BITS : 0;
+    SIM_REG(sim_adc_hw.intr) = u32_intr;
+    SIM_REG(sim_adc_hw.ints) = (u32_intr & sim_adc_hw.inte) | (sim_adc_hw.intf & ADC_INTE_FIFO_BITS);
+    sim_irq_set_line(ADC_IRQ_FIFO, sim_adc_hw.ints != 0);
+}
+
+static void sim_adc_start(uint64_t u64_ticks){
+    b_busy = true;
+    u64_startTicks = u64_ticks;
+    u8_convInput = (uint8_t)((sim_adc_hw.cs & ADC_CS_AINSEL_BITS) >> ADC_CS_AINSEL_LSB);
+}
+
+//the round robin moves AINSEL on to the next input in RROBIN after each conversion
+static void sim_adc_round_robin(void){
+    uint32_t u32_rrobin = (sim_adc_hw.cs & ADC_CS_RROBIN_BITS) >> ADC_CS_RROBIN_LSB;
+    if(u32_rrobin == 0){
+        return;
+    }
+    uint32_t u32_input = (sim_adc_hw.cs & ADC_CS_AINSEL_BITS) >> ADC_CS_AINSEL_LSB;
+    do{
+        u32_input = (u32_input + 1) % NUM_ADC_CHANNELS;
+    }while(!(u32_rrobin & (1u << u32_input)));
+    sim_adc_hw.cs = (sim_adc_hw.cs & ~ADC_CS_AINSEL_BITS) | (u32_input << ADC_CS_AINSEL_LSB);
+}
+
+static void sim_adc_complete(void){
+    uint64_t u64_doneNs = sim_adc_ns(sim_adc_done_ticks());
+    uint16_t u16_value = u8_convInput < NUM_ADC_CHANNELS ? sim_adc_value(u8_convInput, u64_doneNs) : 0;
+    //the temperature sensor only reads when it is powered
+    if(u8_convInput == ADC_TEMPERATURE_CHANNEL_NUM && !(sim_adc_hw.cs & ADC_CS_TS_EN_BITS)){
+        u16_value = 0;
+    }
+    SIM_REG(sim_adc_hw.result) = u16_value;
+    u32_conversions++;
+    if(u32_conversions == 1){
+        u64_firstSampleNs = u64_doneNs;
+    }
+    u64_lastSampleNs = u64_doneNs;
+    if(sim_adc_hw.fcs & ADC_FCS_EN_BITS){
+        sim_adc_fifo_push(sim_adc_hw.fcs & ADC_FCS_SHIFT_BITS ? (uint16_t)(u16_value >> 4) : u16_value);
+    }
+    sim_adc_round_robin();
+}
+
+static void sim_adc_init(void){
+    memset(&sim_adc_hw, 0, sizeof(sim_adc_hw));
+    for(uint8_t u8_i = 0; u8_i < NUM_ADC_CHANNELS; u8_i++){
+        char ac_name[16];
+        snprintf(ac_name, sizeof(ac_name), "SIM_ADC%u", u8_i);
+        memset(&as_inputs[u8_i], 0, sizeof(as_inputs[u8_i]));
+        sim_adc_parse_input(u8_i, sim_env(ac_name, u8_i == ADC_TEMPERATURE_CHANNEL_NUM ? "876" : "0"));
+    }
+    u8_fifoDepth = (uint8_t)MIN(MAX(sim_env_double("SIM_ADC_FIFO_DEPTH", 4), 1), SIM_ADC_FIFO_MAX);
+    u8_fifoHead = 0;
+    u8_fifoLevel = 0;
+    b_busy = false;
+    sim_adc_refresh();
+}
+
+static uint64_t sim_adc_next(void){
+    return b_busy ? sim_adc_ns(sim_adc_done_ticks()) : SIM_NEVER;
+}
+
+static void sim_adc_update(uint64_t u64_nowNs){
+    u64_nowTicks = sim_adc_ticks(u64_nowNs);
+    bool b_enabled = (sim_adc_hw.cs & ADC_CS_EN_BITS) != 0;
+
+    if(!b_enabled){
+        b_busy = false;
+    }else if(!b_busy && (sim_adc_hw.cs & (ADC_CS_START_ONCE_BITS | ADC_CS_START_MANY_BITS))){
+        sim_adc_start(u64_nowTicks);
+    }
+    //START_ONCE clears itself
+    sim_adc_hw.cs &= ~ADC_CS_START_ONCE_BITS;
+
+    while(b_busy && sim_adc_done_ticks() <= u64_nowTicks){
+        sim_adc_complete();
+        b_busy = false;
+        if(sim_adc_hw.cs & ADC_CS_START_MANY_BITS){
+            //free running starts are on a fixed grid, however late the model is looking
+            sim_adc_start(u64_startTicks + sim_adc_period_ticks());
+        }
+    }
+    sim_adc_refresh();
+}
+
+static void sim_adc_report(FILE *ps_file){
+    if(u32_conversions == 0){
+        return;
+    }
+    double d_rate = 0;
+    if(u32_conversions > 1 && u64_lastSampleNs > u64_firstSampleNs){
+        d_rate = (double)(u32_conversions - 1) * SIM_NS_PER_S / (double)(u64_lastSampleNs - u64_firstSampleNs);
+    }
+    fprintf(ps_file, "sim: adc %lu conversions at %.1f Hz, FIFO peak %u of %u, %lu samples lost to overflow, %lu reads of an empty FIFO\n",
+            (unsigned long)u32_conversions, d_rate, u8_fifoPeak, u8_fifoDepth,
+            (unsigned long)u32_fifoOverflows, (unsigned long)u32_fifoUnderflows);
+}
+
+const sim_device_t sim_adc_device = {
+    "adc", sim_adc_init, sim_adc_next, sim_adc_update, sim_adc_report
+};
+
+//hw_set_bits() on FCS: OVER and UNDER are write-1-to-clear
+void sim_adc_set_bits(io_rw_32 *pu32_addr, uint32_t u32_mask){
+    if(pu32_addr == &sim_adc_hw.fcs){
+        sim_adc_hw.fcs &= ~(u32_mask & (ADC_FCS_OVER_BITS | ADC_FCS_UNDER_BITS));
+    }
+}
+
+/*****************************************************************
+ * hardware/adc.h
+ *****************************************************************/
+void adc_init(void){
+    memset(&sim_adc_hw, 0, sizeof(sim_adc_hw));
+    u8_fifoLevel = 0;
+    b_busy = false;
+    sim_adc_hw.cs = ADC_CS_EN_BITS;
+    sim_adc_refresh();
+    sim_hal_call();
+}
+
+void adc_gpio_init(uint u_gpio){
+    gpio_set_function(u_gpio, GPIO_FUNC_NULL);
+    gpio_disable_pulls(u_gpio);
+    gpio_set_input_enabled(u_gpio, false);
+}
+
+void adc_select_input(uint u_input){
+    hw_write_masked(&sim_adc_hw.cs, u_input << ADC_CS_AINSEL_LSB, ADC_CS_AINSEL_BITS);
+    sim_hal_call();
+}
+
+uint adc_get_selected_input(void){
+    return (sim_adc_hw.cs & ADC_CS_AINSEL_BITS) >> ADC_CS_AINSEL_LSB;
+}
+
+void adc_set_round_robin(uint u_inputMask){
+    hw_write_masked(&sim_adc_hw.cs, u_inputMask << ADC_CS_RROBIN_LSB, ADC_CS_RROBIN_BITS);
+    sim_hal_call();
+}
+
+void adc_set_temp_sensor_enabled(bool b_enable){
+    if(b_enable){
+        hw_set_bits(&sim_adc_hw.cs, ADC_CS_TS_EN_BITS);
+    }else{
+        hw_clear_bits(&sim_adc_hw.cs, ADC_CS_TS_EN_BITS);
+    }
+    sim_hal_call();
+}
+
+uint16_t adc_read(void){
+    hw_set_bits(&sim_adc_hw.cs, ADC_CS_START_ONCE_BITS);
+    sim_sync();
+    while(!(sim_adc_hw.cs & ADC_CS_READY_BITS)){
+        sim_idle();
+    }
+    return (uint16_t)sim_adc_hw.result;
+}
+
+void adc_run(bool b_run){
+    if(b_run){
+        hw_set_bits(&sim_adc_hw.cs, ADC_CS_START_MANY_BITS);
+    }else{
+        hw_clear_bits(&sim_adc_hw.cs, ADC_CS_START_MANY_BITS);
+    }
+    sim_hal_call();
+}
+
+void adc_set_clkdiv(float f_clkdiv){
+    sim_adc_hw.div = (uint32_t)(f_clkdiv * (float)(1 << ADC_DIV_INT_LSB));
+    sim_hal_call();
+}
+
+void adc_fifo_setup(bool b_en, bool b_dreqEn, uint16_t u16_dreqThresh, bool b_errInFifo, bool b_byteShift){
+    (void)b_errInFifo;
+    hw_write_masked(&sim_adc_hw.fcs,
+                    (b_en ? ADC_FCS_EN_BITS : 0) | (b_dreqEn ? ADC_FCS_DREQ_EN_BITS : 0) |
+                    ((uint32_t)u16_dreqThresh << ADC_FCS_THRESH_LSB) | (b_byteShift ? ADC_FCS_SHIFT_BITS : 0),
+                    ADC_FCS_EN_BITS | ADC_FCS_DREQ_EN_BITS | ADC_FCS_THRESH_BITS | ADC_FCS_ERR_BITS | ADC_FCS_SHIFT_BITS);
+    sim_hal_call();
+}
+
+bool adc_fifo_is_empty(void){
+    sim_hal_call();
+    return u8_fifoLevel == 0;
+}
+
+uint8_t adc_fifo_get_level(void){
+    sim_hal_call();
+    return u8_fifoLevel;
+}
+
+uint16_t adc_fifo_get(void){
+    uint16_t u16_value = 0;
+    if(u8_fifoLevel == 0){
+        sim_adc_hw.fcs |= ADC_FCS_UNDER_BITS;
+        u32_fifoUnderflows++;
+    }else{
+        u16_value = au16_fifo[u8_fifoHead];
+        u8_fifoHead = (u8_fifoHead + 1) % SIM_ADC_FIFO_MAX;
+        u8_fifoLevel--;
+    }
+    sim_adc_refresh();
+    sim_hal_call();
+    return u16_value;
+}
+
+uint16_t adc_fifo_get_blocking(void){
+    while(adc_fifo_is_empty()){
+        sim_idle();
+    }
+    return adc_fifo_get();
+}
+
+void adc_fifo_drain(void){
+    //a conversion in progress lands in the FIFO first
+    while(!(sim_adc_hw.cs & ADC_CS_READY_BITS)){
+        sim_idle();
+    }
+    while(!adc_fifo_is_empty()){
+        (void)adc_fifo_get();
+    }
+}
+
+void adc_irq_set_enabled(bool b_enabled){
+    sim_adc_hw.inte = b_enabled ? ADC_INTE_FIFO_BITS : 0;
+    sim_hal_call();
+}
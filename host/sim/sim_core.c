@@ -0,0 +1,568 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+//handlers one IRQ can have with irq_add_shared_handler()
+#define SIM_IRQ_MAX_HANDLERS    4
+//running outside any ISR
+#define SIM_THREAD_PRIORITY     0x100
+//how often the pacing compares simulated with real time
+#define SIM_PACE_NS             SIM_NS_PER_MS
+
+typedef struct {
+    irq_handler_t apf_handlers[SIM_IRQ_MAX_HANDLERS];
+    uint8_t u8_numHandlers;
+    bool b_enabled;
+    bool b_pending;
+    bool b_active;
+    bool b_line;
+    uint8_t u8_priority;
+    uint32_t u32_count;
+    uint64_t u64_totalNs;
+    uint64_t u64_maxNs;
+    uint64_t u64_pendNs;        // when it last became pending while enabled
+    uint64_t u64_maxLatencyNs;  // longest from then to its ISR starting
+} sim_irq_t;
+
+static const sim_device_t *const aps_devices[] = {
+    &sim_timer_device,
+    &sim_watchdog_device,
+    &sim_gpio_device,
+    &sim_uart_device,
+    &sim_adc_device,
+    &sim_i2c_device,
+};
+
+static const char *const apc_irqNames[NUM_IRQS] = {
+    [TIMER0_IRQ_0] = "TIMER0_IRQ_0", [TIMER0_IRQ_1] = "TIMER0_IRQ_1",
+    [TIMER0_IRQ_2] = "TIMER0_IRQ_2", [TIMER0_IRQ_3] = "TIMER0_IRQ_3",
+    [PWM_IRQ_WRAP_0] = "PWM_IRQ_WRAP_0", [DMA_IRQ_0] = "DMA_IRQ_0", [DMA_IRQ_1] = "DMA_IRQ_1",
+    [PIO0_IRQ_0] = "PIO0_IRQ_0", [IO_IRQ_BANK0] = "IO_IRQ_BANK0",
+    [SIO_IRQ_FIFO] = "SIO_IRQ_FIFO", [SIO_IRQ_BELL] = "SIO_IRQ_BELL",
+    [UART0_IRQ] = "UART0_IRQ", [UART1_IRQ] = "UART1_IRQ", [ADC_IRQ_FIFO] = "ADC_IRQ_FIFO",
+    [I2C0_IRQ] = "I2C0_IRQ", [I2C1_IRQ] = "I2C1_IRQ",
+};
+
+static sim_irq_t as_irqs[NUM_IRQS];
+static bool b_primask = false;
+static uint16_t u16_activePriority = SIM_THREAD_PRIORITY;
+static uint8_t u8_isrDepth = 0;
+
+static uint64_t u64_nowNs = 0;
+static uint64_t u64_bootNs = 0;        // elapsed time at the start of this boot
+static uint64_t u64_stopNs = 0;        // 0 runs forever
+static uint32_t u32_halNs = 100;
+static double d_speed = 1.0;
+static uint64_t u64_realStartNs;
+static uint64_t u64_lastPaceNs = 0;
+static uint32_t u32_boots = 0;
+static const char *pc_bootReason = NULL;
+static FILE *ps_trace = NULL;
+static char **ppc_argv;
+static volatile sig_atomic_t b_interrupted = 0;
+
+static uint64_t sim_real_ns(void){
+    struct timespec s_now;
+    clock_gettime(CLOCK_MONOTONIC, &s_now);
+    return (uint64_t)s_now.tv_sec * SIM_NS_PER_S + (uint64_t)s_now.tv_nsec;
+}
+
+const char *sim_env(const char *pc_name, const char *pc_default){
+    const char *pc_value = getenv(pc_name);
+    return pc_value != NULL && *pc_value != '\0' ? pc_value : pc_default;
+}
+
+double sim_env_double(const char *pc_name, double d_default){
+    const char *pc_value = sim_env(pc_name, NULL);
+    return pc_value != NULL ? strtod(pc_value, NULL) : d_default;
+}
+
+void sim_log(const char *pc_format, ...){
+    va_list args;
+    fprintf(stderr, "sim: ");
+    va_start(args, pc_format);
+    vfprintf(stderr, pc_format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+bool sim_tracing(void){
+    return ps_trace != NULL;
+}
+
+void sim_trace(const char *pc_format, ...){
+    if(ps_trace == NULL){
+        return;
+    }
+    uint64_t u64_elapsed = sim_elapsed_ns();
+    va_list args;
+    fprintf(ps_trace, "%llu.%09llu ", (unsigned long long)(u64_elapsed / SIM_NS_PER_S),
+            (unsigned long long)(u64_elapsed % SIM_NS_PER_S));
+    va_start(args, pc_format);
+    vfprintf(ps_trace, pc_format, args);
+    va_end(args);
+    fputc('\n', ps_trace);
+}
+
+uint8_t sim_script_parse(const char *pc_script, sim_script_item_t *as_items, uint8_t u8_max){
+    uint8_t u8_count = 0;
+    while(pc_script != NULL && *pc_script != '\0' && u8_count < u8_max){
+        char *pc_end;
+        double d_ms = strtod(pc_script, &pc_end);
+        if(pc_end == pc_script || *pc_end != ':'){
+            sim_log("bad script item at \"%s\", expected ms:text", pc_script);
+            break;
+        }
+        pc_script = pc_end + 1;
+        sim_script_item_t *ps_item = &as_items[u8_count++];
+        ps_item->u64_ns = (uint64_t)(d_ms * SIM_NS_PER_MS);
+        size_t len = 0;
+        while(*pc_script != '\0' && *pc_script != '|'){
+            char c = *pc_script++;
+            if(c == '\\' && *pc_script != '\0'){
+                c = *pc_script++;
+                c = c == 'r' ? '\r' : c == 'n' ? '\n' : c == 'e' ? '\x1b' : c;
+            }
+            if(len + 1 < sizeof(ps_item->ac_text)){
+                ps_item->ac_text[len++] = c;
+            }
+        }
+        ps_item->ac_text[len] = '\0';
+        if(*pc_script == '|'){
+            pc_script++;
+        }
+    }
+    return u8_count;
+}
+
+uint64_t sim_now_ns(void){
+    return u64_nowNs;
+}
+
+uint64_t sim_elapsed_ns(void){
+    return u64_bootNs + u64_nowNs;
+}
+
+const char *sim_boot_reason(void){
+    return pc_bootReason;
+}
+
+bool sim_in_isr(void){
+    return u8_isrDepth != 0;
+}
+
+static void sim_update_all(void){
+    for(uint8_t u8_i = 0; u8_i < count_of(aps_devices); u8_i++){
+        aps_devices[u8_i]->pf_update(u64_nowNs);
+    }
+}
+
+static uint64_t sim_next_event(void){
+    uint64_t u64_next = SIM_NEVER;
+    for(uint8_t u8_i = 0; u8_i < count_of(aps_devices); u8_i++){
+        uint64_t u64_device = aps_devices[u8_i]->pf_next();
+        if(u64_device < u64_next){
+            u64_next = u64_device;
+        }
+    }
+    return u64_next;
+}
+
+//keeps simulated time from running ahead of real time / SIM_SPEED
+static void sim_pace(void){
+    if(d_speed <= 0 || u64_nowNs - u64_lastPaceNs < SIM_PACE_NS){
+        return;
+    }
+    u64_lastPaceNs = u64_nowNs;
+    uint64_t u64_real = sim_real_ns() - u64_realStartNs;
+    uint64_t u64_wanted = (uint64_t)((double)u64_nowNs / d_speed);
+    if(u64_wanted > u64_real + SIM_PACE_NS){
+        uint64_t u64_sleep = u64_wanted - u64_real;
+        struct timespec s_sleep = {(time_t)(u64_sleep / SIM_NS_PER_S), (long)(u64_sleep % SIM_NS_PER_S)};
+        nanosleep(&s_sleep, NULL);
+    }
+}
+
+//latency runs from here, or from the enable if it was already pending
+static void sim_irq_pend(sim_irq_t *ps_irq){
+    if(!ps_irq->b_pending){
+        ps_irq->u64_pendNs = u64_nowNs;
+    }
+    ps_irq->b_pending = true;
+}
+
+static void sim_run_irq(uint u_irq){
+    sim_irq_t *ps_irq = &as_irqs[u_irq];
+    uint16_t u16_savedPriority = u16_activePriority;
+    uint64_t u64_start = u64_nowNs;
+
+    if(u64_start - ps_irq->u64_pendNs > ps_irq->u64_maxLatencyNs){
+        ps_irq->u64_maxLatencyNs = u64_start - ps_irq->u64_pendNs;
+    }
+
+    ps_irq->b_pending = false;
+    ps_irq->b_active = true;
+    u16_activePriority = ps_irq->u8_priority >> 4;
+    u8_isrDepth++;
+    sim_trace("enter %s depth %u", apc_irqNames[u_irq] ? apc_irqNames[u_irq] : "IRQ", u8_isrDepth);
+    for(uint8_t u8_i = 0; u8_i < ps_irq->u8_numHandlers; u8_i++){
+        ps_irq->apf_handlers[u8_i]();
+    }
+    sim_trace("exit %s depth %u", apc_irqNames[u_irq] ? apc_irqNames[u_irq] : "IRQ", u8_isrDepth);
+    u8_isrDepth--;
+    ps_irq->b_active = false;
+    u16_activePriority = u16_savedPriority;
+
+    uint64_t u64_duration = u64_nowNs - u64_start;
+    ps_irq->u32_count++;
+    ps_irq->u64_totalNs += u64_duration;
+    if(u64_duration > ps_irq->u64_maxNs){
+        ps_irq->u64_maxNs = u64_duration;
+    }
+
+    //a level that is still high pends the IRQ again, as the NVIC does
+    sim_update_all();
+    if(ps_irq->b_line){
+        sim_irq_pend(ps_irq);
+    }
+}
+
+//takes every pending IRQ that may preempt what is running, most urgent first
+static void sim_dispatch(void){
+    while(!b_primask){
+        int i_best = -1;
+        uint16_t u16_bestPriority = u16_activePriority;
+        for(uint u_irq = 0; u_irq < NUM_IRQS; u_irq++){
+            sim_irq_t *ps_irq = &as_irqs[u_irq];
+            if(ps_irq->b_pending && ps_irq->b_enabled && (ps_irq->u8_priority >> 4) < u16_bestPriority){
+                i_best = (int)u_irq;
+                u16_bestPriority = ps_irq->u8_priority >> 4;
+            }
+        }
+        if(i_best < 0){
+            return;
+        }
+        if(as_irqs[i_best].u8_numHandlers == 0){
+            panic("unhandled IRQ %d", i_best);
+        }
+        sim_run_irq((uint)i_best);
+    }
+}
+
+//Ctrl-C stops at the next step, so the report still gets printed
+static void sim_on_sigint(int i_signal){
+    (void)i_signal;
+    b_interrupted = 1;
+}
+
+static void sim_check_stop(void){
+    if(b_interrupted || (u64_stopNs != 0 && sim_elapsed_ns() >= u64_stopNs)){
+        sim_log("stopped after %.6f s", (double)sim_elapsed_ns() / SIM_NS_PER_S);
+        exit(0);
+    }
+}
+
+static void sim_step(void){
+    sim_update_all();
+    sim_check_stop();
+    sim_pace();
+    sim_dispatch();
+}
+
+void sim_wait_until_ns(uint64_t u64_targetNs){
+    while(true){
+        uint64_t u64_next = sim_next_event();
+        if(u64_next > u64_targetNs){
+            break;
+        }
+        if(u64_next > u64_nowNs){
+            u64_nowNs = u64_next;
+        }
+        sim_step();
+    }
+    if(u64_targetNs > u64_nowNs){
+        u64_nowNs = u64_targetNs;
+    }
+    sim_step();
+}
+
+void sim_advance_ns(uint64_t u64_ns){
+    sim_wait_until_ns(u64_nowNs + u64_ns);
+}
+
+void sim_hal_call(void){
+    sim_advance_ns(u32_halNs);
+}
+
+void sim_sync(void){
+    sim_update_all();
+}
+
+void sim_idle_until(uint64_t u64_limitNs){
+    uint64_t u64_next = sim_next_event();
+    if(u64_next <= u64_nowNs){
+        u64_next = u64_nowNs + 1;
+    }
+    sim_wait_until_ns(u64_next < u64_limitNs ? u64_next : u64_limitNs);
+}
+
+void sim_idle(void){
+    //with nothing scheduled at all, look again in a millisecond
+    sim_idle_until(u64_nowNs + SIM_NS_PER_MS);
+}
+
+//a rising line pends the IRQ, a line that stays high only pends it again once its ISR returns
+void sim_irq_set_line(uint u_irq, bool b_level){
+    sim_irq_t *ps_irq = &as_irqs[u_irq];
+    if(b_level && (!ps_irq->b_line || !ps_irq->b_active)){
+        sim_irq_pend(ps_irq);
+    }
+    ps_irq->b_line = b_level;
+}
+
+static void sim_report(void){
+    uint64_t u64_real = sim_real_ns() - u64_realStartNs;
+    fflush(stdout);
+    fprintf(stderr, "sim: boot %u ran %.6f s simulated (%.6f s since the first boot) in %.3f s real\n",
+            u32_boots + 1, (double)u64_nowNs / SIM_NS_PER_S, (double)sim_elapsed_ns() / SIM_NS_PER_S,
+            (double)u64_real / SIM_NS_PER_S);
+    fprintf(stderr, "sim: %-16s %10s %12s %10s %10s %10s\n", "irq", "count", "total us", "mean us", "max us", "max lat us");
+    for(uint u_irq = 0; u_irq < NUM_IRQS; u_irq++){
+        sim_irq_t *ps_irq = &as_irqs[u_irq];
+        if(ps_irq->u32_count == 0){
+            continue;
+        }
+        char ac_name[16];
+        snprintf(ac_name, sizeof(ac_name), "IRQ%u", u_irq);
+        fprintf(stderr, "sim: %-16s %10lu %12.3f %10.3f %10.3f %10.3f\n", apc_irqNames[u_irq] ? apc_irqNames[u_irq] : ac_name,
+                (unsigned long)ps_irq->u32_count, (double)ps_irq->u64_totalNs / SIM_NS_PER_US,
+                (double)ps_irq->u64_totalNs / SIM_NS_PER_US / ps_irq->u32_count,
+                (double)ps_irq->u64_maxNs / SIM_NS_PER_US, (double)ps_irq->u64_maxLatencyNs / SIM_NS_PER_US);
+    }
+    for(uint8_t u8_i = 0; u8_i < count_of(aps_devices); u8_i++){
+        if(aps_devices[u8_i]->pf_report != NULL){
+            aps_devices[u8_i]->pf_report(stderr);
+        }
+    }
+    if(ps_trace != NULL){
+        fflush(ps_trace);
+    }
+}
+
+void sim_reboot(const char *pc_reason){
+    char ac_value[32];
+    sim_log("%s reset after %.6f s", pc_reason, (double)u64_nowNs / SIM_NS_PER_S);
+    sim_report();
+    for(uint8_t u8_i = 0; u8_i < count_of(aps_devices); u8_i++){
+        if(aps_devices[u8_i]->pf_save != NULL){
+            aps_devices[u8_i]->pf_save();
+        }
+    }
+    //the next boot picks up the time and the count where this one stopped
+    snprintf(ac_value, sizeof(ac_value), "%llu", (unsigned long long)sim_elapsed_ns());
+    setenv("SIM_ELAPSED_NS", ac_value, 1);
+    snprintf(ac_value, sizeof(ac_value), "%u", u32_boots + 1);
+    setenv("SIM_BOOTS", ac_value, 1);
+    setenv("SIM_BOOT_REASON", pc_reason, 1);
+    fflush(NULL);
+    execv("/proc/self/exe", ppc_argv);
+    sim_log("could not restart: execv failed");
+    _exit(1);
+}
+
+void panic(const char *pc_format, ...){
+    va_list args;
+    fflush(stdout);
+    fprintf(stderr, "sim: *** PANIC *** ");
+    va_start(args, pc_format);
+    vfprintf(stderr, pc_format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    abort();
+}
+
+//runs before the app's main(), glibc passes the arguments to constructors
+__attribute__((constructor)) static void sim_start(int argc, char **argv){
+    (void)argc;
+    ppc_argv = argv;
+    u64_realStartNs = sim_real_ns();
+    u64_bootNs = (uint64_t)strtoull(sim_env("SIM_ELAPSED_NS", "0"), NULL, 10);
+    u32_boots = (uint32_t)strtoul(sim_env("SIM_BOOTS", "0"), NULL, 10);
+    pc_bootReason = sim_env("SIM_BOOT_REASON", NULL);
+    u64_stopNs = (uint64_t)(sim_env_double("SIM_SECONDS", 0) * SIM_NS_PER_S);
+    d_speed = sim_env_double("SIM_SPEED", 1.0);
+    u32_halNs = (uint32_t)sim_env_double("SIM_HAL_NS", 100);
+
+    const char *pc_trace = sim_env("SIM_TRACE", NULL);
+    if(pc_trace != NULL){
+        ps_trace = fopen(pc_trace, u32_boots == 0 ? "w" : "a");
+        if(ps_trace == NULL){
+            sim_log("cannot open trace file %s", pc_trace);
+        }
+    }
+
+    for(uint u_irq = 0; u_irq < NUM_IRQS; u_irq++){
+        as_irqs[u_irq].u8_priority = PICO_DEFAULT_IRQ_PRIORITY;
+    }
+    for(uint8_t u8_i = 0; u8_i < count_of(aps_devices); u8_i++){
+        aps_devices[u8_i]->pf_init();
+    }
+    atexit(sim_report);
+    signal(SIGINT, sim_on_sigint);
+    sim_trace("boot %u%s%s", u32_boots + 1, pc_bootReason ? " after " : "", pc_bootReason ? pc_bootReason : "");
+}
+
+/*****************************************************************
+ * hardware/irq.h
+ *****************************************************************/
+static void sim_irq_check(uint u_num){
+    if(u_num >= NUM_IRQS){
+        panic("IRQ %u does not exist", u_num);
+    }
+}
+
+void irq_set_exclusive_handler(uint u_num, irq_handler_t pf_handler){
+    sim_irq_check(u_num);
+    if(as_irqs[u_num].u8_numHandlers != 0 && as_irqs[u_num].apf_handlers[0] != pf_handler){
+        panic("IRQ %u already has a handler", u_num);
+    }
+    as_irqs[u_num].apf_handlers[0] = pf_handler;
+    as_irqs[u_num].u8_numHandlers = 1;
+}
+
+irq_handler_t irq_get_exclusive_handler(uint u_num){
+    sim_irq_check(u_num);
+    return as_irqs[u_num].u8_numHandlers == 1 ? as_irqs[u_num].apf_handlers[0] : NULL;
+}
+
+//the order priority is not kept, shared handlers run in the order they were added
+void irq_add_shared_handler(uint u_num, irq_handler_t pf_handler, uint8_t u8_orderPriority){
+    (void)u8_orderPriority;
+    sim_irq_check(u_num);
+    if(as_irqs[u_num].u8_numHandlers >= SIM_IRQ_MAX_HANDLERS){
+        panic("too many shared handlers on IRQ %u", u_num);
+    }
+    as_irqs[u_num].apf_handlers[as_irqs[u_num].u8_numHandlers++] = pf_handler;
+}
+
+void irq_remove_handler(uint u_num, irq_handler_t pf_handler){
+    sim_irq_t *ps_irq = &as_irqs[u_num];
+    sim_irq_check(u_num);
+    for(uint8_t u8_i = 0; u8_i < ps_irq->u8_numHandlers; u8_i++){
+        if(ps_irq->apf_handlers[u8_i] == pf_handler){
+            memmove(&ps_irq->apf_handlers[u8_i], &ps_irq->apf_handlers[u8_i + 1],
+                    (size_t)(ps_irq->u8_numHandlers - u8_i - 1) * sizeof(irq_handler_t));
+            ps_irq->u8_numHandlers--;
+            return;
+        }
+    }
+}
+
+void irq_set_enabled(uint u_num, bool b_enabled){
+    sim_irq_check(u_num);
+    if(b_enabled && !as_irqs[u_num].b_enabled){
+        as_irqs[u_num].u64_pendNs = u64_nowNs;
+    }
+    as_irqs[u_num].b_enabled = b_enabled;
+    sim_hal_call();
+}
+
+bool irq_is_enabled(uint u_num){
+    sim_irq_check(u_num);
+    return as_irqs[u_num].b_enabled;
+}
+
+void irq_set_mask_enabled(uint32_t u32_mask, bool b_enabled){
+    for(uint u_num = 0; u_num < 32; u_num++){
+        if(u32_mask & (1u << u_num)){
+            if(b_enabled && !as_irqs[u_num].b_enabled){
+                as_irqs[u_num].u64_pendNs = u64_nowNs;
+            }
+            as_irqs[u_num].b_enabled = b_enabled;
+        }
+    }
+    sim_hal_call();
+}
+
+void irq_set_priority(uint u_num, uint8_t u8_priority){
+    sim_irq_check(u_num);
+    as_irqs[u_num].u8_priority = u8_priority;
+}
+
+uint irq_get_priority(uint u_num){
+    sim_irq_check(u_num);
+    return as_irqs[u_num].u8_priority;
+}
+
+void irq_set_pending(uint u_num){
+    sim_irq_check(u_num);
+    sim_irq_pend(&as_irqs[u_num]);
+    sim_hal_call();
+}
+
+void irq_clear(uint u_num){
+    sim_irq_check(u_num);
+    as_irqs[u_num].b_pending = false;
+}
+
+/*****************************************************************
+ * hardware/sync.h
+ *****************************************************************/
+uint32_t save_and_disable_interrupts(void){
+    uint32_t u32_status = b_primask;
+    b_primask = true;
+    return u32_status;
+}
+
+void restore_interrupts(uint32_t u32_status){
+    b_primask = u32_status != 0;
+    if(!b_primask){
+        sim_dispatch();
+    }
+}
+
+void restore_interrupts_from_disabled(uint32_t u32_status){
+    restore_interrupts(u32_status);
+}
+
+void __wfi(void){
+    sim_idle();
+}
+
+void __wfe(void){
+    sim_idle();
+}
+
+void __sev(void){
+}
+
+void tight_loop_contents(void){
+    sim_hal_call();
+}
+
+/*****************************************************************
+ * hardware/address_mapped.h
+ *****************************************************************/
+void hw_set_bits(io_rw_32 *pu32_addr, uint32_t u32_mask){
+    *pu32_addr |= u32_mask;
+    sim_adc_set_bits(pu32_addr, u32_mask);
+}
+
+void hw_clear_bits(io_rw_32 *pu32_addr, uint32_t u32_mask){
+    *pu32_addr &= ~u32_mask;
+}
+
+void hw_xor_bits(io_rw_32 *pu32_addr, uint32_t u32_mask){
+    *pu32_addr ^= u32_mask;
+}
+
+void hw_write_masked(io_rw_32 *pu32_addr, uint32_t u32_values, uint32_t u32_writeMask){
+    *pu32_addr = (*pu32_addr & ~u32_writeMask) | (u32_values & u32_writeMask);
+}
@@ -0,0 +1,370 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+
+/**
+ * DS3231 RTC. The register map is 0x00-0x12: the time and date in BCD
+ * (12 or 24 hour, with the century bit), the two alarms, control, status,
+ * aging offset and temperature. The register pointer is set by the first
+ * byte of a write and moves on after every byte read or written, wrapping
+ * from 0x12 to 0x00. The time registers are copied to a buffer at each
+ * START, so a burst read sees one consistent time.
+ *
+ * The clock runs from a 32768 Hz crystal and writing the seconds
+ * register restarts its countdown, so the next second is a whole second
+ * after the write. With INTCN = 0 the INT/SQW pin puts out the square
+ * wave RS2:RS1 selects (1 Hz, 1.024, 4.096 or 8.192 kHz); at 1 Hz the
+ * falling edge is where the seconds change. The pin is open drain, it
+ * pulls the GPIO low and lets it go. The alarm registers hold what is
+ * written to them but the alarms never fire, so with INTCN = 1 the pin
+ * stays high.
+ *
+ * The RTC runs on its battery, so it keeps time across a reset of the
+ * Pico.
+ *
+ *   SIM_DS3231_TIME  the time at power on, "YYMMDDhhmmss" or "host" for
+ *                    the PC's clock (default 2000-01-01 00:00:00 with the
+ *                    oscillator stop flag set, as a new part powers up)
+ *   SIM_DS3231_PPM   crystal error in ppm, + runs fast (default 0)
+ *   SIM_DS3231_SQW   GPIO the INT/SQW pin is wired to (default 14), "none"
+ *   SIM_DS3231_TEMP  temperature in deg C (default 25)
+ */
+
+#define SIM_DS3231_ADDR         0x68
+#define SIM_DS3231_NUM_REGS     0x13
+#define SIM_DS3231_TIME_REGS    7
+#define SIM_DS3231_XTAL_HZ      32768u
+
+#define SIM_DS3231_REG_SECONDS  0x00
+#define SIM_DS3231_REG_HOURS    0x02
+#define SIM_DS3231_REG_DAY      0x03
+#define SIM_DS3231_REG_DATE     0x04
+#define SIM_DS3231_REG_MONTH    0x05
+#define SIM_DS3231_REG_YEAR     0x06
+#define SIM_DS3231_REG_CONTROL  0x0E
+#define SIM_DS3231_REG_STATUS   0x0F
+#define SIM_DS3231_REG_TEMP_MSB 0x11
+#define SIM_DS3231_REG_TEMP_LSB 0x12
+
+#define SIM_DS3231_HOURS_12H    0x40u
+#define SIM_DS3231_HOURS_PM     0x20u
+#define SIM_DS3231_CENTURY      0x80u
+#define SIM_DS3231_INTCN        0x04u
+#define SIM_DS3231_RS_SHIFT     3
+#define SIM_DS3231_OSF          0x80u
+#define SIM_DS3231_EN32KHZ      0x08u
+#define SIM_DS3231_BSY          0x04u
+#define SIM_DS3231_ALARM_FLAGS  0x03u
+
+//half a period of the square wave in crystal cycles, by RS2:RS1
+static const uint16_t au16_sqwHalf[4] = {SIM_DS3231_XTAL_HZ / 2, 16, 4, 2};
+
+static uint8_t au8_regs[SIM_DS3231_NUM_REGS];
+static uint8_t au8_timeBuffer[SIM_DS3231_TIME_REGS];
+static uint8_t u8_pointer = 0;
+static bool b_pointerNext = false;     // the next byte written sets the pointer
+
+static double d_nsPerCycle;
+static uint64_t u64_countdownNs = 0;    // elapsed time the countdown last restarted
+static uint64_t u64_seconds = 0;        // seconds counted since then
+static int i_sqwPin = 14;
+static bool b_pinLow = false;
+
+static uint32_t u32_edges = 0;
+static uint32_t u32_timeWrites = 0;
+
+static uint8_t sim_ds3231_bin(uint8_t u8_bcd){
+    return (uint8_t)((u8_bcd >> 4) * 10 + (u8_bcd & 0x0F));
+}
+
+static uint8_t sim_ds3231_bcd(uint8_t u8_bin){
+    return (uint8_t)((u8_bin / 10) << 4 | u8_bin % 10);
+}
+
+//crystal cycles since the countdown restarted
+static uint64_t sim_ds3231_cycles(uint64_t u64_elapsedNs){
+    if(u64_elapsedNs <= u64_countdownNs){
+        return 0;
+    }
+    return (uint64_t)((double)(u64_elapsedNs - u64_countdownNs) / d_nsPerCycle);
+}
+
+static uint64_t sim_ds3231_cycle_ns(uint64_t u64_cycles){
+    return u64_countdownNs + (uint64_t)ceil((double)u64_cycles * d_nsPerCycle);
+}
+
+static uint8_t sim_ds3231_days_in_month(void){
+    static const uint8_t au8_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    uint8_t u8_month = sim_ds3231_bin(au8_regs[SIM_DS3231_REG_MONTH] & 0x1F);
+    if(u8_month < 1 || u8_month > 12){
+        return 31;
+    }
+    //the part counts every fourth year as a leap year
+    if(u8_month == 2 && sim_ds3231_bin(au8_regs[SIM_DS3231_REG_YEAR]) % 4 == 0){
+        return 29;
+    }
+    return au8_days[u8_month - 1];
+}
+
+//moves the hours on, true when that took it past midnight
+static bool sim_ds3231_next_hour(void){
+    uint8_t u8_reg = au8_regs[SIM_DS3231_REG_HOURS];
+    if(!(u8_reg & SIM_DS3231_HOURS_12H)){
+        uint8_t u8_hour = (uint8_t)(sim_ds3231_bin(u8_reg & 0x3F) + 1);
+        au8_regs[SIM_DS3231_REG_HOURS] = u8_hour < 24 ? sim_ds3231_bcd(u8_hour) : 0;
+        return u8_hour >= 24;
+    }
+    uint8_t u8_hour = sim_ds3231_bin(u8_reg & 0x1F);
+    uint8_t u8_pm = u8_reg & SIM_DS3231_HOURS_PM;
+    bool b_midnight = false;
+    if(u8_hour == 11){
+        b_midnight = u8_pm != 0;
+        u8_pm ^= SIM_DS3231_HOURS_PM;
+        u8_hour = 12;
+    }else{
+        u8_hour = u8_hour == 12 ? 1 : u8_hour + 1;
+    }
+    au8_regs[SIM_DS3231_REG_HOURS] = (uint8_t)(SIM_DS3231_HOURS_12H | u8_pm | sim_ds3231_bcd(u8_hour));
+    return b_midnight;
+}
+
+static void sim_ds3231_next_second(void){
+    uint8_t *pu8_r = au8_regs;
+    uint8_t u8_second = (uint8_t)(sim_ds3231_bin(pu8_r[0] & 0x7F) + 1);
+    if(u8_second < 60){
+        pu8_r[0] = sim_ds3231_bcd(u8_second);
+        return;
+    }
+    pu8_r[0] = 0;
+    uint8_t u8_minute = (uint8_t)(sim_ds3231_bin(pu8_r[1] & 0x7F) + 1);
+    if(u8_minute < 60){
+        pu8_r[1] = sim_ds3231_bcd(u8_minute);
+        return;
+    }
+    pu8_r[1] = 0;
+    if(!sim_ds3231_next_hour()){
+        return;
+    }
+    pu8_r[SIM_DS3231_REG_DAY] = (uint8_t)((pu8_r[SIM_DS3231_REG_DAY] & 0x07) % 7 + 1);
+    uint8_t u8_date = (uint8_t)(sim_ds3231_bin(pu8_r[SIM_DS3231_REG_DATE] & 0x3F) + 1);
+    if(u8_date <= sim_ds3231_days_in_month()){
+        pu8_r[SIM_DS3231_REG_DATE] = sim_ds3231_bcd(u8_date);
+        return;
+    }
+    pu8_r[SIM_DS3231_REG_DATE] = 1;
+    uint8_t u8_century = pu8_r[SIM_DS3231_REG_MONTH] & SIM_DS3231_CENTURY;
+    uint8_t u8_month = (uint8_t)(sim_ds3231_bin(pu8_r[SIM_DS3231_REG_MONTH] & 0x1F) + 1);
+    if(u8_month <= 12){
+        pu8_r[SIM_DS3231_REG_MONTH] = u8_century | sim_ds3231_bcd(u8_month);
+        return;
+    }
+    pu8_r[SIM_DS3231_REG_MONTH] = u8_century | 1;
+    uint8_t u8_year = (uint8_t)(sim_ds3231_bin(pu8_r[SIM_DS3231_REG_YEAR]) + 1);
+    if(u8_year < 100){
+        pu8_r[SIM_DS3231_REG_YEAR] = sim_ds3231_bcd(u8_year);
+        return;
+    }
+    pu8_r[SIM_DS3231_REG_YEAR] = 0;
+    pu8_r[SIM_DS3231_REG_MONTH] ^= SIM_DS3231_CENTURY;
+}
+
+static bool sim_ds3231_sqw_on(void){
+    return i_sqwPin >= 0 && !(au8_regs[SIM_DS3231_REG_CONTROL] & SIM_DS3231_INTCN);
+}
+
+static uint16_t sim_ds3231_sqw_half(void){
+    return au16_sqwHalf[(au8_regs[SIM_DS3231_REG_CONTROL] >> SIM_DS3231_RS_SHIFT) & 0x03];
+}
+
+static void sim_ds3231_update(uint64_t u64_nowNs){
+    uint64_t u64_cycles = sim_ds3231_cycles(sim_elapsed_ns() - sim_now_ns() + u64_nowNs);
+    while((u64_seconds + 1) * SIM_DS3231_XTAL_HZ <= u64_cycles){
+        sim_ds3231_next_second();
+        u64_seconds++;
+    }
+    if(i_sqwPin < 0){
+        return;
+    }
+    //low for the first half of each period, so at 1 Hz it falls as the seconds change
+    bool b_low = sim_ds3231_sqw_on() && (u64_cycles / sim_ds3231_sqw_half()) % 2 == 0;
+    if(b_low != b_pinLow){
+        b_pinLow = b_low;
+        if(b_low){
+            u32_edges++;
+        }
+        sim_gpio_drive((uint)i_sqwPin, b_low ? 0 : SIM_GPIO_RELEASE);
+    }
+}
+
+static uint64_t sim_ds3231_next(void){
+    if(!sim_ds3231_sqw_on()){
+        return SIM_NEVER;
+    }
+    uint64_t u64_offsetNs = sim_elapsed_ns() - sim_now_ns();
+    uint16_t u16_half = sim_ds3231_sqw_half();
+    uint64_t u64_edge = (sim_ds3231_cycles(sim_elapsed_ns()) / u16_half + 1) * u16_half;
+    uint64_t u64_next = sim_ds3231_cycle_ns(u64_edge) - u64_offsetNs;
+    return MAX(u64_next, sim_now_ns() + 1);
+}
+
+static void sim_ds3231_restart_countdown(void){
+    u64_countdownNs = sim_elapsed_ns();
+    u64_seconds = 0;
+}
+
+static void sim_ds3231_set_time(const struct tm *ps_tm){
+    au8_regs[0] = sim_ds3231_bcd((uint8_t)ps_tm->tm_sec);
+    au8_regs[1] = sim_ds3231_bcd((uint8_t)ps_tm->tm_min);
+    au8_regs[SIM_DS3231_REG_HOURS] = sim_ds3231_bcd((uint8_t)ps_tm->tm_hour);
+    //Sunday is 1, as the apps count it
+    au8_regs[SIM_DS3231_REG_DAY] = (uint8_t)(ps_tm->tm_wday + 1);
+    au8_regs[SIM_DS3231_REG_DATE] = sim_ds3231_bcd((uint8_t)ps_tm->tm_mday);
+    au8_regs[SIM_DS3231_REG_MONTH] = sim_ds3231_bcd((uint8_t)(ps_tm->tm_mon + 1));
+    au8_regs[SIM_DS3231_REG_YEAR] = sim_ds3231_bcd((uint8_t)(ps_tm->tm_year % 100));
+    au8_regs[SIM_DS3231_REG_STATUS] &= (uint8_t)~SIM_DS3231_OSF;
+}
+
+static void sim_ds3231_power_on(void){
+    memset(au8_regs, 0, sizeof(au8_regs));
+    au8_regs[SIM_DS3231_REG_DAY] = 1;
+    au8_regs[SIM_DS3231_REG_DATE] = 1;
+    au8_regs[SIM_DS3231_REG_MONTH] = 1;
+    au8_regs[SIM_DS3231_REG_CONTROL] = SIM_DS3231_INTCN | 3u << SIM_DS3231_RS_SHIFT;
+    au8_regs[SIM_DS3231_REG_STATUS] = SIM_DS3231_OSF | SIM_DS3231_EN32KHZ;
+    sim_ds3231_restart_countdown();
+
+    const char *pc_time = sim_env("SIM_DS3231_TIME", NULL);
+    struct tm s_tm;
+    memset(&s_tm, 0, sizeof(s_tm));
+    if(pc_time == NULL){
+        return;
+    }
+    if(strcmp(pc_time, "host") == 0){
+        time_t t_now = time(NULL);
+        localtime_r(&t_now, &s_tm);
+    }else if(strlen(pc_time) == 12 && strptime(pc_time, "%y%m%d%H%M%S", &s_tm) != NULL){
+        //strptime leaves the day of the week, mktime works it out
+        s_tm.tm_isdst = -1;
+        mktime(&s_tm);
+    }else{
+        sim_log("SIM_DS3231_TIME: use YYMMDDhhmmss or host, not \"%s\"", pc_time);
+        return;
+    }
+    sim_ds3231_set_time(&s_tm);
+}
+
+static uint8_t sim_ds3231_init(void){
+    d_nsPerCycle = (double)SIM_NS_PER_S / SIM_DS3231_XTAL_HZ / (1.0 + sim_env_double("SIM_DS3231_PPM", 0.0) * 1e-6);
+    const char *pc_sqw = sim_env("SIM_DS3231_SQW", "14");
+    i_sqwPin = strcmp(pc_sqw, "none") == 0 ? -1 : atoi(pc_sqw);
+
+    //after a restart of the Pico, carry on from where the RTC was
+    unsigned long long ull_countdown, ull_seconds;
+    char ac_regs[2 * SIM_DS3231_NUM_REGS + 1];
+    const char *pc_state = sim_env("SIM_DS3231_STATE", NULL);
+    if(pc_state != NULL && sscanf(pc_state, "%llu,%llu,%38s", &ull_countdown, &ull_seconds, ac_regs) == 3
+       && strlen(ac_regs) == 2 * SIM_DS3231_NUM_REGS){
+        u64_countdownNs = ull_countdown;
+        u64_seconds = ull_seconds;
+        for(uint8_t u8_i = 0; u8_i < SIM_DS3231_NUM_REGS; u8_i++){
+            char ac_byte[3] = {ac_regs[2 * u8_i], ac_regs[2 * u8_i + 1], '\0'};
+            au8_regs[u8_i] = (uint8_t)strtoul(ac_byte, NULL, 16);
+        }
+    }else{
+        sim_ds3231_power_on();
+    }
+
+    //two's complement deg C and quarter degrees in the top bits of the LSB
+    int16_t i16_quarters = (int16_t)floor(sim_env_double("SIM_DS3231_TEMP", 25.0) * 4.0);
+    au8_regs[SIM_DS3231_REG_TEMP_MSB] = (uint8_t)(i16_quarters >> 2);
+    au8_regs[SIM_DS3231_REG_TEMP_LSB] = (uint8_t)((i16_quarters & 0x03) << 6);
+    return SIM_DS3231_ADDR;
+}
+
+static void sim_ds3231_start(bool b_read){
+    memcpy(au8_timeBuffer, au8_regs, sizeof(au8_timeBuffer));
+    b_pointerNext = !b_read;
+}
+
+static void sim_ds3231_write_register(uint8_t u8_reg, uint8_t u8_data){
+    switch(u8_reg){
+    case SIM_DS3231_REG_SECONDS:
+        au8_regs[u8_reg] = u8_data & 0x7F;
+        sim_ds3231_restart_countdown();
+        u32_timeWrites++;
+        break;
+    case SIM_DS3231_REG_STATUS: {
+        //OSF and the alarm flags can only be cleared, BSY is read only
+        uint8_t u8_old = au8_regs[u8_reg];
+        uint8_t u8_clearable = SIM_DS3231_OSF | SIM_DS3231_ALARM_FLAGS;
+        au8_regs[u8_reg] = (uint8_t)((u8_old & u8_data & u8_clearable) | (u8_data & SIM_DS3231_EN32KHZ) | (u8_old & SIM_DS3231_BSY));
+        break;
+    }
+    case SIM_DS3231_REG_TEMP_MSB:
+    case SIM_DS3231_REG_TEMP_LSB:
+        break;
+    default:
+        au8_regs[u8_reg] = u8_data;
+        break;
+    }
+}
+
+static bool sim_ds3231_write(uint8_t u8_data){
+    if(b_pointerNext){
+        u8_pointer = u8_data % SIM_DS3231_NUM_REGS;
+        b_pointerNext = false;
+        return true;
+    }
+    sim_ds3231_write_register(u8_pointer, u8_data);
+    u8_pointer = (uint8_t)((u8_pointer + 1) % SIM_DS3231_NUM_REGS);
+    //a new control value or a restarted countdown moves the square wave now
+    sim_ds3231_update(sim_now_ns());
+    return true;
+}
+
+static uint8_t sim_ds3231_read(void){
+    uint8_t u8_data = u8_pointer < SIM_DS3231_TIME_REGS ? au8_timeBuffer[u8_pointer] : au8_regs[u8_pointer];
+    u8_pointer = (uint8_t)((u8_pointer + 1) % SIM_DS3231_NUM_REGS);
+    return u8_data;
+}
+
+static void sim_ds3231_stop(void){
+    b_pointerNext = false;
+}
+
+static void sim_ds3231_report(FILE *ps_file){
+    const uint8_t *pu8_r = au8_regs;
+    bool b_12h = (pu8_r[SIM_DS3231_REG_HOURS] & SIM_DS3231_HOURS_12H) != 0;
+    fprintf(ps_file, "sim: ds3231 %s%02x-%02x-%02x %02x:%02x:%02x%s, %lu SQW falling edges, %lu seconds writes\n",
+            pu8_r[SIM_DS3231_REG_MONTH] & SIM_DS3231_CENTURY ? "21" : "20", pu8_r[SIM_DS3231_REG_YEAR],
+            pu8_r[SIM_DS3231_REG_MONTH] & 0x1F, pu8_r[SIM_DS3231_REG_DATE], pu8_r[SIM_DS3231_REG_HOURS] & (b_12h ? 0x1F : 0x3F),
+            pu8_r[1], pu8_r[0], !b_12h ? "" : pu8_r[SIM_DS3231_REG_HOURS] & SIM_DS3231_HOURS_PM ? " PM" : " AM",
+            (unsigned long)u32_edges, (unsigned long)u32_timeWrites);
+}
+
+static void sim_ds3231_save(void){
+    char ac_state[64 + 2 * SIM_DS3231_NUM_REGS];
+    int i_len = snprintf(ac_state, sizeof(ac_state), "%llu,%llu,",
+                         (unsigned long long)u64_countdownNs, (unsigned long long)u64_seconds);
+    for(uint8_t u8_i = 0; u8_i < SIM_DS3231_NUM_REGS; u8_i++){
+        i_len += snprintf(&ac_state[i_len], sizeof(ac_state) - (size_t)i_len, "%02x", au8_regs[u8_i]);
+    }
+    setenv("SIM_DS3231_STATE", ac_state, 1);
+}
+
+const sim_i2c_target_t sim_ds3231_target = {
+    .pc_name = "ds3231",
+    .u_maxBaud = 400000,
+    .pf_init = sim_ds3231_init,
+    .pf_next = sim_ds3231_next,
+    .pf_update = sim_ds3231_update,
+    .pf_start = sim_ds3231_start,
+    .pf_write = sim_ds3231_write,
+    .pf_read = sim_ds3231_read,
+    .pf_stop = sim_ds3231_stop,
+    .pf_report = sim_ds3231_report,
+    .pf_save = sim_ds3231_save,
+};
@@ -0,0 +1,409 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+/**
+ * SIM_GPIO is a script of what happens on the pins, "ms:action|...":
+ *   6=1    drive GPIO6 high (=0 low, =z let it go)
+ *   10~6   connect GPIO10 to GPIO6, as a pressed key joins a column to a row
+ *   10!6   take the connection away again
+ * An undriven pin with nothing driving it through a connection reads its pull.
+ */
+
+//bits per pin in the event mask, as in the INTR registers
+#define SIM_GPIO_EVENTS_ALL     0xFu
+
+typedef struct {
+    gpio_function_t e_function;
+    bool b_out;
+    bool b_outLevel;
+    bool b_pullUp;
+    bool b_pullDown;
+    int8_t i8_drive;            // SIM_GPIO_RELEASE, 0 or 1
+    bool b_level;               // what the pad reads
+    uint32_t u32_connected;     // pins wired to this one
+    uint8_t u8_intr;            // latched edges and current levels
+    uint8_t u8_inte;
+} sim_pin_t;
+
+static sim_pin_t as_pins[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t pf_gpioCallback = NULL;
+static sim_script_item_t as_gpioScript[SIM_SCRIPT_MAX];
+static uint8_t u8_gpioScriptLen = 0;
+static uint8_t u8_gpioScriptNext = 0;
+static uint32_t u32_edges = 0;
+
+static void sim_gpio_check(uint u_gpio){
+    if(u_gpio >= NUM_BANK0_GPIOS){
+        panic("GPIO %u does not exist", u_gpio);
+    }
+}
+
+static bool sim_gpio_drives(const sim_pin_t *ps_pin){
+    return ps_pin->b_out && ps_pin->e_function == GPIO_FUNC_SIO;
+}
+
+//what a pin reads: its own output, then anything driving it, then its pull
+static bool sim_gpio_level(uint u_gpio){
+    const sim_pin_t *ps_pin = &as_pins[u_gpio];
+    if(sim_gpio_drives(ps_pin)){
+        return ps_pin->b_outLevel;
+    }
+    if(ps_pin->i8_drive != SIM_GPIO_RELEASE){
+        return ps_pin->i8_drive != 0;
+    }
+    bool b_driven = false;
+    bool b_level = false;
+    for(uint u_other = 0; u_other < NUM_BANK0_GPIOS; u_other++){
+        if(ps_pin->u32_connected & (1u << u_other)){
+            const sim_pin_t *ps_other = &as_pins[u_other];
+            if(sim_gpio_drives(ps_other)){
+                b_driven = true;
+                b_level |= ps_other->b_outLevel;
+            }else if(ps_other->i8_drive != SIM_GPIO_RELEASE){
+                b_driven = true;
+                b_level |= ps_other->i8_drive != 0;
+            }
+        }
+    }
+    if(b_driven){
+        return b_level;
+    }
+    if(ps_pin->b_pullUp){
+        return true;
+    }
+    if(ps_pin->b_pullDown){
+        return false;
+    }
+    //floating, a bus keeper holds the last level
+    return ps_pin->b_level;
+}
+
+//new levels for every pin, latching edges and raising IO_IRQ_BANK0
+static void sim_gpio_settle(void){
+    bool b_irq = false;
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        sim_pin_t *ps_pin = &as_pins[u_gpio];
+        bool b_level = sim_gpio_level(u_gpio);
+        if(b_level != ps_pin->b_level){
+            ps_pin->u8_intr |= b_level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+            ps_pin->b_level = b_level;
+            u32_edges++;
+            sim_trace("gpio %u -> %u", u_gpio, b_level);
+        }
+        //the level bits follow the pin, only the edges are latched
+        ps_pin->u8_intr = (uint8_t)((ps_pin->u8_intr & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)) |
+                                    (b_level ? GPIO_IRQ_LEVEL_HIGH : GPIO_IRQ_LEVEL_LOW));
+        b_irq |= (ps_pin->u8_intr & ps_pin->u8_inte) != 0;
+    }
+    sim_irq_set_line(IO_IRQ_BANK0, b_irq);
+}
+
+void sim_gpio_drive(uint u_gpio, int i_level){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].i8_drive = (int8_t)i_level;
+    sim_gpio_settle();
+}
+
+static void sim_gpio_connect(uint u_a, uint u_b, bool b_connect){
+    sim_gpio_check(u_a);
+    sim_gpio_check(u_b);
+    if(b_connect){
+        as_pins[u_a].u32_connected |= 1u << u_b;
+        as_pins[u_b].u32_connected |= 1u << u_a;
+    }else{
+        as_pins[u_a].u32_connected &= ~(1u << u_b);
+        as_pins[u_b].u32_connected &= ~(1u << u_a);
+    }
+    sim_gpio_settle();
+}
+
+static void sim_gpio_run_item(const char *pc_action){
+    char *pc_end;
+    uint u_pin = (uint)strtoul(pc_action, &pc_end, 10);
+    if(pc_end == pc_action){
+        sim_log("SIM_GPIO: bad action \"%s\"", pc_action);
+        return;
+    }
+    switch(*pc_end){
+    case '=':
+        sim_gpio_drive(u_pin, pc_end[1] == 'z' ? SIM_GPIO_RELEASE : pc_end[1] == '1');
+        break;
+    case '~':
+    case '!':
+        sim_gpio_connect(u_pin, (uint)strtoul(pc_end + 1, NULL, 10), *pc_end == '~');
+        break;
+    default:
+        sim_log("SIM_GPIO: bad action \"%s\"", pc_action);
+        break;
+    }
+}
+
+static void sim_gpio_init(void){
+    memset(as_pins, 0, sizeof(as_pins));
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        //reset state: no function, input, pulled down
+        as_pins[u_gpio].e_function = GPIO_FUNC_NULL;
+        as_pins[u_gpio].b_pullDown = true;
+        as_pins[u_gpio].i8_drive = SIM_GPIO_RELEASE;
+    }
+    u8_gpioScriptLen = sim_script_parse(sim_env("SIM_GPIO", NULL), as_gpioScript, SIM_SCRIPT_MAX);
+    //after a reset the outside world is still as the script left it
+    u8_gpioScriptNext = 0;
+    while(u8_gpioScriptNext < u8_gpioScriptLen && as_gpioScript[u8_gpioScriptNext].u64_ns <= sim_elapsed_ns()){
+        sim_gpio_run_item(as_gpioScript[u8_gpioScriptNext++].ac_text);
+    }
+    sim_gpio_settle();
+    //the settle above is the reset state, not an edge
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        as_pins[u_gpio].u8_intr &= ~(GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    }
+    u32_edges = 0;
+}
+
+static uint64_t sim_gpio_next(void){
+    if(u8_gpioScriptNext >= u8_gpioScriptLen){
+        return SIM_NEVER;
+    }
+    uint64_t u64_bootNs = sim_elapsed_ns() - sim_now_ns();
+    uint64_t u64_at = as_gpioScript[u8_gpioScriptNext].u64_ns;
+    return u64_at > u64_bootNs ? u64_at - u64_bootNs : 0;
+}
+
+//the pins only change from the script or from the app's calls, which settle them themselves
+static void sim_gpio_update(uint64_t u64_nowNs){
+    while(u8_gpioScriptNext < u8_gpioScriptLen && sim_gpio_next() <= u64_nowNs){
+        sim_trace("gpio script %s", as_gpioScript[u8_gpioScriptNext].ac_text);
+        sim_gpio_run_item(as_gpioScript[u8_gpioScriptNext++].ac_text);
+    }
+}
+
+static void sim_gpio_report(FILE *ps_file){
+    fprintf(ps_file, "sim: gpio %lu edges, outputs high:", (unsigned long)u32_edges);
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        if(sim_gpio_drives(&as_pins[u_gpio]) && as_pins[u_gpio].b_outLevel){
+            fprintf(ps_file, " %u", u_gpio);
+        }
+    }
+    fputc('\n', ps_file);
+}
+
+const sim_device_t sim_gpio_device = {
+    "gpio", sim_gpio_init, sim_gpio_next, sim_gpio_update, sim_gpio_report
+};
+
+//the SDK's default IO_IRQ_BANK0 handler
+static void sim_gpio_irq(void){
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        uint32_t u32_events = as_pins[u_gpio].u8_intr & as_pins[u_gpio].u8_inte;
+        if(u32_events != 0){
+            gpio_acknowledge_irq(u_gpio, u32_events);
+            if(pf_gpioCallback != NULL){
+                pf_gpioCallback(u_gpio, u32_events);
+            }
+        }
+    }
+}
+
+/*****************************************************************
+ * hardware/gpio.h
+ *****************************************************************/
+static void sim_gpio_changed(void){
+    sim_gpio_settle();
+    sim_hal_call();
+}
+
+void gpio_init(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].b_out = false;
+    as_pins[u_gpio].b_outLevel = false;
+    as_pins[u_gpio].e_function = GPIO_FUNC_SIO;
+    sim_gpio_changed();
+}
+
+void gpio_deinit(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].e_function = GPIO_FUNC_NULL;
+    sim_gpio_changed();
+}
+
+void gpio_init_mask(uint32_t u32_mask){
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        if(u32_mask & (1u << u_gpio)){
+            gpio_init(u_gpio);
+        }
+    }
+}
+
+void gpio_set_function(uint u_gpio, gpio_function_t e_fn){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].e_function = e_fn;
+    sim_gpio_changed();
+}
+
+gpio_function_t gpio_get_function(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].e_function;
+}
+
+void gpio_set_dir(uint u_gpio, bool b_out){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].b_out = b_out;
+    sim_gpio_changed();
+}
+
+void gpio_set_dir_masked(uint32_t u32_mask, uint32_t u32_value){
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        if(u32_mask & (1u << u_gpio)){
+            as_pins[u_gpio].b_out = (u32_value >> u_gpio) & 1u;
+        }
+    }
+    sim_gpio_changed();
+}
+
+void gpio_set_dir_out_masked(uint32_t u32_mask){
+    gpio_set_dir_masked(u32_mask, u32_mask);
+}
+
+void gpio_set_dir_in_masked(uint32_t u32_mask){
+    gpio_set_dir_masked(u32_mask, 0);
+}
+
+void gpio_set_dir_all_bits(uint32_t u32_values){
+    gpio_set_dir_masked((1u << NUM_BANK0_GPIOS) - 1, u32_values);
+}
+
+bool gpio_is_dir_out(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].b_out;
+}
+
+void gpio_set_pulls(uint u_gpio, bool b_up, bool b_down){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].b_pullUp = b_up;
+    as_pins[u_gpio].b_pullDown = b_down;
+    sim_gpio_changed();
+}
+
+void gpio_pull_up(uint u_gpio){
+    gpio_set_pulls(u_gpio, true, false);
+}
+
+void gpio_pull_down(uint u_gpio){
+    gpio_set_pulls(u_gpio, false, true);
+}
+
+void gpio_disable_pulls(uint u_gpio){
+    gpio_set_pulls(u_gpio, false, false);
+}
+
+bool gpio_is_pulled_up(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].b_pullUp;
+}
+
+bool gpio_is_pulled_down(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].b_pullDown;
+}
+
+void gpio_set_input_enabled(uint u_gpio, bool b_enabled){
+    sim_gpio_check(u_gpio);
+    (void)b_enabled;
+}
+
+void gpio_put(uint u_gpio, bool b_value){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].b_outLevel = b_value;
+    sim_gpio_changed();
+}
+
+bool gpio_get(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    sim_hal_call();
+    return as_pins[u_gpio].b_level;
+}
+
+bool gpio_get_out_level(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].b_outLevel;
+}
+
+uint32_t gpio_get_all(void){
+    uint32_t u32_levels = 0;
+    sim_hal_call();
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        u32_levels |= (uint32_t)as_pins[u_gpio].b_level << u_gpio;
+    }
+    return u32_levels;
+}
+
+void gpio_put_masked(uint32_t u32_mask, uint32_t u32_value){
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        if(u32_mask & (1u << u_gpio)){
+            as_pins[u_gpio].b_outLevel = (u32_value >> u_gpio) & 1u;
+        }
+    }
+    sim_gpio_changed();
+}
+
+void gpio_set_mask(uint32_t u32_mask){
+    gpio_put_masked(u32_mask, u32_mask);
+}
+
+void gpio_clr_mask(uint32_t u32_mask){
+    gpio_put_masked(u32_mask, 0);
+}
+
+void gpio_xor_mask(uint32_t u32_mask){
+    uint32_t u32_value = 0;
+    for(uint u_gpio = 0; u_gpio < NUM_BANK0_GPIOS; u_gpio++){
+        u32_value |= (uint32_t)!as_pins[u_gpio].b_outLevel << u_gpio;
+    }
+    gpio_put_masked(u32_mask, u32_value);
+}
+
+void gpio_put_all(uint32_t u32_value){
+    gpio_put_masked((1u << NUM_BANK0_GPIOS) - 1, u32_value);
+}
+
+void gpio_set_irq_enabled(uint u_gpio, uint32_t u32_events, bool b_enabled){
+    sim_gpio_check(u_gpio);
+    //as the SDK does, stale edges are cleared before they are enabled
+    gpio_acknowledge_irq(u_gpio, u32_events);
+    if(b_enabled){
+        as_pins[u_gpio].u8_inte |= (uint8_t)(u32_events & SIM_GPIO_EVENTS_ALL);
+    }else{
+        as_pins[u_gpio].u8_inte &= (uint8_t)~u32_events;
+    }
+    sim_gpio_changed();
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t pf_callback){
+    pf_gpioCallback = pf_callback;
+    if(irq_get_exclusive_handler(IO_IRQ_BANK0) != sim_gpio_irq){
+        irq_set_exclusive_handler(IO_IRQ_BANK0, sim_gpio_irq);
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint u_gpio, uint32_t u32_events, bool b_enabled, gpio_irq_callback_t pf_callback){
+    gpio_set_irq_enabled(u_gpio, u32_events, b_enabled);
+    gpio_set_irq_callback(pf_callback);
+    if(b_enabled){
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+}
+
+//only the edge bits latch, the level ones clear themselves
+void gpio_acknowledge_irq(uint u_gpio, uint32_t u32_events){
+    sim_gpio_check(u_gpio);
+    as_pins[u_gpio].u8_intr &= (uint8_t)~(u32_events & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL));
+    sim_gpio_settle();
+}
+
+uint32_t gpio_get_irq_event_mask(uint u_gpio){
+    sim_gpio_check(u_gpio);
+    return as_pins[u_gpio].u8_intr & as_pins[u_gpio].u8_inte;
+}
@@ -0,0 +1,296 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/i2c.h"
+
+/**
+ * The I2C controllers and the parts on their buses. A transfer takes its
+ * time on the bus: a start, nine clocks for the address and for every
+ * byte (eight bits and the acknowledge) and a stop, at the rate
+ * i2c_init() set. A transfer that ends with nostop skips the stop, and
+ * the repeated start that follows costs what a start does. Time moves a byte at a
+ * time, so interrupts still land while the app waits on the bus, and a
+ * target sees each byte at the time its acknowledge is clocked.
+ *
+ *   SIM_I2C0, SIM_I2C1  the parts on each bus (default "mcp4725,ds3231"
+ *                       on i2c0, nothing on i2c1), "none" for an empty bus
+ *
+ * An address nobody answers, or a part clocked faster than it is rated
+ * for, is NACKed after its address byte.
+ */
+
+#define SIM_I2C_CLK_PERI_HZ     150000000u
+#define SIM_I2C_BITS_PER_BYTE   9u
+#define SIM_I2C_MAX_TARGETS     4
+
+typedef struct {
+    const sim_i2c_target_t *ps_target;
+    uint8_t u8_addr;
+    bool b_warned;              // said once that the bus is too fast for it
+    uint32_t u32_transfers;
+    uint32_t u32_bytes;
+    uint64_t u64_busyNs;
+} sim_i2c_slot_t;
+
+struct i2c_inst {
+    uint u_baud;
+    bool b_enabled;
+    sim_i2c_slot_t as_slots[SIM_I2C_MAX_TARGETS];
+    uint8_t u8_numSlots;
+    uint32_t u32_transfers;
+    uint32_t u32_nacks;
+    uint32_t u32_timeouts;
+    uint64_t u64_busyNs;
+};
+
+i2c_inst_t i2c0_inst;
+i2c_inst_t i2c1_inst;
+
+static const sim_i2c_target_t *const aps_targets[] = {
+    &sim_mcp4725_target,
+    &sim_ds3231_target,
+};
+
+static i2c_inst_t *const aps_i2c[] = {&i2c0_inst, &i2c1_inst};
+
+static void sim_i2c_attach(i2c_inst_t *i2c, const char *pc_list){
+    char ac_list[128];
+    snprintf(ac_list, sizeof(ac_list), "%s", pc_list);
+    for(char *pc_name = strtok(ac_list, ","); pc_name != NULL; pc_name = strtok(NULL, ",")){
+        if(strcmp(pc_name, "none") == 0){
+            continue;
+        }
+        const sim_i2c_target_t *ps_target = NULL;
+        for(uint8_t u8_i = 0; u8_i < count_of(aps_targets); u8_i++){
+            if(strcmp(pc_name, aps_targets[u8_i]->pc_name) == 0){
+                ps_target = aps_targets[u8_i];
+            }
+        }
+        if(ps_target == NULL || i2c->u8_numSlots == SIM_I2C_MAX_TARGETS){
+            sim_log("SIM_I2C%u: cannot add \"%s\"", I2C_NUM(i2c), pc_name);
+            continue;
+        }
+        sim_i2c_slot_t *ps_slot = &i2c->as_slots[i2c->u8_numSlots++];
+        ps_slot->ps_target = ps_target;
+        ps_slot->u8_addr = ps_target->pf_init();
+    }
+}
+
+static void sim_i2c_init(void){
+    memset(&i2c0_inst, 0, sizeof(i2c0_inst));
+    memset(&i2c1_inst, 0, sizeof(i2c1_inst));
+    sim_i2c_attach(&i2c0_inst, sim_env("SIM_I2C0", "mcp4725,ds3231"));
+    sim_i2c_attach(&i2c1_inst, sim_env("SIM_I2C1", "none"));
+}
+
+static uint64_t sim_i2c_next(void){
+    uint64_t u64_next = SIM_NEVER;
+    for(uint8_t u8_bus = 0; u8_bus < count_of(aps_i2c); u8_bus++){
+        for(uint8_t u8_i = 0; u8_i < aps_i2c[u8_bus]->u8_numSlots; u8_i++){
+            const sim_i2c_target_t *ps_target = aps_i2c[u8_bus]->as_slots[u8_i].ps_target;
+            uint64_t u64_target = ps_target->pf_next != NULL ? ps_target->pf_next() : SIM_NEVER;
+            if(u64_target < u64_next){
+                u64_next = u64_target;
+            }
+        }
+    }
+    return u64_next;
+}
+
+static void sim_i2c_update(uint64_t u64_nowNs){
+    for(uint8_t u8_bus = 0; u8_bus < count_of(aps_i2c); u8_bus++){
+        for(uint8_t u8_i = 0; u8_i < aps_i2c[u8_bus]->u8_numSlots; u8_i++){
+            const sim_i2c_target_t *ps_target = aps_i2c[u8_bus]->as_slots[u8_i].ps_target;
+            if(ps_target->pf_update != NULL){
+                ps_target->pf_update(u64_nowNs);
+            }
+        }
+    }
+}
+
+static void sim_i2c_report(FILE *ps_file){
+    for(uint8_t u8_bus = 0; u8_bus < count_of(aps_i2c); u8_bus++){
+        const i2c_inst_t *ps_i2c = aps_i2c[u8_bus];
+        if(ps_i2c->u32_transfers != 0){
+            fprintf(ps_file, "sim: i2c%u %u Hz, %lu transfers, %lu NACKed, %lu timed out, bus busy %.3f ms\n",
+                    u8_bus, ps_i2c->u_baud, (unsigned long)ps_i2c->u32_transfers, (unsigned long)ps_i2c->u32_nacks,
+                    (unsigned long)ps_i2c->u32_timeouts, (double)ps_i2c->u64_busyNs / SIM_NS_PER_MS);
+        }
+        for(uint8_t u8_i = 0; u8_i < ps_i2c->u8_numSlots; u8_i++){
+            const sim_i2c_slot_t *ps_slot = &ps_i2c->as_slots[u8_i];
+            if(ps_slot->u32_transfers == 0){
+                continue;
+            }
+            fprintf(ps_file, "sim: i2c%u 0x%02x %-8s %lu transfers, %lu data bytes, bus busy %.3f ms\n",
+                    u8_bus, ps_slot->u8_addr, ps_slot->ps_target->pc_name, (unsigned long)ps_slot->u32_transfers,
+                    (unsigned long)ps_slot->u32_bytes, (double)ps_slot->u64_busyNs / SIM_NS_PER_MS);
+            if(ps_slot->ps_target->pf_report != NULL){
+                ps_slot->ps_target->pf_report(ps_file);
+            }
+        }
+    }
+}
+
+static void sim_i2c_save(void){
+    for(uint8_t u8_bus = 0; u8_bus < count_of(aps_i2c); u8_bus++){
+        for(uint8_t u8_i = 0; u8_i < aps_i2c[u8_bus]->u8_numSlots; u8_i++){
+            const sim_i2c_target_t *ps_target = aps_i2c[u8_bus]->as_slots[u8_i].ps_target;
+            if(ps_target->pf_save != NULL){
+                ps_target->pf_save();
+            }
+        }
+    }
+}
+
+const sim_device_t sim_i2c_device = {
+    "i2c", sim_i2c_init, sim_i2c_next, sim_i2c_update, sim_i2c_report, sim_i2c_save
+};
+
+static uint64_t sim_i2c_bits_ns(const i2c_inst_t *i2c, uint32_t u32_bits){
+    return (uint64_t)u32_bits * SIM_NS_PER_S / (i2c->u_baud != 0 ? i2c->u_baud : 100000);
+}
+
+//holds the bus for u32_bits, or until the deadline if that comes first
+static bool sim_i2c_hold(i2c_inst_t *i2c, sim_i2c_slot_t *ps_slot, uint32_t u32_bits, absolute_time_t until){
+    uint64_t u64_ns = sim_i2c_bits_ns(i2c, u32_bits);
+    uint64_t u64_endNs = sim_now_ns() + u64_ns;
+    uint64_t u64_untilNs = until * SIM_NS_PER_US;
+    bool b_inTime = u64_endNs <= u64_untilNs;
+    if(!b_inTime){
+        u64_ns = u64_untilNs > sim_now_ns() ? u64_untilNs - sim_now_ns() : 0;
+        u64_endNs = sim_now_ns() + u64_ns;
+    }
+    i2c->u64_busyNs += u64_ns;
+    if(ps_slot != NULL){
+        ps_slot->u64_busyNs += u64_ns;
+    }
+    sim_wait_until_ns(u64_endNs);
+    return b_inTime;
+}
+
+static sim_i2c_slot_t *sim_i2c_find(i2c_inst_t *i2c, uint8_t u8_addr){
+    for(uint8_t u8_i = 0; u8_i < i2c->u8_numSlots; u8_i++){
+        sim_i2c_slot_t *ps_slot = &i2c->as_slots[u8_i];
+        if(ps_slot->u8_addr != u8_addr){
+            continue;
+        }
+        if(i2c->u_baud > ps_slot->ps_target->u_maxBaud){
+            if(!ps_slot->b_warned){
+                sim_log("i2c%u at %u Hz is too fast for the %s (rated to %u Hz), it will not answer",
+                        I2C_NUM(i2c), i2c->u_baud, ps_slot->ps_target->pc_name, ps_slot->ps_target->u_maxBaud);
+                ps_slot->b_warned = true;
+            }
+            return NULL;
+        }
+        return ps_slot;
+    }
+    return NULL;
+}
+
+//the controller sends a stop after the last byte, or after a NACK or a timeout
+static void sim_i2c_stop(i2c_inst_t *i2c, sim_i2c_slot_t *ps_slot){
+    sim_i2c_hold(i2c, ps_slot, 1, SIM_NEVER / SIM_NS_PER_US);
+    if(ps_slot != NULL){
+        ps_slot->ps_target->pf_stop();
+    }
+}
+
+//pu8_src for a write, pu8_dst for a read
+static int sim_i2c_transfer(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, uint8_t *pu8_dst,
+                            size_t len, bool b_nostop, absolute_time_t until){
+    sim_hal_call();
+    i2c->u32_transfers++;
+    if(!i2c->b_enabled){
+        panic("i2c%u used before i2c_init", I2C_NUM(i2c));
+    }
+    if(len == 0){
+        panic("i2c%u: zero length transfer", I2C_NUM(i2c));
+    }
+    sim_i2c_slot_t *ps_slot = sim_i2c_find(i2c, u8_addr);
+    if(ps_slot != NULL){
+        ps_slot->u32_transfers++;
+    }
+
+    //start (or repeated start) and the address byte
+    if(!sim_i2c_hold(i2c, ps_slot, 1 + SIM_I2C_BITS_PER_BYTE, until)){
+        i2c->u32_timeouts++;
+        sim_i2c_stop(i2c, NULL);
+        return PICO_ERROR_TIMEOUT;
+    }
+    if(ps_slot == NULL){
+        i2c->u32_nacks++;
+        sim_i2c_stop(i2c, NULL);
+        return PICO_ERROR_GENERIC;
+    }
+    ps_slot->ps_target->pf_start(pu8_dst != NULL);
+
+    for(size_t i = 0; i < len; i++){
+        if(!sim_i2c_hold(i2c, ps_slot, SIM_I2C_BITS_PER_BYTE, until)){
+            i2c->u32_timeouts++;
+            sim_i2c_stop(i2c, ps_slot);
+            return PICO_ERROR_TIMEOUT;
+        }
+        ps_slot->u32_bytes++;
+        if(pu8_dst != NULL){
+            pu8_dst[i] = ps_slot->ps_target->pf_read();
+        }else if(!ps_slot->ps_target->pf_write(pu8_src[i])){
+            i2c->u32_nacks++;
+            sim_i2c_stop(i2c, ps_slot);
+            return PICO_ERROR_GENERIC;
+        }
+    }
+
+    //with nostop the bus stays held and the next transfer's start is a repeated start
+    if(!b_nostop){
+        sim_i2c_stop(i2c, ps_slot);
+    }
+    return (int)len;
+}
+
+/*****************************************************************
+ * hardware/i2c.h
+ *****************************************************************/
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint u_baudrate){
+    //the SDK's divider: a whole number of clk_peri cycles per SCL period
+    uint32_t u32_period = (SIM_I2C_CLK_PERI_HZ + u_baudrate / 2) / u_baudrate;
+    i2c->u_baud = SIM_I2C_CLK_PERI_HZ / u32_period;
+    sim_hal_call();
+    return i2c->u_baud;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint u_baudrate){
+    i2c->b_enabled = true;
+    return i2c_set_baudrate(i2c, u_baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c){
+    i2c->b_enabled = false;
+    sim_hal_call();
+}
+
+uint i2c_get_index(i2c_inst_t *i2c){
+    return I2C_NUM(i2c);
+}
+
+int i2c_write_blocking_until(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop, absolute_time_t until){
+    return sim_i2c_transfer(i2c, u8_addr, pu8_src, NULL, len, b_nostop, until);
+}
+
+int i2c_read_blocking_until(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop, absolute_time_t until){
+    return sim_i2c_transfer(i2c, u8_addr, NULL, pu8_dst, len, b_nostop, until);
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop, uint u_timeoutUs){
+    return i2c_write_blocking_until(i2c, u8_addr, pu8_src, len, b_nostop, make_timeout_time_us(u_timeoutUs));
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop, uint u_timeoutUs){
+    return i2c_read_blocking_until(i2c, u8_addr, pu8_dst, len, b_nostop, make_timeout_time_us(u_timeoutUs));
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t u8_addr, const uint8_t *pu8_src, size_t len, bool b_nostop){
+    return i2c_write_blocking_until(i2c, u8_addr, pu8_src, len, b_nostop, SIM_NEVER / SIM_NS_PER_US);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t u8_addr, uint8_t *pu8_dst, size_t len, bool b_nostop){
+    return i2c_read_blocking_until(i2c, u8_addr, pu8_dst, len, b_nostop, SIM_NEVER / SIM_NS_PER_US);
+}
@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+/**
+ * MCP4725 12-bit DAC. The write commands, in the first two bits of the
+ * first byte:
+ *   00   fast write, 2 bytes: 0 0 PD1 PD0 D11-D8, D7-D0
+ *   010  write the DAC register, 3 bytes: C2 C1 C0 x x PD1 PD0 x,
+ *        D11-D4, D3-D0 x x x x
+ *   011  the same and the EEPROM too, which is busy for 25 ms after
+ *   1xx  reserved, ignored
+ * Either form may repeat within one transfer, and the output changes on
+ * the acknowledge of each group's last byte. A read returns the status
+ * (RDY/BSY, POR, PD1 PD0), the DAC register and the EEPROM, 5 bytes, and
+ * starts over if the controller keeps reading. With PD1:PD0 not 00 the
+ * output is pulled down to 0 V.
+ *
+ * The part keeps its DAC register across a reset of the Pico, so a
+ * watchdog restart does not lose it.
+ *
+ *   SIM_MCP4725_ADDR  its address (default 0x60, 0x61 with A0 high)
+ *   SIM_MCP4725_VDD   supply and full scale in volts (default 3.3)
+ *   SIM_MCP4725_LOG   file to write "seconds code volts" to at every
+ *                     change of the output, to plot the waveform
+ */
+
+#define SIM_MCP4725_FULL_SCALE      4096u
+#define SIM_MCP4725_EEPROM_NS       (25 * SIM_NS_PER_MS)
+#define SIM_MCP4725_STATUS_RDY      0x80u
+#define SIM_MCP4725_STATUS_POR      0x40u
+
+typedef enum {
+    MCP4725_CMD_NONE,       // next byte starts a command
+    MCP4725_CMD_FAST,
+    MCP4725_CMD_DAC,
+    MCP4725_CMD_EEPROM,
+    MCP4725_CMD_RESERVED
+} mcp4725_cmd_t;
+
+static uint8_t u8_addr = 0x60;
+static double d_vdd = 3.3;
+static FILE *ps_log = NULL;
+
+static uint16_t u16_dac = 0;
+static uint8_t u8_powerDown = 0;
+static uint16_t u16_eeprom = 0;
+static uint8_t u8_eepromPowerDown = 0;
+static uint64_t u64_eepromBusyUntil = 0;    // elapsed ns
+
+static mcp4725_cmd_t e_cmd = MCP4725_CMD_NONE;
+static uint8_t au8_group[3];
+static uint8_t u8_groupLen = 0;
+static uint8_t u8_readIndex = 0;
+
+static uint32_t u32_updates = 0;
+static uint32_t u32_eepromWrites = 0;
+static uint32_t u32_eepromIgnored = 0;
+static uint32_t u32_reserved = 0;
+static uint16_t u16_minCode = UINT16_MAX;
+static uint16_t u16_maxCode = 0;
+static uint64_t u64_firstUpdateNs = 0;
+static uint64_t u64_lastUpdateNs = 0;
+
+static double sim_mcp4725_volts(void){
+    return u8_powerDown != 0 ? 0.0 : d_vdd * u16_dac / SIM_MCP4725_FULL_SCALE;
+}
+
+static bool sim_mcp4725_eeprom_busy(void){
+    return sim_elapsed_ns() < u64_eepromBusyUntil;
+}
+
+static void sim_mcp4725_set(uint16_t u16_code, uint8_t u8_pd){
+    bool b_changed = u16_code != u16_dac || u8_pd != u8_powerDown;
+    u16_dac = u16_code;
+    u8_powerDown = u8_pd;
+    if(u32_updates++ == 0){
+        u64_firstUpdateNs = sim_elapsed_ns();
+    }
+    u64_lastUpdateNs = sim_elapsed_ns();
+    if(u8_pd == 0){
+        u16_minCode = MIN(u16_minCode, u16_code);
+        u16_maxCode = MAX(u16_maxCode, u16_code);
+    }
+    if(b_changed && ps_log != NULL){
+        fprintf(ps_log, "%.9f %u %.4f\n", (double)sim_elapsed_ns() / SIM_NS_PER_S, u16_dac, sim_mcp4725_volts());
+    }
+    sim_trace("mcp4725 %u pd %u", u16_code, u8_pd);
+}
+
+static uint8_t sim_mcp4725_init(void){
+    u8_addr = (uint8_t)strtoul(sim_env("SIM_MCP4725_ADDR", "0x60"), NULL, 0);
+    d_vdd = sim_env_double("SIM_MCP4725_VDD", 3.3);
+    const char *pc_log = sim_env("SIM_MCP4725_LOG", NULL);
+    if(pc_log != NULL){
+        //appended to, so a watchdog restart carries on the same file
+        ps_log = fopen(pc_log, sim_boot_reason() != NULL ? "a" : "w");
+        if(ps_log == NULL){
+            sim_log("cannot write %s", pc_log);
+        }
+    }
+    //power on loads the DAC register from the EEPROM, a restart of the Pico leaves it be
+    unsigned u_dac, u_pd, u_eeprom, u_eepromPd;
+    const char *pc_state = sim_env("SIM_MCP4725_STATE", NULL);
+    if(pc_state != NULL && sscanf(pc_state, "%u,%u,%u,%u", &u_dac, &u_pd, &u_eeprom, &u_eepromPd) == 4){
+        u16_dac = (uint16_t)u_dac;
+        u8_powerDown = (uint8_t)u_pd;
+        u16_eeprom = (uint16_t)u_eeprom;
+        u8_eepromPowerDown = (uint8_t)u_eepromPd;
+    }else{
+        u16_dac = u16_eeprom;
+        u8_powerDown = u8_eepromPowerDown;
+    }
+    return u8_addr;
+}
+
+static void sim_mcp4725_start(bool b_read){
+    (void)b_read;
+    e_cmd = MCP4725_CMD_NONE;
+    u8_groupLen = 0;
+    u8_readIndex = 0;
+}
+
+//a whole group has been received
+static void sim_mcp4725_command(void){
+    switch(e_cmd){
+    case MCP4725_CMD_FAST:
+        sim_mcp4725_set((uint16_t)((au8_group[0] & 0x0F) << 8 | au8_group[1]), (au8_group[0] >> 4) & 0x03);
+        break;
+    case MCP4725_CMD_DAC:
+    case MCP4725_CMD_EEPROM: {
+        uint16_t u16_code = (uint16_t)(au8_group[1] << 4 | au8_group[2] >> 4);
+        uint8_t u8_pd = (au8_group[0] >> 1) & 0x03;
+        sim_mcp4725_set(u16_code, u8_pd);
+        if(e_cmd == MCP4725_CMD_EEPROM){
+            //a write while one is in progress is lost
+            if(sim_mcp4725_eeprom_busy()){
+                u32_eepromIgnored++;
+            }else{
+                u16_eeprom = u16_code;
+                u8_eepromPowerDown = u8_pd;
+                u64_eepromBusyUntil = sim_elapsed_ns() + SIM_MCP4725_EEPROM_NS;
+                u32_eepromWrites++;
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    e_cmd = MCP4725_CMD_NONE;
+    u8_groupLen = 0;
+}
+
+static bool sim_mcp4725_write(uint8_t u8_data){
+    if(e_cmd == MCP4725_CMD_NONE){
+        if((u8_data & 0xC0) == 0x00){
+            e_cmd = MCP4725_CMD_FAST;
+        }else if((u8_data & 0xE0) == 0x40){
+            e_cmd = MCP4725_CMD_DAC;
+        }else if((u8_data & 0xE0) == 0x60){
+            e_cmd = MCP4725_CMD_EEPROM;
+        }else{
+            e_cmd = MCP4725_CMD_RESERVED;
+            u32_reserved++;
+        }
+    }
+    //a reserved command takes no data, every byte after it is another command byte
+    if(e_cmd == MCP4725_CMD_RESERVED){
+        e_cmd = MCP4725_CMD_NONE;
+        return true;
+    }
+    au8_group[u8_groupLen++] = u8_data;
+    if(u8_groupLen == (e_cmd == MCP4725_CMD_FAST ? 2 : 3)){
+        sim_mcp4725_command();
+    }
+    return true;
+}
+
+static uint8_t sim_mcp4725_read(void){
+    uint8_t u8_byte;
+    switch(u8_readIndex){
+    case 0:
+        u8_byte = (uint8_t)((sim_mcp4725_eeprom_busy() ? 0 : SIM_MCP4725_STATUS_RDY) | SIM_MCP4725_STATUS_POR | u8_powerDown << 1);
+        break;
+    case 1:
+        u8_byte = (uint8_t)(u16_dac >> 4);
+        break;
+    case 2:
+        u8_byte = (uint8_t)(u16_dac << 4);
+        break;
+    case 3:
+        u8_byte = (uint8_t)(u8_eepromPowerDown << 5 | u16_eeprom >> 8);
+        break;
+    default:
+        u8_byte = (uint8_t)u16_eeprom;
+        break;
+    }
+    u8_readIndex = (uint8_t)((u8_readIndex + 1) % 5);
+    return u8_byte;
+}
+
+static void sim_mcp4725_stop(void){
+    //a command cut short does nothing
+    e_cmd = MCP4725_CMD_NONE;
+    u8_groupLen = 0;
+}
+
+static void sim_mcp4725_report(FILE *ps_file){
+    if(u32_updates == 0){
+        return;
+    }
+    double d_span = (double)(u64_lastUpdateNs - u64_firstUpdateNs) / SIM_NS_PER_S;
+    fprintf(ps_file, "sim: mcp4725 %lu updates (%.1f/s), ", (unsigned long)u32_updates,
+            d_span > 0 ? (u32_updates - 1) / d_span : 0.0);
+    //the range only counts codes written with the output on
+    if(u16_minCode != UINT16_MAX){
+        fprintf(ps_file, "code %u..%u, ", u16_minCode, u16_maxCode);
+    }
+    fprintf(ps_file, "now %u (%.3f V)%s\n", u16_dac, sim_mcp4725_volts(), u8_powerDown != 0 ? ", powered down" : "");
+    if(u32_eepromWrites != 0 || u32_eepromIgnored != 0 || u32_reserved != 0){
+        fprintf(ps_file, "sim: mcp4725 %lu EEPROM writes, %lu lost while busy, %lu reserved commands\n",
+                (unsigned long)u32_eepromWrites, (unsigned long)u32_eepromIgnored, (unsigned long)u32_reserved);
+    }
+}
+
+static void sim_mcp4725_save(void){
+    char ac_state[48];
+    snprintf(ac_state, sizeof(ac_state), "%u,%u,%u,%u", u16_dac, u8_powerDown, u16_eeprom, u8_eepromPowerDown);
+    setenv("SIM_MCP4725_STATE", ac_state, 1);
+    if(ps_log != NULL){
+        fclose(ps_log);
+    }
+}
+
+const sim_i2c_target_t sim_mcp4725_target = {
+    .pc_name = "mcp4725",
+    //a high speed mode part, the Pico's 1 MHz Fast-mode Plus is well inside what it can clock
+    .u_maxBaud = 3400000,
+    .pf_init = sim_mcp4725_init,
+    .pf_start = sim_mcp4725_start,
+    .pf_write = sim_mcp4725_write,
+    .pf_read = sim_mcp4725_read,
+    .pf_stop = sim_mcp4725_stop,
+    .pf_report = sim_mcp4725_report,
+    .pf_save = sim_mcp4725_save,
+};
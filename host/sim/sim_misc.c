@@ -0,0 +1,301 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+
+/*****************************************************************
+ * hardware/clocks.h, the Pico 2 defaults
+ *****************************************************************/
+uint32_t clock_get_hz(enum clock_index clk_index){
+    switch(clk_index){
+    case clk_sys:
+    case clk_peri:
+    case clk_hstx:
+        return SYS_CLK_HZ;
+    case clk_usb:
+    case clk_adc:
+        return USB_CLK_HZ;
+    case clk_ref:
+        return XOSC_HZ;
+    default:
+        return 0;
+    }
+}
+
+bool set_sys_clock_khz(uint32_t u32_freqKhz, bool b_required){
+    if(u32_freqKhz * 1000 != SYS_CLK_HZ){
+        if(b_required){
+            panic("the simulator only runs clk_sys at %u Hz", SYS_CLK_HZ);
+        }
+        return false;
+    }
+    return true;
+}
+
+/*****************************************************************
+ * hardware/pwm.h, registers only
+ *****************************************************************/
+pwm_hw_t sim_pwm_hw;
+
+pwm_config pwm_get_default_config(void){
+    pwm_config s_config = {0, 1u << PWM_CH0_DIV_INT_LSB, 0xffff};
+    return s_config;
+}
+
+void pwm_config_set_phase_correct(pwm_config *ps_config, bool b_phaseCorrect){
+    ps_config->csr = (ps_config->csr & ~PWM_CH0_CSR_PH_CORRECT_BITS) | (b_phaseCorrect ? PWM_CH0_CSR_PH_CORRECT_BITS : 0);
+}
+
+void pwm_config_set_clkdiv(pwm_config *ps_config, float f_div){
+    ps_config->div = (uint32_t)(f_div * (float)(1u << PWM_CH0_DIV_INT_LSB));
+}
+
+void pwm_config_set_clkdiv_int_frac(pwm_config *ps_config, uint8_t u8_integer, uint8_t u8_fract){
+    ps_config->div = ((uint32_t)u8_integer << PWM_CH0_DIV_INT_LSB) | ((uint32_t)u8_fract << PWM_CH0_DIV_FRAC_LSB);
+}
+
+void pwm_config_set_clkdiv_int(pwm_config *ps_config, uint u_div){
+    pwm_config_set_clkdiv_int_frac(ps_config, (uint8_t)u_div, 0);
+}
+
+void pwm_config_set_wrap(pwm_config *ps_config, uint16_t u16_wrap){
+    ps_config->top = u16_wrap;
+}
+
+static void sim_pwm_check(uint u_slice){
+    if(u_slice >= NUM_PWM_SLICES){
+        panic("PWM slice %u does not exist", u_slice);
+    }
+}
+
+void pwm_init(uint u_slice, pwm_config *ps_config, bool b_start){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].csr = 0;
+    sim_pwm_hw.slice[u_slice].ctr = 0;
+    sim_pwm_hw.slice[u_slice].cc = 0;
+    sim_pwm_hw.slice[u_slice].top = ps_config->top;
+    sim_pwm_hw.slice[u_slice].div = ps_config->div;
+    sim_pwm_hw.slice[u_slice].csr = ps_config->csr | (b_start ? PWM_CH0_CSR_EN_BITS : 0);
+    sim_hal_call();
+}
+
+void pwm_set_wrap(uint u_slice, uint16_t u16_wrap){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].top = u16_wrap;
+    sim_hal_call();
+}
+
+void pwm_set_chan_level(uint u_slice, uint u_chan, uint16_t u16_level){
+    sim_pwm_check(u_slice);
+    uint32_t u32_shift = u_chan ? PWM_CH0_CC_B_LSB : PWM_CH0_CC_A_LSB;
+    sim_pwm_hw.slice[u_slice].cc = (sim_pwm_hw.slice[u_slice].cc & ~(0xffffu << u32_shift)) | ((uint32_t)u16_level << u32_shift);
+    sim_hal_call();
+}
+
+void pwm_set_both_levels(uint u_slice, uint16_t u16_levelA, uint16_t u16_levelB){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].cc = ((uint32_t)u16_levelB << PWM_CH0_CC_B_LSB) | u16_levelA;
+    sim_hal_call();
+}
+
+void pwm_set_gpio_level(uint u_gpio, uint16_t u16_level){
+    pwm_set_chan_level(pwm_gpio_to_slice_num(u_gpio), pwm_gpio_to_channel(u_gpio), u16_level);
+}
+
+void pwm_set_counter(uint u_slice, uint16_t u16_count){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].ctr = u16_count;
+    sim_hal_call();
+}
+
+void pwm_set_enabled(uint u_slice, bool b_enabled){
+    sim_pwm_check(u_slice);
+    if(b_enabled){
+        sim_pwm_hw.slice[u_slice].csr |= PWM_CH0_CSR_EN_BITS;
+    }else{
+        sim_pwm_hw.slice[u_slice].csr &= ~PWM_CH0_CSR_EN_BITS;
+    }
+    sim_hal_call();
+}
+
+void pwm_set_mask_enabled(uint32_t u32_mask){
+    sim_pwm_hw.en = u32_mask;
+    sim_hal_call();
+}
+
+void pwm_set_clkdiv(uint u_slice, float f_div){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].div = (uint32_t)(f_div * (float)(1u << PWM_CH0_DIV_INT_LSB));
+    sim_hal_call();
+}
+
+void pwm_set_clkdiv_int_frac(uint u_slice, uint8_t u8_integer, uint8_t u8_fract){
+    sim_pwm_check(u_slice);
+    sim_pwm_hw.slice[u_slice].div = ((uint32_t)u8_integer << PWM_CH0_DIV_INT_LSB) | u8_fract;
+    sim_hal_call();
+}
+
+void pwm_set_irq_enabled(uint u_slice, bool b_enabled){
+    sim_pwm_check(u_slice);
+    if(b_enabled){
+        sim_pwm_hw.inte |= 1u << u_slice;
+    }else{
+        sim_pwm_hw.inte &= ~(1u << u_slice);
+    }
+}
+
+void pwm_clear_irq(uint u_slice){
+    sim_pwm_hw.intr &= ~(1u << u_slice);
+}
+
+//DREQ_PWM_WRAP0 on the RP2350
+uint pwm_get_dreq(uint u_slice){
+    return 32 + u_slice;
+}
+
+/*****************************************************************
+ * hardware/dma.h, channels are claimed and configured, nothing moves
+ *****************************************************************/
+#define SIM_DMA_CTRL_EN_BITS        0x00000001u
+#define SIM_DMA_CTRL_SIZE_LSB       2
+#define SIM_DMA_CTRL_INCR_READ_BITS 0x00000010u
+#define SIM_DMA_CTRL_INCR_WRITE_BITS 0x00000040u
+#define SIM_DMA_CTRL_RING_SIZE_LSB  8
+#define SIM_DMA_CTRL_RING_SEL_BITS  0x00001000u
+#define SIM_DMA_CTRL_CHAIN_TO_LSB   13
+#define SIM_DMA_CTRL_CHAIN_TO_BITS  0x0001e000u
+#define SIM_DMA_CTRL_TREQ_SEL_LSB   17
+#define SIM_DMA_CTRL_TREQ_SEL_BITS  0x007e0000u
+#define SIM_DMA_TREQ_PERMANENT      0x3fu
+
+dma_hw_t sim_dma_hw;
+static uint16_t u16_dmaClaimed = 0;
+
+static void sim_dma_check(uint u_channel){
+    if(u_channel >= NUM_DMA_CHANNELS){
+        panic("DMA channel %u does not exist", u_channel);
+    }
+}
+
+int dma_claim_unused_channel(bool b_required){
+    for(uint u_channel = 0; u_channel < NUM_DMA_CHANNELS; u_channel++){
+        if(!(u16_dmaClaimed & (1u << u_channel))){
+            u16_dmaClaimed |= (uint16_t)(1u << u_channel);
+            return (int)u_channel;
+        }
+    }
+    if(b_required){
+        panic("no DMA channels available");
+    }
+    return -1;
+}
+
+void dma_channel_claim(uint u_channel){
+    sim_dma_check(u_channel);
+    if(u16_dmaClaimed & (1u << u_channel)){
+        panic("DMA channel %u already claimed", u_channel);
+    }
+    u16_dmaClaimed |= (uint16_t)(1u << u_channel);
+}
+
+void dma_channel_unclaim(uint u_channel){
+    sim_dma_check(u_channel);
+    u16_dmaClaimed &= (uint16_t)~(1u << u_channel);
+}
+
+bool dma_channel_is_claimed(uint u_channel){
+    sim_dma_check(u_channel);
+    return (u16_dmaClaimed & (1u << u_channel)) != 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint u_channel){
+    dma_channel_config s_config = {0};
+    channel_config_set_read_increment(&s_config, true);
+    channel_config_set_write_increment(&s_config, false);
+    channel_config_set_dreq(&s_config, SIM_DMA_TREQ_PERMANENT);
+    channel_config_set_chain_to(&s_config, u_channel);
+    channel_config_set_transfer_data_size(&s_config, DMA_SIZE_32);
+    channel_config_set_ring(&s_config, false, 0);
+    channel_config_set_enable(&s_config, true);
+    return s_config;
+}
+
+static void sim_dma_set(dma_channel_config *ps_config, uint32_t u32_bits, uint32_t u32_value){
+    ps_config->ctrl = (ps_config->ctrl & ~u32_bits) | (u32_value & u32_bits);
+}
+
+void channel_config_set_read_increment(dma_channel_config *ps_config, bool b_incr){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_INCR_READ_BITS, b_incr ? SIM_DMA_CTRL_INCR_READ_BITS : 0);
+}
+
+void channel_config_set_write_increment(dma_channel_config *ps_config, bool b_incr){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_INCR_WRITE_BITS, b_incr ? SIM_DMA_CTRL_INCR_WRITE_BITS : 0);
+}
+
+void channel_config_set_dreq(dma_channel_config *ps_config, uint u_dreq){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_TREQ_SEL_BITS, u_dreq << SIM_DMA_CTRL_TREQ_SEL_LSB);
+}
+
+void channel_config_set_chain_to(dma_channel_config *ps_config, uint u_chainTo){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_CHAIN_TO_BITS, u_chainTo << SIM_DMA_CTRL_CHAIN_TO_LSB);
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *ps_config, enum dma_channel_transfer_size e_size){
+    sim_dma_set(ps_config, 3u << SIM_DMA_CTRL_SIZE_LSB, (uint32_t)e_size << SIM_DMA_CTRL_SIZE_LSB);
+}
+
+void channel_config_set_ring(dma_channel_config *ps_config, bool b_write, uint u_sizeBits){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_RING_SEL_BITS | (0xfu << SIM_DMA_CTRL_RING_SIZE_LSB),
+                (b_write ? SIM_DMA_CTRL_RING_SEL_BITS : 0) | (u_sizeBits << SIM_DMA_CTRL_RING_SIZE_LSB));
+}
+
+void channel_config_set_enable(dma_channel_config *ps_config, bool b_enable){
+    sim_dma_set(ps_config, SIM_DMA_CTRL_EN_BITS, b_enable ? SIM_DMA_CTRL_EN_BITS : 0);
+}
+
+void dma_channel_configure(uint u_channel, const dma_channel_config *ps_config, volatile void *pv_writeAddr,
+                           const volatile void *pv_readAddr, uint u_transferCount, bool b_trigger){
+    sim_dma_check(u_channel);
+    dma_channel_hw_t *ps_ch = &sim_dma_hw.ch[u_channel];
+    //the registers are 32 bits on the chip, only the low half of a host pointer fits
+    ps_ch->read_addr = (uint32_t)(uintptr_t)pv_readAddr;
+    ps_ch->write_addr = (uint32_t)(uintptr_t)pv_writeAddr;
+    ps_ch->transfer_count = u_transferCount;
+    ps_ch->al1_ctrl = ps_config->ctrl;
+    (void)b_trigger;
+    sim_hal_call();
+}
+
+void dma_channel_start(uint u_channel){
+    sim_dma_check(u_channel);
+    sim_hal_call();
+}
+
+void dma_channel_abort(uint u_channel){
+    sim_dma_check(u_channel);
+    sim_hal_call();
+}
+
+bool dma_channel_is_busy(uint u_channel){
+    sim_dma_check(u_channel);
+    return false;
+}
+
+void dma_channel_wait_for_finish_blocking(uint u_channel){
+    sim_dma_check(u_channel);
+}
+
+void dma_channel_set_irq0_enabled(uint u_channel, bool b_enabled){
+    sim_dma_check(u_channel);
+    if(b_enabled){
+        sim_dma_hw.inte0 |= 1u << u_channel;
+    }else{
+        sim_dma_hw.inte0 &= ~(1u << u_channel);
+    }
+}
+
+void dma_channel_acknowledge_irq0(uint u_channel){
+    sim_dma_check(u_channel);
+    sim_dma_hw.ints0 &= ~(1u << u_channel);
+}
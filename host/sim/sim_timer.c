@@ -0,0 +1,328 @@
+#include <string.h>
+#include "sim.h"
+#include "pico/time.h"
+#include "hardware/irq.h"
+#include "hardware/watchdog.h"
+
+/*****************************************************************
+ * Timer: a 1 MHz count and four alarms on TIMER0_IRQ_0..3
+ *****************************************************************/
+timer_hw_t sim_timer_hw;
+
+typedef struct {
+    bool b_claimed;
+    bool b_armed;
+    uint64_t u64_targetUs;
+    hardware_alarm_callback_t pf_callback;
+    uint32_t u32_fired;
+    uint64_t u64_lateNsTotal;
+    uint64_t u64_lateNsMax;
+} sim_alarm_t;
+
+static sim_alarm_t as_alarms[NUM_ALARMS];
+
+static uint64_t sim_timer_us(void){
+    return sim_now_ns() / SIM_NS_PER_US;
+}
+
+static void sim_timer_init(void){
+    memset(&sim_timer_hw, 0, sizeof(sim_timer_hw));
+    memset(as_alarms, 0, sizeof(as_alarms));
+}
+
+static uint64_t sim_timer_next(void){
+    uint64_t u64_next = SIM_NEVER;
+    for(uint u_alarm = 0; u_alarm < NUM_ALARMS; u_alarm++){
+        if(as_alarms[u_alarm].b_armed && as_alarms[u_alarm].u64_targetUs * SIM_NS_PER_US < u64_next){
+            u64_next = as_alarms[u_alarm].u64_targetUs * SIM_NS_PER_US;
+        }
+    }
+    return u64_next;
+}
+
+static void sim_timer_update(uint64_t u64_nowNs){
+    uint64_t u64_us = u64_nowNs / SIM_NS_PER_US;
+    SIM_REG(sim_timer_hw.timerawl) = (uint32_t)u64_us;
+    SIM_REG(sim_timer_hw.timerawh) = (uint32_t)(u64_us >> 32);
+    SIM_REG(sim_timer_hw.timelr) = (uint32_t)u64_us;
+    SIM_REG(sim_timer_hw.timehr) = (uint32_t)(u64_us >> 32);
+    for(uint u_alarm = 0; u_alarm < NUM_ALARMS; u_alarm++){
+        sim_alarm_t *ps_alarm = &as_alarms[u_alarm];
+        if(ps_alarm->b_armed && u64_us >= ps_alarm->u64_targetUs){
+            //the alarm disarms itself and raises its interrupt
+            ps_alarm->b_armed = false;
+            sim_timer_hw.armed &= ~(1u << u_alarm);
+            sim_timer_hw.intr |= 1u << u_alarm;
+        }
+        sim_irq_set_line(TIMER0_IRQ_0 + u_alarm, (sim_timer_hw.intr & sim_timer_hw.inte & (1u << u_alarm)) != 0);
+    }
+    SIM_REG(sim_timer_hw.ints) = sim_timer_hw.intr & sim_timer_hw.inte;
+}
+
+static void sim_timer_report(FILE *ps_file){
+    for(uint u_alarm = 0; u_alarm < NUM_ALARMS; u_alarm++){
+        sim_alarm_t *ps_alarm = &as_alarms[u_alarm];
+        if(ps_alarm->u32_fired != 0){
+            fprintf(ps_file, "sim: alarm %u fired %lu times, ISR entry late by %.3f us mean, %.3f us max\n", u_alarm,
+                    (unsigned long)ps_alarm->u32_fired,
+                    (double)ps_alarm->u64_lateNsTotal / SIM_NS_PER_US / ps_alarm->u32_fired,
+                    (double)ps_alarm->u64_lateNsMax / SIM_NS_PER_US);
+        }
+    }
+}
+
+const sim_device_t sim_timer_device = {
+    "timer", sim_timer_init, sim_timer_next, sim_timer_update, sim_timer_report
+};
+
+//the SDK's handler: clear the interrupt, then call the alarm's callback
+static void sim_alarm_irq(uint u_alarm){
+    sim_alarm_t *ps_alarm = &as_alarms[u_alarm];
+    uint64_t u64_late = sim_now_ns() - ps_alarm->u64_targetUs * SIM_NS_PER_US;
+    sim_timer_hw.intr &= ~(1u << u_alarm);
+    sim_irq_set_line(TIMER0_IRQ_0 + u_alarm, false);
+    ps_alarm->u32_fired++;
+    ps_alarm->u64_lateNsTotal += u64_late;
+    if(u64_late > ps_alarm->u64_lateNsMax){
+        ps_alarm->u64_lateNsMax = u64_late;
+    }
+    if(ps_alarm->pf_callback != NULL){
+        ps_alarm->pf_callback(u_alarm);
+    }
+}
+
+static void sim_alarm_irq_0(void){ sim_alarm_irq(0); }
+static void sim_alarm_irq_1(void){ sim_alarm_irq(1); }
+static void sim_alarm_irq_2(void){ sim_alarm_irq(2); }
+static void sim_alarm_irq_3(void){ sim_alarm_irq(3); }
+
+static const irq_handler_t apf_alarmIrqs[NUM_ALARMS] = {
+    sim_alarm_irq_0, sim_alarm_irq_1, sim_alarm_irq_2, sim_alarm_irq_3
+};
+
+static void sim_alarm_check(uint u_alarmNum){
+    if(u_alarmNum >= NUM_ALARMS){
+        panic("alarm %u does not exist", u_alarmNum);
+    }
+}
+
+uint32_t time_us_32(void){
+    sim_hal_call();
+    return (uint32_t)sim_timer_us();
+}
+
+uint64_t time_us_64(void){
+    sim_hal_call();
+    return sim_timer_us();
+}
+
+void busy_wait_us_32(uint32_t u32_delayUs){
+    sim_advance_ns((uint64_t)u32_delayUs * SIM_NS_PER_US);
+}
+
+void busy_wait_us(uint64_t u64_delayUs){
+    sim_advance_ns(u64_delayUs * SIM_NS_PER_US);
+}
+
+void busy_wait_ms(uint32_t u32_delayMs){
+    sim_advance_ns((uint64_t)u32_delayMs * SIM_NS_PER_MS);
+}
+
+void busy_wait_until(absolute_time_t t){
+    sim_wait_until_ns(t * SIM_NS_PER_US);
+}
+
+void hardware_alarm_claim(uint u_alarmNum){
+    sim_alarm_check(u_alarmNum);
+    if(as_alarms[u_alarmNum].b_claimed){
+        panic("hardware alarm %u already claimed", u_alarmNum);
+    }
+    as_alarms[u_alarmNum].b_claimed = true;
+}
+
+int hardware_alarm_claim_unused(bool b_required){
+    for(uint u_alarm = 0; u_alarm < NUM_ALARMS; u_alarm++){
+        if(!as_alarms[u_alarm].b_claimed){
+            as_alarms[u_alarm].b_claimed = true;
+            return (int)u_alarm;
+        }
+    }
+    if(b_required){
+        panic("no hardware alarms available");
+    }
+    return -1;
+}
+
+void hardware_alarm_unclaim(uint u_alarmNum){
+    sim_alarm_check(u_alarmNum);
+    as_alarms[u_alarmNum].b_claimed = false;
+}
+
+bool hardware_alarm_is_claimed(uint u_alarmNum){
+    sim_alarm_check(u_alarmNum);
+    return as_alarms[u_alarmNum].b_claimed;
+}
+
+void hardware_alarm_set_callback(uint u_alarmNum, hardware_alarm_callback_t pf_callback){
+    sim_alarm_check(u_alarmNum);
+    uint u_irq = TIMER0_IRQ_0 + u_alarmNum;
+    if(pf_callback != NULL){
+        as_alarms[u_alarmNum].pf_callback = pf_callback;
+        irq_set_exclusive_handler(u_irq, apf_alarmIrqs[u_alarmNum]);
+        sim_timer_hw.inte |= 1u << u_alarmNum;
+        irq_set_enabled(u_irq, true);
+    }else{
+        sim_timer_hw.inte &= ~(1u << u_alarmNum);
+        irq_set_enabled(u_irq, false);
+        irq_remove_handler(u_irq, apf_alarmIrqs[u_alarmNum]);
+        as_alarms[u_alarmNum].pf_callback = NULL;
+    }
+}
+
+bool hardware_alarm_set_target(uint u_alarmNum, absolute_time_t t){
+    sim_alarm_check(u_alarmNum);
+    sim_hal_call();
+    sim_alarm_t *ps_alarm = &as_alarms[u_alarmNum];
+    if(t <= sim_timer_us()){
+        ps_alarm->b_armed = false;
+        sim_timer_hw.armed &= ~(1u << u_alarmNum);
+        return true;
+    }
+    ps_alarm->u64_targetUs = t;
+    ps_alarm->b_armed = true;
+    sim_timer_hw.alarm[u_alarmNum] = (uint32_t)t;
+    sim_timer_hw.armed |= 1u << u_alarmNum;
+    return false;
+}
+
+void hardware_alarm_cancel(uint u_alarmNum){
+    sim_alarm_check(u_alarmNum);
+    as_alarms[u_alarmNum].b_armed = false;
+    sim_timer_hw.armed &= ~(1u << u_alarmNum);
+    sim_hal_call();
+}
+
+void hardware_alarm_force_irq(uint u_alarmNum){
+    sim_alarm_check(u_alarmNum);
+    sim_timer_hw.intr |= 1u << u_alarmNum;
+    sim_sync();
+    sim_hal_call();
+}
+
+/*****************************************************************
+ * pico/time.h
+ *****************************************************************/
+absolute_time_t get_absolute_time(void){
+    return time_us_64();
+}
+
+absolute_time_t make_timeout_time_us(uint64_t u64_us){
+    return time_us_64() + u64_us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t u32_ms){
+    return time_us_64() + (uint64_t)u32_ms * 1000;
+}
+
+bool time_reached(absolute_time_t t){
+    return time_us_64() >= t;
+}
+
+//the SDK sleeps in __wfe, here that is skipping ahead to the wake up time
+void sleep_until(absolute_time_t t){
+    sim_wait_until_ns(t * SIM_NS_PER_US);
+}
+
+void sleep_us(uint64_t u64_us){
+    sim_advance_ns(u64_us * SIM_NS_PER_US);
+}
+
+void sleep_ms(uint32_t u32_ms){
+    sim_advance_ns((uint64_t)u32_ms * SIM_NS_PER_MS);
+}
+
+/*****************************************************************
+ * Watchdog: a restart of the whole program when it runs out
+ *****************************************************************/
+static bool b_watchdogOn = false;
+static uint64_t u64_watchdogLoadNs = 0;
+static uint64_t u64_watchdogDueNs = SIM_NEVER;
+static uint64_t u64_watchdogClosestNs = SIM_NEVER;
+static uint32_t u32_watchdogFeeds = 0;
+
+static void sim_watchdog_init(void){
+    b_watchdogOn = false;
+    u64_watchdogDueNs = SIM_NEVER;
+}
+
+static uint64_t sim_watchdog_next(void){
+    return u64_watchdogDueNs;
+}
+
+static void sim_watchdog_update(uint64_t u64_nowNs){
+    if(b_watchdogOn && u64_nowNs >= u64_watchdogDueNs){
+        sim_reboot("watchdog");
+    }
+}
+
+static void sim_watchdog_report(FILE *ps_file){
+    if(u32_watchdogFeeds != 0){
+        fprintf(ps_file, "sim: watchdog fed %lu times, closest call %.3f ms before it ran out\n",
+                (unsigned long)u32_watchdogFeeds, (double)u64_watchdogClosestNs / SIM_NS_PER_MS);
+    }
+}
+
+const sim_device_t sim_watchdog_device = {
+    "watchdog", sim_watchdog_init, sim_watchdog_next, sim_watchdog_update, sim_watchdog_report
+};
+
+void watchdog_enable(uint32_t u32_delayMs, bool b_pauseOnDebug){
+    (void)b_pauseOnDebug;
+    sim_hal_call();
+    u64_watchdogLoadNs = (uint64_t)u32_delayMs * SIM_NS_PER_MS;
+    u64_watchdogDueNs = sim_now_ns() + u64_watchdogLoadNs;
+    b_watchdogOn = true;
+}
+
+void watchdog_disable(void){
+    b_watchdogOn = false;
+    u64_watchdogDueNs = SIM_NEVER;
+    sim_hal_call();
+}
+
+void watchdog_update(void){
+    sim_hal_call();
+    if(!b_watchdogOn){
+        return;
+    }
+    uint64_t u64_left = u64_watchdogDueNs - sim_now_ns();
+    if(u64_left < u64_watchdogClosestNs){
+        u64_watchdogClosestNs = u64_left;
+    }
+    u32_watchdogFeeds++;
+    u64_watchdogDueNs = sim_now_ns() + u64_watchdogLoadNs;
+}
+
+uint32_t watchdog_get_time_remaining_ms(void){
+    sim_hal_call();
+    if(!b_watchdogOn){
+        return 0;
+    }
+    return (uint32_t)((u64_watchdogDueNs - sim_now_ns()) / SIM_NS_PER_MS);
+}
+
+bool watchdog_caused_reboot(void){
+    const char *pc_reason = sim_boot_reason();
+    return pc_reason != NULL && strcmp(pc_reason, "watchdog") == 0;
+}
+
+bool watchdog_enable_caused_reboot(void){
+    return watchdog_caused_reboot();
+}
+
+void watchdog_reboot(uint32_t u32_pc, uint32_t u32_sp, uint32_t u32_delayMs){
+    (void)u32_pc;
+    (void)u32_sp;
+    sim_advance_ns((uint64_t)u32_delayMs * SIM_NS_PER_MS);
+    sim_reboot("watchdog");
+}
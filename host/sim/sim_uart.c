@@ -0,0 +1,631 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "sim.h"
+#include "pico/stdio.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+
+/**
+ * uart0 on the host, picked with SIM_UART:
+ *   pty     a pseudo-terminal, its name is logged at start (default)
+ *   stdio   the simulator's own stdin and stdout
+ *   none    not connected, only SIM_INPUT reaches the app
+ * SIM_INPUT is a script of text typed at given times, "ms:text|...", with
+ * \r, \n, \e, \\ and \| escapes. Host input is looked at once per
+ * millisecond of simulated time and then arrives at the line rate.
+ */
+
+#define SIM_UART_FIFO_DEPTH     32
+//the thresholds uart_set_irqs_enabled() programs, 1/8 full and 1/8 empty
+#define SIM_UART_RX_TRIGGER     4
+#define SIM_UART_TX_TRIGGER     4
+//the receive timeout, in bit times
+#define SIM_UART_RT_BITS        32
+//what the data register holds between writes from the app
+#define SIM_UART_DR_IDLE        0xFFFFFFFFu
+#define SIM_UART_HOST_POLL_NS   SIM_NS_PER_MS
+#define SIM_UART_HOST_QUEUE     256
+#define SIM_UART_CLK_PERI_HZ    150000000u
+
+#define SIM_UART_RIS_RX         UART_UARTIMSC_RXIM_BITS
+#define SIM_UART_RIS_TX         UART_UARTIMSC_TXIM_BITS
+#define SIM_UART_RIS_RT         UART_UARTIMSC_RTIM_BITS
+#define SIM_UART_RIS_OE         UART_UARTIMSC_OEIM_BITS
+
+typedef enum {
+    SIM_UART_NONE,
+    SIM_UART_PTY,
+    SIM_UART_STDIO
+} sim_uart_mode_t;
+
+typedef struct {
+    uint8_t au8_data[SIM_UART_FIFO_DEPTH];
+    uint8_t u8_head;
+    uint8_t u8_level;
+} sim_uart_fifo_t;
+
+typedef struct {
+    uart_hw_t *ps_hw;
+    uint u_irq;
+    sim_uart_fifo_t s_tx;
+    sim_uart_fifo_t s_rx;
+    bool b_txShifting;
+    uint64_t u64_txDoneNs;
+    uint8_t u8_txShift;
+    uint64_t u64_rxDoneNs;      // SIM_NEVER when nothing is arriving
+    uint64_t u64_lastRxNs;
+    bool b_rtCleared;
+    uint32_t u32_ris;
+    //totals for the report
+    uint32_t u32_txBytes;
+    uint32_t u32_rxBytes;
+    uint32_t u32_overruns;
+    uint8_t u8_rxMaxLevel;
+} sim_uart_t;
+
+uart_hw_t sim_uart_hw[2];
+static sim_uart_t as_uarts[2];
+static bool b_stdioReady = false;
+
+static sim_uart_mode_t e_hostMode = SIM_UART_NONE;
+static int i_hostIn = -1;
+static int i_hostOut = -1;
+static uint64_t u64_nextPollNs = 0;
+static uint8_t au8_hostQueue[SIM_UART_HOST_QUEUE];
+static uint16_t u16_hostHead = 0;
+static uint16_t u16_hostLevel = 0;
+static uint32_t u32_hostDropped = 0;
+static sim_script_item_t as_inputScript[SIM_SCRIPT_MAX];
+static uint8_t u8_inputLen = 0;
+static uint8_t u8_inputNext = 0;
+
+static sim_uart_t *sim_uart_get(uart_inst_t *uart){
+    return &as_uarts[UART_NUM(uart)];
+}
+
+static bool sim_uart_fifo_on(const sim_uart_t *ps_uart){
+    return (ps_uart->ps_hw->lcr_h & UART_UARTLCR_H_FEN_BITS) != 0;
+}
+
+static uint8_t sim_uart_depth(const sim_uart_t *ps_uart){
+    return sim_uart_fifo_on(ps_uart) ? SIM_UART_FIFO_DEPTH : 1;
+}
+
+static bool sim_fifo_push(sim_uart_fifo_t *ps_fifo, uint8_t u8_depth, uint8_t u8_data){
+    if(ps_fifo->u8_level >= u8_depth){
+        return false;
+    }
+    ps_fifo->au8_data[(ps_fifo->u8_head + ps_fifo->u8_level) % SIM_UART_FIFO_DEPTH] = u8_data;
+    ps_fifo->u8_level++;
+    return true;
+}
+
+static uint8_t sim_fifo_pop(sim_uart_fifo_t *ps_fifo){
+    if(ps_fifo->u8_level == 0){
+        return 0;
+    }
+    uint8_t u8_data = ps_fifo->au8_data[ps_fifo->u8_head];
+    ps_fifo->u8_head = (ps_fifo->u8_head + 1) % SIM_UART_FIFO_DEPTH;
+    ps_fifo->u8_level--;
+    return u8_data;
+}
+
+/*****************************************************************
+ * Line timing, from the PL011 divisors and LCR_H
+ *****************************************************************/
+static uint32_t sim_uart_baud(const sim_uart_t *ps_uart){
+    uint32_t u32_div = ps_uart->ps_hw->ibrd * 64 + ps_uart->ps_hw->fbrd;
+    return u32_div == 0 ? 0 : (uint32_t)((4ull * SIM_UART_CLK_PERI_HZ) / u32_div);
+}
+
+static uint64_t sim_uart_bit_ns(const sim_uart_t *ps_uart){
+    uint32_t u32_baud = sim_uart_baud(ps_uart);
+    return u32_baud == 0 ? SIM_NS_PER_MS : SIM_NS_PER_S / u32_baud;
+}
+
+//start + data + parity + stop bits
+static uint64_t sim_uart_frame_ns(const sim_uart_t *ps_uart){
+    uint32_t u32_lcr = ps_uart->ps_hw->lcr_h;
+    uint32_t u32_bits = 1 + (5 + ((u32_lcr >> 5) & 3)) + ((u32_lcr >> 1) & 1) + (((u32_lcr >> 3) & 1) ? 2 : 1);
+    uint32_t u32_baud = sim_uart_baud(ps_uart);
+    return u32_baud == 0 ? SIM_NS_PER_MS : ((uint64_t)u32_bits * SIM_NS_PER_S + u32_baud / 2) / u32_baud;
+}
+
+/*****************************************************************
+ * Host side
+ *****************************************************************/
+static void sim_uart_host_open_pty(void){
+    const char *pc_fds = sim_env("SIM_UART_FD", NULL);
+    int i_slave = -1;
+    if(pc_fds != NULL){
+        //a watchdog restart keeps the same terminal
+        i_hostIn = (int)strtol(pc_fds, NULL, 10);
+        i_hostOut = i_hostIn;
+        return;
+    }
+    i_hostIn = posix_openpt(O_RDWR | O_NOCTTY);
+    if(i_hostIn < 0 || grantpt(i_hostIn) != 0 || unlockpt(i_hostIn) != 0){
+        sim_log("cannot open a pseudo-terminal, uart0 is not connected");
+        e_hostMode = SIM_UART_NONE;
+        return;
+    }
+    fcntl(i_hostIn, F_SETFL, fcntl(i_hostIn, F_GETFL) | O_NONBLOCK);
+    i_hostOut = i_hostIn;
+    //holding the other end open keeps output from failing before a terminal attaches
+    i_slave = open(ptsname(i_hostIn), O_RDWR | O_NOCTTY);
+    if(i_slave >= 0){
+        struct termios s_raw;
+        tcgetattr(i_slave, &s_raw);
+        cfmakeraw(&s_raw);
+        tcsetattr(i_slave, TCSANOW, &s_raw);
+    }
+    char ac_fds[32];
+    snprintf(ac_fds, sizeof(ac_fds), "%d,%d", i_hostIn, i_slave);
+    setenv("SIM_UART_FD", ac_fds, 1);
+    sim_log("uart0 is on %s (e.g. picocom %s)", ptsname(i_hostIn), ptsname(i_hostIn));
+}
+
+static void sim_uart_host_init(void){
+    const char *pc_mode = sim_env("SIM_UART", "pty");
+    if(strcmp(pc_mode, "pty") == 0){
+        e_hostMode = SIM_UART_PTY;
+        sim_uart_host_open_pty();
+    }else if(strcmp(pc_mode, "stdio") == 0){
+        e_hostMode = SIM_UART_STDIO;
+        i_hostIn = STDIN_FILENO;
+        i_hostOut = STDOUT_FILENO;
+    }else{
+        e_hostMode = SIM_UART_NONE;
+    }
+    u8_inputLen = sim_script_parse(sim_env("SIM_INPUT", NULL), as_inputScript, SIM_SCRIPT_MAX);
+    u8_inputNext = 0;
+    //text typed before a restart went to the last boot
+    while(u8_inputNext < u8_inputLen && as_inputScript[u8_inputNext].u64_ns < sim_elapsed_ns()){
+        u8_inputNext++;
+    }
+}
+
+static void sim_uart_host_queue(uint8_t u8_data){
+    if(u16_hostLevel >= SIM_UART_HOST_QUEUE){
+        u32_hostDropped++;
+        return;
+    }
+    au8_hostQueue[(u16_hostHead + u16_hostLevel) % SIM_UART_HOST_QUEUE] = u8_data;
+    u16_hostLevel++;
+}
+
+static void sim_uart_host_poll(void){
+    if(i_hostIn < 0 || u16_hostLevel >= SIM_UART_HOST_QUEUE){
+        return;
+    }
+    struct pollfd s_poll = {i_hostIn, POLLIN, 0};
+    if(poll(&s_poll, 1, 0) <= 0 || !(s_poll.revents & POLLIN)){
+        return;
+    }
+    uint8_t au8_buf[SIM_UART_HOST_QUEUE];
+    ssize_t len = read(i_hostIn, au8_buf, SIM_UART_HOST_QUEUE - u16_hostLevel);
+    if(len == 0 && e_hostMode == SIM_UART_STDIO){
+        //end of stdin, nothing more will come
+        i_hostIn = -1;
+        return;
+    }
+    for(ssize_t i = 0; i < len; i++){
+        sim_uart_host_queue(au8_buf[i]);
+    }
+}
+
+static void sim_uart_host_write(uint8_t u8_data){
+    if(i_hostOut < 0){
+        return;
+    }
+    //a full pty means nobody is reading, the byte is gone as it would be on the wire
+    if(write(i_hostOut, &u8_data, 1) != 1){
+        u32_hostDropped++;
+    }
+}
+
+/*****************************************************************
+ * The model
+ *****************************************************************/
+//flags, raw and masked interrupt status and the IRQ line, from the FIFO levels
+static void sim_uart_refresh(sim_uart_t *ps_uart, uint64_t u64_nowNs){
+    uart_hw_t *ps_hw = ps_uart->ps_hw;
+    uint8_t u8_depth = sim_uart_depth(ps_uart);
+    uint32_t u32_fr = 0;
+
+    u32_fr |= ps_uart->s_tx.u8_level == 0 ? UART_UARTFR_TXFE_BITS : 0;
+    u32_fr |= ps_uart->s_tx.u8_level >= u8_depth ? UART_UARTFR_TXFF_BITS : 0;
+    u32_fr |= ps_uart->s_rx.u8_level == 0 ? UART_UARTFR_RXFE_BITS : 0;
+    u32_fr |= ps_uart->s_rx.u8_level >= u8_depth ? UART_UARTFR_RXFF_BITS : 0;
+    u32_fr |= ps_uart->b_txShifting || ps_uart->s_tx.u8_level != 0 ? UART_UARTFR_BUSY_BITS : 0;
+    SIM_REG(ps_hw->fr) = u32_fr;
+
+    //levels as the PL011 has them with its FIFOs off, which is how the apps run it
+    uint32_t u32_ris = ps_uart->u32_ris & SIM_UART_RIS_OE;
+    if(ps_uart->s_rx.u8_level >= (sim_uart_fifo_on(ps_uart) ? SIM_UART_RX_TRIGGER : 1)){
+        u32_ris |= SIM_UART_RIS_RX;
+    }
+    if(ps_uart->s_tx.u8_level <= (sim_uart_fifo_on(ps_uart) ? SIM_UART_TX_TRIGGER : 0)){
+        u32_ris |= SIM_UART_RIS_TX;
+    }
+    if(ps_uart->s_rx.u8_level != 0 && !ps_uart->b_rtCleared &&
+       u64_nowNs >= ps_uart->u64_lastRxNs + SIM_UART_RT_BITS * sim_uart_bit_ns(ps_uart)){
+        u32_ris |= SIM_UART_RIS_RT;
+    }
+    ps_uart->u32_ris = u32_ris;
+    SIM_REG(ps_hw->ris) = u32_ris;
+    SIM_REG(ps_hw->mis) = u32_ris & ps_hw->imsc;
+    if(ps_uart->s_rx.u8_level > ps_uart->u8_rxMaxLevel){
+        ps_uart->u8_rxMaxLevel = ps_uart->s_rx.u8_level;
+    }
+    sim_irq_set_line(ps_uart->u_irq, (ps_hw->cr & UART_UARTCR_UARTEN_BITS) && (u32_ris & ps_hw->imsc));
+}
+
+static void sim_uart_init(void){
+    memset(sim_uart_hw, 0, sizeof(sim_uart_hw));
+    memset(as_uarts, 0, sizeof(as_uarts));
+    for(uint8_t u8_i = 0; u8_i < 2; u8_i++){
+        as_uarts[u8_i].ps_hw = &sim_uart_hw[u8_i];
+        as_uarts[u8_i].u_irq = UART0_IRQ + u8_i;
+        as_uarts[u8_i].u64_rxDoneNs = SIM_NEVER;
+        sim_uart_hw[u8_i].dr = SIM_UART_DR_IDLE;
+    }
+    sim_uart_host_init();
+    u64_nextPollNs = 0;
+}
+
+static uint64_t sim_uart_next(void){
+    uint64_t u64_next = SIM_NEVER;
+    for(uint8_t u8_i = 0; u8_i < 2; u8_i++){
+        const sim_uart_t *ps_uart = &as_uarts[u8_i];
+        if(ps_uart->b_txShifting){
+            u64_next = MIN(u64_next, ps_uart->u64_txDoneNs);
+        }
+        u64_next = MIN(u64_next, ps_uart->u64_rxDoneNs);
+        if(ps_uart->s_rx.u8_level != 0 && !ps_uart->b_rtCleared){
+            u64_next = MIN(u64_next, ps_uart->u64_lastRxNs + SIM_UART_RT_BITS * sim_uart_bit_ns(ps_uart));
+        }
+    }
+    if(i_hostIn >= 0){
+        u64_next = MIN(u64_next, u64_nextPollNs);
+    }
+    if(u8_inputNext < u8_inputLen){
+        uint64_t u64_bootNs = sim_elapsed_ns() - sim_now_ns();
+        uint64_t u64_at = as_inputScript[u8_inputNext].u64_ns;
+        u64_next = MIN(u64_next, u64_at > u64_bootNs ? u64_at - u64_bootNs : 0);
+    }
+    return u64_next;
+}
+
+static void sim_uart_update_one(sim_uart_t *ps_uart, uint64_t u64_nowNs, bool b_host){
+    uart_hw_t *ps_hw = ps_uart->ps_hw;
+    bool b_enabled = (ps_hw->cr & UART_UARTCR_UARTEN_BITS) != 0;
+
+    //a store to dr by the app since the last call
+    if(ps_hw->dr != SIM_UART_DR_IDLE){
+        if(b_enabled && !sim_fifo_push(&ps_uart->s_tx, sim_uart_depth(ps_uart), (uint8_t)ps_hw->dr)){
+            sim_trace("uart%u tx overflow", ps_uart->u_irq - UART0_IRQ);
+        }
+        ps_hw->dr = SIM_UART_DR_IDLE;
+    }
+    //interrupt clears
+    if(ps_hw->icr != 0){
+        if(ps_hw->icr & SIM_UART_RIS_RT){
+            ps_uart->b_rtCleared = true;
+        }
+        ps_uart->u32_ris &= ~ps_hw->icr;
+        ps_hw->icr = 0;
+    }
+
+    //transmitter
+    while(true){
+        if(ps_uart->b_txShifting && u64_nowNs >= ps_uart->u64_txDoneNs){
+            ps_uart->b_txShifting = false;
+            ps_uart->u32_txBytes++;
+            if(b_host){
+                sim_uart_host_write(ps_uart->u8_txShift);
+            }
+        }
+        if(ps_uart->b_txShifting || ps_uart->s_tx.u8_level == 0 || !b_enabled){
+            break;
+        }
+        //the core steps to u64_txDoneNs, so back to back frames have no gap
+        ps_uart->u8_txShift = sim_fifo_pop(&ps_uart->s_tx);
+        ps_uart->u64_txDoneNs = u64_nowNs + sim_uart_frame_ns(ps_uart);
+        ps_uart->b_txShifting = true;
+    }
+
+    //receiver, fed from the host queue one frame at a time
+    if(b_host){
+        while(ps_uart->u64_rxDoneNs <= u64_nowNs){
+            uint8_t u8_data = au8_hostQueue[u16_hostHead];
+            u16_hostHead = (u16_hostHead + 1) % SIM_UART_HOST_QUEUE;
+            u16_hostLevel--;
+            if(!b_enabled){
+                //typed before the app set the UART up
+                sim_trace("uart%u disabled, lost 0x%02x", ps_uart->u_irq - UART0_IRQ, u8_data);
+            }else if(sim_fifo_push(&ps_uart->s_rx, sim_uart_depth(ps_uart), u8_data)){
+                ps_uart->u32_rxBytes++;
+            }else{
+                ps_uart->u32_overruns++;
+                ps_uart->u32_ris |= SIM_UART_RIS_OE;
+                sim_trace("uart%u rx overrun, lost 0x%02x", ps_uart->u_irq - UART0_IRQ, u8_data);
+            }
+            ps_uart->u64_lastRxNs = ps_uart->u64_rxDoneNs;
+            ps_uart->b_rtCleared = false;
+            ps_uart->u64_rxDoneNs = u16_hostLevel != 0 ? ps_uart->u64_rxDoneNs + sim_uart_frame_ns(ps_uart) : SIM_NEVER;
+        }
+        if(ps_uart->u64_rxDoneNs == SIM_NEVER && u16_hostLevel != 0){
+            ps_uart->u64_rxDoneNs = u64_nowNs + sim_uart_frame_ns(ps_uart);
+        }
+    }
+    sim_uart_refresh(ps_uart, u64_nowNs);
+}
+
+static void sim_uart_update(uint64_t u64_nowNs){
+    while(u8_inputNext < u8_inputLen && sim_uart_next() <= u64_nowNs &&
+          as_inputScript[u8_inputNext].u64_ns <= sim_elapsed_ns()){
+        for(const char *pc_c = as_inputScript[u8_inputNext].ac_text; *pc_c != '\0'; pc_c++){
+            sim_uart_host_queue((uint8_t)*pc_c);
+        }
+        u8_inputNext++;
+    }
+    if(i_hostIn >= 0 && u64_nowNs >= u64_nextPollNs){
+        sim_uart_host_poll();
+        u64_nextPollNs = u64_nowNs + SIM_UART_HOST_POLL_NS;
+    }
+    sim_uart_update_one(&as_uarts[0], u64_nowNs, true);
+    sim_uart_update_one(&as_uarts[1], u64_nowNs, false);
+}
+
+static void sim_uart_report(FILE *ps_file){
+    for(uint8_t u8_i = 0; u8_i < 2; u8_i++){
+        const sim_uart_t *ps_uart = &as_uarts[u8_i];
+        if(ps_uart->u32_txBytes == 0 && ps_uart->u32_rxBytes == 0 && ps_uart->u32_overruns == 0){
+            continue;
+        }
+        fprintf(ps_file, "sim: uart%u %lu baud, sent %lu bytes, received %lu, rx overruns %lu, rx FIFO peak %u of %u\n",
+                u8_i, (unsigned long)sim_uart_baud(ps_uart), (unsigned long)ps_uart->u32_txBytes,
+                (unsigned long)ps_uart->u32_rxBytes, (unsigned long)ps_uart->u32_overruns,
+                ps_uart->u8_rxMaxLevel, sim_uart_depth(ps_uart));
+    }
+    if(u32_hostDropped != 0){
+        fprintf(ps_file, "sim: uart0 host side dropped %lu bytes\n", (unsigned long)u32_hostDropped);
+    }
+}
+
+const sim_device_t sim_uart_device = {
+    "uart", sim_uart_init, sim_uart_next, sim_uart_update, sim_uart_report
+};
+
+/*****************************************************************
+ * hardware/uart.h
+ *****************************************************************/
+uint uart_set_baudrate(uart_inst_t *uart, uint u_baudrate){
+    uart_hw_t *ps_hw = uart_get_hw(uart);
+    uint32_t u32_div = (8 * SIM_UART_CLK_PERI_HZ) / u_baudrate;
+    uint32_t u32_ibrd = u32_div >> 7;
+    uint32_t u32_fbrd;
+    if(u32_ibrd == 0){
+        u32_ibrd = 1;
+        u32_fbrd = 0;
+    }else if(u32_ibrd >= 65535){
+        u32_ibrd = 65535;
+        u32_fbrd = 0;
+    }else{
+        u32_fbrd = ((u32_div & 0x7f) + 1) / 2;
+    }
+    ps_hw->ibrd = u32_ibrd;
+    ps_hw->fbrd = u32_fbrd;
+    sim_hal_call();
+    return (4 * SIM_UART_CLK_PERI_HZ) / (64 * u32_ibrd + u32_fbrd);
+}
+
+void uart_set_format(uart_inst_t *uart, uint u_dataBits, uint u_stopBits, uart_parity_t e_parity){
+    uart_hw_t *ps_hw = uart_get_hw(uart);
+    uint32_t u32_lcr = ps_hw->lcr_h & UART_UARTLCR_H_FEN_BITS;
+    u32_lcr |= (u_dataBits - 5) << 5;
+    u32_lcr |= u_stopBits == 2 ? 1u << 3 : 0;
+    u32_lcr |= e_parity != UART_PARITY_NONE ? 1u << 1 : 0;
+    u32_lcr |= e_parity == UART_PARITY_EVEN ? 1u << 2 : 0;
+    ps_hw->lcr_h = u32_lcr;
+    sim_hal_call();
+}
+
+uint uart_init(uart_inst_t *uart, uint u_baudrate){
+    sim_uart_t *ps_uart = sim_uart_get(uart);
+    uart_hw_t *ps_hw = ps_uart->ps_hw;
+    //a reset of the block first
+    memset(&ps_uart->s_tx, 0, sizeof(ps_uart->s_tx));
+    memset(&ps_uart->s_rx, 0, sizeof(ps_uart->s_rx));
+    ps_uart->b_txShifting = false;
+    ps_hw->imsc = 0;
+    uint u_actual = uart_set_baudrate(uart, u_baudrate);
+    uart_set_format(uart, 8, 1, UART_PARITY_NONE);
+    ps_hw->lcr_h |= UART_UARTLCR_H_FEN_BITS;
+    ps_hw->cr = UART_UARTCR_UARTEN_BITS | UART_UARTCR_TXE_BITS | UART_UARTCR_RXE_BITS;
+    sim_hal_call();
+    return u_actual;
+}
+
+void uart_deinit(uart_inst_t *uart){
+    uart_get_hw(uart)->cr = 0;
+    sim_hal_call();
+}
+
+void uart_set_hw_flow(uart_inst_t *uart, bool b_cts, bool b_rts){
+    (void)uart;
+    if(b_cts || b_rts){
+        sim_log("uart hardware flow control is not modelled");
+    }
+    sim_hal_call();
+}
+
+void uart_set_fifo_enabled(uart_inst_t *uart, bool b_enabled){
+    uart_hw_t *ps_hw = uart_get_hw(uart);
+    if(b_enabled){
+        ps_hw->lcr_h |= UART_UARTLCR_H_FEN_BITS;
+    }else{
+        ps_hw->lcr_h &= ~UART_UARTLCR_H_FEN_BITS;
+    }
+    sim_hal_call();
+}
+
+void uart_set_irqs_enabled(uart_inst_t *uart, bool b_rxHasData, bool b_txNeedsData){
+    uart_get_hw(uart)->imsc = (b_txNeedsData ? UART_UARTIMSC_TXIM_BITS : 0) |
+                              (b_rxHasData ? UART_UARTIMSC_RXIM_BITS | UART_UARTIMSC_RTIM_BITS : 0);
+    sim_uart_refresh(sim_uart_get(uart), sim_now_ns());
+    sim_hal_call();
+}
+
+void uart_set_irq_enables(uart_inst_t *uart, bool b_rxHasData, bool b_txNeedsData){
+    uart_set_irqs_enabled(uart, b_rxHasData, b_txNeedsData);
+}
+
+bool uart_is_enabled(uart_inst_t *uart){
+    return (uart_get_hw(uart)->cr & UART_UARTCR_UARTEN_BITS) != 0;
+}
+
+bool uart_is_writable(uart_inst_t *uart){
+    sim_hal_call();
+    return !(uart_get_hw(uart)->fr & UART_UARTFR_TXFF_BITS);
+}
+
+bool uart_is_readable(uart_inst_t *uart){
+    sim_hal_call();
+    return !(uart_get_hw(uart)->fr & UART_UARTFR_RXFE_BITS);
+}
+
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t u32_us){
+    uint64_t u64_deadline = sim_now_ns() + (uint64_t)u32_us * SIM_NS_PER_US;
+    while(!uart_is_readable(uart)){
+        if(sim_now_ns() >= u64_deadline){
+            return false;
+        }
+        sim_idle_until(u64_deadline);
+    }
+    return true;
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart){
+    while(uart_get_hw(uart)->fr & UART_UARTFR_BUSY_BITS){
+        sim_idle();
+    }
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c){
+    while(!uart_is_writable(uart)){
+        sim_idle();
+    }
+    sim_uart_t *ps_uart = sim_uart_get(uart);
+    sim_fifo_push(&ps_uart->s_tx, sim_uart_depth(ps_uart), (uint8_t)c);
+    //no refresh here: an idle shifter takes the byte at once, so TX never shows full
+    sim_hal_call();
+}
+
+void uart_putc(uart_inst_t *uart, char c){
+    uart_putc_raw(uart, c);
+}
+
+void uart_puts(uart_inst_t *uart, const char *pc_s){
+    while(*pc_s != '\0'){
+        uart_putc(uart, *pc_s++);
+    }
+}
+
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *pu8_src, size_t len){
+    for(size_t i = 0; i < len; i++){
+        uart_putc_raw(uart, (char)pu8_src[i]);
+    }
+}
+
+char uart_getc(uart_inst_t *uart){
+    while(!uart_is_readable(uart)){
+        sim_idle();
+    }
+    sim_uart_t *ps_uart = sim_uart_get(uart);
+    char c = (char)sim_fifo_pop(&ps_uart->s_rx);
+    sim_uart_refresh(ps_uart, sim_now_ns());
+    return c;
+}
+
+void uart_read_blocking(uart_inst_t *uart, uint8_t *pu8_dst, size_t len){
+    for(size_t i = 0; i < len; i++){
+        pu8_dst[i] = (uint8_t)uart_getc(uart);
+    }
+}
+
+/*****************************************************************
+ * stdio on uart0, as pico_stdio_uart with CR/LF translation. The app's
+ * printf, puts, putchar and getchar are linked to these (--wrap).
+ *****************************************************************/
+bool stdio_init_all(void){
+    if(!uart_is_enabled(uart0)){
+        uart_init(uart0, 115200);
+    }
+    b_stdioReady = true;
+    return true;
+}
+
+void stdio_flush(void){
+    uart_tx_wait_blocking(uart0);
+}
+
+static void sim_stdio_write(const char *pc_buf, size_t len){
+    if(!b_stdioReady){
+        return;
+    }
+    for(size_t i = 0; i < len; i++){
+        if(pc_buf[i] == '\n'){
+            uart_putc_raw(uart0, '\r');
+        }
+        uart_putc_raw(uart0, pc_buf[i]);
+    }
+}
+
+int getchar_timeout_us(uint32_t u32_timeoutUs){
+    if(!uart_is_readable_within_us(uart0, u32_timeoutUs)){
+        return PICO_ERROR_TIMEOUT;
+    }
+    return (uint8_t)uart_getc(uart0);
+}
+
+int __wrap_vprintf(const char *pc_format, va_list args){
+    char ac_buf[256];
+    int i_len = vsnprintf(ac_buf, sizeof(ac_buf), pc_format, args);
+    if(i_len > 0){
+        sim_stdio_write(ac_buf, MIN((size_t)i_len, sizeof(ac_buf) - 1));
+    }
+    return i_len;
+}
+
+int __wrap_printf(const char *pc_format, ...){
+    va_list args;
+    va_start(args, pc_format);
+    int i_len = __wrap_vprintf(pc_format, args);
+    va_end(args);
+    return i_len;
+}
+
+int __wrap_puts(const char *pc_s){
+    sim_stdio_write(pc_s, strlen(pc_s));
+    sim_stdio_write("\n", 1);
+    return 1;
+}
+
+int __wrap_putchar(int c){
+    char c_out = (char)c;
+    sim_stdio_write(&c_out, 1);
+    return c;
+}
+
+int __wrap_getchar(void){
+    return (uint8_t)uart_getc(uart0);
+}
@@ -0,0 +1,44 @@
+/**
+ * Host stand-in for hardware/sync.h.
+ *
+ * There are no interrupts on the host, so "disabling" them only sets a
+ * flag. The tests check the flag is clear after every call, which catches
+ * a code path that returns from inside its critical region, and
+ * preempt_stress holds its virtual interrupt off while it is set.
+ *
+ * Like the SDK's versions these are compiler memory barriers, so the
+ * compiler cannot move a buffer access out of the critical region.
+ * __dmb() is a real fence, so spsc.c can be tested with two threads
+ * standing in for the two cores.
+ */
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+extern volatile uint32_t host_irq_disabled;
+
+#define host_memory_barrier() __asm__ volatile("" ::: "memory")
+
+static inline void __dmb(void){
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t save_and_disable_interrupts(void){
+    uint32_t status = host_irq_disabled;
+    host_irq_disabled = 1;
+    host_memory_barrier();
+    return status;
+}
+
+static inline void restore_interrupts(uint32_t status){
+    host_memory_barrier();
+    host_irq_disabled = status;
+}
+
+static inline void restore_interrupts_from_disabled(uint32_t status){
+    host_memory_barrier();
+    host_irq_disabled = status;
+}
+
+#endif
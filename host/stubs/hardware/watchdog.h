@@ -0,0 +1,2 @@
+//Host stand-in, nothing the portable modules need comes from here
+#pragma once
@@ -0,0 +1,25 @@
+/**
+ * Host stand-in for the Pico SDK's pico/stdlib.h. Only what the portable
+ * modules use: the integer types and a few helper macros.
+ */
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+//the modules only pass these around by pointer
+typedef struct uart_inst uart_inst_t;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * adc_jitter.c, the sample timing analysis. The stamps are made up the way
+ * the ADC ISR takes them: a grid of conversions, an ISR some latency after
+ * one of them taking out everything converted before its stamp, rounded
+ * down to the timer's 1 us.
+ */
+#include <string.h>
+#include "unit.h"
+#include "adc_jitter.h"
+#include "adc_rate.h"
+
+#define ADC_CLK_HZ 48000000u
+
+static adc_jitter s_jitter;
+
+//conversion n is at n * period, in ns
+typedef struct {
+    uint64_t u64_periodNs;
+    uint64_t u64_taken;     // conversions taken out so far
+} grid_t;
+
+//an ISR u64_latencyNs after conversion u64_last, taking out everything up to it
+static void isr_at(grid_t *ps_grid, uint64_t u64_last, uint64_t u64_latencyNs){
+    uint64_t u64_stampUs = (u64_last * ps_grid->u64_periodNs + u64_latencyNs) / 1000;
+    uint32_t u32_samples = (uint32_t)(u64_last + 1 - ps_grid->u64_taken);
+    ps_grid->u64_taken = u64_last + 1;
+    adc_jitter_block(&s_jitter, u64_stampUs, u32_samples, 0, false);
+}
+
+static void test_steady(void){
+    grid_t s_grid = {100000, 0};
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    for(uint64_t u64_n = 0; u64_n < 1000; u64_n++){
+        isr_at(&s_grid, u64_n, 3000);
+    }
+    CHECK_EQ(s_jitter.u32_blocks, 1000);
+    CHECK_EQ(s_jitter.u32_samples, 1000);
+    CHECK_EQ(s_jitter.i32_minNs, 0);
+    CHECK_EQ(s_jitter.i32_maxNs, 0);
+    CHECK_EQ(adc_jitter_rms_ns(&s_jitter), 0);
+    CHECK_EQ(s_jitter.u32_gaps, 0);
+}
+
+//the latency going between 2 and 40 us moves each interval 38 us either way
+static void test_latency_jitter(void){
+    grid_t s_grid = {100000, 0};
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    for(uint64_t u64_n = 0; u64_n < 1001; u64_n++){
+        isr_at(&s_grid, u64_n, (u64_n & 1) ? 40000 : 2000);
+    }
+    CHECK_EQ(s_jitter.i32_minNs, -38000);
+    CHECK_EQ(s_jitter.i32_maxNs, 38000);
+    CHECK_EQ(adc_jitter_rms_ns(&s_jitter), 38000);
+    CHECK_EQ(s_jitter.u32_gaps, 0);
+}
+
+//an ISR 250 us late finds three samples waiting, nothing is missing
+static void test_late_isr(void){
+    grid_t s_grid = {100000, 0};
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    for(uint64_t u64_n = 0; u64_n < 10; u64_n++){
+        isr_at(&s_grid, u64_n, 1000);
+    }
+    isr_at(&s_grid, 12, 50000);
+    isr_at(&s_grid, 13, 1000);
+    CHECK_EQ(s_jitter.u32_samples, 14);
+    CHECK_EQ(s_jitter.u32_gaps, 0);
+    CHECK_EQ(s_jitter.u32_missing, 0);
+    CHECK_EQ(s_jitter.i32_maxNs, 49000);
+    CHECK_EQ(s_jitter.i32_minNs, -49000);
+}
+
+//samples the FIFO dropped show up as gaps, however late the ISR was
+static void test_gaps(void){
+    grid_t s_grid = {100000, 0};
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    for(uint64_t u64_n = 0; u64_n < 10; u64_n++){
+        isr_at(&s_grid, u64_n, 1000);
+    }
+    //conversions 10 to 12 were lost, the ISR takes 13 only
+    s_grid.u64_taken = 13;
+    isr_at(&s_grid, 13, 1000);
+    CHECK_EQ(s_jitter.u32_gaps, 1);
+    CHECK_EQ(s_jitter.u32_missing, 3);
+    //lost 14 and 15 and took 16 and 17 late, near the end of a period
+    s_grid.u64_taken = 16;
+    isr_at(&s_grid, 17, 99000);
+    CHECK_EQ(s_jitter.u32_gaps, 2);
+    CHECK_EQ(s_jitter.u32_missing, 5);
+    //and back on time, the grid still lines up
+    for(uint64_t u64_n = 18; u64_n < 100; u64_n++){
+        isr_at(&s_grid, u64_n, 1000);
+    }
+    CHECK_EQ(s_jitter.u32_gaps, 2);
+    CHECK_EQ(s_jitter.u32_missing, 5);
+    CHECK_EQ(s_jitter.u32_samples + s_jitter.u32_missing, 100);
+    CHECK_EQ(s_jitter.i32_maxNs, 98000);
+}
+
+//7 kS/s, 6857 + 37/256 cycles, for longer than the us timer takes to
+//drift a period off a rounded period: the Q32 grid has to keep up
+static void test_fractional_period(void){
+    uint32_t u32_periodQ8 = adc_rate_period_q8(ADC_CLK_HZ, 7000, 1);
+    adc_jitter_init(&s_jitter, adc_rate_period_us_q32(ADC_CLK_HZ, u32_periodQ8));
+    uint64_t u64_stepFs = (uint64_t)u32_periodQ8 * 1000000000u / 48 / 256;  // period in fs, to 1 fs
+    for(uint64_t u64_n = 0; u64_n < 2000000; u64_n++){
+        uint64_t u64_stampUs = (u64_n * u64_stepFs) / 1000000000u + 2;
+        adc_jitter_block(&s_jitter, u64_stampUs, 1, 0, false);
+    }
+    CHECK_EQ(s_jitter.u32_gaps, 0);
+    //only the rounding to 1 us
+    CHECK(s_jitter.i32_minNs >= -1000);
+    CHECK(s_jitter.i32_maxNs <= 1000);
+}
+
+static void test_flags(void){
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    adc_jitter_block(&s_jitter, 1000, 1, 0, false);
+    adc_jitter_block(&s_jitter, 1100, 1, 1, true);
+    //an ISR that found nothing only counts its flags
+    adc_jitter_block(&s_jitter, 1150, 0, 0, true);
+    adc_jitter_block(&s_jitter, 1200, 2, 2, false);
+    CHECK_EQ(s_jitter.u32_blocks, 3);
+    CHECK_EQ(s_jitter.u32_samples, 4);
+    CHECK_EQ(s_jitter.u32_overs, 2);
+    CHECK_EQ(s_jitter.u32_errors, 3);
+    //2 samples in 100 us is one in the gap
+    CHECK_EQ(s_jitter.u32_gaps, 0);
+    CHECK_EQ(s_jitter.i32_minNs, -100000);
+}
+
+static void test_format(void){
+    char ac_line[ADC_JITTER_LINE_SIZE];
+    adc_jitter_init(&s_jitter, (uint64_t)100 << 32);
+    adc_jitter_format(&s_jitter, ac_line);
+    CHECK(strcmp(ac_line, "JITTER n=0/0 int=+0/+0/0ns gap=0/0 over=0 err=0\n\r") == 0);
+    grid_t s_grid = {100000, 0};
+    isr_at(&s_grid, 0, 1000);
+    isr_at(&s_grid, 1, 3000);
+    isr_at(&s_grid, 2, 1000);
+    s_grid.u64_taken = 4;
+    isr_at(&s_grid, 4, 1000);
+    adc_jitter_format(&s_jitter, ac_line);
+    printf("%s\n", ac_line);
+    CHECK(strcmp(ac_line, "JITTER n=4/4 int=-2000/+2000/1632ns gap=1/1 over=0 err=0\n\r") == 0);
+}
+
+int main(void){
+    test_steady();
+    test_latency_jitter();
+    test_late_isr();
+    test_gaps();
+    test_fractional_period();
+    test_flags();
+    test_format();
+    return UNIT_RESULT();
+}
@@ -0,0 +1,94 @@
+/**
+ * adc_rate.h, the divider for a sample rate and the rate it gives.
+ */
+#include <math.h>
+#include "unit.h"
+#include "adc_rate.h"
+
+#define ADC_CLK_HZ 48000000u
+
+static void test_channels(void){
+    CHECK_EQ(adc_rate_channels(0), 1);
+    CHECK_EQ(adc_rate_channels(0x04), 1);
+    CHECK_EQ(adc_rate_channels(0x05), 2);
+    CHECK_EQ(adc_rate_channels(0x1F), 5);
+}
+
+static void test_known_rates(void){
+    //the old DEFUALT_ADC_PERIOD_CYCLES 4800 was DIV 4800, 4801 cycles
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, 4801u << 8, 1), 9997917);
+    //10 kS/s is exactly 4800 cycles, DIV 4799
+    uint32_t u32_period = adc_rate_period_q8(ADC_CLK_HZ, 10000, 1);
+    CHECK_EQ(u32_period, 4800u << 8);
+    CHECK_EQ(adc_rate_div(u32_period), 4799u << 8);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, u32_period, 1), 10000000);
+    //7 kS/s needs the fraction, 6857.14 cycles rounds to 6857 + 37/256
+    u32_period = adc_rate_period_q8(ADC_CLK_HZ, 7000, 1);
+    CHECK_EQ(u32_period, (6857u << 8) + 37);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, u32_period, 1), 6999998);
+    //1 kS/s on each of three inputs is 3 kS/s of conversions
+    u32_period = adc_rate_period_q8(ADC_CLK_HZ, 1000, 3);
+    CHECK_EQ(u32_period, 16000u << 8);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, u32_period, 3), 1000000);
+}
+
+static void test_limits(void){
+    //never faster than one 96 cycle conversion, and that is DIV 0
+    CHECK_EQ(adc_rate_period_q8(ADC_CLK_HZ, 500000, 1), ADC_RATE_PERIOD_MIN_Q8);
+    CHECK_EQ(adc_rate_period_q8(ADC_CLK_HZ, 2000000, 1), ADC_RATE_PERIOD_MIN_Q8);
+    CHECK_EQ(adc_rate_div(ADC_RATE_PERIOD_MIN_Q8), 0);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, ADC_RATE_PERIOD_MIN_Q8, 1), 500000000);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, ADC_RATE_PERIOD_MIN_Q8, 5), 100000000);
+    //96.5 cycles is still slower than back to back
+    CHECK_EQ(adc_rate_div(ADC_RATE_PERIOD_MIN_Q8 + 128), (95u << 8) + 128);
+    //never slower than DIV all ones, 65537 cycles or 732.411 Hz
+    CHECK_EQ(adc_rate_period_q8(ADC_CLK_HZ, 0, 1), ADC_RATE_PERIOD_MAX_Q8);
+    CHECK_EQ(adc_rate_period_q8(ADC_CLK_HZ, 700, 1), ADC_RATE_PERIOD_MAX_Q8);
+    CHECK_EQ(adc_rate_div(ADC_RATE_PERIOD_MAX_Q8), 0xFFFFFF);
+    CHECK_EQ(adc_rate_millihz(ADC_CLK_HZ, ADC_RATE_PERIOD_MAX_Q8, 1), 732411);
+}
+
+//every rate in range gets the nearest period there is, to half of 1/256 cycle
+static void test_nearest(void){
+    uint32_t u32_worse = 0;
+    double d_worstPpm = 0;
+    for(uint32_t u32_hz = 100; u32_hz <= 500000; u32_hz += (u32_hz < 20000 ? 1 : 7)){
+        for(uint32_t u32_channels = 1; u32_channels <= 5; u32_channels += 2){
+            double d_ideal = (double)ADC_CLK_HZ * 256.0 / ((double)u32_hz * u32_channels);
+            if(d_ideal < ADC_RATE_PERIOD_MIN_Q8 || d_ideal > ADC_RATE_PERIOD_MAX_Q8){
+                continue;
+            }
+            uint32_t u32_period = adc_rate_period_q8(ADC_CLK_HZ, u32_hz, u32_channels);
+            if(fabs((double)u32_period - d_ideal) > 0.5 + 1e-9){
+                u32_worse++;
+            }
+            double d_got = adc_rate_millihz(ADC_CLK_HZ, u32_period, u32_channels) / 1000.0;
+            double d_ppm = fabs(d_got - u32_hz) / u32_hz * 1e6;
+            if(d_ppm > d_worstPpm){
+                d_worstPpm = d_ppm;
+            }
+        }
+    }
+    printf("worst rate error %.1f ppm\n", d_worstPpm);
+    CHECK_EQ(u32_worse, 0);
+    //half of 1/256 cycle out of the shortest period, 96 cycles
+    CHECK(d_worstPpm < 0.5 / (96.0 * 256.0) * 1e6 + 1.0);
+}
+
+static void test_period_us(void){
+    CHECK(adc_rate_period_us_q32(ADC_CLK_HZ, 4800u << 8) == (uint64_t)100 << 32);
+    CHECK(adc_rate_period_us_q32(ADC_CLK_HZ, 4801u << 8) == ((uint64_t)4801 << 32) / 48);
+    //the longest period, 1365 us
+    double d_us = (double)ADC_RATE_PERIOD_MAX_Q8 / 256.0 / 48.0;
+    double d_q32 = (double)adc_rate_period_us_q32(ADC_CLK_HZ, ADC_RATE_PERIOD_MAX_Q8) / 4294967296.0;
+    CHECK(fabs(d_q32 - d_us) < 1e-6);
+}
+
+int main(void){
+    test_channels();
+    test_known_rates();
+    test_limits();
+    test_nearest();
+    test_period_us();
+    return UNIT_RESULT();
+}
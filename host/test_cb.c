@@ -0,0 +1,95 @@
+/**
+ * cb.c, the ring buffer in picoedub/ that the apps link.
+ */
+#include <string.h>
+#include "unit.h"
+#include "cb.h"
+
+static circular_buffer cb_test;
+
+static void test_fifo_order_and_wrap(void){
+    cb_init(&cb_test);
+    CHECK(cb_isEmpty(&cb_test));
+
+    //three passes over the buffer so head and tail both wrap
+    char c_in = 0;
+    char c_out = 0;
+    for(uint32_t u32_i = 0; u32_i < 3 * CD_BUFFER_SIZE; u32_i++){
+        c_in = (char)(u32_i & 0x7F);
+        cb_push_back(&cb_test, &c_in);
+        cb_pop_front(&cb_test, &c_out);
+        CHECK_EQ(c_out, c_in);
+        CHECK_EQ(host_irq_disabled, 0);
+    }
+    CHECK(cb_isEmpty(&cb_test));
+    CHECK_EQ(cb_test.u32_highWater, 1);
+}
+
+static void test_empty_pop(void){
+    cb_init(&cb_test);
+    char c_out = 0;
+    cb_pop_front(&cb_test, &c_out);
+    CHECK_EQ(c_out, '?');
+    CHECK_EQ(cb_test.u32_count, 0);
+    CHECK_EQ(host_irq_disabled, 0);
+}
+
+static void test_full_drops(void){
+    cb_init(&cb_test);
+    char c_in = 'x';
+    for(uint32_t u32_i = 0; u32_i < CD_BUFFER_SIZE + 5; u32_i++){
+        cb_push_back(&cb_test, &c_in);
+    }
+    CHECK_EQ(cb_test.u32_count, CD_BUFFER_SIZE);
+    CHECK_EQ(cb_test.u32_drops, 5);
+    CHECK_EQ(cb_test.u32_highWater, CD_BUFFER_SIZE);
+    CHECK_EQ(host_irq_disabled, 0);
+
+    //the oldest items are the ones kept
+    char c_out = 0;
+    cb_pop_front(&cb_test, &c_out);
+    CHECK_EQ(c_out, 'x');
+    CHECK_EQ(cb_test.u32_count, CD_BUFFER_SIZE - 1);
+}
+
+static void test_print_cstring(void){
+    cb_init(&cb_test);
+    cb_print_cstring_to_buffer(&cb_test, "hello");
+    CHECK_EQ(cb_test.u32_count, 5);
+    CHECK_EQ(host_irq_disabled, 0);
+    char *pc_out = cb_pop_multiple(&cb_test, 5);
+    CHECK(memcmp(pc_out, "hello", 5) == 0);
+    CHECK(cb_isEmpty(&cb_test));
+
+    //a string longer than the space left is cut and the rest counted as drops
+    char ac_long[CD_BUFFER_SIZE + 11];
+    memset(ac_long, 'a', sizeof(ac_long) - 1);
+    ac_long[sizeof(ac_long) - 1] = '\0';
+    cb_print_cstring_to_buffer(&cb_test, ac_long);
+    CHECK_EQ(cb_test.u32_count, CD_BUFFER_SIZE);
+    CHECK_EQ(cb_test.u32_drops, 10);
+    CHECK_EQ(host_irq_disabled, 0);
+}
+
+static void test_print_float(void){
+    cb_init(&cb_test);
+    cb_print_float_to_buffer(&cb_test, 72.5f);
+    CHECK_EQ(cb_test.u32_count, strlen("72.500000"));
+    char *pc_out = cb_pop_multiple(&cb_test, cb_test.u32_count);
+    CHECK(memcmp(pc_out, "72.500000", strlen("72.500000")) == 0);
+    CHECK_EQ(host_irq_disabled, 0);
+
+    //wider than the 20 char scratch buffer, it is cut to 19
+    cb_print_float_to_buffer(&cb_test, -1.0e30f);
+    CHECK_EQ(cb_test.u32_count, 19);
+    CHECK_EQ(host_irq_disabled, 0);
+}
+
+int main(void){
+    test_fifo_order_and_wrap();
+    test_empty_pop();
+    test_full_drops();
+    test_print_cstring();
+    test_print_float();
+    return UNIT_RESULT();
+}
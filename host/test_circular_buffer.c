@@ -0,0 +1,72 @@
+/**
+ * circular_buffer.c, the MCP4725 apps' old ring buffer, kept in bench/.
+ */
+#include "unit.h"
+#include "circular_buffer.h"
+
+static circular_buffer cb_test;
+
+static void test_fifo_order_and_wrap(void){
+    cb_init(&cb_test);
+    CHECK(cb_is_empty(&cb_test));
+
+    uint8_t u8_out = 0;
+    for(uint32_t u32_i = 0; u32_i < 3 * BUFFER_SIZE; u32_i++){
+        uint8_t u8_in = (uint8_t)u32_i;
+        CHECK_EQ(cb_push(&cb_test, &u8_in), 0);
+        CHECK_EQ(cb_pop_next(&cb_test, &u8_out), 0);
+        CHECK_EQ(u8_out, u8_in);
+        CHECK_EQ(host_irq_disabled, 0);
+    }
+    CHECK(cb_is_empty(&cb_test));
+    CHECK_EQ(cb_pop_next(&cb_test, &u8_out), -1);
+    CHECK_EQ(host_irq_disabled, 0);
+    CHECK_EQ(cb_test.u32_highWater, 1);
+}
+
+static void test_full_drops(void){
+    cb_init(&cb_test);
+    for(uint32_t u32_i = 0; u32_i < BUFFER_SIZE; u32_i++){
+        uint8_t u8_in = (uint8_t)u32_i;
+        CHECK_EQ(cb_push(&cb_test, &u8_in), 0);
+    }
+    CHECK(cb_is_full(&cb_test));
+    CHECK_EQ(cb_test.u32_highWater, BUFFER_SIZE);
+
+    uint8_t u8_in = 0xAA;
+    CHECK_EQ(cb_push(&cb_test, &u8_in), -1);
+    CHECK_EQ(cb_push(&cb_test, &u8_in), -1);
+    CHECK_EQ(cb_test.u32_drops, 2);
+    CHECK_EQ(host_irq_disabled, 0);
+
+    uint8_t u8_out = 0xFF;
+    CHECK_EQ(cb_pop_next(&cb_test, &u8_out), 0);
+    CHECK_EQ(u8_out, 0);
+    CHECK(!cb_is_full(&cb_test));
+}
+
+static void test_pop_recent(void){
+    cb_init(&cb_test);
+    uint8_t u8_out = 0;
+    CHECK_EQ(cb_pop_recent(&cb_test, &u8_out), -1);
+
+    //pop_recent takes from the head, so it wraps backwards past index 0
+    for(uint8_t u8_i = 1; u8_i <= 3; u8_i++){
+        CHECK_EQ(cb_push(&cb_test, &u8_i), 0);
+    }
+    CHECK_EQ(cb_pop_recent(&cb_test, &u8_out), 0);
+    CHECK_EQ(u8_out, 3);
+    CHECK_EQ(cb_pop_next(&cb_test, &u8_out), 0);
+    CHECK_EQ(u8_out, 1);
+    CHECK_EQ(cb_pop_recent(&cb_test, &u8_out), 0);
+    CHECK_EQ(u8_out, 2);
+    CHECK(cb_is_empty(&cb_test));
+    CHECK_EQ(host_irq_disabled, 0);
+}
+
+int main(void){
+    test_fifo_order_and_wrap();
+    test_full_drops();
+    test_pop_recent();
+    return UNIT_RESULT();
+}
@@ -0,0 +1,162 @@
+/**
+ * fft.c, against a DFT in double and against signals whose levels, THD and
+ * SNR are known: a sine with harmonics added at set levels, a sine with
+ * noise of a set power, and a full-scale sine rounded to 12 bits, which an
+ * ideal ADC gives 74 dB of SNR. The last shows the FFT's own rounding is
+ * well under what the ADC adds.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unit.h"
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RATE_MHZ 10000000u
+
+static int16_t ai16_in[FFT_MAX_POINTS];
+static int32_t ai32_bins[FFT_MAX_POINTS];
+static fft_result s_result;
+
+static int16_t q15(double d_x){
+    double d_q = round(d_x * 32768);
+    return (int16_t)(d_q > 32767 ? 32767 : d_q < -32768 ? -32768 : d_q);
+}
+
+static void test_sizes(void){
+    CHECK(fft_real_q15(ai16_in, ai32_bins, 256));
+    CHECK(fft_real_q15(ai16_in, ai32_bins, 4096));
+    CHECK(!fft_real_q15(ai16_in, ai32_bins, 128));
+    CHECK(!fft_real_q15(ai16_in, ai32_bins, 8192));
+    CHECK(!fft_real_q15(ai16_in, ai32_bins, 1000));
+}
+
+//the same window, then the DFT in double
+static void test_against_dft(void){
+    const uint32_t u32_n = 512;
+    srand(4);
+    for(uint32_t u32_i = 0; u32_i < u32_n; u32_i++){
+        ai16_in[u32_i] = (int16_t)(rand() % 65536 - 32768);
+    }
+    CHECK(fft_real_q15(ai16_in, ai32_bins, u32_n));
+    double d_worst = 0, d_largest = 0;
+    for(uint32_t u32_k = 0; u32_k < u32_n / 2; u32_k++){
+        double d_re = 0, d_im = 0;
+        for(uint32_t u32_i = 0; u32_i < u32_n; u32_i++){
+            double d_t = 2 * M_PI * u32_i / u32_n;
+            double d_w = 0.35875 - 0.48829 * cos(d_t) + 0.14128 * cos(2 * d_t) - 0.01168 * cos(3 * d_t);
+            d_re += ai16_in[u32_i] * d_w * cos(d_t * u32_k);
+            d_im -= ai16_in[u32_i] * d_w * sin(d_t * u32_k);
+        }
+        double d_err = hypot(ai32_bins[2 * u32_k] - d_re, ai32_bins[2 * u32_k + 1] - d_im);
+        d_worst = d_err > d_worst ? d_err : d_worst;
+        d_largest = hypot(d_re, d_im) > d_largest ? hypot(d_re, d_im) : d_largest;
+    }
+    //the Q15 twiddles, some 80 dB under the largest bin
+    printf("fft against the DFT: worst %.1f on bins up to %.0f\n", d_worst, d_largest);
+    CHECK(d_worst < d_largest * 2e-4);
+}
+
+//a half-scale sine, on a bin and between two, reads -6.0 dBFS either way
+static void test_tone(void){
+    const double ad_bins[] = {100.0, 100.37, 100.5};
+    for(int i = 0; i < 3; i++){
+        for(uint32_t u32_i = 0; u32_i < 1024; u32_i++){
+            ai16_in[u32_i] = q15(0.5 * sin(2 * M_PI * ad_bins[i] * u32_i / 1024 + 0.3));
+        }
+        CHECK(fft_real_q15(ai16_in, ai32_bins, 1024));
+        fft_analyze(ai32_bins, 1024, RATE_MHZ, &s_result);
+        double d_hz = ad_bins[i] * 10000.0 / 1024;
+        printf("tone at %.3f Hz: %.3f Hz %.3f dBFS\n", d_hz, s_result.as_peak[0].f_hz, s_result.as_peak[0].f_dbfs);
+        CHECK(fabs(s_result.as_peak[0].f_dbfs - -6.02) < 0.05);
+        CHECK(fabs(s_result.as_peak[0].f_hz - d_hz) < 0.05 * s_result.f_binHz);
+    }
+    CHECK(fabs(s_result.f_binHz - 9.765625) < 1e-4);
+}
+
+//2nd at -40 dB and 3rd at -50 dB is a THD of -39.6 dB, both folding back past fs/2
+static void test_thd(void){
+    double d_bin = 150.25;  // the 2nd and 3rd are at 300.5 and 450.75 of 512, past the 256 of fs/2
+    for(uint32_t u32_i = 0; u32_i < 512; u32_i++){
+        double d_t = 2 * M_PI * d_bin * u32_i / 512;
+        ai16_in[u32_i] = q15(0.7 * sin(d_t) + 0.007 * sin(2 * d_t + 1) + 0.0022136 * sin(3 * d_t + 2));
+    }
+    CHECK(fft_real_q15(ai16_in, ai32_bins, 512));
+    fft_analyze(ai32_bins, 512, RATE_MHZ, &s_result);
+    printf("thd %.2f dB snr %.1f dB\n", s_result.f_thdDb, s_result.f_snrDb);
+    CHECK(fabs(s_result.f_thdDb - -39.59) < 0.1);
+    //the harmonics are the next two peaks, where they fold to
+    CHECK_EQ(s_result.u8_peaks, FFT_PEAKS);
+    CHECK(fabs(s_result.as_peak[1].f_hz - (10000 - 2 * s_result.as_peak[0].f_hz)) < 1);
+    CHECK(fabs(s_result.as_peak[2].f_hz - (10000 - 3 * s_result.as_peak[0].f_hz)) < 1);
+    CHECK(fabs(s_result.as_peak[1].f_dbfs - (s_result.as_peak[0].f_dbfs - 40)) < 0.1);
+}
+
+//noise with a set power, uniform over +-d_half, under a sine: the SNR is
+//the sine's power over the noise's, less the DC and harmonic bins it loses
+static void test_snr(void){
+    srand(5);
+    double d_half = 0.01;
+    for(uint32_t u32_i = 0; u32_i < 4096; u32_i++){
+        double d_noise = d_half * (2.0 * rand() / RAND_MAX - 1);
+        ai16_in[u32_i] = q15(0.5 * sin(2 * M_PI * 301.3 * u32_i / 4096) + d_noise);
+    }
+    CHECK(fft_real_q15(ai16_in, ai32_bins, 4096));
+    fft_analyze(ai32_bins, 4096, RATE_MHZ, &s_result);
+    double d_expected = 10 * log10((0.5 * 0.5 / 2) / (d_half * d_half / 3));
+    printf("snr %.2f dB, expected %.2f, noise %.2f dBFS\n", s_result.f_snrDb, d_expected, s_result.f_noiseDbfs);
+    CHECK(fabs(s_result.f_snrDb - d_expected) < 0.5);
+    CHECK(fabs(s_result.f_noiseDbfs - (-6.02 - d_expected)) < 0.5);
+}
+
+//an ideal 12-bit ADC on a full-scale sine, 6.02 * 12 + 1.76 = 74 dB
+static void test_adc_floor(void){
+    for(uint32_t u32_i = 0; u32_i < 4096; u32_i++){
+        double d_raw = round(2047.5 + 2047.5 * sin(2 * M_PI * 211.7 * u32_i / 4096));
+        ai16_in[u32_i] = (int16_t)(((int32_t)d_raw - 2048) << 4);
+    }
+    CHECK(fft_real_q15(ai16_in, ai32_bins, 4096));
+    fft_analyze(ai32_bins, 4096, RATE_MHZ, &s_result);
+    printf("12-bit sine: snr %.2f dB thd %.1f dB\n", s_result.f_snrDb, s_result.f_thdDb);
+    CHECK(fabs(s_result.f_snrDb - 74.0) < 1.5);
+}
+
+static void test_format(void){
+    char ac_line[FFT_LINE_SIZE];
+    for(uint32_t u32_i = 0; u32_i < 1024; u32_i++){
+        ai16_in[u32_i] = q15(0.5 * sin(2 * M_PI * 10.24 * u32_i / 1024));
+    }
+    fft_real_q15(ai16_in, ai32_bins, 1024);
+    fft_analyze(ai32_bins, 1024, RATE_MHZ, &s_result);
+    CHECK(fft_format_line(&s_result, 0, ac_line));
+    printf("%s\n", ac_line);
+    CHECK(strncmp(ac_line, "FFT n=1024 fs=10000.000Hz bin=9.766Hz f0=100.0Hz -6.0dBFS", 57) == 0);
+    CHECK(fft_format_line(&s_result, 1, ac_line));
+    CHECK(strncmp(ac_line, "PEAKS 100.0Hz/-6.0", 18) == 0);
+    CHECK(fft_format_line(&s_result, 2, ac_line));
+    printf("%s\n", ac_line);
+    CHECK(strncmp(ac_line, "SPEC -9 ", 8) == 0);
+    CHECK(!fft_format_line(&s_result, 3, ac_line));
+    //the longest a line gets
+    s_result.f_sampleHz = 500000.0f;
+    for(uint8_t u8_b = 0; u8_b < FFT_BANDS; u8_b++){
+        s_result.ai16_bandDbfs[u8_b] = -200;
+    }
+    CHECK(fft_format_line(&s_result, 2, ac_line));
+    CHECK(strlen(ac_line) < FFT_LINE_SIZE - 1);
+    CHECK(strcmp(ac_line + strlen(ac_line) - 2, "\n\r") == 0);
+}
+
+int main(void){
+    test_sizes();
+    test_against_dft();
+    test_tone();
+    test_thd();
+    test_snr();
+    test_adc_floor();
+    test_format();
+    return UNIT_RESULT();
+}
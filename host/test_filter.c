@@ -0,0 +1,286 @@
+/**
+ * filter.c, checked against the same filters worked out in double, and
+ * the Q15 FIR against the integer sum it is meant to be, to the bit. The
+ * host has no DSP extension, so this runs the C stand-ins for SMLAD and the
+ * rest, which are checked against the instructions' definitions first.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "unit.h"
+#include "filter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BLOCK 500
+
+static int16_t ai16_in[BLOCK];
+static int16_t ai16_out[BLOCK];
+static int32_t ai32_in[BLOCK];
+static int32_t ai32_out[BLOCK];
+
+static void test_instructions(void){
+    CHECK_EQ(filt_pack(-1, 2), 0x0002FFFFu);
+    CHECK_EQ(filt_smlad(filt_pack(3, -4), filt_pack(5, 6), 100), 100 + 15 - 24);
+    //two -32768 squared is 2^31, SMLAD wraps it
+    CHECK_EQ(filt_smlad(filt_pack(INT16_MIN, INT16_MIN), filt_pack(INT16_MIN, INT16_MIN), 0), INT32_MIN);
+    CHECK_EQ(filt_smlald(filt_pack(INT16_MIN, INT16_MIN), filt_pack(INT16_MIN, INT16_MIN), 0), 2147483648ll);
+    CHECK_EQ(filt_smlald(filt_pack(7, -1), filt_pack(-2, 9), -5), -5 - 14 - 9);
+    CHECK_EQ(filt_ssat16(40000), INT16_MAX);
+    CHECK_EQ(filt_ssat16(-40000), INT16_MIN);
+    CHECK_EQ(filt_ssat16(-123), -123);
+}
+
+//the biquad in double, on the coefficients as the filter quantized them
+static double reference_biquad(const double *pd_coef, double *pd_state, double d_x){
+    double d_y = pd_coef[0] * d_x + pd_coef[1] * pd_state[0] + pd_coef[2] * pd_state[1] - pd_coef[3] * pd_state[2] - pd_coef[4] * pd_state[3];
+    pd_state[1] = pd_state[0];
+    pd_state[0] = d_x;
+    pd_state[3] = pd_state[2];
+    pd_state[2] = d_y;
+    return d_y;
+}
+
+static void quantize_row(const double *pd_row, double *pd_out, double d_scale){
+    for(int i = 0; i < 5; i++){
+        pd_out[i] = round(pd_row[i] * d_scale) / d_scale;
+    }
+}
+
+//noise through a 4th-order lowpass at fs/20, within a few LSB of double
+static void test_biquad_q15(void){
+    double aad_coef[2][5];
+    filt_design_lowpass(aad_coef[0], 1000, 20000, 0.5412);
+    filt_design_lowpass(aad_coef[1], 1000, 20000, 1.3066);
+    filt_biquad_q15 s_filt;
+    CHECK(filt_biquad_q15_init(&s_filt, 2, (const double (*)[5])aad_coef));
+    double aad_quant[2][5], aad_state[2][4] = {{0}};
+    quantize_row(aad_coef[0], aad_quant[0], 16384);
+    quantize_row(aad_coef[1], aad_quant[1], 16384);
+    srand(1);
+    int32_t i32_worst = 0;
+    for(int i_block = 0; i_block < 20; i_block++){
+        for(int i = 0; i < BLOCK; i++){
+            ai16_in[i] = (int16_t)((rand() % 32768) - 16384);
+        }
+        filt_biquad_q15_block(&s_filt, ai16_in, ai16_out, BLOCK);
+        for(int i = 0; i < BLOCK; i++){
+            double d_y = reference_biquad(aad_quant[1], aad_state[1], reference_biquad(aad_quant[0], aad_state[0], ai16_in[i]));
+            int32_t i32_err = abs(ai16_out[i] - (int32_t)lround(d_y));
+            i32_worst = i32_err > i32_worst ? i32_err : i32_worst;
+        }
+    }
+    //each section rounds, and the second one's Q of 1.3 builds that up
+    printf("biquad q15 worst error %ld LSB\n", (long)i32_worst);
+    CHECK(i32_worst <= 10);
+}
+
+//fs/50 is as low as the Q14 coefficients go with the DC gain within 1%
+static void test_biquad_q15_dc(void){
+    double aad_coef[1][5];
+    filt_design_lowpass(aad_coef[0], 200, 10000, 0.7071);
+    filt_biquad_q15 s_filt;
+    CHECK(filt_biquad_q15_init(&s_filt, 1, (const double (*)[5])aad_coef));
+    for(int i = 0; i < BLOCK; i++){
+        ai16_in[i] = 20000;
+    }
+    for(int i_block = 0; i_block < 4; i_block++){
+        filt_biquad_q15_block(&s_filt, ai16_in, ai16_out, BLOCK);
+    }
+    CHECK(abs(ai16_out[BLOCK - 1] - 20000) < 200);
+    //primed, it starts settled. Rounding gives a DF1 lowpass a dead band
+    //around its DC value, so not necessarily where it settled from 0.
+    filt_biquad_q15_prime(&s_filt, 20000);
+    filt_biquad_q15_block(&s_filt, ai16_in, ai16_out, BLOCK);
+    CHECK(abs(ai16_out[0] - 20000) < 200);
+    CHECK_EQ(ai16_out[BLOCK - 1], ai16_out[0]);
+}
+
+//a gain of 1.9 on a loud input clips instead of wrapping
+static void test_biquad_q15_saturates(void){
+    double aad_coef[1][5] = {{1.9, 0, 0, 0, 0}};
+    filt_biquad_q15 s_filt;
+    CHECK(filt_biquad_q15_init(&s_filt, 1, (const double (*)[5])aad_coef));
+    ai16_in[0] = 30000;
+    ai16_in[1] = -30000;
+    ai16_in[2] = 1000;
+    filt_biquad_q15_block(&s_filt, ai16_in, ai16_out, 3);
+    CHECK_EQ(ai16_out[0], INT16_MAX);
+    CHECK_EQ(ai16_out[1], INT16_MIN);
+    CHECK_EQ(ai16_out[2], 1900);
+    //2 does not fit in Q14, nor do too many sections
+    double aad_bad[1][5] = {{2.0, 0, 0, 0, 0}};
+    CHECK(!filt_biquad_q15_init(&s_filt, 1, (const double (*)[5])aad_bad));
+    CHECK(!filt_biquad_q15_init(&s_filt, FILT_BIQUAD_MAX_SECTIONS + 1, (const double (*)[5])aad_coef));
+    //and a filter that failed passes samples through
+    filt_biquad_q15_block(&s_filt, ai16_in, ai16_out, 3);
+    CHECK_EQ(ai16_out[1], -30000);
+}
+
+//the LM45's 10 Hz lowpass at 10 kS/s on ADC readings shifted up by 16
+static void test_biquad_q31(void){
+    double aad_coef[1][5];
+    filt_design_lowpass(aad_coef[0], 10, 10000, 0.7071);
+    filt_biquad_q31 s_filt;
+    CHECK(filt_biquad_q31_init(&s_filt, 1, (const double (*)[5])aad_coef));
+    double ad_quant[5], ad_state[4] = {0};
+    quantize_row(aad_coef[0], ad_quant, 1073741824.0);
+    //a step to 310 with 1 kHz and 2.7 kHz on it
+    double d_worst = 0;
+    for(int i_block = 0; i_block < 20; i_block++){
+        for(int i = 0; i < BLOCK; i++){
+            int i_n = i_block * BLOCK + i;
+            double d_raw = 310 + 40 * sin(2 * M_PI * 1000 * i_n / 10000.0) + 20 * sin(2 * M_PI * 2700 * i_n / 10000.0);
+            ai32_in[i] = (int32_t)(d_raw * 65536);
+        }
+        filt_biquad_q31_block(&s_filt, ai32_in, ai32_out, BLOCK);
+        for(int i = 0; i < BLOCK; i++){
+            double d_err = fabs(ai32_out[i] - reference_biquad(ad_quant, ad_state, ai32_in[i]));
+            d_worst = d_err > d_worst ? d_err : d_worst;
+        }
+    }
+    //the rounding goes round a loop with a DC gain of 1 / (1 + a1 + a2),
+    //25000 here, still well under 1/10 of a reading
+    printf("biquad q31 worst error %.0f LSB, %.4f of a reading\n", d_worst, d_worst / 65536);
+    CHECK(d_worst < 6553);
+    //settled on 310 to 1/100 of a reading, the 1 kHz and 2.7 kHz are gone
+    for(int i = BLOCK - 100; i < BLOCK; i++){
+        CHECK(fabs(ai32_out[i] / 65536.0 - 310) < 0.01);
+    }
+    //DC gain within 0.01%, and primed it starts there
+    filt_biquad_q31_prime(&s_filt, 310 << 16);
+    for(int i = 0; i < BLOCK; i++){
+        ai32_in[i] = 310 << 16;
+    }
+    filt_biquad_q31_block(&s_filt, ai32_in, ai32_out, BLOCK);
+    CHECK(fabs(ai32_out[0] / 65536.0 - 310) < 0.031);
+    CHECK(fabs(ai32_out[BLOCK - 1] / 65536.0 - 310) < 0.031);
+}
+
+//the FIR's sum as it is specified: Q15 taps, rounded, saturated
+static int16_t reference_fir(const int16_t *pi16_taps, int i_taps, const int16_t *pi16_x, int i_n){
+    int64_t i64_acc = 1 << 14;
+    for(int k = 0; k < i_taps && k <= i_n; k++){
+        i64_acc += (int64_t)pi16_taps[k] * pi16_x[i_n - k];
+    }
+    i64_acc >>= 15;
+    return (int16_t)(i64_acc > INT16_MAX ? INT16_MAX : i64_acc < INT16_MIN ? INT16_MIN : i64_acc);
+}
+
+//an odd number of taps, in blocks of odd sizes, to the bit
+static void test_fir(void){
+    double ad_coef[7] = {0.05, -0.1, 0.25, 0.5, 0.25, -0.1, 0.049};
+    int16_t ai16_taps[7];
+    for(int i = 0; i < 7; i++){
+        ai16_taps[i] = (int16_t)lround(ad_coef[i] * 32768);
+    }
+    filt_fir_q15 s_filt;
+    CHECK(filt_fir_q15_init(&s_filt, 7, ad_coef));
+    CHECK_EQ(s_filt.u8_taps, 8);
+    //an impulse gives the taps back in order
+    for(int i = 0; i < 10; i++){
+        ai16_in[i] = i == 0 ? INT16_MAX : 0;
+    }
+    filt_fir_q15_block(&s_filt, ai16_in, ai16_out, 10);
+    for(int i = 0; i < 7; i++){
+        CHECK(abs(ai16_out[i] - ai16_taps[i]) <= 1);
+    }
+    CHECK_EQ(ai16_out[7], 0);
+
+    CHECK(filt_fir_q15_init(&s_filt, 7, ad_coef));
+    srand(3);
+    for(int i = 0; i < BLOCK; i++){
+        ai16_in[i] = (int16_t)(rand() % 65536 - 32768);
+    }
+    int i_done = 0;
+    for(int i_size = 1; i_done < BLOCK; i_size += 2){
+        int i_n = i_done + i_size > BLOCK ? BLOCK - i_done : i_size;
+        filt_fir_q15_block(&s_filt, &ai16_in[i_done], &ai16_out[i_done], (uint32_t)i_n);
+        i_done += i_n;
+    }
+    int i_wrong = 0;
+    for(int i = 0; i < BLOCK; i++){
+        i_wrong += ai16_out[i] != reference_fir(ai16_taps, 7, ai16_in, i);
+    }
+    CHECK_EQ(i_wrong, 0);
+}
+
+static void test_fir_limits(void){
+    filt_fir_q15 s_filt;
+    double ad_full[FILT_FIR_MAX_TAPS + 1];
+    for(int i = 0; i <= FILT_FIR_MAX_TAPS; i++){
+        ad_full[i] = 1.0 / (FILT_FIR_MAX_TAPS + 1);
+    }
+    CHECK(filt_fir_q15_init(&s_filt, FILT_FIR_MAX_TAPS, ad_full));
+    CHECK(!filt_fir_q15_init(&s_filt, FILT_FIR_MAX_TAPS + 1, ad_full));
+    CHECK(!filt_fir_q15_init(&s_filt, 0, ad_full));
+    double ad_one[1] = {1.0};
+    CHECK(!filt_fir_q15_init(&s_filt, 1, ad_one));
+    double ad_big[3] = {0.9, -0.9, 0.3};
+    CHECK(!filt_fir_q15_init(&s_filt, 3, ad_big));
+    //that leaves it passing samples through
+    ai16_in[0] = 1000;
+    ai16_in[1] = -20000;
+    filt_fir_q15_block(&s_filt, ai16_in, ai16_out, 2);
+    CHECK_EQ(ai16_out[0], 1000);
+    CHECK_EQ(ai16_out[1], -20000);
+}
+
+static void test_moving_average(void){
+    filt_ma_q15 s_filt;
+    filt_ma_q15_init(&s_filt, 4, 100);
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 100), 100);
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 102), 101);     // 402 / 4, 100.5 rounds up
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 0), 76);
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 0), 51);        // 202 / 4
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 0), 26);        // 102 / 4
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 0), 0);
+    //the same below 0
+    filt_ma_q15_init(&s_filt, 4, -100);
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, -102), -101);
+    //full scale either way, in place, over many wraps
+    filt_ma_q15_init(&s_filt, FILT_MA_MAX_LEN, 0);
+    for(int i = 0; i < BLOCK; i++){
+        ai16_out[i] = INT16_MIN;
+    }
+    filt_ma_q15_block(&s_filt, ai16_out, ai16_out, BLOCK);
+    CHECK_EQ(ai16_out[FILT_MA_MAX_LEN - 2], -32256);
+    CHECK_EQ(ai16_out[BLOCK - 1], INT16_MIN);
+    filt_ma_q15_init(&s_filt, 0, 5);
+    CHECK_EQ(s_filt.u8_len, 1);
+    CHECK_EQ(filt_ma_q15_sample(&s_filt, 7), 7);
+    filt_ma_q15_init(&s_filt, 200, 5);
+    CHECK_EQ(s_filt.u8_len, FILT_MA_MAX_LEN);
+}
+
+//the design's gain at DC, at the cutoff and an octave above
+static double design_gain(const double *pd_coef, double d_w){
+    double d_bRe = pd_coef[0] + pd_coef[1] * cos(d_w) + pd_coef[2] * cos(2 * d_w);
+    double d_bIm = -pd_coef[1] * sin(d_w) - pd_coef[2] * sin(2 * d_w);
+    double d_aRe = 1 + pd_coef[3] * cos(d_w) + pd_coef[4] * cos(2 * d_w);
+    double d_aIm = -pd_coef[3] * sin(d_w) - pd_coef[4] * sin(2 * d_w);
+    return sqrt((d_bRe * d_bRe + d_bIm * d_bIm) / (d_aRe * d_aRe + d_aIm * d_aIm));
+}
+
+static void test_design(void){
+    double ad_coef[5];
+    filt_design_lowpass(ad_coef, 1000, 48000, 0.70710678);
+    CHECK(fabs(design_gain(ad_coef, 0) - 1) < 1e-12);
+    CHECK(fabs(design_gain(ad_coef, 2 * M_PI * 1000 / 48000) - 0.70710678) < 1e-6);
+    //12 dB an octave
+    CHECK(fabs(design_gain(ad_coef, 2 * M_PI * 8000 / 48000) - 1.0 / 64) < 0.004);
+}
+
+int main(void){
+    test_instructions();
+    test_biquad_q15();
+    test_biquad_q15_dc();
+    test_biquad_q15_saturates();
+    test_biquad_q31();
+    test_fir();
+    test_fir_limits();
+    test_moving_average();
+    test_design();
+    return UNIT_RESULT();
+}
@@ -0,0 +1,35 @@
+/**
+ * lm45.h, the fixed-point conversion against the float one.
+ */
+#include <math.h>
+#include "unit.h"
+#include "picoedub.h"
+#include "lm45.h"
+
+static void test_fixed_matches_float(void){
+    //every 12-bit code, rounding the float result gives the fixed one to within 1 tenth
+    float f_worst = 0;
+    for(uint32_t u32_raw = 0; u32_raw < LM45_ADC_COUNTS; u32_raw++){
+        float f_tenths = lm45_raw_to_degF((uint16_t)u32_raw) * 10.0f;
+        float f_error = fabsf((float)lm45_raw_to_tenthsF((uint16_t)u32_raw) - f_tenths);
+        if(f_error > f_worst){
+            f_worst = f_error;
+        }
+    }
+    printf("worst fixed vs float error %.3f tenths\n", f_worst);
+    CHECK(f_worst <= 0.5f + 0.01f);
+}
+
+static void test_known_points(void){
+    //0 V is 32 deg F plus the calibration
+    CHECK_EQ(lm45_raw_to_tenthsF(0), 251);
+    //310 counts is 249.8 mV, 24.98 deg C, 76.96 deg F, less 6.9
+    CHECK_EQ(lm45_raw_to_tenthsF(310), 701);
+    CHECK(fabsf(lm45_raw_to_degF(310) - 70.06f) < 0.01f);
+}
+
+int main(void){
+    test_fixed_matches_float();
+    test_known_points();
+    return UNIT_RESULT();
+}
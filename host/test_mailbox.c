@@ -0,0 +1,193 @@
+/**
+ * mailbox.c, the latest-value mailbox. A read is run with a write landing
+ * at each of its instruction boundaries (preempt.c), as ADC_callback would,
+ * and then with a writer thread standing in for the other core. Every
+ * record written has all of its words made from one number, so a copy
+ * mixing two writes shows.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "unit.h"
+#include "mailbox.h"
+#include "preempt.h"
+
+#define MAILBOX_THREAD_WRITES 1000000u
+
+typedef struct {
+    uint32_t u32_n;
+    uint32_t u32_not;
+    uint32_t u32_times3;
+    uint32_t u32_mixed;
+} test_record_t;
+
+static mailbox s_box;
+static test_record_t s_readRecord;
+static uint32_t u32_readSeq;
+static uint32_t u32_isrN;
+
+static test_record_t make_record(uint32_t u32_n){
+    test_record_t s_record = {u32_n, ~u32_n, u32_n * 3u, u32_n ^ 0xA5A5A5A5u};
+    return s_record;
+}
+
+static bool record_whole(const test_record_t *ps_record){
+    test_record_t s_expected = make_record(ps_record->u32_n);
+    return ps_record->u32_not == s_expected.u32_not && ps_record->u32_times3 == s_expected.u32_times3 &&
+           ps_record->u32_mixed == s_expected.u32_mixed;
+}
+
+static void test_first_read(void){
+    CHECK(mailbox_init(&s_box, sizeof(test_record_t)));
+    CHECK_EQ(s_box.u32_words, 4);
+    test_record_t s_record = make_record(77);
+    //nothing written yet reads as zeros, with 0 writes
+    CHECK_EQ(mailbox_read(&s_box, &s_record), 0);
+    CHECK_EQ(s_record.u32_n, 0);
+    CHECK_EQ(s_record.u32_mixed, 0);
+    CHECK_EQ(mailbox_writes(&s_box), 0);
+}
+
+static void test_latest_wins(void){
+    mailbox_init(&s_box, sizeof(test_record_t));
+    test_record_t s_record;
+    for(uint32_t u32_n = 1; u32_n <= 5; u32_n++){
+        s_record = make_record(u32_n);
+        mailbox_write(&s_box, &s_record);
+    }
+    CHECK_EQ(mailbox_writes(&s_box), 5);
+    CHECK_EQ(mailbox_read(&s_box, &s_record), 5);
+    CHECK_EQ(s_record.u32_n, 5);
+    CHECK(record_whole(&s_record));
+    //reading again gives the same one, the count says it is not new
+    CHECK_EQ(mailbox_read(&s_box, &s_record), 5);
+    CHECK_EQ(s_box.u32_retries, 0);
+}
+
+//a record smaller than the mailbox, as the LM45 app's, only copies its own words
+static void test_short_record(void){
+    typedef struct {
+        uint32_t u32_timeUs;
+        uint16_t u16_raw;
+        uint8_t u8_channel;
+    } sample_t;
+    sample_t s_in = {123456, 2048, 2};
+    uint32_t au32_out[MAILBOX_WORDS] = {9, 9, 9, 9};
+    CHECK(mailbox_init(&s_box, sizeof(sample_t)));
+    CHECK_EQ(s_box.u32_words, 2);
+    mailbox_write(&s_box, &s_in);
+    CHECK_EQ(mailbox_read(&s_box, au32_out), 1);
+    sample_t *ps_out = (sample_t *)au32_out;
+    CHECK_EQ(ps_out->u32_timeUs, 123456);
+    CHECK_EQ(ps_out->u16_raw, 2048);
+    CHECK_EQ(ps_out->u8_channel, 2);
+    CHECK_EQ(au32_out[2], 9);
+    CHECK_EQ(au32_out[3], 9);
+}
+
+//a record bigger than the mailbox is refused, not cut short
+static void test_too_big(void){
+    uint32_t au32_in[MAILBOX_WORDS + 1] = {1, 2, 3, 4, 5};
+    uint32_t au32_out[MAILBOX_WORDS + 1] = {9, 9, 9, 9, 9};
+    CHECK(!mailbox_init(&s_box, sizeof(au32_in)));
+    CHECK_EQ(s_box.u32_words, 0);
+    mailbox_write(&s_box, au32_in);
+    mailbox_read(&s_box, au32_out);
+    CHECK_EQ(au32_out[0], 9);
+    CHECK_EQ(s_box.au32_data[0], 0);
+}
+
+static void preempt_read(void){
+    u32_readSeq = mailbox_read(&s_box, &s_readRecord);
+}
+
+static void preempt_write(void){
+    test_record_t s_record = make_record(++u32_isrN);
+    mailbox_write(&s_box, &s_record);
+}
+
+static void preempt_start(void){
+    mailbox_init(&s_box, sizeof(test_record_t));
+    u32_isrN = 0;
+    preempt_write();
+}
+
+//a write at every boundary of a read, the read must come back with one of the two whole
+static void test_write_during_read(void){
+    if(!preempt_supported()){
+        printf("no single stepping here, skipped the boundary test\n");
+        return;
+    }
+    preempt_start();
+    uint32_t u32_steps = preempt_count(preempt_read);
+    CHECK(u32_steps > 10);
+    uint32_t u32_retried = 0;
+    for(uint32_t u32_point = 0; u32_point <= u32_steps; u32_point++){
+        preempt_start();
+        preempt_run(preempt_read, preempt_write, &u32_point, 1);
+        CHECK_EQ(preempt_taken(), 1);
+        CHECK(record_whole(&s_readRecord));
+        CHECK(s_readRecord.u32_n == 1 || s_readRecord.u32_n == 2);
+        CHECK_EQ(u32_readSeq, s_readRecord.u32_n);
+        u32_retried += s_box.u32_retries;
+    }
+    //a write that landed between the two reads of the count made some start over
+    CHECK(u32_retried > 0);
+}
+
+static void *mailbox_writer(void *pv_arg){
+    (void)pv_arg;
+    for(uint32_t u32_n = 1; u32_n <= MAILBOX_THREAD_WRITES; u32_n++){
+        test_record_t s_record = make_record(u32_n);
+        mailbox_write(&s_box, &s_record);
+        //let the reader in now and then on one CPU, the scheduler does the rest
+        if((u32_n & 0xFFF) == 0){
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_two_threads(void){
+    mailbox_init(&s_box, sizeof(test_record_t));
+    pthread_t s_thread;
+    pthread_create(&s_thread, NULL, mailbox_writer, NULL);
+    test_record_t s_record;
+    uint32_t u32_last = 0;
+    uint32_t u32_torn = 0;
+    uint32_t u32_wrongSeq = 0;
+    uint32_t u32_backwards = 0;
+    uint32_t u32_reads = 0;
+    while(u32_last < MAILBOX_THREAD_WRITES){
+        uint32_t u32_seq = mailbox_read(&s_box, &s_record);
+        u32_reads++;
+        //before the first write it is the zeros from mailbox_init()
+        if(u32_seq != 0 && !record_whole(&s_record)){
+            u32_torn++;
+        }
+        if(u32_seq != s_record.u32_n){
+            u32_wrongSeq++;
+        }
+        if(u32_seq < u32_last){
+            u32_backwards++;
+        }
+        u32_last = u32_seq;
+        if((u32_reads & 0xFFF) == 0){
+            sched_yield();
+        }
+    }
+    pthread_join(s_thread, NULL);
+    CHECK_EQ(u32_torn, 0);
+    CHECK_EQ(u32_wrongSeq, 0);
+    CHECK_EQ(u32_backwards, 0);
+    CHECK_EQ(mailbox_writes(&s_box), MAILBOX_THREAD_WRITES);
+}
+
+int main(void){
+    test_first_read();
+    test_latest_wins();
+    test_short_record();
+    test_too_big();
+    test_write_during_read();
+    test_two_threads();
+    return UNIT_RESULT();
+}
@@ -0,0 +1,128 @@
+/**
+ * spsc.c, the ring between the two cores. The last test runs a producer
+ * and a consumer thread against each other, as core 1 and core 0 would.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "unit.h"
+#include "spsc.h"
+
+#define SPSC_THREAD_ITEMS 2000000u
+
+static spsc_ring s_ring;
+
+static void test_fifo_order_and_wrap(void){
+    spsc_init(&s_ring);
+    CHECK(spsc_isEmpty(&s_ring));
+
+    //three passes over the ring so both indices wrap
+    bool b_wasEmpty = false;
+    uint32_t u32_out = 0;
+    for(uint32_t u32_i = 0; u32_i < 3 * SPSC_SIZE; u32_i++){
+        CHECK(spsc_push(&s_ring, u32_i * 7u, &b_wasEmpty));
+        CHECK(b_wasEmpty);
+        CHECK(spsc_pop(&s_ring, &u32_out));
+        CHECK_EQ(u32_out, u32_i * 7u);
+    }
+    CHECK(spsc_isEmpty(&s_ring));
+    CHECK_EQ(s_ring.u32_highWater, 1);
+}
+
+static void test_empty_pop(void){
+    spsc_init(&s_ring);
+    uint32_t u32_out = 1234;
+    CHECK(!spsc_pop(&s_ring, &u32_out));
+    CHECK_EQ(u32_out, 1234);
+    CHECK_EQ(spsc_count(&s_ring), 0);
+}
+
+static void test_full_drops(void){
+    spsc_init(&s_ring);
+    bool b_wasEmpty = true;
+    for(uint32_t u32_i = 0; u32_i < SPSC_SIZE + 5; u32_i++){
+        bool b_pushed = spsc_push(&s_ring, u32_i, &b_wasEmpty);
+        CHECK_EQ(b_pushed, u32_i < SPSC_SIZE);
+        CHECK_EQ(b_wasEmpty, u32_i == 0);
+    }
+    CHECK_EQ(spsc_count(&s_ring), SPSC_SIZE);
+    CHECK_EQ(s_ring.u32_drops, 5);
+    CHECK_EQ(s_ring.u32_highWater, SPSC_SIZE);
+
+    //the oldest items are the ones kept, and a NULL flag is allowed
+    uint32_t u32_out = 0;
+    CHECK(spsc_pop(&s_ring, &u32_out));
+    CHECK_EQ(u32_out, 0);
+    CHECK(spsc_push(&s_ring, 99, NULL));
+    for(uint32_t u32_i = 1; u32_i < SPSC_SIZE; u32_i++){
+        CHECK(spsc_pop(&s_ring, &u32_out));
+        CHECK_EQ(u32_out, u32_i);
+    }
+    CHECK(spsc_pop(&s_ring, &u32_out));
+    CHECK_EQ(u32_out, 99);
+    CHECK(spsc_isEmpty(&s_ring));
+}
+
+//the indices are free running, so they wrap the 32 bits too
+static void test_index_wrap(void){
+    spsc_init(&s_ring);
+    s_ring.u32_head = UINT32_MAX - 2;
+    s_ring.u32_tail = UINT32_MAX - 2;
+    uint32_t u32_out = 0;
+    for(uint32_t u32_i = 0; u32_i < 6; u32_i++){
+        CHECK(spsc_push(&s_ring, u32_i, NULL));
+    }
+    CHECK_EQ(spsc_count(&s_ring), 6);
+    for(uint32_t u32_i = 0; u32_i < 6; u32_i++){
+        CHECK(spsc_pop(&s_ring, &u32_out));
+        CHECK_EQ(u32_out, u32_i);
+    }
+    CHECK(spsc_isEmpty(&s_ring));
+}
+
+static void *spsc_producer(void *pv_arg){
+    (void)pv_arg;
+    for(uint32_t u32_i = 0; u32_i < SPSC_THREAD_ITEMS; ){
+        //a full ring is a drop on the Pico, here the producer waits so every item arrives
+        if(spsc_count(&s_ring) < SPSC_SIZE && spsc_push(&s_ring, u32_i, NULL)){
+            u32_i++;
+        }
+        else{
+            //on one CPU the consumer only runs once this thread gives way
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_two_threads(void){
+    spsc_init(&s_ring);
+    pthread_t s_thread;
+    pthread_create(&s_thread, NULL, spsc_producer, NULL);
+    uint32_t u32_expected = 0;
+    uint32_t u32_out = 0;
+    uint32_t u32_wrong = 0;
+    while(u32_expected < SPSC_THREAD_ITEMS){
+        if(spsc_pop(&s_ring, &u32_out)){
+            if(u32_out != u32_expected){
+                u32_wrong++;
+            }
+            u32_expected = u32_out + 1;
+        }
+        else{
+            sched_yield();
+        }
+    }
+    pthread_join(s_thread, NULL);
+    CHECK_EQ(u32_wrong, 0);
+    CHECK_EQ(s_ring.u32_drops, 0);
+    CHECK(spsc_isEmpty(&s_ring));
+}
+
+int main(void){
+    test_fifo_order_and_wrap();
+    test_empty_pop();
+    test_full_drops();
+    test_index_wrap();
+    test_two_threads();
+    return UNIT_RESULT();
+}
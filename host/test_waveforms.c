@@ -0,0 +1,63 @@
+/**
+ * sine_step.h and triangle_step.h, the MCP4725 apps' waveform stepping.
+ */
+#include "unit.h"
+#include "sinusoidal_wave/sine_step.h"
+#include "triangle_wave/triangle_step.h"
+
+static void test_sine_stays_in_table(void){
+    for(uint16_t u16_step = 1; u16_step <= 255; u16_step++){
+        uint16_t u16_index = 0;
+        uint32_t u32_total = 0;
+        for(uint32_t u32_i = 0; u32_i < 2 * SINE_TABLE_SIZE; u32_i++){
+            uint16_t u16_next = sine_step(u16_index, (uint8_t)u16_step);
+            CHECK(u16_next < SINE_TABLE_SIZE);
+            //the phase carries over, it does not restart at 0
+            u32_total += u16_step;
+            CHECK_EQ(u16_next, u32_total % SINE_TABLE_SIZE);
+            u16_index = u16_next;
+        }
+    }
+    //the last entry is reached, 512 is not
+    CHECK_EQ(sine_step(SINE_TABLE_SIZE - 2, 1), SINE_TABLE_SIZE - 1);
+    CHECK_EQ(sine_step(SINE_TABLE_SIZE - 1, 1), 0);
+}
+
+static void test_triangle_stays_in_range(void){
+    for(uint16_t u16_step = 1; u16_step <= 255; u16_step++){
+        int16_t i16_code = 0;
+        bool b_down = false;
+        bool b_sawTop = false;
+        bool b_sawBottom = false;
+        uint32_t u32_steps = 3 * (2 * TRIANGLE_MAX_CODE / u16_step + 2);
+        for(uint32_t u32_i = 0; u32_i < u32_steps; u32_i++){
+            uint16_t u16_code = triangle_step(&i16_code, &b_down, (uint8_t)u16_step);
+            CHECK(u16_code <= TRIANGLE_MAX_CODE);
+            b_sawTop |= (u16_code == TRIANGLE_MAX_CODE);
+            b_sawBottom |= (u16_code == 0);
+        }
+        CHECK(b_sawTop);
+        CHECK(b_sawBottom);
+    }
+}
+
+static void test_triangle_turns_around(void){
+    int16_t i16_code = TRIANGLE_MAX_CODE - 10;
+    bool b_down = false;
+    CHECK_EQ(triangle_step(&i16_code, &b_down, 37), TRIANGLE_MAX_CODE);
+    CHECK(b_down);
+    CHECK_EQ(triangle_step(&i16_code, &b_down, 37), TRIANGLE_MAX_CODE - 37);
+
+    i16_code = 10;
+    b_down = true;
+    CHECK_EQ(triangle_step(&i16_code, &b_down, 37), 0);
+    CHECK(!b_down);
+    CHECK_EQ(triangle_step(&i16_code, &b_down, 37), 37);
+}
+
+int main(void){
+    test_sine_stays_in_table();
+    test_triangle_stays_in_range();
+    test_triangle_turns_around();
+    return UNIT_RESULT();
+}
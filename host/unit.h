@@ -0,0 +1,36 @@
+/**
+ * Minimal unit test checks for the host build.
+ *
+ * A failed check prints where it was and the test carries on, so one run
+ * shows every failure. UNIT_RESULT() is the exit code for main.
+ */
+#ifndef UNIT_H
+#define UNIT_H
+
+#include <stdio.h>
+
+static int i_unitFailures = 0;
+static int i_unitChecks = 0;
+
+#define CHECK(cond) do { \
+    i_unitChecks++; \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        i_unitFailures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    long long ll_actual = (long long)(actual); \
+    long long ll_expected = (long long)(expected); \
+    i_unitChecks++; \
+    if (ll_actual != ll_expected) { \
+        printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, ll_actual, ll_expected); \
+        i_unitFailures++; \
+    } \
+} while (0)
+
+#define UNIT_RESULT() \
+    (printf("%d checks, %d failed\n", i_unitChecks, i_unitFailures), i_unitFailures == 0 ? 0 : 1)
+
+#endif
@@ -13,12 +13,21 @@
 #include "pico/stdlib.h"
 #include "picoedub.h"
 #include "hardware/uart.h"
-#include "circular_buffer.h"
+#include "led_pwm.h"
+#include "isr_prof.h"
+#include "stats.h"
+#include "stack_paint.h"
+#include "edub_ram.h"
+#include "edub_irq.h"
+#include "sine_step.h"
 #include "hardware/irq.h"
-#include "hardware/timer.h"
 #include "hardware/watchdog.h"
 #include "hardware/i2c.h"
+#include "hardware/xip_cache.h"
 #include "pico/binary_info.h"
+#ifdef EDUB_DAC_PUMP
+#include "dac_pump.h"
+#endif
 
 // Here I create the values that will configure UART
 #define UART_ID uart0
@@ -33,47 +42,11 @@
 #define UART_TX_PIN 0
 #define UART_RX_PIN 1
 
-// The function below allows me to access clock time 
-// to use in the timer.
-
-static uint64_t get_time(void) {
-    // Reading low latches the high value
-    uint32_t lo = timer_hw->timelr;
-    uint32_t hi = timer_hw->timehr;
-
-    //We return the value of the running clock
-    //to be used in our timer ISR
-    return ((uint64_t) hi << 32u) | lo;
-}
-
-// Use alarm 0. Like the above UART values, this configures my timers
-#define ALARM_NUM 0
-#define ALARM_IRQ timer_hardware_alarm_get_irq_num(timer_hw, ALARM_NUM)
-
-// This global variable holds the state of the led. It is off in the beginning
-bool b_led_flag = 0;
-
-// This global variable controls the length of my timer and the period 
-// of the LED toggling. It's set to a millisecond (half on, half off)
-uint16_t u16_period = 10;
-
-static void alarm_irq(void) {
-    // Clear the alarm irq
-    hw_clear_bits(&timer_hw->intr, 1u << ALARM_NUM);
-    
-    // Here I toggle and set the LED
-    b_led_flag = !b_led_flag;
-    pico_set_led(b_led_flag);
-    
-    // This computes the next clock intstance at which the
-    // alarm will "fire". The 500 * modifies u16_period to fit 
-    // the how the alarm works
-    uint64_t target = timer_hw->timerawl + (500 * u16_period);
-
-    // Write the lower 32 bits of the target time to the alarm which
-    // will arm it
-    timer_hw->alarm[ALARM_NUM] = (uint32_t) target;
-}
+// Period of the heartbeat on the pico LED. The pattern runs from
+// PWM and DMA (led_pwm.c), so it takes no interrupts away from the DAC.
+// In ms. The old alarm ISR toggled the LED every 5 ms, a 10 ms period
+// that looked like a dim steady light; this is a visible 1 s heartbeat.
+uint16_t u16_period = 1000;
 
 // Here I initialize my two circular buffers
 // as well as pointers to refer them through
@@ -93,10 +66,32 @@ volatile uint8_t u8_read_or_write = 0;
 uint8_t u8_ch;
 uint8_t *pu8_ch = &u8_ch;
 
-void on_uart_rx() {
-    //I made the uart ISR a critical region to prevent
-    //potential race conditions with the variable u8_read_or_write.
-    uint32_t u32_register = save_and_disable_interrupts(); 
+// Typing "S" prints the counters from stats.c and "M" the stack and RAM use
+char ac_statsLine[STATS_LINE_SIZE];
+char ac_stackLine[STACK_PAINT_LINE_SIZE];
+
+// ISR profiler. Typing "P" dumps it and "R" clears it.
+uint8_t u8_profUart;
+bool b_profDump = false;
+char ac_profLine[ISR_PROF_LINE_SIZE];
+
+// Typing "X" toggles emptying the XIP cache every loop, so the ISR
+// always starts cold and the profiler shows its worst case
+bool b_coldCache = false;
+
+#ifdef EDUB_DAC_PUMP
+// With the core 1 pump, "+" and "-" only set this and the main loop
+// hands the pump the new period once it can take one
+bool b_pumpRefill = true;
+char ac_pumpLine[DAC_PUMP_LINE_SIZE];
+#endif
+
+void EDUB_RAM_FUNC(on_uart_rx)() {
+    //No critical region around the whole ISR. The main loop cannot run
+    //while it does, and no ISR above it touches u8_read_or_write, so
+    //turning every interrupt off only held up the ones above it. The
+    //buffers guard themselves (cb.c).
+    uint32_t u32_profStart = ISR_PROF_ENTER();
 
     //This is when I've decided to update my watchdog, so 
     //if nobody types anything for the alloted time, the 
@@ -105,19 +100,20 @@ void on_uart_rx() {
 
     if(!u8_read_or_write){
         u8_ch = uart_getc(UART_ID); //if I'm receiving, i get the value and place
-        cb_push(p_cb_in, pu8_ch);   //it in the appropriate buffer
+        cb_push_back(p_cb_in, (char *)pu8_ch);   //it in the appropriate buffer
+        stats_inc(STAT_UART_RX);
     }
     else {
-        if(!cb_is_empty(p_cb_out)){         //if I am sending, I pop my buffer after being 
-            cb_pop_next(p_cb_out, pu8_ch);  //sure it's not empty and output it to uart
+        if(!cb_isEmpty(p_cb_out)){         //if I am sending, I pop my buffer after being 
+            cb_pop_front(p_cb_out, (char *)pu8_ch);  //sure it's not empty and output it to uart
             uart_putc(UART_ID, u8_ch);
+            stats_inc(STAT_UART_TX);
         }
         u8_read_or_write = 0;                       //Here I reassign my variable so that the isr
         uart_set_irq_enables(UART_ID, true, false); //will receive, and I disable the TX interrupt.
     }
 
-    //end critical region
-    restore_interrupts(u32_register);
+    isr_prof_exit(u8_profUart, u32_profStart);
 }
 
 //This function will control the DAC's output via i2c
@@ -127,13 +123,35 @@ bool DACInput(uint16_t inputCode);
 void printIntro();
 
 //The array is essentially a table with values in an order
-//that will represent a sinusoidal via the DAC
-const uint16_t DACLookupSineWave[512];
+//that will represent a sinusoidal via the DAC. With ISR_IN_RAM
+//it is in SRAM too, so a new sample never waits on the flash.
+extern const uint16_t EDUB_RAM_DATA DACLookupSineWave[SINE_TABLE_SIZE];
+
+#ifdef EDUB_DAC_PUMP
+//a period at a step of 1 is the whole table, and it has to fit in a pump buffer
+_Static_assert(SINE_TABLE_SIZE <= DAC_PUMP_MAX_SAMPLES, "one sine period does not fit in a pump buffer");
+
+//One period of the output for the pump: the table stepped by count from
+//index 0 until the index comes back to 0, at most the whole table and never
+//more than the u16_capacity samples pu16_buf holds
+uint16_t fillPeriod(uint16_t *pu16_buf, uint16_t u16_capacity, uint8_t count){
+    uint16_t u16_len = 0;
+    uint16_t state = 0;
+    do {
+        pu16_buf[u16_len++] = DACLookupSineWave[state];
+        state = sine_step(state, count);
+    } while(state != 0 && u16_len < u16_capacity);
+    return u16_len;
+}
+#endif
 
 int main() {
+    //Painting the stacks comes first so the high-water marks include all of init
+    stack_paint();
+
     //I run my general initializations
     stdio_init_all();
-    edub_init();
+    edub_gpio_init();
 
     //I initialize the watchdog for 10 seconds.
     watchdog_enable(10000, 1);
@@ -168,8 +186,13 @@ int main() {
     // Select correct interrupts for the UART we are using
     int UART_IRQ = UART_ID == uart0 ? UART0_IRQ : UART1_IRQ;
 
+    // The profiler has to know the ISR before it can run
+    isr_prof_init();
+    u8_profUart = isr_prof_register("on_uart_rx");
+
     // Set up and enable the interrupt handlers
     irq_set_exclusive_handler(UART_IRQ, on_uart_rx);
+    edub_irq_set_priority(UART_IRQ, EDUB_IRQ_PRIO_IO);
 
     //irq_set_exclusive_handler(UART_IRQ, on_uart_tx);
     irq_set_enabled(UART_IRQ, true);
@@ -177,30 +200,24 @@ int main() {
     // Enable the UART to send interrupts for RX and TX
     uart_set_irq_enables(UART_ID, true, false); // Enable both RX and TX interrupts
 
-    // Enable the interrupt for our alarm (the timer outputs 4 alarm irqs)
-    hw_set_bits(&timer_hw->inte, 1u << ALARM_NUM);
-
-    // Set irq handler for alarm irq
-    irq_set_exclusive_handler(ALARM_IRQ, alarm_irq);
-
-    // Enable the alarm irq
-    irq_set_enabled(ALARM_IRQ, true);
-
-    // This is the first time the alarmed will be armed.
-    // Afterwards, it'll be alarmed through the isr.
-    // Alarm is only 32 bits so if trying to delay more
-    // than that need to be careful and keep track of the upper
-    // bits
-    uint64_t target = timer_hw->timerawl + (500 * u16_period);
-
-    // Write the lower 32 bits of the target time to the alarm which
-    // will arm it
-    timer_hw->alarm[ALARM_NUM] = (uint32_t) target;
+    // Heartbeat on the pico LED. LED0 and LED1 share the UART pins.
+    led_init(LED_MASK(LED_PICO));
+    led_set_pattern(LED_PICO, LED_PATTERN_HEARTBEAT, u16_period);
 
     // I initialize both circular buffers
     cb_init(p_cb_in);
     cb_init(p_cb_out);
 
+    // Counters, including the drops and high-water marks of both buffers
+    stats_init();
+    stats_add_buffer("in", &cb_in.u32_drops, &cb_in.u32_highWater);
+    stats_add_buffer("out", &cb_out.u32_drops, &cb_out.u32_highWater);
+
+#ifdef EDUB_DAC_PUMP
+    //From here on only core 1 touches the I2C bus and the DAC
+    dac_pump_launch(DACInput);
+#endif
+
     //I output a little explanation of the program
     //via UART.
     printIntro();
@@ -210,13 +227,17 @@ int main() {
     //of the signal.
     uint8_t count = 1;
 
+#ifndef EDUB_DAC_PUMP
     //This marks what index in the table we will be referecing.
+    //The pump keeps its own, see fillPeriod().
     uint16_t state = 0;
+#endif
 
     while (1) {
+        stats_loop();
 
-        if(!cb_is_empty(p_cb_in)){          //If my input cb holds values, 
-            cb_pop_next(p_cb_in, pu8_ch);   //we pop the next one
+        if(!cb_isEmpty(p_cb_in)){          //If my input cb holds values, 
+            cb_pop_front(p_cb_in, (char *)pu8_ch);   //we pop the next one
 
             //The following if statements check to see if 
             //a "+" or "-" is pressed. It will not print 
@@ -226,20 +247,81 @@ int main() {
             //unnecessary.
             if((*pu8_ch == 43)&&(count != 50)){
                 count += 1;
+#ifdef EDUB_DAC_PUMP
+                b_pumpRefill = true;
+#endif
             }
             else if((*pu8_ch == 45)&&(count != 1)){
                 count -= 1;
+#ifdef EDUB_DAC_PUMP
+                b_pumpRefill = true;
+#endif
+            }
+            else if(*pu8_ch == 'P'){
+                isr_prof_dump_begin();
+                b_profDump = true;
+            }
+            else if(*pu8_ch == 'R'){
+                isr_prof_reset();
+            }
+            else if(*pu8_ch == 'S'){
+                stats_format(ac_statsLine);
+                for(char *pc_ch = ac_statsLine; *pc_ch != '\0'; pc_ch++){
+                    cb_push_back(p_cb_out, pc_ch);
+                }
+#ifdef EDUB_DAC_PUMP
+                dac_pump_format(ac_pumpLine);
+                for(char *pc_ch = ac_pumpLine; *pc_ch != '\0'; pc_ch++){
+                    cb_push_back(p_cb_out, pc_ch);
+                }
+#endif
+            }
+            else if(*pu8_ch == 'M'){
+                stack_format(ac_stackLine);
+                for(char *pc_ch = ac_stackLine; *pc_ch != '\0'; pc_ch++){
+                    cb_push_back(p_cb_out, pc_ch);
+                }
+            }
+            else if(*pu8_ch == 'X'){
+                b_coldCache = !b_coldCache;
+                for(char *pc_ch = b_coldCache ? " XIP COLD " : " XIP WARM "; *pc_ch != '\0'; pc_ch++){
+                    cb_push_back(p_cb_out, pc_ch);
+                }
             }
             else {
-                cb_push(p_cb_out, pu8_ch);
+                cb_push_back(p_cb_out, (char *)pu8_ch);
+            }
+        }
+
+        //The dump goes out a line at a time, once the last line has been sent
+        if(b_profDump && cb_isEmpty(p_cb_out)){
+            b_profDump = isr_prof_dump_next(ac_profLine);
+            for(char *pc_ch = ac_profLine; b_profDump && *pc_ch != '\0'; pc_ch++){
+                cb_push_back(p_cb_out, pc_ch);
             }
         }
 
-        if(!cb_is_empty(p_cb_out)){                     //if the output buffer isn't empty, enable it's IRQ and set the ISR to write
+        if(b_coldCache){
+            xip_cache_invalidate_all();
+        }
+
+        if(!cb_isEmpty(p_cb_out)){                     //if the output buffer isn't empty, enable it's IRQ and set the ISR to write
             u8_read_or_write = 1;                       //through the u8_read_or_write variable
             uart_set_irq_enables(UART_ID, true, true);
         }
 
+#ifdef EDUB_DAC_PUMP
+        //Core 1 writes the samples. A new period only goes in once the
+        //pump has switched to the last one, so a quick run of "+" ends
+        //up at the last setting.
+        if(b_pumpRefill){
+            uint16_t *pu16_period = dac_pump_begin();
+            if(pu16_period != NULL){
+                dac_pump_commit(fillPeriod(pu16_period, DAC_PUMP_MAX_SAMPLES, count));
+                b_pumpRefill = false;
+            }
+        }
+#else
         //I added this function before initiating contact with the 
         //DAC peripheral. If the contact is interrupted by a watchdog
         //reboot, the DAC will get stuck to a value. This prevents that.
@@ -247,20 +329,17 @@ int main() {
             DACInput(DACLookupSineWave[state]);
         }
 
-        //Here I update the index to get from the table.
-        state = state + count;
-
-        //Recycle through the matrix
-        if(state > 512){
-            state = 0;
-        }
+        //Here I update the index to get from the table. It wraps
+        //around the table, so it never reads past the end.
+        state = sine_step(state, count);
+#endif
     }   
 }
 
 //This function transmits information to the DAC. It sets the DAC 
 //to "FastMode" and "PowerDownOff" modes and updates the DAC registers
 //to output a new voltage. 
-bool DACInput(uint16_t inputCode) {
+bool EDUB_RAM_FUNC(DACInput)(uint16_t inputCode) {
 
     //The data buffer var will be sent to the DAC
     uint8_t dataBuffer[2];
@@ -271,8 +350,9 @@ bool DACInput(uint16_t inputCode) {
     //This will be the first
 	uint8_t highByte = 0;
 
-    //This is for error detection
-    uint8_t ReturnCode = 0;
+    //This is for error detection. It has to be signed, the SDK
+    //returns PICO_ERROR_TIMEOUT or PICO_ERROR_GENERIC on failure.
+    int ReturnCode = 0;
 
     //I make the low byte the bottom half of the value passed
     //by the function.
@@ -293,10 +373,17 @@ bool DACInput(uint16_t inputCode) {
 	ReturnCode = i2c_write_timeout_us(i2c_default, 0x60, dataBuffer, 2 , true, 50000);
 
     //I check to make sure the message sent
+	if (ReturnCode == PICO_ERROR_TIMEOUT){
+        stats_inc(STAT_I2C_TIMEOUT);
+		return false;
+	}
 	if (ReturnCode < 1){
+        stats_inc(STAT_I2C_ERROR);
 		return false;
 	}
 
+    stats_inc(STAT_I2C_OK);
+
     return true;
 }
 
@@ -305,12 +392,12 @@ void printIntro(){
     uint8_t au8_message[] = "Welcome to I2C and MCP4725 Demonstration. Press '+' to raise the signal's voltage and '-' to lower it. ";
     
     for(uint8_t i = 0; i < 103; i++){
-        cb_push(p_cb_out, &au8_message[i]);
+        cb_push_back(p_cb_out, (char *)&au8_message[i]);
     }
 }
 
 //This is the table that represents the sinusoid
-const uint16_t DACLookupSineWave[512]  =  
+const uint16_t EDUB_RAM_DATA DACLookupSineWave[SINE_TABLE_SIZE]  =  
 {
 	2048, 2073, 2098, 2123, 2148, 2174, 2199, 2224, 
 	2249, 2274, 2299, 2324, 2349, 2373, 2398, 2423,
@@ -0,0 +1,22 @@
+/**
+ * Stepping through the sine table.
+ *
+ * The table has SINE_TABLE_SIZE entries and the step (the count the user
+ * changes with + and -) sets the frequency. Stepping past the end wraps
+ * around modulo the table size, so the phase carries over into the next
+ * period instead of restarting at 0.
+ */
+#ifndef SINE_STEP_H
+#define SINE_STEP_H
+
+#include <stdint.h>
+
+//must be a power of two, the wrap is a mask
+#define SINE_TABLE_SIZE 512
+
+//next table index, always below SINE_TABLE_SIZE
+static inline uint16_t sine_step(uint16_t u16_index, uint8_t u8_step){
+    return (uint16_t)((u16_index + u8_step) & (SINE_TABLE_SIZE - 1));
+}
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * Stepping the triangle wave.
+ *
+ * The code climbs by the step to full scale, then falls by the step to 0.
+ * The code is clamped at both ends, so it never leaves the DAC's 12 bits.
+ * Without the clamp, a step that does not divide 4095 would overshoot into
+ * the power-down bits or wrap negative.
+ */
+#ifndef TRIANGLE_STEP_H
+#define TRIANGLE_STEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRIANGLE_MAX_CODE 4095
+
+//moves *pi16_code one step and turns around at the ends, returns the new code
+static inline uint16_t triangle_step(int16_t *pi16_code, bool *pb_down, uint8_t u8_step){
+    int16_t i16_code = *pi16_code;
+    if(!*pb_down){
+        i16_code += u8_step;
+    }
+    else {
+        i16_code -= u8_step;
+    }
+
+    if(i16_code >= TRIANGLE_MAX_CODE){
+        i16_code = TRIANGLE_MAX_CODE;
+        *pb_down = true;
+    }
+    else if(i16_code <= 0){
+        i16_code = 0;
+        *pb_down = false;
+    }
+
+    *pi16_code = i16_code;
+    return (uint16_t)i16_code;
+}
+
+#endif
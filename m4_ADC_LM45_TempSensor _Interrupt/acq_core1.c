@@ -0,0 +1,93 @@
+#include "acq_core1.h"
+#include "lm45.h"
+#include "isr_prof.h"
+#include "stats.h"
+#include "adc_capture.h"
+#include "edub_ram.h"
+#include "pico/multicore.h"
+
+spsc_ring acq_ring;
+
+//only the ADC ISR on core 1 touches these
+static uint8_t u8_acqProf;
+static adc_jitter *ps_acqJitter;
+static uint32_t u32_acqSum = 0;
+static uint32_t u32_acqCount = 0;
+
+static void EDUB_RAM_FUNC(acq_adc_isr)(void){
+    uint32_t u32_profStart = ISR_PROF_ENTER();
+    //the stamp, then only what was in the FIFO at it (adc_jitter.h)
+    uint64_t u64_stamp = time_us_64();
+    uint32_t u32_samples = adc_fifo_get_level();
+    uint32_t u32_errors = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+        uint16_t u16_fifo = adc_fifo_get();
+        if(u16_fifo & ADC_FIFO_ERR_BITS){
+            u32_errors++;
+        }
+        u32_acqSum += u16_fifo & ADC_FIFO_VAL_BITS;
+        adc_capture_add(u16_fifo & ADC_FIFO_VAL_BITS);
+        stats_inc(STAT_ADC_SAMPLES);
+        if(++u32_acqCount == ACQ_BLOCK_SAMPLES){
+            uint16_t u16_mean = (uint16_t)((u32_acqSum + ACQ_BLOCK_SAMPLES / 2) / ACQ_BLOCK_SAMPLES);
+            int16_t i16_tenthsF = (int16_t)lm45_raw_to_tenthsF(u16_mean);
+            u32_acqSum = 0;
+            u32_acqCount = 0;
+
+            bool b_wasEmpty = false;
+            uint32_t u32_item = u16_mean | (uint32_t)(uint16_t)i16_tenthsF << 16;
+            //core 0 only waits when it has emptied the ring, so only then
+            //ring. A full FIFO already holds a doorbell, never wait for room.
+            if(spsc_push(&acq_ring, u32_item, &b_wasEmpty) && b_wasEmpty && multicore_fifo_wready()){
+                multicore_fifo_push_blocking(ACQ_DOORBELL);
+            }
+        }
+    }
+    bool b_over = (adc_hw->fcs & ADC_FCS_OVER_BITS) != 0;
+    if(b_over){
+        hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS);
+    }
+    adc_jitter_block(ps_acqJitter, u64_stamp, u32_samples, u32_errors, b_over);
+    isr_prof_exit(u8_acqProf, u32_profStart);
+}
+
+static void acq_core1_main(void){
+    isr_prof_core_init();
+    //the NVIC is per core, enabling the IRQ here is what moves it to core 1
+    irq_set_exclusive_handler(ADC_IRQ_FIFO, acq_adc_isr);
+    irq_set_enabled(ADC_IRQ_FIFO, true);
+    while(true){
+        __wfi();
+    }
+}
+
+void acq_core1_launch(uint8_t u8_profId, adc_jitter *ps_jitter){
+    u8_acqProf = u8_profId;
+    ps_acqJitter = ps_jitter;
+    spsc_init(&acq_ring);
+    multicore_launch_core1(acq_core1_main);
+}
+
+bool acq_wait(uint32_t u32_timeoutUs){
+    uint64_t u64_deadline = time_us_64() + u32_timeoutUs;
+    uint32_t u32_word;
+    //a doorbell can be left over from a record that was taken without
+    //waiting, so one only counts if the ring has something in it
+    while(spsc_isEmpty(&acq_ring)){
+        uint64_t u64_now = time_us_64();
+        if(u64_now >= u64_deadline || !multicore_fifo_pop_timeout_us(u64_deadline - u64_now, &u32_word)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool acq_get(acq_record_t *ps_record){
+    uint32_t u32_item;
+    if(!spsc_pop(&acq_ring, &u32_item)){
+        return false;
+    }
+    ps_record->u16_raw = (uint16_t)u32_item;
+    ps_record->i16_tenthsF = (int16_t)(u32_item >> 16);
+    return true;
+}
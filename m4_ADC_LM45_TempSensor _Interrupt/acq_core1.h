@@ -0,0 +1,60 @@
+/**
+ * ADC capture and filtering on core 1 (-DCORE1_ACQUISITION=ON).
+ *
+ * Core 1 takes ADC_IRQ_FIFO, so a conversion is read out as soon as it is
+ * ready whatever core 0's UART ISR, keypad and printing are doing. Every
+ * ACQ_BLOCK_SAMPLES conversions the ISR averages them (a boxcar, which
+ * also brings the 10 kHz samples down to the rate the main loop prints at),
+ * converts the mean to tenths of a deg F with lm45_raw_to_tenthsF() and
+ * pushes one record into an spsc ring (picoedub/spsc.h). When the ring was
+ * empty it also puts a word in the SIO FIFO, the doorbell acq_wait()
+ * sleeps on. Core 0 keeps the UART, the keypad, the buzzer and the watchdog.
+ *
+ * Each counter in stats.c still has one writer: core 1 counts the ADC
+ * samples, core 0 the records it processed. Core 1 also stamps the blocks
+ * for adc_jitter.c and fills the FFT block (adc_capture.h) when core 0 arms it.
+ *
+ * Usage, on core 0 once the ADC is set up and running:
+ *     acq_core1_launch(u8_profADC, &s_jitter);
+ *     while(true){
+ *         acq_wait(10000);
+ *         while(acq_get(&s_record)){ ... }
+ *     }
+ */
+#ifndef ACQ_CORE1_H
+#define ACQ_CORE1_H
+
+#include "picoedub.h"
+#include "spsc.h"
+#include "adc_jitter.h"
+
+//conversions averaged into one record, 10 ms of them. It was 10, written
+//for a 1 ms ADC period that was really 0.1 ms, so records came every 1 ms.
+#ifndef ACQ_BLOCK_SAMPLES
+#define ACQ_BLOCK_SAMPLES   (ADC_SAMPLE_RATE_HZ / 100)
+#endif
+
+//the word core 1 puts in the SIO FIFO, only its arrival matters
+#define ACQ_DOORBELL        0xACD0u
+
+typedef struct {
+    uint16_t u16_raw;       // mean of the block, 12 bits
+    int16_t i16_tenthsF;    // the same in tenths of a deg F
+} acq_record_t;
+
+//records from core 1 to core 0, for stats_add_buffer()
+extern spsc_ring acq_ring;
+
+//starts core 1, which turns on ADC_IRQ_FIFO on its own NVIC. u8_profId is
+//the isr_prof id its ISR reports under, and it stamps each block into
+//*ps_jitter, which core 1's ISR is then the only writer of.
+void acq_core1_launch(uint8_t u8_profId, adc_jitter *ps_jitter);
+
+//core 0: returns at once if a record is waiting, else sleeps until the
+//doorbell or u32_timeoutUs. False on the timeout.
+bool acq_wait(uint32_t u32_timeoutUs);
+
+//core 0: the oldest record, false when there is none
+bool acq_get(acq_record_t *ps_record);
+
+#endif
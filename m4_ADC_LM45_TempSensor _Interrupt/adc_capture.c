@@ -0,0 +1,29 @@
+#include "adc_capture.h"
+
+int16_t ai16_adcCapture[ADC_FFT_POINTS];
+volatile uint32_t u32_adcCaptureWant = 0;
+volatile uint32_t u32_adcCaptureCount = 0;
+
+bool adc_capture_arm(void){
+    if(u32_adcCaptureWant != 0){
+        return false;
+    }
+    //the count is back at 0 before the ISR can see the block is wanted
+    u32_adcCaptureCount = 0;
+    __dmb();
+    u32_adcCaptureWant = ADC_FFT_POINTS;
+    return true;
+}
+
+bool adc_capture_full(void){
+    if(u32_adcCaptureWant == 0 || u32_adcCaptureCount != u32_adcCaptureWant){
+        return false;
+    }
+    //the samples are read after the count that published them
+    __dmb();
+    return true;
+}
+
+void adc_capture_release(void){
+    u32_adcCaptureWant = 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * A block of raw ADC samples for the FFT (picoedub/fft.h), taken by the
+ * ADC ISR while the rest of the ISR goes on as before.
+ *
+ * The main loop arms it, the ISR (on core 0, or on core 1 with
+ * CORE1_ACQUISITION) copies each conversion in as Q15, (raw - 2048) << 4,
+ * until there are ADC_FFT_POINTS of them, then stops. The loop sees the
+ * count reach the size, runs the FFT over the block in its idle time and
+ * releases it. Nothing is copied twice and neither side waits on the
+ * other: the ISR is the only writer until the block is full, the loop
+ * after. A __dmb() before the count is published orders the samples ahead
+ * of it for the other core, as in picoedub/spsc.c.
+ *
+ * Usage:
+ *     adc_capture_arm();                    // main loop, e.g. on 'F'
+ *     adc_capture_add(u16_raw);             // ADC ISR, every conversion
+ *     if(adc_capture_full()){               // main loop
+ *         fft_real_q15(ai16_adcCapture, ...);
+ *         adc_capture_release();
+ *     }
+ */
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+//samples in a block, a power of 2 from FFT_MIN_POINTS to FFT_MAX_POINTS.
+//1024 at 10 kS/s is 0.1 s, bins of 9.8 Hz.
+#ifndef ADC_FFT_POINTS
+#define ADC_FFT_POINTS 1024
+#endif
+
+extern int16_t ai16_adcCapture[ADC_FFT_POINTS];
+//ADC_FFT_POINTS while armed or full, 0 while idle, only the main loop writes it
+extern volatile uint32_t u32_adcCaptureWant;
+//samples in the block so far, only the ISR writes it while armed
+extern volatile uint32_t u32_adcCaptureCount;
+
+//starts a block, false if one is already being taken or waiting
+bool adc_capture_arm(void);
+
+//ISR: one conversion, 12 bits
+static inline void adc_capture_add(uint16_t u16_raw){
+    uint32_t u32_count = u32_adcCaptureCount;
+    if(u32_count < u32_adcCaptureWant){
+        ai16_adcCapture[u32_count] = (int16_t)(((int32_t)u16_raw - 2048) << 4);
+        __dmb();
+        u32_adcCaptureCount = u32_count + 1;
+    }
+}
+
+//main loop: the block is all there and the ISR has let go of it
+bool adc_capture_full(void);
+
+//main loop: done with the block, the next adc_capture_arm() can go
+void adc_capture_release(void);
+
+#endif
@@ -0,0 +1,101 @@
+#include "adc_jitter.h"
+#include "edub_ram.h"
+#include <stdio.h>
+
+//Q32 us to ns, 2^32 / 1000
+#define ADC_JITTER_Q32_PER_NS 4294967
+//a stamp further than this from the last one is not the same run, ~36 min
+#define ADC_JITTER_MAX_GAP_US 0x7FFFFFFFull
+
+void adc_jitter_init(adc_jitter *ps_jitter, uint64_t u64_periodQ32){
+    ps_jitter->u64_periodQ32 = u64_periodQ32;
+    ps_jitter->u64_lastUs = 0;
+    ps_jitter->i64_phaseQ32 = 0;
+    ps_jitter->i64_minPhaseQ32 = 0;
+    ps_jitter->b_started = false;
+    ps_jitter->u32_blocks = 0;
+    ps_jitter->u32_samples = 0;
+    ps_jitter->i32_minNs = INT32_MAX;
+    ps_jitter->i32_maxNs = INT32_MIN;
+    ps_jitter->u64_sumSqNs = 0;
+    ps_jitter->u32_gaps = 0;
+    ps_jitter->u32_missing = 0;
+    ps_jitter->u32_overs = 0;
+    ps_jitter->u32_errors = 0;
+}
+
+void EDUB_RAM_FUNC(adc_jitter_block)(adc_jitter *ps_jitter, uint64_t u64_nowUs, uint32_t u32_samples, uint32_t u32_errors, bool b_over){
+    ps_jitter->u32_errors += u32_errors;
+    if(b_over){
+        ps_jitter->u32_overs++;
+    }
+    if(u32_samples == 0){
+        return;
+    }
+    ps_jitter->u32_blocks++;
+    ps_jitter->u32_samples += u32_samples;
+    uint64_t u64_intervalUs = u64_nowUs - ps_jitter->u64_lastUs;
+    ps_jitter->u64_lastUs = u64_nowUs;
+    //the first block, or the ADC was stopped for a long time, is the new reference
+    if(!ps_jitter->b_started || u64_intervalUs > ADC_JITTER_MAX_GAP_US || ps_jitter->u64_periodQ32 == 0){
+        ps_jitter->b_started = true;
+        ps_jitter->i64_phaseQ32 = 0;
+        ps_jitter->i64_minPhaseQ32 = 0;
+        return;
+    }
+    int64_t i64_phase = ps_jitter->i64_phaseQ32 + (int64_t)(u64_intervalUs << 32) -
+                        (int64_t)(u32_samples * ps_jitter->u64_periodQ32);
+    //each sample converted and never taken out puts the stamp one more period late
+    int64_t i64_late = i64_phase - ps_jitter->i64_minPhaseQ32;
+    if(i64_late >= (int64_t)ps_jitter->u64_periodQ32){
+        uint32_t u32_missing = (uint32_t)((uint64_t)i64_late / ps_jitter->u64_periodQ32);
+        ps_jitter->u32_gaps++;
+        ps_jitter->u32_missing += u32_missing;
+        i64_phase -= (int64_t)(u32_missing * ps_jitter->u64_periodQ32);
+    }
+    if(i64_phase < ps_jitter->i64_minPhaseQ32){
+        ps_jitter->i64_minPhaseQ32 = i64_phase;
+    }
+
+    //the interval less what its samples (and any missing ones) should have taken
+    int64_t i64_ns = (i64_phase - ps_jitter->i64_phaseQ32) / ADC_JITTER_Q32_PER_NS;
+    ps_jitter->i64_phaseQ32 = i64_phase;
+    int32_t i32_ns = i64_ns > INT32_MAX ? INT32_MAX : i64_ns < -INT32_MAX ? -INT32_MAX : (int32_t)i64_ns;
+    if(i32_ns < ps_jitter->i32_minNs){
+        ps_jitter->i32_minNs = i32_ns;
+    }
+    if(i32_ns > ps_jitter->i32_maxNs){
+        ps_jitter->i32_maxNs = i32_ns;
+    }
+    uint64_t u64_sq = (uint64_t)((int64_t)i32_ns * i32_ns);
+    ps_jitter->u64_sumSqNs = ps_jitter->u64_sumSqNs > UINT64_MAX - u64_sq ? UINT64_MAX : ps_jitter->u64_sumSqNs + u64_sq;
+}
+
+uint32_t adc_jitter_rms_ns(const adc_jitter *ps_jitter){
+    //the first block has no interval
+    if(ps_jitter->u32_blocks < 2){
+        return 0;
+    }
+    uint64_t u64_mean = ps_jitter->u64_sumSqNs / (ps_jitter->u32_blocks - 1);
+    //integer square root, one bit at a time from the top
+    uint64_t u64_root = 0;
+    for(uint64_t u64_bit = 1ull << 62; u64_bit != 0; u64_bit >>= 2){
+        if(u64_mean >= u64_root + u64_bit){
+            u64_mean -= u64_root + u64_bit;
+            u64_root = (u64_root >> 1) + u64_bit;
+        }else{
+            u64_root >>= 1;
+        }
+    }
+    return (uint32_t)u64_root;
+}
+
+void adc_jitter_format(const adc_jitter *ps_jitter, char *pc_line){
+    bool b_any = ps_jitter->u32_blocks >= 2;
+    snprintf(pc_line, ADC_JITTER_LINE_SIZE, "JITTER n=%lu/%lu int=%+ld/%+ld/%luns gap=%lu/%lu over=%lu err=%lu\n\r",
+             (unsigned long)ps_jitter->u32_blocks, (unsigned long)ps_jitter->u32_samples,
+             b_any ? (long)ps_jitter->i32_minNs : 0L, b_any ? (long)ps_jitter->i32_maxNs : 0L,
+             (unsigned long)adc_jitter_rms_ns(ps_jitter),
+             (unsigned long)ps_jitter->u32_gaps, (unsigned long)ps_jitter->u32_missing,
+             (unsigned long)ps_jitter->u32_overs, (unsigned long)ps_jitter->u32_errors);
+}
@@ -0,0 +1,70 @@
+/**
+ * Sample timing analysis: is the ADC rate really being kept up with?
+ *
+ * The ADC ISR stamps each block of samples it takes out of the FIFO with
+ * time_us_64(), then takes out only the samples that were in the FIFO at
+ * that moment. A sample that arrives in between waits for the next ISR.
+ * Every sample in a block was then converted before its stamp, and the one
+ * after it was not. The stamp is at most one period after the last sample.
+ *
+ * The ADC converts on a fixed grid (adc_rate_period_us()), so each stamp
+ * is compared with where the grid says the block's last sample should be:
+ *  - jitter: each stamp-to-stamp interval less the time its samples should
+ *    have taken, as min/max/RMS in ns. The stamps are to 1 us.
+ *  - gaps: a stamp a whole period or more later than the quickest stamp
+ *    so far means samples were converted and never taken out of the FIFO.
+ *    The count of such gaps and of the samples in them.
+ *  - over: ISRs that found FCS.OVER set, the FIFO filled and dropped samples
+ *  - err: samples with the FIFO's ERR bit, a conversion error (needs
+ *    FCS.ERR, err_in_fifo, on)
+ * A rate the board can keep up with has no gaps and no OVER, with jitter
+ * well inside one period.
+ *
+ * One ISR writes it and the main loop only formats it, as with stats.c,
+ * so a reading can be a little old. The expected period is Q32 us.
+ *
+ * Usage, in the ADC ISR:
+ *     uint64_t u64_stamp = time_us_64();
+ *     uint32_t u32_level = adc_fifo_get_level();
+ *     ...take out u32_level samples, counting the ERR bits...
+ *     adc_jitter_block(&s_jitter, u64_stamp, u32_level, u32_errors, b_over);
+ */
+#ifndef ADC_JITTER_H
+#define ADC_JITTER_H
+
+#include "pico/stdlib.h"
+
+#define ADC_JITTER_LINE_SIZE 160
+
+typedef struct adc_jitter
+{
+    uint64_t u64_periodQ32;     // one conversion to the next, us Q32
+    uint64_t u64_lastUs;        // stamp of the last block
+    int64_t i64_phaseQ32;       // the last stamp less where the grid put it
+    int64_t i64_minPhaseQ32;    // the quickest stamp so far, gaps are counted from it
+    bool b_started;
+    uint32_t u32_blocks;
+    uint32_t u32_samples;
+    int32_t i32_minNs;          // shortest interval less the expected one
+    int32_t i32_maxNs;          // longest
+    uint64_t u64_sumSqNs;       // sum of the squares, for the RMS, stops at the top
+    uint32_t u32_gaps;
+    uint32_t u32_missing;       // samples in the gaps
+    uint32_t u32_overs;
+    uint32_t u32_errors;
+} adc_jitter;
+
+//u64_periodQ32 is adc_rate_period_us(), starts over with nothing counted
+void adc_jitter_init(adc_jitter *ps_jitter, uint64_t u64_periodQ32);
+
+//one block, u32_samples taken out of the FIFO after the stamp u64_nowUs
+void adc_jitter_block(adc_jitter *ps_jitter, uint64_t u64_nowUs, uint32_t u32_samples, uint32_t u32_errors, bool b_over);
+
+//RMS jitter in ns
+uint32_t adc_jitter_rms_ns(const adc_jitter *ps_jitter);
+
+//writes the record into pc_line (ADC_JITTER_LINE_SIZE bytes), e.g.
+//  JITTER n=10000/10000 int=-1000/+1000/480ns gap=0/0 over=0 err=0
+void adc_jitter_format(const adc_jitter *ps_jitter, char *pc_line);
+
+#endif
@@ -0,0 +1,134 @@
+#include "buzzer.h"
+#include "picoedub.h"
+#include "edub_irq.h"
+#include "hardware/pwm.h"
+
+//PWM divider is 8.4 fixed point, so it is handled in 1/16ths
+#define BUZZER_DIV16_MIN 16
+#define BUZZER_DIV16_MAX ((255 << 4) | 15)
+#define BUZZER_TOP_MAX   65535
+
+static const buzzer_step_t as_overTempSteps[] = {
+    {2000, 150}, {0, 100},
+    {2000, 150}, {0, 100},
+    {2000, 150}, {0, 800}
+};
+static const buzzer_step_t as_watchdogSteps[] = {
+    {600, 600}, {0, 150}, {2400, 150}, {0, 0}
+};
+static const buzzer_step_t as_chirpSteps[] = {
+    {3000, 60}, {0, 0}
+};
+
+const buzzer_pattern_t buzzer_pattern_overTemp = {as_overTempSteps, count_of(as_overTempSteps), true};
+const buzzer_pattern_t buzzer_pattern_watchdog = {as_watchdogSteps, count_of(as_watchdogSteps), false};
+const buzzer_pattern_t buzzer_pattern_chirp = {as_chirpSteps, count_of(as_chirpSteps), false};
+
+static uint u_buzzerSlice;
+static uint u_buzzerChan;
+static int8_t i8_buzzerAlarmNum = -1;
+
+static const buzzer_pattern_t *volatile ps_playing = NULL;
+static volatile uint8_t u8_step = 0;
+
+uint32_t buzzer_set_tone(uint32_t u32_freqHz, uint8_t u8_dutyPercent){
+    if(u32_freqHz == 0){
+        buzzer_off();
+        return 0;
+    }
+    uint32_t u32_sysHz = clock_get_hz(clk_sys);
+
+    //smallest divider that still lets the wrap fit in 16 bits gives the best resolution
+    uint64_t u64_div16 = ((uint64_t)u32_sysHz * 16 + (uint64_t)u32_freqHz * (BUZZER_TOP_MAX + 1) - 1)
+                         / ((uint64_t)u32_freqHz * (BUZZER_TOP_MAX + 1));
+    if(u64_div16 < BUZZER_DIV16_MIN){
+        u64_div16 = BUZZER_DIV16_MIN;
+    }
+    if(u64_div16 > BUZZER_DIV16_MAX){
+        u64_div16 = BUZZER_DIV16_MAX;
+    }
+    uint64_t u64_period = ((uint64_t)u32_sysHz * 16) / (u64_div16 * u32_freqHz);
+    if(u64_period > BUZZER_TOP_MAX + 1){
+        u64_period = BUZZER_TOP_MAX + 1;
+    }
+    if(u64_period < 2){
+        u64_period = 2;
+    }
+    uint32_t u32_level = (uint32_t)((u64_period * u8_dutyPercent) / 100);
+
+    pwm_set_clkdiv_int_frac(u_buzzerSlice, (uint8_t)(u64_div16 >> 4), (uint8_t)(u64_div16 & 0xF));
+    pwm_set_wrap(u_buzzerSlice, (uint16_t)(u64_period - 1));
+    pwm_set_chan_level(u_buzzerSlice, u_buzzerChan, (uint16_t)u32_level);
+    pwm_set_enabled(u_buzzerSlice, true);
+
+    return (uint32_t)(((uint64_t)u32_sysHz * 16) / (u64_div16 * u64_period));
+}
+
+void buzzer_off(void){
+    //level 0 holds the pin low, which is where the speaker is quiet
+    pwm_set_chan_level(u_buzzerSlice, u_buzzerChan, 0);
+}
+
+//Plays the current step and schedules the next one. A step with a duration
+//of 0 ends the pattern early, which lets a one-shot pattern end in silence.
+static void buzzer_run_step(void){
+    const buzzer_pattern_t *ps_pattern = ps_playing;
+    if(ps_pattern == NULL){
+        return;
+    }
+    if(u8_step >= ps_pattern->u8_numSteps){
+        if(!ps_pattern->b_repeat){
+            ps_playing = NULL;
+            buzzer_off();
+            return;
+        }
+        u8_step = 0;
+    }
+    const buzzer_step_t *ps_step = &ps_pattern->ps_steps[u8_step];
+    buzzer_set_tone(ps_step->u16_freqHz, BUZZER_DEFAULT_DUTY);
+    if(ps_step->u16_durationMs == 0){
+        ps_playing = NULL;
+        buzzer_off();
+        return;
+    }
+    u8_step++;
+    hardware_alarm_set_target(i8_buzzerAlarmNum, from_us_since_boot(time_us_64() + (uint64_t)ps_step->u16_durationMs * 1000));
+}
+
+static void buzzer_alarm_callback(uint alarm_num){
+    buzzer_run_step();
+}
+
+void buzzer_init(void){
+    gpio_set_function(PICO_SPK_PIN, GPIO_FUNC_PWM);
+    u_buzzerSlice = pwm_gpio_to_slice_num(PICO_SPK_PIN);
+    u_buzzerChan = pwm_gpio_to_channel(PICO_SPK_PIN);
+    pwm_config s_config = pwm_get_default_config();
+    pwm_init(u_buzzerSlice, &s_config, false);
+    pwm_set_chan_level(u_buzzerSlice, u_buzzerChan, 0);
+
+    i8_buzzerAlarmNum = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(i8_buzzerAlarmNum, &buzzer_alarm_callback);
+    edub_irq_set_priority(timer_hardware_alarm_get_irq_num(timer_hw, i8_buzzerAlarmNum), EDUB_IRQ_PRIO_TIMER);
+}
+
+void buzzer_play(const buzzer_pattern_t *ps_pattern){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_TIMER);
+    hardware_alarm_cancel(i8_buzzerAlarmNum);
+    ps_playing = ps_pattern;
+    u8_step = 0;
+    buzzer_run_step();
+    edub_irq_unmask(status);
+}
+
+void buzzer_stop(void){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_TIMER);
+    hardware_alarm_cancel(i8_buzzerAlarmNum);
+    ps_playing = NULL;
+    buzzer_off();
+    edub_irq_unmask(status);
+}
+
+bool buzzer_is_playing(void){
+    return ps_playing != NULL;
+}
@@ -0,0 +1,45 @@
+/**
+ * Buzzer on PICO_SPK_PIN driven by a hardware PWM slice.
+ *
+ * The PWM makes the square wave, so a tone costs no interrupts at all.
+ * On top of it is a small non-blocking sequencer: a pattern is a list of
+ * (frequency, duration) steps and a hardware alarm moves to the next step,
+ * so the CPU only wakes up at step boundaries. Patterns can repeat, which
+ * is how the beep codes for alarms are made.
+ */
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include "pico/stdlib.h"
+
+#define BUZZER_DEFAULT_DUTY 50
+
+typedef struct {
+    uint16_t u16_freqHz;      // 0 = silence
+    uint16_t u16_durationMs;
+} buzzer_step_t;
+
+typedef struct {
+    const buzzer_step_t *ps_steps;
+    uint8_t u8_numSteps;
+    bool b_repeat;
+} buzzer_pattern_t;
+
+//beep codes
+extern const buzzer_pattern_t buzzer_pattern_overTemp;   // 3 short high beeps, repeating
+extern const buzzer_pattern_t buzzer_pattern_watchdog;   // long low, short high, once
+extern const buzzer_pattern_t buzzer_pattern_chirp;      // one short beep, once
+
+//sets up the PWM slice and claims a hardware alarm for the sequencer
+void buzzer_init(void);
+
+//starts a continuous tone, returns the frequency the PWM actually makes
+uint32_t buzzer_set_tone(uint32_t u32_freqHz, uint8_t u8_dutyPercent);
+void buzzer_off(void);
+
+//plays a pattern from its first step, replacing whatever was playing
+void buzzer_play(const buzzer_pattern_t *ps_pattern);
+void buzzer_stop(void);
+bool buzzer_is_playing(void);
+
+#endif
@@ -0,0 +1,294 @@
+#include "keypad.h"
+#include "picoedub.h"
+#include "edub_irq.h"
+#ifdef KEYPAD_USE_PIO
+#include "keypad_pio.h"
+#endif
+
+#define KEYPAD_ROW_MASK (0b1111 << PICOEDUB_ROW0_PIN)
+#define KEYPAD_COL_MASK (0b1111 << PICOEDUB_COL0_PIN)
+
+//per key debounce state
+typedef enum {
+    KEY_RELEASED,
+    KEY_PRESSED,
+    KEY_HELD
+} key_state_t;
+
+typedef struct {
+    uint8_t u8_state;         // key_state_t
+    uint8_t u8_count;         // integrator, 0 = released .. KEYPAD_DEBOUNCE_TICKS = pressed
+    uint32_t u32_pressUs;     // time the press was accepted, for the hold event
+} key_debounce_t;
+
+static key_debounce_t as_keys[KEYPAD_NUM_KEYS];
+static volatile uint32_t u32_keyState = 0;
+
+//event queue, written only by the scan tick and read by main
+static keypad_event_t as_events[KEYPAD_EVENT_QUEUE_SIZE];
+static volatile uint32_t u32_eventHead = 0;
+static volatile uint32_t u32_eventTail = 0;
+static volatile uint32_t u32_eventsDropped = 0;
+
+static int8_t i8_scanAlarmNum = -1;
+static volatile bool b_scanning = false;
+
+static void keypad_push_event(uint8_t u8_key, keypad_event_type_t type, uint32_t u32_timeUs){
+    if(u32_eventHead - u32_eventTail == KEYPAD_EVENT_QUEUE_SIZE){
+        u32_eventsDropped++;
+        return;
+    }
+    keypad_event_t *p_event = &as_events[u32_eventHead & (KEYPAD_EVENT_QUEUE_SIZE - 1)];
+    p_event->u8_key = u8_key;
+    p_event->u8_type = type;
+    p_event->u32_timeUs = u32_timeUs;
+    u32_eventHead++;
+}
+
+//Reads every key once. The switches pull their row high on their own, so
+//they are read with every column low first. A row that is high from its
+//switch cannot tell us anything about the matrix keys on it.
+static uint32_t keypad_scan_raw(void){
+    uint32_t u32_raw;
+    uint32_t u32_switchRows;
+
+    gpio_clr_mask(KEYPAD_COL_MASK);
+    busy_wait_us_32(KEYPAD_SETTLE_US);
+    u32_switchRows = (gpio_get_all() & KEYPAD_ROW_MASK) >> PICOEDUB_ROW0_PIN;
+    u32_raw = u32_switchRows << KEYPAD_FIRST_SW_KEY;
+
+    for(uint8_t u8_col = 0; u8_col < KEYPAD_NUM_COLS; u8_col++){
+        gpio_put_masked(KEYPAD_COL_MASK, 1u << (PICOEDUB_COL0_PIN + u8_col));
+        busy_wait_us_32(KEYPAD_SETTLE_US);
+        uint32_t u32_rows = ((gpio_get_all() & KEYPAD_ROW_MASK) >> PICOEDUB_ROW0_PIN) & ~u32_switchRows;
+        for(uint8_t u8_row = 0; u8_row < KEYPAD_NUM_ROWS; u8_row++){
+            if(u32_rows & (1u << u8_row)){
+                u32_raw |= 1u << (u8_row * KEYPAD_NUM_COLS + u8_col);
+            }
+        }
+    }
+
+    //idle state, every column high so any key raises its row
+    gpio_set_mask(KEYPAD_COL_MASK);
+    return u32_raw;
+}
+
+static void keypad_arm_rows(bool b_enabled){
+    for(uint8_t u8_row = 0; u8_row < KEYPAD_NUM_ROWS; u8_row++){
+        gpio_acknowledge_irq(PICOEDUB_ROW0_PIN + u8_row, GPIO_IRQ_EDGE_RISE);
+        gpio_set_irq_enabled(PICOEDUB_ROW0_PIN + u8_row, GPIO_IRQ_EDGE_RISE, b_enabled);
+    }
+}
+
+static void keypad_start_ticks(void){
+    b_scanning = true;
+    hardware_alarm_set_target(i8_scanAlarmNum, from_us_since_boot(time_us_64() + KEYPAD_TICK_US));
+}
+
+/*****************************************************************
+ * Scan tick. Runs from the hardware alarm only while a key is active.
+ * Each key is an integrator: a pressed read counts up, a released read
+ * counts down, and the state only flips when the count hits an end.
+ * That way a single bounce can never produce an event.
+ *****************************************************************/
+static void keypad_tick(uint alarm_num){
+    uint32_t u32_now = time_us_32();
+    uint32_t u32_raw = keypad_scan_raw();
+    bool b_active = false;
+
+    for(uint8_t u8_key = 0; u8_key < KEYPAD_NUM_KEYS; u8_key++){
+        key_debounce_t *p_key = &as_keys[u8_key];
+
+        if(u32_raw & (1u << u8_key)){
+            if(p_key->u8_count < KEYPAD_DEBOUNCE_TICKS){
+                p_key->u8_count++;
+            }
+        }
+        else if(p_key->u8_count > 0){
+            p_key->u8_count--;
+        }
+
+        switch(p_key->u8_state){
+        case KEY_RELEASED:
+            if(p_key->u8_count == KEYPAD_DEBOUNCE_TICKS){
+                p_key->u8_state = KEY_PRESSED;
+                p_key->u32_pressUs = u32_now;
+                u32_keyState |= 1u << u8_key;
+                keypad_push_event(u8_key, KEY_EVENT_PRESS, u32_now);
+            }
+            break;
+        case KEY_PRESSED:
+        case KEY_HELD:
+            if(p_key->u8_count == 0){
+                p_key->u8_state = KEY_RELEASED;
+                u32_keyState &= ~(1u << u8_key);
+                keypad_push_event(u8_key, KEY_EVENT_RELEASE, u32_now);
+            }
+            else if(p_key->u8_state == KEY_PRESSED && (u32_now - p_key->u32_pressUs) >= KEYPAD_HOLD_US){
+                p_key->u8_state = KEY_HELD;
+                keypad_push_event(u8_key, KEY_EVENT_HOLD, u32_now);
+            }
+            break;
+        }
+
+        if(p_key->u8_count != 0 || p_key->u8_state != KEY_RELEASED){
+            b_active = true;
+        }
+    }
+
+    if(b_active){
+        hardware_alarm_set_target(i8_scanAlarmNum, from_us_since_boot(time_us_64() + KEYPAD_TICK_US));
+        return;
+    }
+
+    //everything released, go back to waiting on a row edge
+    b_scanning = false;
+    keypad_arm_rows(true);
+    //a key that went down between the last scan and re-arming left no edge
+    if(gpio_get_all() & KEYPAD_ROW_MASK){
+        keypad_arm_rows(false);
+        keypad_start_ticks();
+    }
+}
+
+//Arms the alarm for the earliest pressed key that has not sent its hold event
+static void keypad_arm_hold(uint32_t u32_now){
+    uint32_t u32_wait = 0;
+    bool b_pending = false;
+    for(uint8_t u8_key = 0; u8_key < KEYPAD_NUM_KEYS; u8_key++){
+        if(as_keys[u8_key].u8_state != KEY_PRESSED){
+            continue;
+        }
+        uint32_t u32_elapsed = u32_now - as_keys[u8_key].u32_pressUs;
+        uint32_t u32_left = u32_elapsed >= KEYPAD_HOLD_US ? 0 : KEYPAD_HOLD_US - u32_elapsed;
+        if(!b_pending || u32_left < u32_wait){
+            u32_wait = u32_left;
+            b_pending = true;
+        }
+    }
+    if(b_pending){
+        hardware_alarm_set_target(i8_scanAlarmNum, from_us_since_boot(time_us_64() + u32_wait + 1));
+    }
+}
+
+#ifdef KEYPAD_USE_PIO
+//PIO mode only, sends the hold events
+static void keypad_hold_tick(uint alarm_num){
+    uint32_t u32_now = time_us_32();
+    for(uint8_t u8_key = 0; u8_key < KEYPAD_NUM_KEYS; u8_key++){
+        if(as_keys[u8_key].u8_state == KEY_PRESSED && (u32_now - as_keys[u8_key].u32_pressUs) >= KEYPAD_HOLD_US){
+            as_keys[u8_key].u8_state = KEY_HELD;
+            keypad_push_event(u8_key, KEY_EVENT_HOLD, u32_now);
+        }
+    }
+    keypad_arm_hold(u32_now);
+}
+#endif
+
+void keypad_post_state(uint32_t u32_state, uint32_t u32_timeUs){
+    uint32_t u32_changed = u32_state ^ u32_keyState;
+    for(uint8_t u8_key = 0; u8_key < KEYPAD_NUM_KEYS; u8_key++){
+        if(!(u32_changed & (1u << u8_key))){
+            continue;
+        }
+        if(u32_state & (1u << u8_key)){
+            as_keys[u8_key].u8_state = KEY_PRESSED;
+            as_keys[u8_key].u32_pressUs = u32_timeUs;
+            keypad_push_event(u8_key, KEY_EVENT_PRESS, u32_timeUs);
+        }
+        else{
+            as_keys[u8_key].u8_state = KEY_RELEASED;
+            keypad_push_event(u8_key, KEY_EVENT_RELEASE, u32_timeUs);
+        }
+    }
+    u32_keyState = u32_state;
+    keypad_arm_hold(u32_timeUs);
+}
+
+//shared GPIO callback, keypad_init() registers it for the row pins
+static void gpio_callback(uint gpio, uint32_t events) {
+    keypad_row_irq(gpio, events);
+}
+
+static void keypad_init(void){
+    //initialize columns as sio
+    gpio_set_function(PICOEDUB_COL0_PIN,GPIO_FUNC_SIO);
+    gpio_set_function(PICOEDUB_COL1_PIN,GPIO_FUNC_SIO);
+    gpio_set_function(PICOEDUB_COL2_PIN,GPIO_FUNC_SIO);
+    gpio_set_function(PICOEDUB_COL3_PIN,GPIO_FUNC_SIO);
+    //set output for columns
+    gpio_set_dir(PICOEDUB_COL0_PIN, GPIO_OUT);
+    gpio_set_dir(PICOEDUB_COL1_PIN, GPIO_OUT);
+    gpio_set_dir(PICOEDUB_COL2_PIN, GPIO_OUT);
+    gpio_set_dir(PICOEDUB_COL3_PIN, GPIO_OUT);
+    //set up columns as high
+    gpio_set_mask(0b1111<< PICOEDUB_COL0_PIN);
+
+    //initalize rows as input, with pulldown.
+    gpio_init(PICOEDUB_ROW0_PIN);
+    gpio_init(PICOEDUB_ROW1_PIN);
+    gpio_init(PICOEDUB_ROW2_PIN);
+    gpio_init(PICOEDUB_ROW3_PIN);
+    gpio_set_dir(PICOEDUB_ROW0_PIN, GPIO_IN);
+    gpio_set_dir(PICOEDUB_ROW1_PIN, GPIO_IN);
+    gpio_set_dir(PICOEDUB_ROW2_PIN, GPIO_IN);
+    gpio_set_dir(PICOEDUB_ROW3_PIN, GPIO_IN);
+    gpio_pull_down(PICOEDUB_ROW0_PIN);
+    gpio_pull_down(PICOEDUB_ROW1_PIN);
+    gpio_pull_down(PICOEDUB_ROW2_PIN);
+    gpio_pull_down(PICOEDUB_ROW3_PIN);
+
+    //set up interrupts for rows
+    gpio_set_irq_enabled_with_callback(PICOEDUB_ROW0_PIN, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    gpio_set_irq_enabled(PICOEDUB_ROW1_PIN, GPIO_IRQ_EDGE_RISE, true);
+    gpio_set_irq_enabled(PICOEDUB_ROW2_PIN, GPIO_IRQ_EDGE_RISE, true);
+    gpio_set_irq_enabled(PICOEDUB_ROW3_PIN, GPIO_IRQ_EDGE_RISE, true);
+}
+
+void keypad_engine_init(void){
+    keypad_init();
+    i8_scanAlarmNum = hardware_alarm_claim_unused(true);
+    //the scan is I/O, it stays below the ADC and the watchdog alarm
+    edub_irq_set_priority(timer_hardware_alarm_get_irq_num(timer_hw, i8_scanAlarmNum), EDUB_IRQ_PRIO_IO);
+#ifdef KEYPAD_USE_PIO
+    //the PIO program owns the columns, the row interrupts are not needed
+    keypad_arm_rows(false);
+    hardware_alarm_set_callback(i8_scanAlarmNum, &keypad_hold_tick);
+    keypad_pio_init();
+#else
+    hardware_alarm_set_callback(i8_scanAlarmNum, &keypad_tick);
+#endif
+}
+
+void keypad_row_irq(uint gpio, uint32_t events){
+    if(!(events & GPIO_IRQ_EDGE_RISE) || b_scanning){
+        return;
+    }
+    if(gpio < PICOEDUB_ROW0_PIN || gpio > PICOEDUB_ROW3_PIN){
+        return;
+    }
+    //the scan takes over until every key is released again
+    keypad_arm_rows(false);
+    keypad_start_ticks();
+}
+
+bool keypad_get_event(keypad_event_t *p_event){
+    //the row, PIO and scan IRQs are all on the I/O level
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    if(u32_eventHead == u32_eventTail){
+        edub_irq_unmask(status);
+        return false;
+    }
+    *p_event = as_events[u32_eventTail & (KEYPAD_EVENT_QUEUE_SIZE - 1)];
+    u32_eventTail++;
+    edub_irq_unmask(status);
+    return true;
+}
+
+uint32_t keypad_get_state(void){
+    return u32_keyState;
+}
+
+uint32_t keypad_get_dropped(void){
+    return u32_eventsDropped;
+}
@@ -0,0 +1,76 @@
+/**
+ * Interrupt driven keypad engine for the eduboard 4x4 matrix and SW2-SW5.
+ *
+ * While no key is touched the columns are all driven high and the only
+ * thing armed is the rising edge IRQ on the rows, so the engine costs no
+ * CPU. A row edge turns the row IRQs off and starts a scan tick on a
+ * hardware alarm. Every tick scans the matrix, runs the debounce state
+ * machine for each key and queues press/release/hold events. Once every
+ * key has settled released the ticks stop and the row IRQs are re-armed.
+ *
+ * With KEYPAD_USE_PIO the scanning and debouncing are done by a PIO state
+ * machine instead (keypad_pio.c) and the engine only turns its changes into
+ * the same events. The hardware alarm is then only used for hold events.
+ *
+ * Key numbers: 0-15 are the matrix, row * 4 + column.
+ *              16-19 are the switches on rows 0-3 (SW5, SW4, SW3, SW2).
+ */
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "pico/stdlib.h"
+
+#define KEYPAD_NUM_ROWS        4
+#define KEYPAD_NUM_COLS        4
+#define KEYPAD_NUM_MATRIX_KEYS (KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS)
+#define KEYPAD_FIRST_SW_KEY    KEYPAD_NUM_MATRIX_KEYS
+#define KEYPAD_NUM_KEYS        (KEYPAD_NUM_MATRIX_KEYS + KEYPAD_NUM_ROWS)
+
+//scan period while a key is active
+#ifndef KEYPAD_TICK_US
+#define KEYPAD_TICK_US         5000
+#endif
+//a key has to read the same for this many ticks to change state
+#ifndef KEYPAD_DEBOUNCE_TICKS
+#define KEYPAD_DEBOUNCE_TICKS  4
+#endif
+//a key held this long sends one KEY_EVENT_HOLD
+#ifndef KEYPAD_HOLD_US
+#define KEYPAD_HOLD_US         800000
+#endif
+//time for a row to follow a column after the column is driven
+#define KEYPAD_SETTLE_US       10
+//must be a power of 2
+#define KEYPAD_EVENT_QUEUE_SIZE 16
+
+typedef enum {
+    KEY_EVENT_PRESS,
+    KEY_EVENT_RELEASE,
+    KEY_EVENT_HOLD
+} keypad_event_type_t;
+
+typedef struct {
+    uint8_t u8_key;
+    uint8_t u8_type;          // keypad_event_type_t
+    uint32_t u32_timeUs;      // time_us_32() when the state changed
+} keypad_event_t;
+
+//sets up the pins through keypad_init() and claims a hardware alarm for the scan tick
+void keypad_engine_init(void);
+
+//called from gpio_callback for the row pins
+void keypad_row_irq(uint gpio, uint32_t events);
+
+//takes a new debounced state (key bits) from the PIO scanner
+void keypad_post_state(uint32_t u32_state, uint32_t u32_timeUs);
+
+//returns false if no event is waiting
+bool keypad_get_event(keypad_event_t *p_event);
+
+//bit n set = key n is currently pressed (debounced)
+uint32_t keypad_get_state(void);
+
+//number of events lost because the queue was full
+uint32_t keypad_get_dropped(void);
+
+#endif
@@ -0,0 +1,58 @@
+#include "keypad_pio.h"
+#include "keypad.h"
+#include "picoedub.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "keypad.pio.h"
+
+static PIO pio_keypad = pio0;
+static uint u_keypadSm = 0;
+
+uint32_t keypad_pio_decode(uint32_t u32_raw){
+    //a switch holds its whole row high, so its row says nothing about the matrix
+    uint32_t u32_switchRows = (u32_raw >> (KEYPAD_NUM_COLS * KEYPAD_NUM_ROWS)) & 0xF;
+    uint32_t u32_keys = u32_switchRows << KEYPAD_FIRST_SW_KEY;
+
+    for(uint8_t u8_col = 0; u8_col < KEYPAD_NUM_COLS; u8_col++){
+        //COL0 was read first so it was shifted furthest up
+        uint32_t u32_rows = (u32_raw >> ((KEYPAD_NUM_COLS - 1 - u8_col) * KEYPAD_NUM_ROWS)) & 0xF & ~u32_switchRows;
+        for(uint8_t u8_row = 0; u8_row < KEYPAD_NUM_ROWS; u8_row++){
+            if(u32_rows & (1u << u8_row)){
+                u32_keys |= 1u << (u8_row * KEYPAD_NUM_COLS + u8_col);
+            }
+        }
+    }
+    return u32_keys;
+}
+
+//only runs when the debounced state changed
+static void keypad_pio_irq(void){
+    while(!pio_sm_is_rx_fifo_empty(pio_keypad, u_keypadSm)){
+        keypad_post_state(keypad_pio_decode(pio_sm_get(pio_keypad, u_keypadSm)), time_us_32());
+    }
+}
+
+void keypad_pio_init(void){
+    uint u_offset = pio_add_program(pio_keypad, &keypad_scan_program);
+    u_keypadSm = pio_claim_unused_sm(pio_keypad, true);
+    keypad_scan_program_init(pio_keypad, u_keypadSm, u_offset, PICOEDUB_COL0_PIN, PICOEDUB_ROW0_PIN,
+                             (float)clock_get_hz(clk_sys) / KEYPAD_PIO_CLK_HZ);
+
+    irq_set_exclusive_handler(PIO0_IRQ_0, keypad_pio_irq);
+    pio_set_irq0_source_enabled(pio_keypad, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + u_keypadSm), true);
+    irq_set_enabled(PIO0_IRQ_0, true);
+}
+
+void keypad_pio_start_dma(volatile uint32_t *pu32_raw){
+    pio_set_irq0_source_enabled(pio_keypad, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + u_keypadSm), false);
+    irq_set_enabled(PIO0_IRQ_0, false);
+
+    uint u_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(u_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_keypad, u_keypadSm, false));
+    //0xffffffff is ENDLESS mode on the RP2350 (and 4 billion changes on an RP2040)
+    dma_channel_configure(u_chan, &c, pu32_raw, &pio_keypad->rxf[u_keypadSm], 0xffffffff, true);
+}
@@ -0,0 +1,31 @@
+/**
+ * PIO keypad scanner, built when KEYPAD_USE_PIO is set.
+ *
+ * A PIO state machine scans the matrix and switches on its own and only
+ * pushes a scan word when the debounced state changes, so the CPU does no
+ * keypad work on the hot ADC/UART paths. The words are either handled by
+ * the PIO RX FIFO interrupt, which feeds the keypad event queue, or copied
+ * by DMA into a state word that main can look at whenever it wants.
+ */
+#ifndef KEYPAD_PIO_H
+#define KEYPAD_PIO_H
+
+#include "pico/stdlib.h"
+
+//PIO clock. Each column is driven for 32 clocks, so a full scan is about
+//5 * 33 clocks (4 ms) and a change has to hold for two scans to be reported.
+#ifndef KEYPAD_PIO_CLK_HZ
+#define KEYPAD_PIO_CLK_HZ 40000
+#endif
+
+//starts the state machine and the RX FIFO interrupt
+void keypad_pio_init(void);
+
+//stops the FIFO interrupt and lets DMA copy every change into *pu32_raw.
+//Use keypad_pio_decode() on the value.
+void keypad_pio_start_dma(volatile uint32_t *pu32_raw);
+
+//converts a scan word from the PIO program to keypad key bits (see keypad.h)
+uint32_t keypad_pio_decode(uint32_t u32_raw);
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * LM45 reading to temperature, in float and in fixed point.
+ *
+ * Include after picoedub.h, which has the sensor constants.
+ */
+#ifndef LM45_H
+#define LM45_H
+
+#ifndef LM45_mV_to_degC
+#error "include picoedub.h before lm45.h"
+#endif
+
+//12-bit conversion, full scale is ADC_VREF == 3.3 V
+#define LM45_VREF_MV            3300
+#define LM45_ADC_COUNTS         (1 << 12)
+
+//Vout = 10 mV/deg C, so 1 mV is 0.1 deg C or 1.8 tenths of a deg F
+#define LM45_TENTHS_F_PER_MV_X10 18
+//32 deg F plus the calibration, in tenths of a deg F, rounded (the sum is positive)
+#define LM45_OFFSET_TENTHS_F    ((int32_t)((C_to_F_offset + CALIBRATION_FACTOR) * 10.0f + 0.5f))
+
+//the conversion the apps have always done, in deg F
+static inline float lm45_raw_to_degF(uint16_t u16_raw){
+    float f_volts = (float)u16_raw * (3.3f / LM45_ADC_COUNTS);
+    return (f_volts / LM45_mV_to_degC) * C_to_F_scaler + C_to_F_offset + CALIBRATION_FACTOR;
+}
+
+//same result in tenths of a deg F with no float math, rounded to nearest
+static inline int32_t lm45_raw_to_tenthsF(uint16_t u16_raw){
+    int32_t i32_scaled = (int32_t)u16_raw * (LM45_VREF_MV * LM45_TENTHS_F_PER_MV_X10 / 10);
+    return (i32_scaled + LM45_ADC_COUNTS / 2) / LM45_ADC_COUNTS + LM45_OFFSET_TENTHS_F;
+}
+
+#endif
@@ -3,11 +3,61 @@
  */
 
 #include "picoedub.h"
+#include "lm45.h"
+#include "keypad.h"
+#include "buzzer.h"
+#include "led_pwm.h"
+#include "isr_prof.h"
+#include "stats.h"
+#include "stack_paint.h"
+#include "edub_ram.h"
+#include "mailbox.h"
+#include "edub_irq.h"
+#include "adc_jitter.h"
+#include "filter.h"
+#include "fft.h"
+#include "adc_capture.h"
+#include "hardware/xip_cache.h"
+#ifdef EDUB_CORE1_ACQ
+#include "acq_core1.h"
+#endif
 
 //Variables for ADC
-// 12-bit conversion, assume max value == ADC_VREF == 3.3 V
-const float f_conversion_factor = 3.3f / (1 << 12);
 uint16_t u16_ADC_out;
+//the latest conversion, when it was taken and the input it was taken on.
+//ADC_callback writes it into mb_adcLatest and the main loop reads it out
+//whole, with no interrupts turned off on either side (picoedub/mailbox.h)
+typedef struct {
+    uint32_t u32_timeUs;
+    uint32_t u32_count;     // conversions taken out of the FIFO so far, this one included
+    uint16_t u16_raw;
+    uint16_t u16_filtered;  // through s_adcFilter, what the temperature is worked out from
+    uint8_t u8_channel;
+} adc_sample_t;
+mailbox mb_adcLatest;
+adc_sample_t s_adcSample;
+adc_sample_t s_adcLatest;
+uint32_t u32_adcSeq = 0;
+//the rate adc_rate_set() gave, in mHz. 'A' prints it next to the rate
+//measured from the ISR's timestamps since the first sample the loop read
+uint32_t u32_adcRateMilliHz = 0;
+adc_sample_t s_adcFirst;
+char ac_rateLine[64];
+//the ISR's time stamps against the ADC's grid, 'S' prints them after the counters
+adc_jitter s_adcJitter;
+char ac_jitterLine[ADC_JITTER_LINE_SIZE];
+//every conversion goes through a 2nd-order lowpass in ADC_callback, so the
+//loop reads the level of the last few hundred samples instead of one noisy
+//one. Q31, the cutoff is a 1/1000 of the rate (filter.h). 0 turns it off.
+#ifndef ADC_FILTER_HZ
+#define ADC_FILTER_HZ 10
+#endif
+filt_biquad_q31 s_adcFilter;
+bool b_adcFilterPrimed = false;
+//no new conversion for this long and the reading is marked stale
+#ifndef ADC_STALE_US
+#define ADC_STALE_US 100000
+#endif
 float f_ADC_out;
 uint8_t u8_temp;
 uint8_t *pu8_temp = &u8_temp;
@@ -23,7 +73,7 @@ uint32_t u32_time2Expire= 1000;
 
 
 
-//variable for speaker
+//variable for speaker, true while the over temperature beep code is playing
 bool b_toggleSpeaker = false;
 
 //circular buffers
@@ -31,55 +81,129 @@ circular_buffer  cb_inputBuffer;
 circular_buffer *pcb_inputBuffer = &cb_inputBuffer;
 circular_buffer  cb_outputBuffer;
 circular_buffer *pcb_outputBuffer = &cb_outputBuffer;
-bool b_toggle = false;
 uint8_t u8_buf = 0;
 uint8_t *pu8_buf = &u8_buf;
 uint8_t u8_callbackBuf = 0;
 uint8_t *pu8_callbackBuf = &u8_callbackBuf;
 
-void alarmCallback(){
-    if(!b_toggle){
-        pico_set_led(true);  
-        b_toggle = 1;
-        if(b_toggleSpeaker){
-            gpio_put(PICO_SPK_PIN, true);
-        }
-    } else if(b_toggle){
-        pico_set_led(false);
-        b_toggle = 0;
-        if(b_toggleSpeaker){
-            gpio_put(PICO_SPK_PIN, false);
-        }
-    }  
-    
+//keypad events
+keypad_event_t s_keyEvent;
+char ac_keyMsg[32];
+const char *apc_keyEventNames[] = {"PRESS", "RELEASE", "HOLD"};
+
+//'S' on the UART prints the counters from stats.c, 'M' the stack and RAM use
+char ac_statsLine[STATS_LINE_SIZE];
+char ac_stackLine[STACK_PAINT_LINE_SIZE];
+
+//ISR profiler ids, 'P' on the UART dumps them and 'R' clears them
+uint8_t u8_profAlarm;
+uint8_t u8_profUart;
+uint8_t u8_profADC;
+bool b_profDump = false;
+char ac_profLine[ISR_PROF_LINE_SIZE];
+//'X' toggles emptying the XIP cache every loop, so the ISRs always start cold
+//and the profiler shows their worst case
+bool b_coldCache = false;
+//'F' has the ADC ISR take ADC_FFT_POINTS samples (adc_capture.h), the loop
+//runs the FFT over them when it has nothing else to do and prints the
+//report a line at a time, like the profiler dump
+int32_t ai32_fftBins[ADC_FFT_POINTS];
+fft_result s_fftResult;
+uint8_t u8_fftLine = 0;
+bool b_fftDump = false;
+char ac_fftLine[FFT_LINE_SIZE];
+
+#ifdef EDUB_CORE1_ACQ
+//latest block from core 1
+acq_record_t s_acqRecord;
+#endif
+
+#ifdef ISR_PROF_ENABLE
+/****************************************
+ * ADC latency for the profiler. The ADC converts every 1 + DIV cycles of
+ * the 48 MHz clk_adc, and the timer counts from the same crystal, so the
+ * time each sample was ready can be predicted in us (Q32 from
+ * adc_rate_period_us(), to keep it from drifting). The prediction starts at the first ISR and moves back to any
+ * ISR that comes in earlier, so the latency is counted from the quickest
+ * the ISR has ever started. It is the latency of the oldest sample in the
+ * FIFO, the one that has waited longest.
+*****************************************/
+#define ADC_FIFO_DEPTH 4
+uint64_t u64_adcPeriodQ32 = 0;
+uint64_t u64_adcDueQ32 = 0;
+bool b_adcDueSet = false;
+
+void EDUB_RAM_FUNC(adc_latency)(uint32_t u32_samples){
+    uint32_t u32_now = time_us_32();
+    int32_t i32_late = (int32_t)(u32_now - (uint32_t)(u64_adcDueQ32 >> 32));
+    //a full FIFO has lost samples and the count no longer lines up, start over
+    if(!b_adcDueSet || i32_late < 0 || (uint64_t)i32_late << 32 > ADC_FIFO_DEPTH * u64_adcPeriodQ32){
+        u64_adcDueQ32 = (uint64_t)u32_now << 32;
+        b_adcDueSet = true;
+        i32_late = 0;
+    }
+    isr_prof_latency(u8_profADC, (uint32_t)i32_late);
+    u64_adcDueQ32 += u32_samples * u64_adcPeriodQ32;
+}
+#endif
+
+//'A': the rate set and, from the ISR's timestamps, the rate the samples
+//really came in at. Both in Hz to 3 places, the time stamps are to 1 us.
+void adc_rate_format(char *pc_line){
+    uint32_t u32_setHz = u32_adcRateMilliHz / 1000;
+    uint32_t u32_setFrac = u32_adcRateMilliHz % 1000;
+#ifndef EDUB_CORE1_ACQ
+    uint32_t u32_us = s_adcLatest.u32_timeUs - s_adcFirst.u32_timeUs;
+    if(u32_adcSeq != 0 && u32_us != 0){
+        uint64_t u64_milliHz = ((uint64_t)(s_adcLatest.u32_count - s_adcFirst.u32_count) * 1000000000u + u32_us / 2) / u32_us;
+        sprintf(pc_line, "\n\rADC %lu.%03lu Hz set, %lu.%03lu Hz measured\n\r",
+                (unsigned long)u32_setHz, (unsigned long)u32_setFrac,
+                (unsigned long)(u64_milliHz / 1000), (unsigned long)(u64_milliHz % 1000));
+        return;
+    }
+#endif
+    sprintf(pc_line, "\n\rADC %lu.%03lu Hz set\n\r", (unsigned long)u32_setHz, (unsigned long)u32_setFrac);
+}
+
+//the heartbeat LED is PWM + DMA now (led_pwm.c), this alarm only feeds the watchdog
+void EDUB_RAM_FUNC(alarmCallback)(){
+    uint32_t u32_profStart = ISR_PROF_ENTER();
     u32_refTime = time_us_32();  
-    hardware_alarm_set_target(i8_alarmNum, u32_refTime + u32_time2Expire);
+    isr_prof_latency(u8_profAlarm, u32_refTime - u32_expireTime);
+    u32_expireTime = u32_refTime + u32_time2Expire;
+    hardware_alarm_set_target(i8_alarmNum, u32_expireTime);
     watchdog_update();     
+    isr_prof_exit(u8_profAlarm, u32_profStart);
 }
 
-void uartCallback(){
-    /*
+void EDUB_RAM_FUNC(uartCallback)(){
+    uint32_t u32_profStart = ISR_PROF_ENTER();
+    //RX is on for the profiler commands
     if(uart_is_readable(UART_ID)){
         
         u8_callbackBuf = uart_getc(UART_ID);
+        stats_inc(STAT_UART_RX);
         cb_push_back(pcb_inputBuffer, pu8_callbackBuf); 
     } 
-    */
     if(uart_is_writable(UART_ID)){
         if(!cb_isEmpty(pcb_outputBuffer)){
             cb_pop_front(pcb_outputBuffer, pu8_callbackBuf);
-            uart_putc_nonBlocking(UART_ID, *pu8_callbackBuf, DEFAULT_TIMEOUT_ITERATIONS);
+            if(uart_putc_nonBlocking(UART_ID, *pu8_callbackBuf, DEFAULT_TIMEOUT_ITERATIONS)){
+                stats_inc(STAT_UART_TX);
+            }
         }
         else{
-            uart_set_irqs_enabled(UART_ID, false, false);
+            uart_set_irqs_enabled(UART_ID, true, false);
             //this disables the TX interrupt. This is here to prevent unnessesary calls to this function
 
         }
         
     }
+    isr_prof_exit(u8_profUart, u32_profStart);
 }
 
-void ADC_callback(){
+void EDUB_RAM_FUNC(ADC_callback)(){
+    uint32_t u32_profStart = ISR_PROF_ENTER();
     //bool b_temp = false;
     //If some toggling function is desired when intr is called then it can be done in the next if statement.
     /*
@@ -90,16 +214,56 @@ void ADC_callback(){
     } 
     */
 
-    while(!adc_fifo_is_empty()){
-            u16_ADC_out =  adc_fifo_get();
+    //the stamp first, then only the samples that were in the FIFO at the
+    //stamp, so the block lines up with the ADC's grid (adc_jitter.h)
+    uint64_t u64_stamp = time_us_64();
+    uint32_t u32_samples = adc_fifo_get_level();
+    uint32_t u32_errors = 0;
+    for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+            uint16_t u16_fifo = adc_fifo_get();
+            if(u16_fifo & ADC_FIFO_ERR_BITS){
+                u32_errors++;
+            }
+            s_adcSample.u16_raw = u16_fifo & ADC_FIFO_VAL_BITS;
+            adc_capture_add(s_adcSample.u16_raw);
+            //the reading shifted up by 16, Q31 with headroom, starting at the first one
+            int32_t i32_level = (int32_t)s_adcSample.u16_raw << 16;
+            if(!b_adcFilterPrimed){
+                filt_biquad_q31_prime(&s_adcFilter, i32_level);
+                b_adcFilterPrimed = true;
+            }
+            filt_biquad_q31_block(&s_adcFilter, &i32_level, &i32_level, 1);
+            i32_level = (i32_level + (1 << 15)) >> 16;
+            s_adcSample.u16_filtered = (uint16_t)(i32_level < 0 ? 0 : i32_level > ADC_FIFO_VAL_BITS ? ADC_FIFO_VAL_BITS : i32_level);
+            stats_inc(STAT_ADC_SAMPLES);
+            s_adcSample.u32_count++;
         }
+    //OVER stays set until it is written with a 1
+    bool b_over = (adc_hw->fcs & ADC_FCS_OVER_BITS) != 0;
+    if(b_over){
+        hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS);
+    }
+    adc_jitter_block(&s_adcJitter, u64_stamp, u32_samples, u32_errors, b_over);
+    //only the newest one is passed on, the main loop reads at its own pace
+    if(u32_samples != 0){
+#ifdef ISR_PROF_ENABLE
+        adc_latency(u32_samples);
+#endif
+        s_adcSample.u32_timeUs = (uint32_t)u64_stamp;
+        s_adcSample.u8_channel = (uint8_t)adc_get_selected_input();
+        mailbox_write(&mb_adcLatest, &s_adcSample);
+    }
+    isr_prof_exit(u8_profADC, u32_profStart);
 }
 
 //initializations needed for this program
 void edub_init(){
     //initialize basic peripherals
     stdio_init_all();
-    pico_led_init();
+
+    //heartbeat on the Pico LED, runs from PWM and DMA with no interrupts
+    led_init(LED_MASK(LED_PICO));
+    led_set_pattern(LED_PICO, LED_PATTERN_HEARTBEAT, 1000);
 
     gpio_init(PICOEDUB_LED2_PIN);
     gpio_set_dir(PICOEDUB_LED2_PIN, GPIO_OUT);
@@ -109,14 +273,31 @@ void edub_init(){
     gpio_set_dir(PICOEDUB_LED3_PIN, GPIO_OUT);
     gpio_put(PICOEDUB_LED3_PIN, false);
 
+    //ISR profiler, registered before any of the interrupts are turned on
+    isr_prof_init();
+    u8_profAlarm = isr_prof_register("alarmCallback");
+    u8_profUart = isr_prof_register("uartCallback");
+    u8_profADC = isr_prof_register("ADC_callback");
+
     //initialze circular buffers
     cb_init(pcb_outputBuffer);
     cb_init(pcb_inputBuffer);
+    _Static_assert(sizeof(adc_sample_t) <= MAILBOX_WORDS * 4, "adc_sample_t is too big for the mailbox");
+    mailbox_init(&mb_adcLatest, sizeof(adc_sample_t));
+
+    //counters, with the drops and high-water marks of both buffers
+    stats_init();
+    stats_add_buffer("in", &cb_inputBuffer.u32_drops, &cb_inputBuffer.u32_highWater);
+    stats_add_buffer("out", &cb_outputBuffer.u32_drops, &cb_outputBuffer.u32_highWater);
+#ifdef EDUB_CORE1_ACQ
+    stats_add_buffer("core1", &acq_ring.u32_drops, &acq_ring.u32_highWater);
+#endif
     
-    //speaker setup
-    gpio_init(PICO_SPK_PIN);
-    gpio_set_dir(PICO_SPK_PIN, GPIO_OUT);
-    gpio_put(PICO_SPK_PIN, false);
+    //keypad, idles on the row interrupts until a key is touched
+    keypad_engine_init();
+
+    //speaker setup, the tone comes from a PWM slice so the alarm ISR does not make it
+    buzzer_init();
 
 //Start UART init*********************************************************
     // Set up our UART with a basic baud rate.
@@ -143,14 +324,20 @@ void edub_init(){
 //Start TIMER init************************************************** 
     //will not panic with false
     i8_alarmNum = hardware_alarm_claim_unused(false);
-    u32_time2Expire = 1000;
+    u32_time2Expire = 100000;
     //sets callback function for the timer ISR
     hardware_alarm_set_callback(i8_alarmNum, &alarmCallback);
+    //above the UART, so a busy console cannot starve the watchdog (edub_irq.h)
+    edub_irq_set_priority(timer_hardware_alarm_get_irq_num(timer_hw, i8_alarmNum), EDUB_IRQ_PRIO_TIMER);
 //End TIMER init**************************************************** 
 
 //Start ADC init*****************************************************
     //initialize ADC hardware
+#ifndef EDUB_CORE1_ACQ
     irq_set_exclusive_handler(ADC_IRQ_FIFO, ADC_callback);
+    //the most urgent, it preempts the UART and alarm ISRs part way through
+    edub_irq_set_priority(ADC_IRQ_FIFO, EDUB_IRQ_PRIO_ACQ);
+#endif
     
     //disabling digital functions of GPIO28 and selecting channel 2 in the adc input multiplexor
     adc_gpio_init(PICO_ADC_2_PIN );
@@ -161,6 +348,8 @@ void edub_init(){
     adc_hw->cs |= 1;
     //turn on FIFO
     adc_hw->fcs |= 1;
+    //and bit 15 of each sample for a conversion error, adc_jitter.c counts them
+    adc_hw->fcs |= ADC_FCS_ERR_BITS;
 
     //enable IRQ
     adc_hw->inte |= 1;
@@ -180,10 +369,20 @@ void edub_init(){
     
     
     /****************************************
-     * Want to make a sample every ms or so
-     * 48 Mhz * 1ms = 4800 cycles
+     * ADC_SAMPLE_RATE_HZ samples a second, 10000 by default. adc_rate_set()
+     * works out the divider and gives back the rate it really runs at
     *****************************************/
-    adc_set_clkdiv(DEFUALT_ADC_PERIOD_CYCLES);
+    u32_adcRateMilliHz = adc_rate_set(ADC_SAMPLE_RATE_HZ);
+    adc_jitter_init(&s_adcJitter, adc_rate_period_us());
+    //designed for the rate the divider gives, before the IRQ is on
+    if(ADC_FILTER_HZ != 0){
+        double aad_adcFilter[1][5];
+        filt_design_lowpass(aad_adcFilter[0], ADC_FILTER_HZ, u32_adcRateMilliHz / 1000.0, 0.7071);
+        filt_biquad_q31_init(&s_adcFilter, 1, (const double (*)[5])aad_adcFilter);
+    }
+#ifdef ISR_PROF_ENABLE
+    u64_adcPeriodQ32 = adc_rate_period_us();
+#endif
      
 
 
@@ -193,26 +392,39 @@ void edub_init(){
          
     //sets the callback function for uart
     irq_set_exclusive_handler (UART0_IRQ, uartCallback);
+    edub_irq_set_priority(UART0_IRQ, EDUB_IRQ_PRIO_IO);
     //enables the actual iterrupt on the calling core
     
     irq_set_enabled(UART0_IRQ, true);
     
+    //what piled up in the FIFO while the rest was set up is not the rate's fault
+    adc_fifo_drain();
+    hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS);
+#ifdef EDUB_CORE1_ACQ
+    //core 1 takes the ADC interrupt and the filtering (acq_core1.c)
+    acq_core1_launch(u8_profADC, &s_adcJitter);
+#else
     irq_set_enabled(ADC_IRQ_FIFO, true);
+#endif
     
     //getting the reference time to set the alarm
     u32_refTime = time_us_32();
-    hardware_alarm_set_target(i8_alarmNum, u32_refTime + u32_time2Expire);
+    u32_expireTime = u32_refTime + u32_time2Expire;
+    hardware_alarm_set_target(i8_alarmNum, u32_expireTime);
     //only want to send on transmit but only want to start when we have data. Will be set in main
-    uart_set_irqs_enabled(UART_ID, false, false);
+    uart_set_irqs_enabled(UART_ID, true, false);
     
 }
 
 
 int main() {
+    //before anything else runs, so the high-water marks include all of init
+    stack_paint();
     edub_init();
     if (watchdog_caused_reboot()) {
         cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &"WATCHDOG REBOOT\n\r");
         gpio_put(PICOEDUB_LED3_PIN, true);
+        buzzer_play(&buzzer_pattern_watchdog);
         
     } else {
         cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &"CLEAN BOOT\n\r");
@@ -223,6 +435,7 @@ int main() {
     //watchdog_enable(1000, 1);
     
     //Tx interrupt only works when the Tx is ready for more data. So send something to make the Tx intr start firing.
+    //Not counted in STAT_UART_TX: uartCallback is the counter's only writer (stats.h).
     uart_putc_nonBlocking(UART_ID, '\r', DEFAULT_TIMEOUT_ITERATIONS);
 
     
@@ -230,24 +443,47 @@ int main() {
     cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &"HELLO ADC INTR BY GABRIEL BUCKNER AND THE RAVENS F24!\n\r");
 
     while (true) {
+        stats_loop();
+#ifdef EDUB_CORE1_ACQ
+        //sleeps until core 1 has a block ready, at most 10 ms so the console keeps going
+        acq_wait(10000);
+        while(acq_get(&s_acqRecord)){
+            u16_ADC_out = s_acqRecord.u16_raw;
+            f_ADC_out = s_acqRecord.i16_tenthsF / 10.0f;
+            stats_inc(STAT_ADC_PROCESSED);
+        }
+#else
         //read the 12 bit data from ADC
       
         sleep_ms(10);
 
-            f_ADC_out = (float)u16_ADC_out * f_conversion_factor;
-            
+        //a whole record from one ISR, so the value and its time always match
+        uint32_t u32_seq = mailbox_read(&mb_adcLatest, &s_adcLatest);
+        if(u32_seq != u32_adcSeq){
+            if(u32_adcSeq == 0){
+                s_adcFirst = s_adcLatest;
+            }
+            u32_adcSeq = u32_seq;
+            u16_ADC_out = s_adcLatest.u16_filtered;
+
             /***********************************
              * From LM45 datasheet
              * Vout = (10 mv/°C * x°C)
              * sensor is accurate +- 3.6 °F
             ************************************/
-        //following line converts volts to °C then to °F
-        f_ADC_out = (f_ADC_out / LM45_mV_to_degC) * C_to_F_scaler + C_to_F_offset + CALIBRATION_FACTOR;
-        if(f_ADC_out >= Buzzer_Threshold){
+            //converts the reading to volts, then °C, then °F (lm45.h)
+            f_ADC_out = lm45_raw_to_degF(u16_ADC_out);
+            stats_inc(STAT_ADC_PROCESSED);
+        }
+#endif
+        //only touch the buzzer when crossing the threshold, the sequencer does the rest
+        if(f_ADC_out >= Buzzer_Threshold && !b_toggleSpeaker){
             b_toggleSpeaker = true;
+            buzzer_play(&buzzer_pattern_overTemp);
         }
-        else{
+        else if(f_ADC_out < Buzzer_Threshold && b_toggleSpeaker){
             b_toggleSpeaker = false;
+            buzzer_stop();
         }
         
 
@@ -256,8 +492,82 @@ int main() {
         cb_push_back(pcb_outputBuffer, pu8_temp);
         cb_print_float_to_buffer(pcb_outputBuffer, f_ADC_out);
 
-        cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &" \'F\r");
-        uart_set_irqs_enabled(UART_ID, false, true);
+        cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &" \'F");
+#ifndef EDUB_CORE1_ACQ
+        //the ADC has stopped, or has not started, and this is an old reading
+        if(u32_adcSeq == 0 || time_us_32() - s_adcLatest.u32_timeUs > ADC_STALE_US){
+            cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &" STALE");
+        }
+#endif
+        u8_temp = '\r';
+        cb_push_back(pcb_outputBuffer, (char *)pu8_temp);
+
+        //report keypad events
+        while(keypad_get_event(&s_keyEvent)){
+            sprintf(ac_keyMsg, "\n\rKEY %u %s\n\r", s_keyEvent.u8_key, apc_keyEventNames[s_keyEvent.u8_type]);
+            cb_print_cstring_to_buffer(pcb_outputBuffer, ac_keyMsg);
+        }
+
+        //profiler commands
+        while(!cb_isEmpty(pcb_inputBuffer)){
+            cb_pop_front(pcb_inputBuffer, (char *)pu8_buf);
+            if(u8_buf == 'P' || u8_buf == 'p'){
+                isr_prof_dump_begin();
+                b_profDump = true;
+            }
+            else if(u8_buf == 'R' || u8_buf == 'r'){
+                isr_prof_reset();
+            }
+            else if(u8_buf == 'S' || u8_buf == 's'){
+                stats_format(ac_statsLine);
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_statsLine);
+                adc_jitter_format(&s_adcJitter, ac_jitterLine);
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_jitterLine);
+            }
+            else if(u8_buf == 'M' || u8_buf == 'm'){
+                stack_format(ac_stackLine);
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_stackLine);
+            }
+            else if(u8_buf == 'A' || u8_buf == 'a'){
+                adc_rate_format(ac_rateLine);
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_rateLine);
+            }
+            else if(u8_buf == 'X' || u8_buf == 'x'){
+                b_coldCache = !b_coldCache;
+                cb_print_cstring_to_buffer(pcb_outputBuffer, b_coldCache ? "\n\rXIP COLD\n\r" : "\n\rXIP WARM\n\r");
+            }
+            else if(u8_buf == 'F' || u8_buf == 'f'){
+                if(!adc_capture_arm()){
+                    cb_print_cstring_to_buffer(pcb_outputBuffer, (char *) &"\n\rFFT BUSY\n\r");
+                }
+            }
+        }
+        if(b_coldCache){
+            xip_cache_invalidate_all();
+        }
+        //one line at a time, only when it fits, so the dump never blocks the loop
+        while(b_profDump && pcb_outputBuffer->u32_capacity - pcb_outputBuffer->u32_count >= ISR_PROF_LINE_SIZE){
+            b_profDump = isr_prof_dump_next(ac_profLine);
+            if(b_profDump){
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_profLine);
+            }
+        }
+        //a whole block is in, the FFT reads it and the ISR can have it back.
+        //Not while the last report is still going out, it would change under it.
+        if(!b_fftDump && adc_capture_full()){
+            fft_real_q15(ai16_adcCapture, ai32_fftBins, ADC_FFT_POINTS);
+            adc_capture_release();
+            fft_analyze(ai32_fftBins, ADC_FFT_POINTS, u32_adcRateMilliHz, &s_fftResult);
+            u8_fftLine = 0;
+            b_fftDump = true;
+        }
+        while(b_fftDump && pcb_outputBuffer->u32_capacity - pcb_outputBuffer->u32_count >= FFT_LINE_SIZE){
+            b_fftDump = fft_format_line(&s_fftResult, u8_fftLine++, ac_fftLine);
+            if(b_fftDump){
+                cb_print_cstring_to_buffer(pcb_outputBuffer, ac_fftLine);
+            }
+        }
+        uart_set_irqs_enabled(UART_ID, true, true);
 
         
     }
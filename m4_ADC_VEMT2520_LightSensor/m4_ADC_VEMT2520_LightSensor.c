@@ -3,6 +3,7 @@
  */
 
 #include "picoedub.h"
+#include "filter.h"
 
 //Variables for ADC
 // 12-bit conversion, assume max value == ADC_VREF == 3.3 V
@@ -13,6 +14,10 @@
     uint8_t u8_temp;
     uint8_t *pu8_temp = &u8_temp;
     uint32_t u32_outputIn_mV;
+    //the last 16 readings, 160 ms, averaged so flicker does not flip the level (filter.h)
+    #define LIGHT_AVERAGE_LEN 16
+    filt_ma_q15 s_lightAverage;
+    bool b_lightPrimed = false;
 
 //variables for timer and alarm
 int8_t i8_alarmNum = 0;
@@ -167,6 +172,12 @@ int main() {
         //This next line doesnt work for some reason
         //u16_ADC_out = (adc_hw->result & (111111111111));
         u16_ADC_out = (uint16_t) adc_hw->result;
+        //starts on the first reading instead of averaging it with zeros
+        if(!b_lightPrimed){
+            filt_ma_q15_init(&s_lightAverage, LIGHT_AVERAGE_LEN, (int16_t)u16_ADC_out);
+            b_lightPrimed = true;
+        }
+        u16_ADC_out = (uint16_t)filt_ma_q15_sample(&s_lightAverage, (int16_t)u16_ADC_out);
         //This turns the output into volts
         f_ADC_out = (float)u16_ADC_out * f_conversion_factor;
         
@@ -0,0 +1,23 @@
+#include "adc_rate.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+
+static uint32_t u32_adcClkHz = 48000000;
+static uint32_t u32_adcPeriodQ8 = ADC_RATE_PERIOD_MIN_Q8;
+
+uint32_t adc_rate_set(uint32_t u32_hz){
+    u32_adcClkHz = clock_get_hz(clk_adc);
+    uint32_t u32_channels = adc_rate_channels((adc_hw->cs & ADC_CS_RROBIN_BITS) >> ADC_CS_RROBIN_LSB);
+    u32_adcPeriodQ8 = adc_rate_period_q8(u32_adcClkHz, u32_hz, u32_channels);
+    //24 bits, a float holds it exactly and the SDK scales it back by 256
+    adc_set_clkdiv((float)adc_rate_div(u32_adcPeriodQ8) / 256.0f);
+    return adc_rate_millihz(u32_adcClkHz, u32_adcPeriodQ8, u32_channels);
+}
+
+uint32_t adc_rate_period(void){
+    return u32_adcPeriodQ8;
+}
+
+uint64_t adc_rate_period_us(void){
+    return adc_rate_period_us_q32(u32_adcClkHz, u32_adcPeriodQ8);
+}
@@ -0,0 +1,80 @@
+/**
+ * ADC sample rate from the clock divider.
+ *
+ * In free-running mode the ADC starts a conversion every 1 + DIV.INT +
+ * DIV.FRAC/256 cycles of clk_adc (48 MHz). A conversion takes 96 cycles,
+ * so a shorter interval runs them back to back at 500 kS/s. With the round
+ * robin on, each conversion is the next input in RROBIN, so each input is
+ * sampled at the conversion rate over the number of inputs. A FRAC that is
+ * not 0 makes the interval alternate between two whole cycle counts, and
+ * the rate is exact on average.
+ *
+ * adc_rate_set() takes the rate wanted on each input, picks the nearest
+ * DIV and returns the rate it gives in mHz. Rates are passed in mHz because
+ * most of them do not come out as a whole number of Hz. The arithmetic is
+ * below as inline functions so the host build can test it without the SDK.
+ */
+#ifndef ADC_RATE_H
+#define ADC_RATE_H
+
+#include "pico/stdlib.h"
+
+#define ADC_RATE_CONVERSION_CYCLES  96u
+//DIV is 16 integer bits and 8 fraction bits, periods are in 1/256 cycles
+#define ADC_RATE_PERIOD_MIN_Q8      (ADC_RATE_CONVERSION_CYCLES << 8)
+#define ADC_RATE_PERIOD_MAX_Q8      (0x100u + 0xFFFFFFu)
+
+//inputs in a RROBIN mask, 0 (off) is the one AINSEL selects
+static inline uint32_t adc_rate_channels(uint32_t u32_rrobin){
+    uint32_t u32_channels = 0;
+    for(; u32_rrobin != 0; u32_rrobin &= u32_rrobin - 1){
+        u32_channels++;
+    }
+    return u32_channels == 0 ? 1 : u32_channels;
+}
+
+//start to start period in 1/256 clk_adc cycles nearest u32_hz on each of
+//u32_channels inputs, limited to what the divider and the conversion allow
+static inline uint32_t adc_rate_period_q8(uint32_t u32_clkHz, uint32_t u32_hz, uint32_t u32_channels){
+    uint64_t u64_total = (uint64_t)u32_hz * (u32_channels == 0 ? 1 : u32_channels);
+    if(u64_total == 0){
+        return ADC_RATE_PERIOD_MAX_Q8;
+    }
+    uint64_t u64_period = (((uint64_t)u32_clkHz << 8) + u64_total / 2) / u64_total;
+    if(u64_period < ADC_RATE_PERIOD_MIN_Q8){
+        return ADC_RATE_PERIOD_MIN_Q8;
+    }
+    return u64_period > ADC_RATE_PERIOD_MAX_Q8 ? ADC_RATE_PERIOD_MAX_Q8 : (uint32_t)u64_period;
+}
+
+//the DIV register value for a period, 0 when the conversions are back to back
+static inline uint32_t adc_rate_div(uint32_t u32_periodQ8){
+    return u32_periodQ8 > ADC_RATE_PERIOD_MIN_Q8 ? u32_periodQ8 - 0x100u : 0;
+}
+
+//samples a second on each input in mHz, rounded
+static inline uint32_t adc_rate_millihz(uint32_t u32_clkHz, uint32_t u32_periodQ8, uint32_t u32_channels){
+    uint64_t u64_den = (uint64_t)u32_periodQ8 * (u32_channels == 0 ? 1 : u32_channels);
+    return (uint32_t)(((uint64_t)u32_clkHz * 256000u + u64_den / 2) / u64_den);
+}
+
+//one period in us as Q32, for predicting when samples are due. Split in
+//two so the largest period at 48 MHz does not overflow 64 bits.
+static inline uint64_t adc_rate_period_us_q32(uint32_t u32_clkHz, uint32_t u32_periodQ8){
+    //us in 1/256 cycles is 1000000 / 256 = 15625 / 4
+    uint64_t u64_num = (uint64_t)u32_periodQ8 * 15625u;
+    return ((u64_num / u32_clkHz) << 30) + (((u64_num % u32_clkHz) << 30) / u32_clkHz);
+}
+
+//Sets DIV for u32_hz samples a second on each input, counting the inputs in
+//the round robin, so call it after adc_set_round_robin(). Returns the rate
+//it gives in mHz, 0 Hz asks for the slowest there is.
+uint32_t adc_rate_set(uint32_t u32_hz);
+
+//the period the last adc_rate_set() chose, in 1/256 clk_adc cycles
+uint32_t adc_rate_period(void);
+
+//the same, in us as Q32
+uint64_t adc_rate_period_us(void);
+
+#endif
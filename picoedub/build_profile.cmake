@@ -0,0 +1,54 @@
+# Build profiles for the Pico apps, one file for all of them. Included by
+# path before add_subdirectory(../picoedub), so the libraries get the same
+# options, and after add_executable():
+#   include(../picoedub/build_profile.cmake)
+#   edub_build_profile(<target>)
+#
+#   cmake -DPICO_BOARD=pico2 -DCMAKE_BUILD_TYPE=Release ..      speed, -O3 (-DEDUB_OPT=O2 for -O2)
+#   cmake -DPICO_BOARD=pico2 -DCMAKE_BUILD_TYPE=MinSizeRel ..   size, -Os
+#   cmake -DPICO_BOARD=pico2 -DPICO_DEOPTIMIZED_DEBUG=1 -DCMAKE_BUILD_TYPE=Debug ..   stepping in a debugger
+#
+# Release and MinSizeRel link with LTO (-DEDUB_LTO=OFF turns it off) and
+# compile assert() out. Every build prints the flash and RAM the target
+# uses (text is flash, data is flash and RAM, bss is RAM) and keeps it in
+# <target>.size, so two build directories can be compared.
+
+set(EDUB_OPT "O3" CACHE STRING "Optimization level of Release builds, O2 or O3")
+set_property(CACHE EDUB_OPT PROPERTY STRINGS O2 O3)
+option(EDUB_LTO "Link time optimization in Release and MinSizeRel builds" ON)
+
+# The compile side only, for the libraries an app links (picoedub/)
+function(edub_library_profile TARGET)
+    # comes after CMake's own -O3 on the command line, so it wins
+    target_compile_options(${TARGET} PRIVATE $<$<CONFIG:Release>:-${EDUB_OPT}>)
+    if (EDUB_LTO)
+        set_target_properties(${TARGET} PROPERTIES
+            INTERPROCEDURAL_OPTIMIZATION_RELEASE ON
+            INTERPROCEDURAL_OPTIMIZATION_MINSIZEREL ON
+        )
+    endif()
+endfunction()
+
+function(edub_build_profile TARGET)
+    edub_library_profile(${TARGET})
+    # LTO optimizes again at link time, at the level the link is given
+    target_link_options(${TARGET} PRIVATE $<$<CONFIG:Release>:-${EDUB_OPT}>)
+
+    set(LTO_GENEX "")
+    if (EDUB_LTO)
+        set(LTO_GENEX "$<$<OR:$<CONFIG:Release>,$<CONFIG:MinSizeRel>>: LTO>")
+    endif()
+
+    # e.g. "Release -O3 LTO", for the program to print so a result says how it was built
+    target_compile_definitions(${TARGET} PRIVATE
+        "EDUB_BUILD_PROFILE=\"$<CONFIG>$<$<CONFIG:Release>: -${EDUB_OPT}>${LTO_GENEX}\""
+    )
+
+    if (PICO_COMPILER STREQUAL "pico_arm_gcc")
+        pico_find_compiler(PICO_COMPILER_SIZE ${PICO_GCC_TRIPLE}-size)
+        add_custom_command(TARGET ${TARGET} POST_BUILD
+            COMMAND ${PICO_COMPILER_SIZE} $<TARGET_FILE:${TARGET}>
+            COMMAND ${PICO_COMPILER_SIZE} $<TARGET_FILE:${TARGET}> >${TARGET}.size
+        )
+    endif()
+endfunction()
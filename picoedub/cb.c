@@ -0,0 +1,135 @@
+#include "cb.h"
+#include "edub_ram.h"
+#include "edub_irq.h"
+
+char ac_returnBuffer[CD_BUFFER_SIZE];
+
+//adds one item, must be called inside edub_irq_mask(). A full buffer drops
+//the item and counts it, so callers never have to return from inside their
+//critical region.
+static bool EDUB_RAM_FUNC(cb_put_locked)(circular_buffer *cb, char c_item){
+    if(cb->u32_count == cb->u32_capacity){
+        cb->u32_drops++;
+        return false;
+    }
+
+    //add char item and increment pc_head
+    *cb->pc_head = c_item;
+    
+    if(cb->pc_head == cb->pc_buffer_end){
+        cb->pc_head = cb->ac_buffer;
+    }
+    else{
+        cb->pc_head++;
+    }
+    cb->u32_count += 1;
+    if(cb->u32_count > cb->u32_highWater){
+        cb->u32_highWater = cb->u32_count;
+    }
+    return true;
+}
+
+bool EDUB_RAM_FUNC(cb_isEmpty)(circular_buffer *cb){
+    if(cb->u32_count == 0){
+        return true;
+    }
+    else{
+        return false;
+    }
+}
+
+void cb_init(circular_buffer *cb){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    cb->u32_count = 0;
+    cb->pc_head = cb->ac_buffer;
+    cb->pc_tail = cb->ac_buffer;
+    cb->pc_buffer_end = &cb->ac_buffer[CD_BUFFER_SIZE-1];
+    cb->u32_capacity =  CD_BUFFER_SIZE;  // maximum number of items in the buffer
+    cb->u32_drops = 0;
+    cb->u32_highWater = 0;
+    edub_irq_unmask(status);
+}
+
+void EDUB_RAM_FUNC(cb_push_back)(circular_buffer *cb, char *c_item){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    cb_put_locked(cb, *c_item);
+    edub_irq_unmask(status);
+
+}
+
+void EDUB_RAM_FUNC(cb_pop_front)(circular_buffer *cb, char *c_item){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    if(cb->u32_count == 0){
+        *c_item = '?';
+        edub_irq_unmask(status);
+        return;
+    }
+    
+    *c_item = *cb->pc_tail;
+    if(cb->pc_tail == cb->pc_buffer_end){
+        cb->pc_tail = cb->ac_buffer;
+    }
+    else{
+        cb->pc_tail = (cb->pc_tail + 1);
+    }
+    cb->u32_count--;
+    edub_irq_unmask(status);
+}
+
+char *cb_pop_multiple(circular_buffer *cb, uint32_t u32_num){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    if(cb->u32_count == 0){
+        //handle error
+    }
+    if(cb->u32_count < u32_num){
+        //handle error
+    }
+    
+    for(uint32_t u32_i = 0; u32_i < u32_num; u32_i++){ 
+        ac_returnBuffer[u32_i] = *cb->pc_tail;
+        if(cb->pc_tail == cb->pc_buffer_end){
+            cb->pc_tail = cb->ac_buffer;
+        }
+        else{
+            cb->pc_tail = (cb->pc_tail + 1);
+        }
+        cb->u32_count--;
+    }
+    edub_irq_unmask(status);
+    return ac_returnBuffer;
+
+}
+
+void cb_print_cstring_to_buffer(circular_buffer *cb, char* pc_cString){
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+
+    while(*pc_cString != '\0'){
+        //once one char is dropped the rest are too, but they are still counted
+        cb_put_locked(cb, *pc_cString++);
+    }
+    
+    edub_irq_unmask(status);
+    return;
+}
+
+void cb_print_float_to_buffer(circular_buffer *cb, float f_num){
+    char ac_tempChar[20];
+    int8_t i8_numCharsWritten;
+    //format before the critical region, sprintf is far too slow to run with interrupts off
+    i8_numCharsWritten = snprintf(ac_tempChar, sizeof(ac_tempChar), "%f", f_num);
+
+    if(i8_numCharsWritten < 0){
+        return;
+    }
+    if(i8_numCharsWritten >= (int8_t)sizeof(ac_tempChar)){
+        i8_numCharsWritten = sizeof(ac_tempChar) - 1;
+    }
+
+    uint32_t status = edub_irq_mask(EDUB_IRQ_PRIO_IO);
+    for(uint8_t u8_i = 0; u8_i < i8_numCharsWritten; u8_i++){
+        cb_put_locked(cb, ac_tempChar[u8_i]);
+    }
+    
+    edub_irq_unmask(status);
+    return;
+}
\ No newline at end of file
@@ -1,3 +1,6 @@
+#ifndef CB_H
+#define CB_H
+
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/sync.h"
@@ -5,7 +8,8 @@
 #ifndef CD_BUFFER_SIZE
     #define CD_BUFFER_SIZE 256
 #endif
-//make safe
+//Shared between the main loop and I/O ISRs. Each call holds off the
+//EDUB_IRQ_PRIO_IO level only (edub_irq.h), so an ISR above it must not use one.
 typedef struct circular_buffer
 {
     char ac_buffer[CD_BUFFER_SIZE];     // data buffer
@@ -14,6 +18,8 @@ typedef struct circular_buffer
     uint32_t u32_count;     // number of items in the buffer
     char *pc_head;       // pointer to head
     char *pc_tail;       // pointer to tail
+    uint32_t u32_drops;     // items lost because the buffer was full
+    uint32_t u32_highWater; // most items the buffer has held since cb_init
 } circular_buffer;
 
 //returns true if cb is empty
@@ -29,4 +35,6 @@ char* cb_pop_multiple(circular_buffer *cb, uint32_t u32_num);
 
 void cb_print_cstring_to_buffer(circular_buffer *cb, char* pc_cString);
 
-void cb_print_float_to_buffer(circular_buffer *cb, float f_num);
\ No newline at end of file
+void cb_print_float_to_buffer(circular_buffer *cb, float f_num);
+
+#endif
@@ -0,0 +1,96 @@
+#include "dac_pump.h"
+#include <stdio.h>
+#include "edub_ram.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "pico/multicore.h"
+
+#define DAC_PUMP_NONE 0xFFu
+
+static uint16_t au16_pumpBuf[2][DAC_PUMP_MAX_SAMPLES];
+static uint16_t au16_pumpLen[2];
+//the buffer core 1 plays, only core 1 writes it
+static volatile uint8_t u8_pumpActive = DAC_PUMP_NONE;
+//the buffer core 0 committed, core 1 clears it when it switches
+static volatile uint8_t u8_pumpPending = DAC_PUMP_NONE;
+
+static dac_pump_write_t pf_pumpWrite;
+
+//core 1 writes these, core 0 only reads them for the report
+static volatile uint32_t u32_pumpPeriods = 0;
+static volatile uint32_t u32_pumpSwitches = 0;
+static volatile uint32_t u32_pumpMaxLateUs = 0;
+static volatile uint32_t u32_pumpOverruns = 0;
+static volatile uint32_t u32_pumpSkipped = 0;
+
+static void EDUB_RAM_FUNC(dac_pump_main)(void){
+    uint16_t u16_index = 0;
+    uint32_t u32_deadline = time_us_32() + DAC_PUMP_PERIOD_US;
+    while(true){
+        //the period boundary, the only place a new buffer is taken
+        if(u16_index == 0 && u8_pumpPending != DAC_PUMP_NONE){
+            u8_pumpActive = u8_pumpPending;
+            //core 0 filled the buffer before committing it
+            __dmb();
+            u8_pumpPending = DAC_PUMP_NONE;
+            u32_pumpSwitches++;
+        }
+
+        while((int32_t)(time_us_32() - u32_deadline) < 0){
+            tight_loop_contents();
+        }
+        uint32_t u32_late = time_us_32() - u32_deadline;
+        if(u32_late > u32_pumpMaxLateUs){
+            u32_pumpMaxLateUs = u32_late;
+        }
+        //a whole period behind, the missed samples are not worth catching up on
+        if(u32_late >= DAC_PUMP_PERIOD_US){
+            u32_pumpOverruns++;
+            u32_deadline = time_us_32();
+        }
+        u32_deadline += DAC_PUMP_PERIOD_US;
+
+        uint8_t u8_active = u8_pumpActive;
+        if(u8_active == DAC_PUMP_NONE){
+            continue;
+        }
+        //a watchdog reset in the middle of a transfer can leave the DAC stuck
+        if(watchdog_get_time_remaining_ms() > 1000){
+            pf_pumpWrite(au16_pumpBuf[u8_active][u16_index]);
+        }
+        else{
+            u32_pumpSkipped++;
+        }
+        if(++u16_index >= au16_pumpLen[u8_active]){
+            u16_index = 0;
+            u32_pumpPeriods++;
+        }
+    }
+}
+
+void dac_pump_launch(dac_pump_write_t pf_write){
+    pf_pumpWrite = pf_write;
+    multicore_launch_core1(dac_pump_main);
+}
+
+uint16_t *dac_pump_begin(void){
+    if(u8_pumpPending != DAC_PUMP_NONE){
+        return NULL;
+    }
+    //with nothing pending core 1 cannot switch, so the other buffer stays free
+    return au16_pumpBuf[u8_pumpActive == 0 ? 1 : 0];
+}
+
+void dac_pump_commit(uint16_t u16_len){
+    uint8_t u8_free = u8_pumpActive == 0 ? 1 : 0;
+    au16_pumpLen[u8_free] = u16_len == 0 ? 1 : MIN(u16_len, DAC_PUMP_MAX_SAMPLES);
+    //the samples and the length before the switch that makes them live
+    __dmb();
+    u8_pumpPending = u8_free;
+}
+
+void dac_pump_format(char *pc_line){
+    snprintf(pc_line, DAC_PUMP_LINE_SIZE, "PUMP rate=%u/s periods=%lu switches=%lu late=%luus overruns=%lu skipped=%lu\n\r",
+             (unsigned)DAC_PUMP_RATE_HZ, (unsigned long)u32_pumpPeriods, (unsigned long)u32_pumpSwitches,
+             (unsigned long)u32_pumpMaxLateUs, (unsigned long)u32_pumpOverruns, (unsigned long)u32_pumpSkipped);
+}
@@ -0,0 +1,56 @@
+/**
+ * Core 1 DAC sample pump (-DDAC_CORE1_PUMP=ON).
+ *
+ * Core 1 does nothing but write one precomputed sample to the DAC every
+ * 1 / DAC_PUMP_RATE_HZ seconds, timed against an absolute deadline so an
+ * I2C transfer that runs long does not push every later sample back. The
+ * UART, the console and the watchdog stay on core 0, so typing no longer
+ * changes when a sample goes out.
+ *
+ * The samples are one period of the wave, in one of two buffers. Core 0
+ * writes a new period into the other buffer and commits it, and core 1
+ * switches over when it reaches the end of the period it is playing, so a
+ * change of frequency never leaves a period half one and half the other:
+ *     uint16_t *pu16_buf = dac_pump_begin();     //NULL while a switch is pending
+ *     if(pu16_buf != NULL){
+ *         dac_pump_commit(fill_period(pu16_buf));
+ *     }
+ *
+ * Core 1 plays nothing until the first commit. Only core 0 calls
+ * dac_pump_begin()/commit() and only core 1 switches, so the buffer core 0
+ * is writing is never the one being played.
+ */
+#ifndef DAC_PUMP_H
+#define DAC_PUMP_H
+
+#include "pico/stdlib.h"
+
+//samples per second, the MCP4725 fast write takes about 290 us at 100 kHz
+#ifndef DAC_PUMP_RATE_HZ
+#define DAC_PUMP_RATE_HZ        2000
+#endif
+#define DAC_PUMP_PERIOD_US      (1000000u / DAC_PUMP_RATE_HZ)
+//longest period in samples, each of the two buffers holds this many
+#ifndef DAC_PUMP_MAX_SAMPLES
+#define DAC_PUMP_MAX_SAMPLES    8192
+#endif
+#define DAC_PUMP_LINE_SIZE      128
+
+//writes one code to the DAC, false if the transfer failed
+typedef bool (*dac_pump_write_t)(uint16_t u16_code);
+
+//starts core 1, which calls pf_write for every sample
+void dac_pump_launch(dac_pump_write_t pf_write);
+
+//core 0: the buffer to fill (DAC_PUMP_MAX_SAMPLES long), or NULL while the
+//last commit has not been picked up yet
+uint16_t *dac_pump_begin(void);
+
+//core 0: hands the filled buffer to core 1 from its next period on
+void dac_pump_commit(uint16_t u16_len);
+
+//writes "PUMP ..." with the rate, periods, switches and timing into pc_line
+//(DAC_PUMP_LINE_SIZE bytes)
+void dac_pump_format(char *pc_line);
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * Interrupt priorities for the eduboard apps.
+ *
+ * Every IRQ starts at PICO_DEFAULT_IRQ_PRIORITY, so an ISR that is already
+ * running holds off all the others until it returns, and a slow UART ISR
+ * can make the ADC miss samples. With EDUB_IRQ_PLAN defined (cmake
+ * -DIRQ_PRIORITY_PLAN=ON, the default) the apps put each IRQ on one of
+ * three levels, most urgent first:
+ *   EDUB_IRQ_PRIO_ACQ    the ADC FIFO, a late read loses a sample
+ *   EDUB_IRQ_PRIO_TIMER  the alarms that feed the watchdog and step the buzzer
+ *   EDUB_IRQ_PRIO_IO     UART, keypad rows and scan, PIO; the console and the keys
+ * An IRQ on a higher level preempts an ISR on a lower one part way through.
+ * Lower numbers are more urgent, and the RP2350 only keeps the top four
+ * bits. Each level can be changed with target_compile_definitions().
+ *
+ * A critical region only has to hold off the ISRs that share its data.
+ * edub_irq_mask(level) holds off that level and everything below it by
+ * raising BASEPRI, and the levels above keep running. The ring buffers
+ * (cb.c) are only shared with I/O ISRs, so the ADC gets through while the
+ * main loop is queueing output. On the RISC-V cores, and with the plan off,
+ * it is save_and_disable_interrupts() as before. BASEPRI cannot mask level
+ * 0, and data shared with the ADC ISR still needs every interrupt off.
+ */
+#ifndef EDUB_IRQ_H
+#define EDUB_IRQ_H
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#ifndef EDUB_IRQ_PRIO_ACQ
+#define EDUB_IRQ_PRIO_ACQ       0x40
+#endif
+#ifndef EDUB_IRQ_PRIO_TIMER
+#define EDUB_IRQ_PRIO_TIMER     0x60
+#endif
+//the SDK's default, so IRQs the apps never set (the sleep_ms alarm) are here too
+#ifndef EDUB_IRQ_PRIO_IO
+#define EDUB_IRQ_PRIO_IO        0x80
+#endif
+
+//with the plan off every IRQ stays at the default
+static inline void edub_irq_set_priority(uint u_irq, uint8_t u8_level){
+#ifdef EDUB_IRQ_PLAN
+    irq_set_priority(u_irq, u8_level);
+#else
+    (void)u_irq;
+    (void)u8_level;
+#endif
+}
+
+#if defined(EDUB_IRQ_PLAN) && defined(__ARM_ARCH_8M_MAIN__)
+//holds off u8_level and the levels below it on this core, returns what to
+//give edub_irq_unmask(). basepri_max only ever raises the mask, so a region
+//inside another one cannot let in anything the outer one held off.
+static inline uint32_t edub_irq_mask(uint8_t u8_level){
+    uint32_t u32_saved;
+    __asm volatile ("mrs %0, basepri" : "=r" (u32_saved));
+    __asm volatile ("msr basepri_max, %0" : : "r" (u8_level) : "memory");
+    return u32_saved;
+}
+
+static inline void edub_irq_unmask(uint32_t u32_saved){
+    __asm volatile ("msr basepri, %0" : : "r" (u32_saved) : "memory");
+}
+#else
+static inline uint32_t edub_irq_mask(uint8_t u8_level){
+    (void)u8_level;
+    return save_and_disable_interrupts();
+}
+
+//the mask always leaves them off, so the cheaper restore does
+static inline void edub_irq_unmask(uint32_t u32_saved){
+    restore_interrupts_from_disabled(u32_saved);
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * Code that runs from SRAM instead of through the XIP flash cache.
+ *
+ * Everything is fetched from flash through a 16 KB cache by default, so an
+ * ISR that was evicted by the main loop starts with a run of cache misses,
+ * each a QSPI read, and its worst case is much longer than its average.
+ * With EDUB_RAM_ISRS defined (cmake -DISR_IN_RAM=ON) the functions named with
+ * EDUB_RAM_FUNC() are copied to SRAM at boot and never miss. Without it they
+ * stay in flash, as before, and the macro is just the name.
+ *
+ *     void EDUB_RAM_FUNC(alarmCallback)(){
+ *
+ * Only the ISRs and what they call are worth the SRAM. SDK functions they
+ * call (hardware_alarm_set_target, watchdog_update, ...) stay in flash unless
+ * the whole program is built to run from RAM (ALL_IN_RAM).
+ */
+#ifndef EDUB_RAM_H
+#define EDUB_RAM_H
+
+#ifdef EDUB_RAM_ISRS
+#include "pico.h"
+#define EDUB_RAM_FUNC(func_name)    __not_in_flash_func(func_name)
+#define EDUB_RAM_DATA               __not_in_flash("edub")
+#else
+#define EDUB_RAM_FUNC(func_name)    func_name
+#define EDUB_RAM_DATA
+#endif
+
+#endif
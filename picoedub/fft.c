@@ -0,0 +1,314 @@
+#include "fft.h"
+#include <math.h>
+#include <stdio.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FFT_QUARTER (FFT_MAX_POINTS / 4)
+
+//4-term Blackman-Harris in Q15, they add up to 32767
+#define FFT_WIN_A0  11755
+#define FFT_WIN_A1  16000
+#define FFT_WIN_A2  4629
+#define FFT_WIN_A3  383
+//the window's mean square, a0^2 + (a1^2 + a2^2 + a3^2) / 2
+#define FFT_WIN_POWER   0.25796f
+
+//sin over a quarter turn of FFT_MAX_POINTS steps, Q15, made on the first FFT
+static int16_t ai16_fftSin[FFT_QUARTER + 1];
+static bool b_fftTable = false;
+
+static void fft_table_init(void){
+    for(uint32_t u32_i = 0; u32_i <= FFT_QUARTER; u32_i++){
+        ai16_fftSin[u32_i] = (int16_t)lround(sin(M_PI / 2 * u32_i / FFT_QUARTER) * 32767);
+    }
+    b_fftTable = true;
+}
+
+//cos and sin of u32_i / FFT_MAX_POINTS of a turn
+static inline int32_t fft_cos(uint32_t u32_i){
+    uint32_t u32_r = u32_i % FFT_QUARTER;
+    switch((u32_i / FFT_QUARTER) & 3){
+        case 0: return ai16_fftSin[FFT_QUARTER - u32_r];
+        case 1: return -ai16_fftSin[u32_r];
+        case 2: return -ai16_fftSin[FFT_QUARTER - u32_r];
+        default: return ai16_fftSin[u32_r];
+    }
+}
+
+static inline int32_t fft_sin(uint32_t u32_i){
+    return fft_cos(u32_i + 3 * FFT_QUARTER);
+}
+
+//x * a Q15 twiddle, rounded. x stays under 2^29, so the SMULL never overflows.
+static inline int32_t fft_mul(int32_t i32_x, int32_t i32_w){
+    return (int32_t)(((int64_t)i32_x * i32_w + (1 << 14)) >> 15);
+}
+
+//window point n of N, Q15
+static inline int32_t fft_window(uint32_t u32_n, uint32_t u32_step){
+    uint32_t u32_i = u32_n * u32_step;
+    int32_t i32_w = (FFT_WIN_A0 << 15) - FFT_WIN_A1 * fft_cos(u32_i) + FFT_WIN_A2 * fft_cos(2 * u32_i) - FFT_WIN_A3 * fft_cos(3 * u32_i);
+    return (i32_w + (1 << 14)) >> 15;
+}
+
+static inline uint32_t fft_bit_reverse(uint32_t u32_x, uint8_t u8_bits){
+    uint32_t u32_r = 0;
+    for(uint8_t u8_i = 0; u8_i < u8_bits; u8_i++){
+        u32_r = (u32_r << 1) | (u32_x & 1);
+        u32_x >>= 1;
+    }
+    return u32_r;
+}
+
+bool fft_real_q15(const int16_t *pi16_in, int32_t *pi32_bins, uint32_t u32_points){
+    if(u32_points < FFT_MIN_POINTS || u32_points > FFT_MAX_POINTS || (u32_points & (u32_points - 1)) != 0){
+        return false;
+    }
+    if(!b_fftTable){
+        fft_table_init();
+    }
+    uint32_t u32_half = u32_points / 2;
+    uint32_t u32_step = FFT_MAX_POINTS / u32_points;
+    uint8_t u8_bits = 0;
+    while((1u << u8_bits) < u32_half){
+        u8_bits++;
+    }
+
+    //windowed, the even samples as re and the odd ones as im, in bit-reversed order
+    for(uint32_t u32_n = 0; u32_n < u32_half; u32_n++){
+        uint32_t u32_r = fft_bit_reverse(u32_n, u8_bits);
+        pi32_bins[2 * u32_r] = (pi16_in[2 * u32_n] * fft_window(2 * u32_n, u32_step) + (1 << 14)) >> 15;
+        pi32_bins[2 * u32_r + 1] = (pi16_in[2 * u32_n + 1] * fft_window(2 * u32_n + 1, u32_step) + (1 << 14)) >> 15;
+    }
+
+    //radix-2 decimation in time over the u32_half complex points
+    for(uint32_t u32_len = 2; u32_len <= u32_half; u32_len <<= 1){
+        uint32_t u32_span = u32_len / 2;
+        uint32_t u32_twStep = FFT_MAX_POINTS / u32_len;
+        for(uint32_t u32_j = 0; u32_j < u32_span; u32_j++){
+            //W = c - js
+            int32_t i32_c = fft_cos(u32_j * u32_twStep);
+            int32_t i32_s = fft_sin(u32_j * u32_twStep);
+            for(uint32_t u32_a = u32_j; u32_a < u32_half; u32_a += u32_len){
+                int32_t *pi32_a = &pi32_bins[2 * u32_a];
+                int32_t *pi32_b = &pi32_bins[2 * (u32_a + u32_span)];
+                int32_t i32_tr, i32_ti;
+                if(u32_j == 0){
+                    i32_tr = pi32_b[0];
+                    i32_ti = pi32_b[1];
+                }else if(2 * u32_j == u32_span){
+                    //W = -j
+                    i32_tr = pi32_b[1];
+                    i32_ti = -pi32_b[0];
+                }else{
+                    i32_tr = fft_mul(pi32_b[0], i32_c) + fft_mul(pi32_b[1], i32_s);
+                    i32_ti = fft_mul(pi32_b[1], i32_c) - fft_mul(pi32_b[0], i32_s);
+                }
+                pi32_b[0] = pi32_a[0] - i32_tr;
+                pi32_b[1] = pi32_a[1] - i32_ti;
+                pi32_a[0] += i32_tr;
+                pi32_a[1] += i32_ti;
+            }
+        }
+    }
+
+    //the even and odd halves out of Z, X[k] = E[k] + W^k O[k], k and N/2 - k together
+    int32_t i32_z0r = pi32_bins[0];
+    int32_t i32_z0i = pi32_bins[1];
+    pi32_bins[0] = i32_z0r + i32_z0i;
+    pi32_bins[1] = 0;
+    for(uint32_t u32_k = 1; u32_k <= u32_half / 2; u32_k++){
+        uint32_t u32_m = u32_half - u32_k;
+        int32_t i32_zkr = pi32_bins[2 * u32_k], i32_zki = pi32_bins[2 * u32_k + 1];
+        int32_t i32_zmr = pi32_bins[2 * u32_m], i32_zmi = pi32_bins[2 * u32_m + 1];
+        int32_t i32_er = (i32_zkr + i32_zmr) >> 1;
+        int32_t i32_ei = (i32_zki - i32_zmi) >> 1;
+        int32_t i32_or = (i32_zki + i32_zmi) >> 1;
+        int32_t i32_oi = (i32_zmr - i32_zkr) >> 1;
+        int32_t i32_c = fft_cos(u32_k * u32_step);
+        int32_t i32_s = fft_sin(u32_k * u32_step);
+        int32_t i32_tr = fft_mul(i32_or, i32_c) + fft_mul(i32_oi, i32_s);
+        int32_t i32_ti = fft_mul(i32_oi, i32_c) - fft_mul(i32_or, i32_s);
+        pi32_bins[2 * u32_k] = i32_er + i32_tr;
+        pi32_bins[2 * u32_k + 1] = i32_ei + i32_ti;
+        //X[N/2 - k] = conj(E[k] - W^k O[k])
+        if(u32_m != u32_k){
+            pi32_bins[2 * u32_m] = i32_er - i32_tr;
+            pi32_bins[2 * u32_m + 1] = i32_ti - i32_ei;
+        }
+    }
+    return true;
+}
+
+//the power of a full-scale sine, over all of its bins
+static float fft_full_scale(uint32_t u32_points){
+    float f_points = (float)u32_points;
+    return f_points * f_points * 32768.0f * 32768.0f * FFT_WIN_POWER / 4.0f;
+}
+
+static float fft_db(float f_ratio){
+    float f_db = f_ratio > 0 ? 10.0f * log10f(f_ratio) : FFT_DB_FLOOR;
+    return f_db < FFT_DB_FLOOR ? FFT_DB_FLOOR : f_db;
+}
+
+float fft_bin_dbfs(const int32_t *pi32_bins, uint32_t u32_points, uint32_t u32_bin){
+    return fft_db((float)fft_bin_power(pi32_bins, u32_bin) / fft_full_scale(u32_points));
+}
+
+static inline bool fft_near(uint32_t u32_a, uint32_t u32_b){
+    return (u32_a > u32_b ? u32_a - u32_b : u32_b - u32_a) <= FFT_LOBE_BINS;
+}
+
+//a tone's power, all the bins within FFT_LOBE_BINS of u32_bin, and their
+//power centroid in bins. The bins that are u32_owner's are left to it, a
+//harmonic close to the fundamental does not take the fundamental's skirt.
+static uint64_t fft_lobe(const int32_t *pi32_bins, uint32_t u32_half, uint32_t u32_bin, uint32_t u32_owner, float *pf_centroid){
+    uint32_t u32_first = u32_bin > FFT_LOBE_BINS ? u32_bin - FFT_LOBE_BINS : 0;
+    uint32_t u32_last = MIN(u32_bin + FFT_LOBE_BINS, u32_half - 1);
+    uint64_t u64_sum = 0;
+    float f_moment = 0;
+    for(uint32_t u32_k = u32_first; u32_k <= u32_last; u32_k++){
+        if(fft_near(u32_k, u32_owner)){
+            continue;
+        }
+        uint64_t u64_power = fft_bin_power(pi32_bins, u32_k);
+        u64_sum += u64_power;
+        f_moment += (float)u64_power * (float)u32_k;
+    }
+    if(pf_centroid != NULL){
+        *pf_centroid = u64_sum != 0 ? f_moment / (float)u64_sum : (float)u32_bin;
+    }
+    return u64_sum;
+}
+
+//no bin is this far from a real one
+#define FFT_NO_BIN  0x80000000u
+
+void fft_analyze(const int32_t *pi32_bins, uint32_t u32_points, uint32_t u32_rateMilliHz, fft_result *ps_result){
+    uint32_t u32_half = u32_points / 2;
+    float f_fullScale = fft_full_scale(u32_points);
+    ps_result->u32_points = u32_points;
+    ps_result->f_sampleHz = u32_rateMilliHz / 1000.0f;
+    ps_result->f_binHz = ps_result->f_sampleHz / u32_points;
+
+    //the strongest local maxima clear of DC
+    uint32_t au32_peak[FFT_PEAKS];
+    uint64_t au64_peak[FFT_PEAKS];
+    uint8_t u8_peaks = 0;
+    for(uint32_t u32_k = FFT_LOBE_BINS + 1; u32_k + 1 < u32_half; u32_k++){
+        uint64_t u64_power = fft_bin_power(pi32_bins, u32_k);
+        if(u64_power == 0 || u64_power <= fft_bin_power(pi32_bins, u32_k - 1) || u64_power < fft_bin_power(pi32_bins, u32_k + 1)){
+            continue;
+        }
+        //insertion into the list, strongest first
+        uint8_t u8_at = u8_peaks < FFT_PEAKS ? u8_peaks : FFT_PEAKS;
+        while(u8_at > 0 && au64_peak[u8_at - 1] < u64_power){
+            if(u8_at < FFT_PEAKS){
+                au64_peak[u8_at] = au64_peak[u8_at - 1];
+                au32_peak[u8_at] = au32_peak[u8_at - 1];
+            }
+            u8_at--;
+        }
+        if(u8_at < FFT_PEAKS){
+            au64_peak[u8_at] = u64_power;
+            au32_peak[u8_at] = u32_k;
+            u8_peaks = u8_peaks < FFT_PEAKS ? u8_peaks + 1 : FFT_PEAKS;
+        }
+    }
+    ps_result->u8_peaks = u8_peaks;
+    uint64_t u64_fundamental = 0;
+    float f_fundamentalBin = 0;
+    for(uint8_t u8_i = 0; u8_i < u8_peaks; u8_i++){
+        float f_centroid;
+        uint64_t u64_lobe = fft_lobe(pi32_bins, u32_half, au32_peak[u8_i], FFT_NO_BIN, &f_centroid);
+        ps_result->as_peak[u8_i].f_hz = f_centroid * ps_result->f_binHz;
+        ps_result->as_peak[u8_i].f_dbfs = fft_db((float)u64_lobe / f_fullScale);
+        if(u8_i == 0){
+            u64_fundamental = u64_lobe;
+            f_fundamentalBin = f_centroid;
+        }
+    }
+
+    //the harmonics, folded back below fs/2, each the strongest bin near where it should be
+    uint32_t au32_harmonic[FFT_HARMONICS];
+    uint8_t u8_harmonics = 0;
+    uint64_t u64_harmonics = 0;
+    for(uint8_t u8_h = 2; u8_peaks != 0 && u8_h < 2 + FFT_HARMONICS; u8_h++){
+        float f_bin = fmodf(f_fundamentalBin * u8_h, (float)u32_points);
+        f_bin = f_bin > u32_half ? u32_points - f_bin : f_bin;
+        uint32_t u32_center = (uint32_t)(f_bin + 0.5f);
+        if(u32_center <= FFT_LOBE_BINS || u32_center + 2 >= u32_half || fft_near(u32_center, au32_peak[0])){
+            continue;
+        }
+        uint32_t u32_best = u32_center - 2;
+        for(uint32_t u32_k = u32_center - 1; u32_k <= u32_center + 2; u32_k++){
+            if(fft_bin_power(pi32_bins, u32_k) > fft_bin_power(pi32_bins, u32_best)){
+                u32_best = u32_k;
+            }
+        }
+        bool b_counted = false;
+        for(uint8_t u8_i = 0; u8_i < u8_harmonics; u8_i++){
+            b_counted |= au32_harmonic[u8_i] == u32_best;
+        }
+        if(!b_counted){
+            au32_harmonic[u8_harmonics++] = u32_best;
+            u64_harmonics += fft_lobe(pi32_bins, u32_half, u32_best, au32_peak[0], NULL);
+        }
+    }
+
+    //everything else clear of DC is noise
+    uint64_t u64_noise = 0;
+    for(uint32_t u32_k = FFT_LOBE_BINS + 1; u32_k < u32_half; u32_k++){
+        bool b_tone = u8_peaks != 0 && fft_near(u32_k, au32_peak[0]);
+        for(uint8_t u8_i = 0; u8_i < u8_harmonics; u8_i++){
+            b_tone |= fft_near(u32_k, au32_harmonic[u8_i]);
+        }
+        if(!b_tone){
+            u64_noise += fft_bin_power(pi32_bins, u32_k);
+        }
+    }
+    ps_result->f_thdDb = u64_fundamental != 0 ? fft_db((float)u64_harmonics / (float)u64_fundamental) : FFT_DB_FLOOR;
+    ps_result->f_snrDb = u64_noise != 0 ? fft_db((float)u64_fundamental / (float)u64_noise) : -FFT_DB_FLOOR;
+    ps_result->f_noiseDbfs = fft_db((float)u64_noise / f_fullScale);
+
+    for(uint32_t u32_b = 0; u32_b < FFT_BANDS; u32_b++){
+        uint64_t u64_max = 0;
+        for(uint32_t u32_k = u32_b * u32_half / FFT_BANDS; u32_k < (u32_b + 1) * u32_half / FFT_BANDS; u32_k++){
+            u64_max = MAX(u64_max, fft_bin_power(pi32_bins, u32_k));
+        }
+        ps_result->ai16_bandDbfs[u32_b] = (int16_t)lroundf(fft_db((float)u64_max / f_fullScale));
+    }
+}
+
+bool fft_format_line(const fft_result *ps_result, uint8_t u8_line, char *pc_line){
+    int i_len = 0;
+    switch(u8_line){
+        case 0:
+            snprintf(pc_line, FFT_LINE_SIZE, "FFT n=%lu fs=%.3fHz bin=%.3fHz f0=%.1fHz %.1fdBFS thd=%.1fdB snr=%.1fdB noise=%.1fdBFS\n\r",
+                     (unsigned long)ps_result->u32_points, ps_result->f_sampleHz, ps_result->f_binHz,
+                     ps_result->u8_peaks != 0 ? ps_result->as_peak[0].f_hz : 0.0f,
+                     ps_result->u8_peaks != 0 ? ps_result->as_peak[0].f_dbfs : FFT_DB_FLOOR,
+                     ps_result->f_thdDb, ps_result->f_snrDb, ps_result->f_noiseDbfs);
+            return true;
+        case 1:
+            i_len = snprintf(pc_line, FFT_LINE_SIZE, "PEAKS");
+            for(uint8_t u8_i = 0; u8_i < ps_result->u8_peaks; u8_i++){
+                i_len += snprintf(pc_line + i_len, FFT_LINE_SIZE - i_len, " %.1fHz/%.1f",
+                                  ps_result->as_peak[u8_i].f_hz, ps_result->as_peak[u8_i].f_dbfs);
+            }
+            snprintf(pc_line + i_len, FFT_LINE_SIZE - i_len, "\n\r");
+            return true;
+        case 2:
+            i_len = snprintf(pc_line, FFT_LINE_SIZE, "SPEC");
+            for(uint8_t u8_b = 0; u8_b < FFT_BANDS; u8_b++){
+                i_len += snprintf(pc_line + i_len, FFT_LINE_SIZE - i_len, " %d", ps_result->ai16_bandDbfs[u8_b]);
+            }
+            snprintf(pc_line + i_len, FFT_LINE_SIZE - i_len, "\n\r");
+            return true;
+        default:
+            return false;
+    }
+}
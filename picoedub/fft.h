@@ -0,0 +1,92 @@
+/**
+ * Real FFT of a block of ADC samples, and what it says about the signal:
+ * the strongest tones, THD and SNR.
+ *
+ * The samples, the window and the twiddles are Q15, the butterflies are
+ * 32-bit. A Q15 FFT that halves at every stage to stay in 16 bits adds
+ * more rounding noise than a 12-bit ADC has, about 50 dB down at 1024
+ * points, so it cannot measure the ADC. In 32 bits a block of up to 4096
+ * Q15 samples grows to at most 28 bits with no scaling at all. Each
+ * twiddle multiply is one SMULL on the M33.
+ *
+ * N real samples go in as N/2 complex ones, through a radix-2 FFT of N/2
+ * points, and are split into bins 0 to N/2 - 1 of the real FFT. W = 1 and
+ * W = -j (all of the first two stages and one butterfly in two of the
+ * third) are done without multiplies, as a radix-4 first pass would. The
+ * bins end up in the same int32_t buffer as re, im pairs.
+ *
+ * The window is the 4-term Blackman-Harris, its sidelobes are 92 dB down.
+ * A tone is all within 4 bins either side of its peak wherever it falls
+ * between bins. Its level is the sum over those bins, so it does not
+ * scallop. Its frequency is the power centroid of the same bins.
+ *
+ * Levels are dBFS, against a sine that fills the Q15 range. For 12-bit ADC
+ * readings that is (raw - 2048) << 4 and a sine from 0 to 4095.
+ *
+ *     fft_real_q15(ai16_samples, ai32_bins, 1024);
+ *     fft_analyze(ai32_bins, 1024, u32_rateMilliHz, &s_result);
+ *     for(uint8_t u8_line = 0; fft_format_line(&s_result, u8_line, ac_line); u8_line++) ...
+ *
+ * The FFT and the analysis take no locks and touch no hardware, so they
+ * can run in the main loop's idle time or on core 1 while the ADC ISR goes
+ * on taking samples.
+ */
+#ifndef FFT_H
+#define FFT_H
+
+#include "pico/stdlib.h"
+
+#define FFT_MIN_POINTS      256
+#define FFT_MAX_POINTS      4096
+#define FFT_LOBE_BINS       5       // either side of a tone's peak bin that are its own
+#define FFT_PEAKS           4
+#define FFT_HARMONICS       5       // the 2nd to the 6th
+#define FFT_BANDS           32
+#define FFT_DB_FLOOR        -200.0f // nothing there
+#define FFT_LINE_SIZE       192
+
+typedef struct fft_peak
+{
+    float f_hz;
+    float f_dbfs;
+} fft_peak;
+
+typedef struct fft_result
+{
+    uint32_t u32_points;
+    float f_sampleHz;
+    float f_binHz;
+    uint8_t u8_peaks;
+    fft_peak as_peak[FFT_PEAKS];        // strongest first, as_peak[0] is the fundamental
+    float f_thdDb;                      // the harmonics against the fundamental
+    float f_snrDb;                      // the fundamental against the rest, less DC and the harmonics
+    float f_noiseDbfs;                  // that rest against a full-scale sine
+    int16_t ai16_bandDbfs[FFT_BANDS];   // strongest bin in each 1/32 of 0..fs/2
+} fft_result;
+
+//u32_points Q15 samples from pi16_in, windowed, into bins 0 to u32_points / 2 - 1
+//of pi32_bins (u32_points int32_t). The input is left alone. False if
+//u32_points is not a power of 2 from FFT_MIN_POINTS to FFT_MAX_POINTS.
+bool fft_real_q15(const int16_t *pi16_in, int32_t *pi32_bins, uint32_t u32_points);
+
+//|X[k]|^2 of one bin
+static inline uint64_t fft_bin_power(const int32_t *pi32_bins, uint32_t u32_bin){
+    int64_t i64_re = pi32_bins[2 * u32_bin];
+    int64_t i64_im = pi32_bins[2 * u32_bin + 1];
+    return (uint64_t)(i64_re * i64_re) + (uint64_t)(i64_im * i64_im);
+}
+
+//one bin's power in dBFS
+float fft_bin_dbfs(const int32_t *pi32_bins, uint32_t u32_points, uint32_t u32_bin);
+
+//the tones, THD, SNR and the band levels of a block fft_real_q15() has done,
+//taken at u32_rateMilliHz (adc_rate_set())
+void fft_analyze(const int32_t *pi32_bins, uint32_t u32_points, uint32_t u32_rateMilliHz, fft_result *ps_result);
+
+//line u8_line of the report into pc_line (FFT_LINE_SIZE bytes), false past the last:
+//  FFT n=1024 fs=10000.000Hz bin=9.766Hz f0=100.0Hz -8.1dBFS thd=-18.6dB snr=32.1dB noise=-40.2dBFS
+//  PEAKS 100.0Hz/-8.1 300.0Hz/-27.2 500.0Hz/-36.0 700.0Hz/-41.9
+//  SPEC -11 -30 ... (the strongest bin of each band, whole dBFS)
+bool fft_format_line(const fft_result *ps_result, uint8_t u8_line, char *pc_line);
+
+#endif
@@ -0,0 +1,290 @@
+#include "filter.h"
+#include "edub_ram.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+//d_coef scaled by 2^u8_bits and rounded, false if it does not fit in i64_min..i64_max
+static bool filt_quantize(double d_coef, uint8_t u8_bits, int64_t i64_min, int64_t i64_max, int64_t *pi64_out){
+    double d_scaled = d_coef * (double)(1ll << u8_bits);
+    d_scaled = d_scaled < 0 ? d_scaled - 0.5 : d_scaled + 0.5;
+    if(!(d_scaled > (double)i64_min - 1.0 && d_scaled < (double)i64_max + 1.0)){
+        return false;
+    }
+    *pi64_out = (int64_t)d_scaled;
+    return *pi64_out >= i64_min && *pi64_out <= i64_max;
+}
+
+//(b0 + b1 + b2) / (1 + a1 + a2) in Q u8_bits from the quantized coefficients,
+//so priming matches where the filter really settles. 1 for an integrator.
+static int64_t filt_dc_gain(const int64_t *pi64_coef, uint8_t u8_bits){
+    int64_t i64_num = pi64_coef[0] + pi64_coef[1] + pi64_coef[2];
+    int64_t i64_den = (1ll << u8_bits) - pi64_coef[3] - pi64_coef[4];
+    if(i64_den == 0){
+        return 1ll << u8_bits;
+    }
+    double d_gain = (double)i64_num / (double)i64_den * (double)(1ll << u8_bits);
+    //a gain past 8 is not a filter the prime helps with
+    double d_max = (double)(8ll << u8_bits);
+    return (int64_t)(d_gain > d_max ? d_max : d_gain < -d_max ? -d_max : d_gain);
+}
+
+//the coefficients of one biquad row in Q u8_bits, a1 and a2 negated
+static bool filt_biquad_row(const double *pd_row, uint8_t u8_bits, int64_t i64_min, int64_t i64_max, int64_t *pi64_coef){
+    for(uint8_t u8_i = 0; u8_i < 5; u8_i++){
+        double d_coef = u8_i < 3 ? pd_row[u8_i] : -pd_row[u8_i];
+        if(!filt_quantize(d_coef, u8_bits, i64_min, i64_max, &pi64_coef[u8_i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+/********************************************************************
+ * Biquad, Q15
+ ********************************************************************/
+
+bool filt_biquad_q15_init(filt_biquad_q15 *ps_filt, uint8_t u8_sections, const double (*pad_coef)[5]){
+    memset(ps_filt, 0, sizeof(*ps_filt));
+    if(u8_sections > FILT_BIQUAD_MAX_SECTIONS){
+        return false;
+    }
+    for(uint8_t u8_s = 0; u8_s < u8_sections; u8_s++){
+        int64_t ai64_coef[5];
+        if(!filt_biquad_row(pad_coef[u8_s], 14, INT16_MIN, INT16_MAX, ai64_coef)){
+            ps_filt->u8_sections = 0;
+            return false;
+        }
+        ps_filt->as_section[u8_s].i32_b0 = (int32_t)ai64_coef[0];
+        ps_filt->as_section[u8_s].u32_b12 = filt_pack((int16_t)ai64_coef[1], (int16_t)ai64_coef[2]);
+        ps_filt->as_section[u8_s].u32_a12 = filt_pack((int16_t)ai64_coef[3], (int16_t)ai64_coef[4]);
+        ps_filt->as_section[u8_s].i32_dcGain = (int32_t)filt_dc_gain(ai64_coef, 14);
+    }
+    ps_filt->u8_sections = u8_sections;
+    return true;
+}
+
+void filt_biquad_q15_prime(filt_biquad_q15 *ps_filt, int16_t i16_value){
+    int32_t i32_x = i16_value;
+    for(uint8_t u8_s = 0; u8_s < ps_filt->u8_sections; u8_s++){
+        int32_t i32_y = filt_ssat16((int32_t)(((int64_t)i32_x * ps_filt->as_section[u8_s].i32_dcGain + (1 << 13)) >> 14));
+        ps_filt->as_section[u8_s].u32_x = filt_pack((int16_t)i32_x, (int16_t)i32_x);
+        ps_filt->as_section[u8_s].u32_y = filt_pack((int16_t)i32_y, (int16_t)i32_y);
+        i32_x = i32_y;
+    }
+}
+
+//one section over the whole block, so its state stays in registers. The
+//sum of 5 Q15 x Q14 products is up to 33 bits, hence SMLALD.
+void EDUB_RAM_FUNC(filt_biquad_q15_block)(filt_biquad_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples){
+    if(ps_filt->u8_sections == 0 && pi16_in != pi16_out){
+        memmove(pi16_out, pi16_in, u32_samples * sizeof(int16_t));
+    }
+    for(uint8_t u8_s = 0; u8_s < ps_filt->u8_sections; u8_s++){
+        int32_t i32_b0 = ps_filt->as_section[u8_s].i32_b0;
+        uint32_t u32_b12 = ps_filt->as_section[u8_s].u32_b12;
+        uint32_t u32_a12 = ps_filt->as_section[u8_s].u32_a12;
+        uint32_t u32_x = ps_filt->as_section[u8_s].u32_x;
+        uint32_t u32_y = ps_filt->as_section[u8_s].u32_y;
+        //the first section reads the input, the rest go over the output in place
+        const int16_t *pi16_src = u8_s == 0 ? pi16_in : pi16_out;
+        for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+            int32_t i32_x = pi16_src[u32_i];
+            int64_t i64_acc = (int64_t)(i32_b0 * i32_x + (1 << 13));
+            i64_acc = filt_smlald(u32_x, u32_b12, i64_acc);
+            i64_acc = filt_smlald(u32_y, u32_a12, i64_acc);
+            int32_t i32_y = filt_ssat16((int32_t)(i64_acc >> 14));
+            //the new sample into the low half, the old low half up (PKHBT)
+            u32_x = (uint16_t)i32_x | (u32_x << 16);
+            u32_y = (uint16_t)i32_y | (u32_y << 16);
+            pi16_out[u32_i] = (int16_t)i32_y;
+        }
+        ps_filt->as_section[u8_s].u32_x = u32_x;
+        ps_filt->as_section[u8_s].u32_y = u32_y;
+    }
+}
+
+/********************************************************************
+ * Biquad, Q31
+ ********************************************************************/
+
+bool filt_biquad_q31_init(filt_biquad_q31 *ps_filt, uint8_t u8_sections, const double (*pad_coef)[5]){
+    memset(ps_filt, 0, sizeof(*ps_filt));
+    if(u8_sections > FILT_BIQUAD_MAX_SECTIONS){
+        return false;
+    }
+    for(uint8_t u8_s = 0; u8_s < u8_sections; u8_s++){
+        int64_t ai64_coef[5];
+        if(!filt_biquad_row(pad_coef[u8_s], 30, INT32_MIN, INT32_MAX, ai64_coef)){
+            ps_filt->u8_sections = 0;
+            return false;
+        }
+        for(uint8_t u8_i = 0; u8_i < 5; u8_i++){
+            ps_filt->as_section[u8_s].ai32_coef[u8_i] = (int32_t)ai64_coef[u8_i];
+        }
+        ps_filt->as_section[u8_s].i64_dcGain = filt_dc_gain(ai64_coef, 30);
+    }
+    ps_filt->u8_sections = u8_sections;
+    return true;
+}
+
+static inline int32_t filt_sat32(int64_t i64_x){
+    return i64_x > INT32_MAX ? INT32_MAX : i64_x < INT32_MIN ? INT32_MIN : (int32_t)i64_x;
+}
+
+void EDUB_RAM_FUNC(filt_biquad_q31_prime)(filt_biquad_q31 *ps_filt, int32_t i32_value){
+    int32_t i32_x = i32_value;
+    for(uint8_t u8_s = 0; u8_s < ps_filt->u8_sections; u8_s++){
+        //x is under 2^29 and the gain under 8 in Q30, the product fits
+        int32_t i32_y = filt_sat32(((int64_t)i32_x * ps_filt->as_section[u8_s].i64_dcGain + (1 << 29)) >> 30);
+        ps_filt->as_section[u8_s].ai32_x[0] = i32_x;
+        ps_filt->as_section[u8_s].ai32_x[1] = i32_x;
+        ps_filt->as_section[u8_s].ai32_y[0] = i32_y;
+        ps_filt->as_section[u8_s].ai32_y[1] = i32_y;
+        i32_x = i32_y;
+    }
+}
+
+//each product is one SMLAL on the M33
+void EDUB_RAM_FUNC(filt_biquad_q31_block)(filt_biquad_q31 *ps_filt, const int32_t *pi32_in, int32_t *pi32_out, uint32_t u32_samples){
+    if(ps_filt->u8_sections == 0 && pi32_in != pi32_out){
+        memmove(pi32_out, pi32_in, u32_samples * sizeof(int32_t));
+    }
+    for(uint8_t u8_s = 0; u8_s < ps_filt->u8_sections; u8_s++){
+        const int32_t *pi32_coef = ps_filt->as_section[u8_s].ai32_coef;
+        int32_t i32_b0 = pi32_coef[0], i32_b1 = pi32_coef[1], i32_b2 = pi32_coef[2];
+        int32_t i32_a1 = pi32_coef[3], i32_a2 = pi32_coef[4];
+        int32_t i32_x1 = ps_filt->as_section[u8_s].ai32_x[0], i32_x2 = ps_filt->as_section[u8_s].ai32_x[1];
+        int32_t i32_y1 = ps_filt->as_section[u8_s].ai32_y[0], i32_y2 = ps_filt->as_section[u8_s].ai32_y[1];
+        const int32_t *pi32_src = u8_s == 0 ? pi32_in : pi32_out;
+        for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+            int32_t i32_x = pi32_src[u32_i];
+            int64_t i64_acc = 1 << 29;
+            i64_acc += (int64_t)i32_b0 * i32_x;
+            i64_acc += (int64_t)i32_b1 * i32_x1;
+            i64_acc += (int64_t)i32_b2 * i32_x2;
+            i64_acc += (int64_t)i32_a1 * i32_y1;
+            i64_acc += (int64_t)i32_a2 * i32_y2;
+            int32_t i32_y = filt_sat32(i64_acc >> 30);
+            i32_x2 = i32_x1;
+            i32_x1 = i32_x;
+            i32_y2 = i32_y1;
+            i32_y1 = i32_y;
+            pi32_out[u32_i] = i32_y;
+        }
+        ps_filt->as_section[u8_s].ai32_x[0] = i32_x1;
+        ps_filt->as_section[u8_s].ai32_x[1] = i32_x2;
+        ps_filt->as_section[u8_s].ai32_y[0] = i32_y1;
+        ps_filt->as_section[u8_s].ai32_y[1] = i32_y2;
+    }
+}
+
+/********************************************************************
+ * FIR, Q15
+ ********************************************************************/
+
+bool filt_fir_q15_init(filt_fir_q15 *ps_filt, uint8_t u8_taps, const double *pd_coef){
+    //0 taps passes samples through, until the taps are known to be good
+    memset(ps_filt, 0, sizeof(*ps_filt));
+    if(u8_taps == 0 || u8_taps > FILT_FIR_MAX_TAPS){
+        return false;
+    }
+    uint8_t u8_even = (u8_taps + 1) & ~1;
+    int16_t ai16_coef[FILT_FIR_MAX_TAPS] = {0};
+    int64_t i64_sumAbs = 0;
+    for(uint8_t u8_i = 0; u8_i < u8_taps; u8_i++){
+        int64_t i64_coef;
+        if(!filt_quantize(pd_coef[u8_i], 15, INT16_MIN, INT16_MAX, &i64_coef)){
+            return false;
+        }
+        i64_sumAbs += i64_coef < 0 ? -i64_coef : i64_coef;
+        //the newest sample is last in the history, so tap 0 goes last
+        ai16_coef[u8_even - 1 - u8_i] = (int16_t)i64_coef;
+    }
+    if(i64_sumAbs > 0xFFFF){
+        return false;
+    }
+    memcpy(ps_filt->ai16_coef, ai16_coef, sizeof(ai16_coef));
+    ps_filt->u8_taps = u8_even;
+    return true;
+}
+
+//the unaligned pair loads are single LDRs on the M33
+void EDUB_RAM_FUNC(filt_fir_q15_block)(filt_fir_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples){
+    uint32_t u32_taps = ps_filt->u8_taps;
+    uint32_t u32_pos = ps_filt->u8_pos;
+    if(u32_taps == 0){
+        if(pi16_in != pi16_out){
+            memmove(pi16_out, pi16_in, u32_samples * sizeof(int16_t));
+        }
+        return;
+    }
+    for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+        int16_t i16_x = pi16_in[u32_i];
+        ps_filt->ai16_hist[u32_pos] = i16_x;
+        ps_filt->ai16_hist[u32_pos + u32_taps] = i16_x;
+        u32_pos = u32_pos + 1 == u32_taps ? 0 : u32_pos + 1;
+        //oldest to newest
+        const int16_t *pi16_window = &ps_filt->ai16_hist[u32_pos];
+        int32_t i32_acc = 1 << 14;
+        for(uint32_t u32_k = 0; u32_k < u32_taps; u32_k += 2){
+            uint32_t u32_samplePair, u32_coefPair;
+            memcpy(&u32_samplePair, &pi16_window[u32_k], sizeof(uint32_t));
+            memcpy(&u32_coefPair, &ps_filt->ai16_coef[u32_k], sizeof(uint32_t));
+            i32_acc = filt_smlad(u32_samplePair, u32_coefPair, i32_acc);
+        }
+        pi16_out[u32_i] = (int16_t)filt_ssat16(i32_acc >> 15);
+    }
+    ps_filt->u8_pos = (uint8_t)u32_pos;
+}
+
+/********************************************************************
+ * Moving average, Q15
+ ********************************************************************/
+
+void filt_ma_q15_init(filt_ma_q15 *ps_filt, uint8_t u8_len, int16_t i16_value){
+    u8_len = u8_len == 0 ? 1 : u8_len > FILT_MA_MAX_LEN ? FILT_MA_MAX_LEN : u8_len;
+    ps_filt->u8_len = u8_len;
+    ps_filt->u8_pos = 0;
+    ps_filt->i32_sum = (int32_t)i16_value * u8_len;
+    for(uint8_t u8_i = 0; u8_i < u8_len; u8_i++){
+        ps_filt->ai16_hist[u8_i] = i16_value;
+    }
+}
+
+int16_t EDUB_RAM_FUNC(filt_ma_q15_sample)(filt_ma_q15 *ps_filt, int16_t i16_in){
+    int32_t i32_len = ps_filt->u8_len;
+    ps_filt->i32_sum += i16_in - ps_filt->ai16_hist[ps_filt->u8_pos];
+    ps_filt->ai16_hist[ps_filt->u8_pos] = i16_in;
+    ps_filt->u8_pos = ps_filt->u8_pos + 1 == i32_len ? 0 : ps_filt->u8_pos + 1;
+    //rounded to nearest, half away from 0, so it is the same either side of 0
+    int32_t i32_sum = ps_filt->i32_sum;
+    return (int16_t)((i32_sum + (i32_sum < 0 ? -(i32_len / 2) : i32_len / 2)) / i32_len);
+}
+
+void EDUB_RAM_FUNC(filt_ma_q15_block)(filt_ma_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples){
+    for(uint32_t u32_i = 0; u32_i < u32_samples; u32_i++){
+        pi16_out[u32_i] = filt_ma_q15_sample(ps_filt, pi16_in[u32_i]);
+    }
+}
+
+/********************************************************************
+ * Design
+ ********************************************************************/
+
+void filt_design_lowpass(double ad_coef[5], double d_cutoffHz, double d_sampleHz, double d_q){
+    double d_w0 = 2.0 * M_PI * d_cutoffHz / d_sampleHz;
+    double d_alpha = sin(d_w0) / (2.0 * d_q);
+    double d_sinHalf = sin(d_w0 / 2.0);
+    //1 - cos(w0), without losing it to rounding when w0 is small
+    double d_oneLessCos = 2.0 * d_sinHalf * d_sinHalf;
+    double d_a0 = 1.0 + d_alpha;
+    ad_coef[0] = d_oneLessCos / 2.0 / d_a0;
+    ad_coef[1] = d_oneLessCos / d_a0;
+    ad_coef[2] = ad_coef[0];
+    ad_coef[3] = -2.0 * cos(d_w0) / d_a0;
+    ad_coef[4] = (1.0 - d_alpha) / d_a0;
+}
@@ -0,0 +1,175 @@
+/**
+ * Fixed-point filters for ADC samples: biquad IIR cascades in Q15 and Q31,
+ * a moving average and a short FIR in Q15.
+ *
+ * Each filter keeps its own state and takes a block of samples at a time,
+ * in place if pi_in == pi_out, so a whole DMA block or FIFO drain goes
+ * through with one call. The Q15 filters are for 500 kS/s blocks: on the
+ * M33 they pair up the 16-bit samples and coefficients in 32-bit words and
+ * do two multiplies a cycle with SMLAD/SMLALD, and saturate with SSAT. The
+ * RISC-V cores and the host build get the same arithmetic from the C in
+ * filt_smlad() and friends below, to the bit.
+ *
+ * The coefficients are given as doubles, the way a filter design tool or
+ * filt_design_lowpass() puts them out, and quantized once by the init.
+ * Float is not enough: a lowpass's poles sit just inside 1 and its DC gain
+ * is set by digits past float's 24 bits.
+ * A biquad row is {b0, b1, b2, a1, a2} for
+ *     y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ * (a0 is 1). The Q15 biquad keeps its coefficients in Q14, so they can go
+ * up to 2. A lowpass at fs/50 keeps its DC gain within 1%, and lower
+ * cutoffs lose it fast as the poles close in on 1. The Q31 biquad (Q30
+ * coefficients, 64-bit accumulator) is for those: at fs/1000, 10 Hz at
+ * 10 kS/s, its DC gain is within 0.01%.
+ *
+ * Q15 is a 16-bit sample as a fraction of full scale: a 12-bit ADC reading
+ * shifted up by 3 (or by 4 less its midpoint, for a signed signal).
+ */
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "pico/stdlib.h"
+
+#if defined(__ARM_FEATURE_SIMD32) && defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#define FILT_DSP 1
+#endif
+
+#define FILT_BIQUAD_MAX_SECTIONS    4
+#define FILT_FIR_MAX_TAPS           32
+#define FILT_MA_MAX_LEN             64
+
+/**
+ * The DSP instructions the filters are written with. A pair is two int16_t
+ * in one word, the first in memory in the low half.
+ */
+
+//acc + lo(x) * lo(y) + hi(x) * hi(y), wraps at 32 bits as SMLAD does
+static inline int32_t filt_smlad(uint32_t u32_x, uint32_t u32_y, int32_t i32_acc){
+#ifdef FILT_DSP
+    return __smlad((int16x2_t)u32_x, (int16x2_t)u32_y, i32_acc);
+#else
+    int32_t i32_sum = (int32_t)(int16_t)u32_x * (int16_t)u32_y + (int32_t)(int16_t)(u32_x >> 16) * (int16_t)(u32_y >> 16);
+    return (int32_t)((uint32_t)i32_acc + (uint32_t)i32_sum);
+#endif
+}
+
+//the same with a 64-bit accumulator
+static inline int64_t filt_smlald(uint32_t u32_x, uint32_t u32_y, int64_t i64_acc){
+#ifdef FILT_DSP
+    return __smlald((int16x2_t)u32_x, (int16x2_t)u32_y, i64_acc);
+#else
+    return i64_acc + (int32_t)(int16_t)u32_x * (int16_t)u32_y + (int32_t)(int16_t)(u32_x >> 16) * (int16_t)(u32_y >> 16);
+#endif
+}
+
+//clamps to an int16_t
+static inline int32_t filt_ssat16(int32_t i32_x){
+#ifdef FILT_DSP
+    return __ssat(i32_x, 16);
+#else
+    return i32_x > INT16_MAX ? INT16_MAX : i32_x < INT16_MIN ? INT16_MIN : i32_x;
+#endif
+}
+
+//i16_lo in the low half, i16_hi in the high half
+static inline uint32_t filt_pack(int16_t i16_lo, int16_t i16_hi){
+    return (uint16_t)i16_lo | ((uint32_t)(uint16_t)i16_hi << 16);
+}
+
+/**
+ * Biquad cascade, Q15 samples. Direct form I, so the state is the samples
+ * themselves and a section can never overflow inside, only saturate at
+ * its output.
+ */
+typedef struct filt_biquad_q15
+{
+    uint8_t u8_sections;
+    struct {
+        int32_t i32_b0;         // b0 in Q14
+        uint32_t u32_b12;       // b1, b2 in Q14
+        uint32_t u32_a12;       // -a1, -a2 in Q14
+        uint32_t u32_x;         // x[n-1], x[n-2]
+        uint32_t u32_y;         // y[n-1], y[n-2]
+        int32_t i32_dcGain;     // in Q14, for filt_biquad_q15_prime()
+    } as_section[FILT_BIQUAD_MAX_SECTIONS];
+} filt_biquad_q15;
+
+//u8_sections rows of {b0, b1, b2, a1, a2}. False if there are too many or a
+//coefficient is 2 or more, the filter is then left passing samples through.
+bool filt_biquad_q15_init(filt_biquad_q15 *ps_filt, uint8_t u8_sections, const double (*pad_coef)[5]);
+
+//sets the state as if i16_value had been going in forever, so a lowpass
+//starts on the first reading instead of rising to it from 0
+void filt_biquad_q15_prime(filt_biquad_q15 *ps_filt, int16_t i16_value);
+
+void filt_biquad_q15_block(filt_biquad_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples);
+
+/**
+ * Biquad cascade, Q31 samples and Q30 coefficients. Five 32x32 products go
+ * into one 64-bit sum, so keep the input 2 bits below full scale (an ADC
+ * reading shifted up by 16 has plenty of room).
+ */
+typedef struct filt_biquad_q31
+{
+    uint8_t u8_sections;
+    struct {
+        int32_t ai32_coef[5];   // b0, b1, b2, -a1, -a2 in Q30
+        int32_t ai32_x[2];      // x[n-1], x[n-2]
+        int32_t ai32_y[2];      // y[n-1], y[n-2]
+        int64_t i64_dcGain;     // in Q30
+    } as_section[FILT_BIQUAD_MAX_SECTIONS];
+} filt_biquad_q31;
+
+//false as for the Q15 one, for a coefficient of 2 or more
+bool filt_biquad_q31_init(filt_biquad_q31 *ps_filt, uint8_t u8_sections, const double (*pad_coef)[5]);
+void filt_biquad_q31_prime(filt_biquad_q31 *ps_filt, int32_t i32_value);
+void filt_biquad_q31_block(filt_biquad_q31 *ps_filt, const int32_t *pi32_in, int32_t *pi32_out, uint32_t u32_samples);
+
+/**
+ * FIR, Q15 taps and samples. The taps are kept reversed and padded to an
+ * even count, and each sample goes into the history twice, u8_taps apart,
+ * so the last u8_taps samples are always in a row and the sum is one SMLAD
+ * per pair with no wrap. The sum is 32 bits: the taps' absolute values must
+ * add up to less than 2, which any lowpass or smoothing filter does.
+ */
+typedef struct filt_fir_q15
+{
+    uint8_t u8_taps;            // rounded up to even
+    uint8_t u8_pos;             // oldest sample in the history
+    int16_t ai16_coef[FILT_FIR_MAX_TAPS];           // oldest sample's tap first
+    int16_t ai16_hist[2 * FILT_FIR_MAX_TAPS];
+} filt_fir_q15;
+
+//false if there are too many taps, a tap is 1 or more or they add up to 2
+//or more. The filter is then left passing samples through.
+bool filt_fir_q15_init(filt_fir_q15 *ps_filt, uint8_t u8_taps, const double *pd_coef);
+void filt_fir_q15_block(filt_fir_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples);
+
+/**
+ * Moving average of the last u8_len samples, with a running sum so it costs
+ * the same for any length. Exact: a steady input comes out unchanged.
+ */
+typedef struct filt_ma_q15
+{
+    uint8_t u8_len;
+    uint8_t u8_pos;
+    int32_t i32_sum;
+    int16_t ai16_hist[FILT_MA_MAX_LEN];
+} filt_ma_q15;
+
+//u8_len is limited to 1..FILT_MA_MAX_LEN. Primed with i16_value.
+void filt_ma_q15_init(filt_ma_q15 *ps_filt, uint8_t u8_len, int16_t i16_value);
+void filt_ma_q15_block(filt_ma_q15 *ps_filt, const int16_t *pi16_in, int16_t *pi16_out, uint32_t u32_samples);
+
+//one sample in, the average out
+int16_t filt_ma_q15_sample(filt_ma_q15 *ps_filt, int16_t i16_in);
+
+/**
+ * Second-order Butterworth-style lowpass (RBJ cookbook) for one biquad row.
+ * d_q is 0.7071 for Butterworth. Two sections at Q 0.5412 and 1.3066 make
+ * a 4th-order Butterworth.
+ */
+void filt_design_lowpass(double ad_coef[5], double d_cutoffHz, double d_sampleHz, double d_q);
+
+#endif
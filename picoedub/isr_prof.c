@@ -0,0 +1,207 @@
+#include "isr_prof.h"
+#include "edub_ram.h"
+
+#ifdef ISR_PROF_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+
+static isr_prof_t as_isrs[ISR_PROF_MAX_ISRS];
+static uint8_t u8_numIsrs = 0;
+//ISRs on both cores add to the records (EDUB_CORE1_ACQ), masking interrupts
+//only stops the calling core, so the hardware spin lock guards them
+static spin_lock_t *p_lock;
+
+//dump position, the record is copied once per ISR so its lines agree
+static uint8_t u8_dumpIsr = 0;
+static uint8_t u8_dumpLine = 0;
+static isr_prof_t s_dumpCopy;
+
+static void isr_prof_stat_clear(isr_prof_stat_t *ps_stat){
+    memset(ps_stat, 0, sizeof(*ps_stat));
+    ps_stat->u32_min = UINT32_MAX;
+}
+
+static inline void isr_prof_stat_add(isr_prof_stat_t *ps_stat, uint32_t u32_value){
+    ps_stat->u32_count++;
+    ps_stat->u64_sum += u32_value;
+    if(u32_value < ps_stat->u32_min){
+        ps_stat->u32_min = u32_value;
+    }
+    if(u32_value > ps_stat->u32_max){
+        ps_stat->u32_max = u32_value;
+    }
+    uint32_t u32_bucket = u32_value == 0 ? 0 : 32 - __builtin_clz(u32_value);
+    if(u32_bucket >= ISR_PROF_BUCKETS){
+        u32_bucket = ISR_PROF_BUCKETS - 1;
+    }
+    ps_stat->au32_hist[u32_bucket]++;
+}
+
+void isr_prof_core_init(void){
+#ifdef __ARM_ARCH_8M_MAIN__
+    //the DWT only counts once trace is enabled in DEMCR
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#endif
+}
+
+void isr_prof_init(void){
+    isr_prof_core_init();
+    if(p_lock == NULL){
+        p_lock = spin_lock_init(spin_lock_claim_unused(true));
+    }
+    u8_numIsrs = 0;
+}
+
+uint8_t isr_prof_register(const char *pc_name){
+    if(u8_numIsrs >= ISR_PROF_MAX_ISRS){
+        return ISR_PROF_MAX_ISRS;
+    }
+    as_isrs[u8_numIsrs].pc_name = pc_name;
+    isr_prof_stat_clear(&as_isrs[u8_numIsrs].s_duration);
+    isr_prof_stat_clear(&as_isrs[u8_numIsrs].s_latency);
+    isr_prof_stat_clear(&as_isrs[u8_numIsrs].s_xipMiss);
+    return u8_numIsrs++;
+}
+
+void EDUB_RAM_FUNC(isr_prof_exit)(uint8_t u8_id, uint32_t u32_start){
+    uint32_t u32_end = ISR_PROF_NOW();
+#ifdef ISR_PROF_XIP_MISSES
+    //hits first, so an access between the two reads only adds to acc, and
+    //no nested ISR on this core can clear the counters between them. The
+    //other core's ISRs share the cache and still can, so a cleared pair
+    //counts as no misses rather than wrapping to about 4 billion.
+    uint32_t u32_irqStatus = save_and_disable_interrupts();
+    uint32_t u32_hits = xip_ctrl_hw->ctr_hit;
+    uint32_t u32_acc = xip_ctrl_hw->ctr_acc;
+    restore_interrupts(u32_irqStatus);
+    uint32_t u32_misses = u32_acc < u32_hits ? 0 : u32_acc - u32_hits;
+#endif
+    if(u8_id >= u8_numIsrs){
+        return;
+    }
+    uint32_t status = spin_lock_blocking(p_lock);
+    //unsigned subtraction is right across a counter wrap
+    isr_prof_stat_add(&as_isrs[u8_id].s_duration, u32_end - u32_start);
+#ifdef ISR_PROF_XIP_MISSES
+    isr_prof_stat_add(&as_isrs[u8_id].s_xipMiss, u32_misses);
+#endif
+    spin_unlock(p_lock, status);
+}
+
+void EDUB_RAM_FUNC(isr_prof_latency)(uint8_t u8_id, uint32_t u32_lateUs){
+    if(u8_id >= u8_numIsrs){
+        return;
+    }
+    //an alarm that fired early shows up as a huge value, count it as on time
+    if((int32_t)u32_lateUs < 0){
+        u32_lateUs = 0;
+    }
+    uint32_t status = spin_lock_blocking(p_lock);
+    isr_prof_stat_add(&as_isrs[u8_id].s_latency, u32_lateUs);
+    spin_unlock(p_lock, status);
+}
+
+void isr_prof_reset(void){
+    uint32_t status = spin_lock_blocking(p_lock);
+    for(uint8_t u8_i = 0; u8_i < u8_numIsrs; u8_i++){
+        isr_prof_stat_clear(&as_isrs[u8_i].s_duration);
+        isr_prof_stat_clear(&as_isrs[u8_i].s_latency);
+        isr_prof_stat_clear(&as_isrs[u8_i].s_xipMiss);
+    }
+    spin_unlock(p_lock, status);
+}
+
+bool isr_prof_get(uint8_t u8_id, isr_prof_t *ps_out){
+    if(u8_id >= u8_numIsrs){
+        return false;
+    }
+    uint32_t status = spin_lock_blocking(p_lock);
+    *ps_out = as_isrs[u8_id];
+    spin_unlock(p_lock, status);
+    return true;
+}
+
+void isr_prof_dump_begin(void){
+    u8_dumpIsr = 0;
+    u8_dumpLine = 0;
+}
+
+static void isr_prof_format_summary(char *pc_line, const char *pc_label, const char *pc_unit, const isr_prof_stat_t *ps_stat){
+    if(ps_stat->u32_count == 0){
+        snprintf(pc_line, ISR_PROF_LINE_SIZE, "  %s: none\n\r", pc_label);
+        return;
+    }
+    snprintf(pc_line, ISR_PROF_LINE_SIZE, "  %s %s: n=%lu min=%lu mean=%lu max=%lu\n\r", pc_label, pc_unit,
+             (unsigned long)ps_stat->u32_count, (unsigned long)ps_stat->u32_min,
+             (unsigned long)(ps_stat->u64_sum / ps_stat->u32_count), (unsigned long)ps_stat->u32_max);
+}
+
+static void isr_prof_format_hist(char *pc_line, const isr_prof_stat_t *ps_stat){
+    int i_len = snprintf(pc_line, ISR_PROF_LINE_SIZE, "   log2:");
+    for(uint8_t u8_b = 0; u8_b < ISR_PROF_BUCKETS && i_len < ISR_PROF_LINE_SIZE; u8_b++){
+        i_len += snprintf(pc_line + i_len, ISR_PROF_LINE_SIZE - i_len, " %lu", (unsigned long)ps_stat->au32_hist[u8_b]);
+    }
+    if(i_len < ISR_PROF_LINE_SIZE){
+        snprintf(pc_line + i_len, ISR_PROF_LINE_SIZE - i_len, "\n\r");
+    }
+}
+
+/*****************************************************************
+ * Each ISR prints as a name line, then a summary and a histogram
+ * line for its duration and, if it has any, for its latency and
+ * its XIP cache misses.
+ *****************************************************************/
+bool isr_prof_dump_next(char *pc_line){
+    while(u8_dumpIsr < u8_numIsrs){
+        switch(u8_dumpLine++){
+        case 0:
+            isr_prof_get(u8_dumpIsr, &s_dumpCopy);
+            snprintf(pc_line, ISR_PROF_LINE_SIZE, "ISR %s\n\r", s_dumpCopy.pc_name);
+            return true;
+        case 1:
+            isr_prof_format_summary(pc_line, "duration", ISR_PROF_UNIT, &s_dumpCopy.s_duration);
+            return true;
+        case 2:
+            if(s_dumpCopy.s_duration.u32_count == 0){
+                continue;
+            }
+            isr_prof_format_hist(pc_line, &s_dumpCopy.s_duration);
+            return true;
+        case 3:
+            if(s_dumpCopy.s_latency.u32_count == 0){
+                continue;
+            }
+            isr_prof_format_summary(pc_line, "latency", "us", &s_dumpCopy.s_latency);
+            return true;
+        case 4:
+            if(s_dumpCopy.s_latency.u32_count == 0){
+                continue;
+            }
+            isr_prof_format_hist(pc_line, &s_dumpCopy.s_latency);
+            return true;
+        case 5:
+            if(s_dumpCopy.s_xipMiss.u32_count == 0){
+                continue;
+            }
+            isr_prof_format_summary(pc_line, "xip", "misses", &s_dumpCopy.s_xipMiss);
+            return true;
+        case 6:
+            if(s_dumpCopy.s_xipMiss.u32_count == 0){
+                continue;
+            }
+            isr_prof_format_hist(pc_line, &s_dumpCopy.s_xipMiss);
+            return true;
+        default:
+            u8_dumpIsr++;
+            u8_dumpLine = 0;
+            break;
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * ISR profiler.
+ *
+ * Each instrumented ISR stamps its entry and exit. Durations are counted on
+ * the Cortex-M33 DWT cycle counter (timer_hw microseconds when it is not
+ * available) and latency is how late an ISR started after the time it was
+ * due, which is only known for alarms. On the RP2350 it also counts the
+ * XIP cache misses each ISR took, the fetches that had to go out to flash
+ * (0 for an ISR that runs from SRAM, see edub_ram.h). Each keeps min/max/mean
+ * and a log2 histogram per ISR, and isr_prof_dump_next() prints them a line at a time
+ * so the output fits through the small UART buffers.
+ *
+ * Usage:
+ *     static uint8_t u8_prof;                        //u8_prof = isr_prof_register("alarm");
+ *     void alarmCallback(){
+ *         uint32_t u32_profStart = ISR_PROF_ENTER();
+ *         isr_prof_latency(u8_prof, time_us_32() - u32_target);
+ *         ...
+ *         isr_prof_exit(u8_prof, u32_profStart);
+ *     }
+ *
+ * Build with ISR_PROF_ENABLE undefined and every hook compiles to nothing.
+ */
+#ifndef ISR_PROF_H
+#define ISR_PROF_H
+
+#include "pico/stdlib.h"
+
+#define ISR_PROF_MAX_ISRS   8
+//bucket n holds values in [2^(n-1), 2^n), the last one everything above
+#define ISR_PROF_BUCKETS    16
+#define ISR_PROF_LINE_SIZE  128
+
+#if defined(ISR_PROF_ENABLE) && defined(__ARM_ARCH_8M_MAIN__)
+#include "hardware/structs/m33.h"
+#include "hardware/structs/xip_ctrl.h"
+#define ISR_PROF_NOW()      (m33_hw->dwt_cyccnt)
+#define ISR_PROF_UNIT       "cyc"
+#define ISR_PROF_XIP_MISSES
+#else
+#include "hardware/timer.h"
+#define ISR_PROF_NOW()      (timer_hw->timerawl)
+#define ISR_PROF_UNIT       "us"
+#endif
+
+typedef struct {
+    uint32_t u32_count;
+    uint32_t u32_min;
+    uint32_t u32_max;
+    uint64_t u64_sum;
+    uint32_t au32_hist[ISR_PROF_BUCKETS];
+} isr_prof_stat_t;
+
+typedef struct {
+    const char *pc_name;
+    isr_prof_stat_t s_duration;    // ISR_PROF_UNIT
+    isr_prof_stat_t s_latency;     // microseconds
+    isr_prof_stat_t s_xipMiss;     // XIP cache misses
+} isr_prof_t;
+
+#ifdef ISR_PROF_ENABLE
+
+//starts the cycle counter, call once before registering
+void isr_prof_init(void);
+
+//each core has its own cycle counter, core 1 calls this before its ISRs
+//are turned on. isr_prof_init() does it for the core that calls it.
+void isr_prof_core_init(void);
+
+//returns the id for the hooks, or ISR_PROF_MAX_ISRS if the table is full
+uint8_t isr_prof_register(const char *pc_name);
+
+#ifdef ISR_PROF_XIP_MISSES
+//the cache's access and hit counters saturate, so each ISR clears them on
+//entry. A nested ISR clears them too, and so does an ISR on the other core
+//(EDUB_CORE1_ACQ), as both cores share the cache: the ISR that was running
+//undercounts. isr_prof_exit() reads the pair with interrupts off and counts
+//a pair cleared between its reads as 0, so the count never wraps.
+static inline uint32_t isr_prof_enter(void){
+    xip_ctrl_hw->ctr_acc = 0;
+    xip_ctrl_hw->ctr_hit = 0;
+    return ISR_PROF_NOW();
+}
+#define ISR_PROF_ENTER() isr_prof_enter()
+#else
+#define ISR_PROF_ENTER() ISR_PROF_NOW()
+#endif
+void isr_prof_exit(uint8_t u8_id, uint32_t u32_start);
+void isr_prof_latency(uint8_t u8_id, uint32_t u32_lateUs);
+
+//clears all statistics, the registered names stay. Takes the spin lock,
+//so it is safe while core 1's ISRs are running
+void isr_prof_reset(void);
+
+//copy of one ISR's record, taken under the profiler's spin lock so
+//neither core's ISRs can write it halfway
+bool isr_prof_get(uint8_t u8_id, isr_prof_t *ps_out);
+
+//restarts the dump, then each call writes the next line into pc_line
+//(at least ISR_PROF_LINE_SIZE bytes) and returns false when it is done
+void isr_prof_dump_begin(void);
+bool isr_prof_dump_next(char *pc_line);
+
+#else
+
+#define isr_prof_init()                 ((void)0)
+#define isr_prof_core_init()            ((void)0)
+#define isr_prof_register(pc_name)      ((uint8_t)0)
+#define ISR_PROF_ENTER()                (0u)
+#define isr_prof_exit(u8_id, u32_start) ((void)(u32_start))
+#define isr_prof_latency(u8_id, u32_lateUs) ((void)0)
+#define isr_prof_reset()                ((void)0)
+#define isr_prof_get(u8_id, ps_out)     (false)
+#define isr_prof_dump_begin()           ((void)0)
+#define isr_prof_dump_next(pc_line)     (false)
+
+#endif
+
+#endif
@@ -0,0 +1,187 @@
+#include "led_pwm.h"
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+//same pins as PICOEDUB_LED0_PIN..PICOEDUB_LED3_PIN
+static const uint8_t au8_ledPins[LED_COUNT] = {PICO_DEFAULT_LED_PIN, 1, 0, 2, 3};
+
+#define LED_MAX_SLICES 3
+
+typedef struct {
+    uint8_t u8_pattern;       // led_pattern_t
+    uint16_t u16_steps;       // table length this pattern needs
+} led_state_t;
+
+typedef struct {
+    uint32_t au32_table[LED_PATTERN_MAX_STEPS];  // CC words, A in the low half, B in the high half
+    const uint32_t *pu32_tableStart;             // read by the reload channel
+    int8_t ai8_led[2];                           // LED on channel A and B, -1 if none
+    uint u_slice;
+    int i_dataChan;
+    int i_reloadChan;
+} led_slice_t;
+
+static led_state_t as_leds[LED_COUNT];
+static led_slice_t as_slices[LED_MAX_SLICES];
+static uint8_t u8_numSlices = 0;
+
+static uint16_t led_gcd(uint16_t a, uint16_t b){
+    while(b != 0){
+        uint16_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+//level of one pattern at step u16_step of u16_steps
+static uint16_t led_pattern_level(uint8_t u8_pattern, uint16_t u16_step, uint16_t u16_steps){
+    uint32_t u32_phase = ((uint32_t)u16_step << 16) / u16_steps;   // 0..65535 over the period
+    switch(u8_pattern){
+    case LED_PATTERN_ON:
+        return LED_PWM_TOP;
+    case LED_PATTERN_BLINK:
+        return u32_phase < 32768 ? LED_PWM_TOP : 0;
+    case LED_PATTERN_BREATHE: {
+        //triangle, squared so the fade looks even to the eye
+        uint32_t u32_tri = u32_phase < 32768 ? u32_phase * 2 : (65535 - u32_phase) * 2;
+        return (uint16_t)(((u32_tri >> 8) * (u32_tri >> 8) * LED_PWM_TOP) >> 16);
+    }
+    case LED_PATTERN_HEARTBEAT:
+        //flashes at 0-10% and 20-30% of the period
+        if(u32_phase < 6554 || (u32_phase >= 13107 && u32_phase < 19661)){
+            return LED_PWM_TOP;
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+static void led_stop_dma(led_slice_t *ps_slice){
+    //the reload channel can retrigger the data channel, so abort it on both sides
+    dma_channel_abort(ps_slice->i_reloadChan);
+    dma_channel_abort(ps_slice->i_dataChan);
+    dma_channel_abort(ps_slice->i_reloadChan);
+}
+
+/*****************************************************************
+ * Rebuilds a slice's table and restarts its DMA. The data channel
+ * copies the table into the CC register, one entry per pacer wrap,
+ * then chains to the reload channel which writes the table address
+ * back into the data channel's read address trigger and so starts
+ * it over. Both LEDs on the slice are in one CC word, so the table
+ * is as long as the least common multiple of the two patterns.
+ *****************************************************************/
+static void led_slice_restart(led_slice_t *ps_slice){
+    uint16_t u16_steps = 1;
+    for(uint8_t u8_chan = 0; u8_chan < 2; u8_chan++){
+        if(ps_slice->ai8_led[u8_chan] < 0){
+            continue;
+        }
+        uint16_t u16_ledSteps = as_leds[ps_slice->ai8_led[u8_chan]].u16_steps;
+        uint32_t u32_lcm = (uint32_t)u16_steps / led_gcd(u16_steps, u16_ledSteps) * u16_ledSteps;
+        //too long to repeat both exactly, the shorter one slips a little each period
+        u16_steps = u32_lcm <= LED_PATTERN_MAX_STEPS ? (uint16_t)u32_lcm : MAX(u16_steps, u16_ledSteps);
+    }
+
+    led_stop_dma(ps_slice);
+
+    for(uint16_t u16_i = 0; u16_i < u16_steps; u16_i++){
+        uint32_t u32_cc = 0;
+        for(uint8_t u8_chan = 0; u8_chan < 2; u8_chan++){
+            int8_t i8_led = ps_slice->ai8_led[u8_chan];
+            if(i8_led < 0){
+                continue;
+            }
+            uint16_t u16_ledSteps = as_leds[i8_led].u16_steps;
+            u32_cc |= (uint32_t)led_pattern_level(as_leds[i8_led].u8_pattern, u16_i % u16_ledSteps, u16_ledSteps) << (16 * u8_chan);
+        }
+        ps_slice->au32_table[u16_i] = u32_cc;
+    }
+
+    //a pattern that does not change needs no DMA
+    pwm_hw->slice[ps_slice->u_slice].cc = ps_slice->au32_table[0];
+    if(u16_steps == 1){
+        return;
+    }
+
+    dma_channel_config s_config = dma_channel_get_default_config(ps_slice->i_reloadChan);
+    channel_config_set_transfer_data_size(&s_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&s_config, false);
+    channel_config_set_write_increment(&s_config, false);
+    dma_channel_configure(ps_slice->i_reloadChan, &s_config,
+                          &dma_hw->ch[ps_slice->i_dataChan].al3_read_addr_trig,
+                          &ps_slice->pu32_tableStart, 1, false);
+
+    s_config = dma_channel_get_default_config(ps_slice->i_dataChan);
+    channel_config_set_transfer_data_size(&s_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&s_config, true);
+    channel_config_set_write_increment(&s_config, false);
+    channel_config_set_dreq(&s_config, pwm_get_dreq(LED_PACER_SLICE));
+    channel_config_set_chain_to(&s_config, ps_slice->i_reloadChan);
+    dma_channel_configure(ps_slice->i_dataChan, &s_config,
+                          &pwm_hw->slice[ps_slice->u_slice].cc,
+                          ps_slice->au32_table, u16_steps, true);
+}
+
+void led_init(uint32_t u32_ledMask){
+    //pattern tick: a slice with no pin, wrapping LED_PATTERN_TICK_HZ times a second
+    uint32_t u32_sysHz = clock_get_hz(clk_sys);
+    uint32_t u32_div = (u32_sysHz / LED_PATTERN_TICK_HZ + 65535) / 65536;
+    pwm_config s_pacer = pwm_get_default_config();
+    pwm_config_set_clkdiv_int_frac(&s_pacer, (uint8_t)u32_div, 0);
+    pwm_config_set_wrap(&s_pacer, (uint16_t)(u32_sysHz / (u32_div * LED_PATTERN_TICK_HZ) - 1));
+    pwm_init(LED_PACER_SLICE, &s_pacer, true);
+
+    for(uint8_t u8_led = 0; u8_led < LED_COUNT; u8_led++){
+        as_leds[u8_led].u8_pattern = LED_PATTERN_OFF;
+        as_leds[u8_led].u16_steps = 1;
+        if(!(u32_ledMask & LED_MASK(u8_led))){
+            continue;
+        }
+
+        uint u_slice = pwm_gpio_to_slice_num(au8_ledPins[u8_led]);
+        led_slice_t *ps_slice = NULL;
+        for(uint8_t u8_i = 0; u8_i < u8_numSlices; u8_i++){
+            if(as_slices[u8_i].u_slice == u_slice){
+                ps_slice = &as_slices[u8_i];
+            }
+        }
+        if(ps_slice == NULL){
+            ps_slice = &as_slices[u8_numSlices++];
+            ps_slice->u_slice = u_slice;
+            ps_slice->ai8_led[0] = -1;
+            ps_slice->ai8_led[1] = -1;
+            ps_slice->pu32_tableStart = ps_slice->au32_table;
+            ps_slice->i_dataChan = dma_claim_unused_channel(true);
+            ps_slice->i_reloadChan = dma_claim_unused_channel(true);
+
+            pwm_config s_config = pwm_get_default_config();
+            pwm_config_set_wrap(&s_config, LED_PWM_TOP);
+            pwm_init(u_slice, &s_config, true);
+            pwm_hw->slice[u_slice].cc = 0;
+        }
+        ps_slice->ai8_led[pwm_gpio_to_channel(au8_ledPins[u8_led])] = u8_led;
+        gpio_set_function(au8_ledPins[u8_led], GPIO_FUNC_PWM);
+    }
+}
+
+void led_set_pattern(led_id_t led, led_pattern_t pattern, uint16_t u16_periodMs){
+    uint16_t u16_steps = 1;
+    if(pattern != LED_PATTERN_OFF && pattern != LED_PATTERN_ON){
+        u16_steps = u16_periodMs / LED_PATTERN_TICK_MS;
+        u16_steps = MIN(MAX(u16_steps, 2), LED_PATTERN_MAX_STEPS);
+    }
+    as_leds[led].u8_pattern = pattern;
+    as_leds[led].u16_steps = u16_steps;
+
+    uint u_slice = pwm_gpio_to_slice_num(au8_ledPins[led]);
+    for(uint8_t u8_i = 0; u8_i < u8_numSlices; u8_i++){
+        if(as_slices[u8_i].u_slice == u_slice){
+            led_slice_restart(&as_slices[u8_i]);
+        }
+    }
+}
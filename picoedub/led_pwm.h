@@ -0,0 +1,54 @@
+/**
+ * LED service for the Pico LED and the eduboard LED0-LED3.
+ *
+ * Each LED is driven by its PWM slice. A pattern (blink, breathe, heartbeat)
+ * is turned into a table of compare values once, when it is set, and DMA
+ * copies one entry per pattern tick into the slice's CC register. The ticks
+ * come from a spare PWM slice that is never connected to a pin. After the
+ * pattern is set the CPU does nothing, no timer interrupt and no GPIO writes.
+ *
+ * LEDs on the same slice share one table (LED2/LED3 and LED0/LED1), so their
+ * patterns run in step. LED0 and LED1 are on GPIO 0 and 1, the UART pins, so
+ * only pass them to led_init() in programs that do not use the UART.
+ */
+#ifndef LED_PWM_H
+#define LED_PWM_H
+
+#include "pico/stdlib.h"
+
+#ifndef LED_PACER_SLICE
+#define LED_PACER_SLICE         7
+#endif
+#define LED_PATTERN_TICK_HZ     100
+#define LED_PATTERN_TICK_MS     (1000 / LED_PATTERN_TICK_HZ)
+//longest table, so the longest period is 2.56 s
+#define LED_PATTERN_MAX_STEPS   256
+//PWM resolution of the LEDs, about 36 kHz at 150 MHz
+#define LED_PWM_TOP             4095
+
+typedef enum {
+    LED_PICO,
+    LED_EDUB0,
+    LED_EDUB1,
+    LED_EDUB2,
+    LED_EDUB3,
+    LED_COUNT
+} led_id_t;
+
+#define LED_MASK(id) (1u << (id))
+
+typedef enum {
+    LED_PATTERN_OFF,
+    LED_PATTERN_ON,
+    LED_PATTERN_BLINK,       // on for half the period
+    LED_PATTERN_BREATHE,     // fades up and down over the period
+    LED_PATTERN_HEARTBEAT    // two short flashes per period
+} led_pattern_t;
+
+//takes the LEDs in u32_ledMask (LED_MASK(LED_PICO) | ...) and starts the pattern tick
+void led_init(uint32_t u32_ledMask);
+
+//period is rounded to pattern ticks, ignored for OFF and ON
+void led_set_pattern(led_id_t led, led_pattern_t pattern, uint16_t u16_periodMs);
+
+#endif
@@ -0,0 +1,55 @@
+#include "mailbox.h"
+#include "edub_ram.h"
+
+bool mailbox_init(mailbox *ps_box, uint32_t u32_bytes){
+    ps_box->u32_seq = 0;
+    ps_box->u32_words = (u32_bytes + 3) / 4;
+    for(uint32_t u32_i = 0; u32_i < MAILBOX_WORDS; u32_i++){
+        ps_box->au32_data[u32_i] = 0;
+    }
+    ps_box->u32_retries = 0;
+    //a cut-short copy would hand readers half a record
+    if(ps_box->u32_words > MAILBOX_WORDS){
+        ps_box->u32_words = 0;
+        return false;
+    }
+    return true;
+}
+
+void EDUB_RAM_FUNC(mailbox_write)(mailbox *ps_box, const void *pv_record){
+    const uint32_t *pu32_record = pv_record;
+    uint32_t u32_seq = ps_box->u32_seq;
+    ps_box->u32_seq = u32_seq + 1;
+    //readers have to see the odd count before any of the new words
+    __dmb();
+    for(uint32_t u32_i = 0; u32_i < ps_box->u32_words; u32_i++){
+        ps_box->au32_data[u32_i] = pu32_record[u32_i];
+    }
+    //and all of the new words before the even one
+    __dmb();
+    ps_box->u32_seq = u32_seq + 2;
+}
+
+uint32_t mailbox_read(mailbox *ps_box, void *pv_record){
+    uint32_t *pu32_record = pv_record;
+    while(true){
+        uint32_t u32_seq = ps_box->u32_seq;
+        if((u32_seq & 1) == 0){
+            //the words are read only after the count they go with
+            __dmb();
+            for(uint32_t u32_i = 0; u32_i < ps_box->u32_words; u32_i++){
+                pu32_record[u32_i] = ps_box->au32_data[u32_i];
+            }
+            //and the count again only after all of them
+            __dmb();
+            if(ps_box->u32_seq == u32_seq){
+                return u32_seq >> 1;
+            }
+        }
+        ps_box->u32_retries++;
+    }
+}
+
+uint32_t mailbox_writes(mailbox *ps_box){
+    return ps_box->u32_seq >> 1;
+}
@@ -0,0 +1,61 @@
+/**
+ * A "latest value" mailbox: one writer keeps replacing a small record and
+ * readers take a copy of whichever one is newest.
+ *
+ * A ring (cb.c, spsc.c) keeps every item in order. A reading from a sensor
+ * only matters until the next one, and a reader that wants the value, the
+ * time it was taken and the channel it came from needs all three from the
+ * same write. The mailbox is a sequence lock. The writer makes u32_seq odd,
+ * copies the record in and makes it even again. A reader copies the record
+ * out between two reads of u32_seq and starts over if they differ or are
+ * odd, so it never keeps a copy the writer was in the middle of.
+ *
+ * Neither side disables interrupts. The writer never waits, so it is safe
+ * in an ISR. A reader only loops while a write is under way, which is a
+ * few instructions whether the writer is an ISR on the same core or code
+ * on the other one. There has to be exactly one writer, and a reader must
+ * not be able to interrupt the writer on its own core: it would spin on
+ * the odd count forever. A main loop reading what an ISR writes is fine.
+ *
+ * Records are copied a word at a time, so they must be word aligned (any
+ * struct with a uint32_t in it is) and at most MAILBOX_WORDS words.
+ * mailbox_init() refuses a larger one rather than cutting it short, and a
+ * caller that knows its record type can check it at compile time:
+ *     _Static_assert(sizeof(sample_t) <= MAILBOX_WORDS * 4, "sample_t is too big for a mailbox");
+ */
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#ifndef MAILBOX_WORDS
+    #define MAILBOX_WORDS 4
+#endif
+
+typedef struct mailbox
+{
+    volatile uint32_t u32_seq;                  // twice the writes, odd while one is under way
+    volatile uint32_t au32_data[MAILBOX_WORDS];
+    uint32_t u32_words;                         // size of the record
+    uint32_t u32_retries;                       // reads that had to start over, reader side
+} mailbox;
+
+//u32_bytes is sizeof the record, the record reads as all zeros until the first write.
+//false if the record is bigger than MAILBOX_WORDS words, the mailbox then
+//holds nothing: writes store nothing and reads copy nothing
+bool mailbox_init(mailbox *ps_box, uint32_t u32_bytes);
+
+//writer side, replaces the record with *pv_record
+void mailbox_write(mailbox *ps_box, const void *pv_record);
+
+//reader side, copies the newest record into *pv_record and returns how many
+//writes there had been when it was written (0 if none yet). Comparing that
+//with the last read's says whether it is new and how many were missed
+//between the two. It counts modulo 2^31.
+uint32_t mailbox_read(mailbox *ps_box, void *pv_record);
+
+//how many writes there have been, to check for a new record without copying it
+uint32_t mailbox_writes(mailbox *ps_box);
+
+#endif
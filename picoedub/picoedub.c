@@ -0,0 +1,149 @@
+
+#include "picoedub.h"
+#include "edub_ram.h"
+
+void gpio_input_reset(uint8_t u8_pin_num){
+    gpio_set_dir(u8_pin_num, GPIO_OUT);
+    gpio_put(u8_pin_num, false);
+    gpio_set_dir(u8_pin_num, GPIO_IN);
+}
+
+
+
+// Initialize the GPIO for the LED
+void pico_led_init(void) {
+#ifdef PICO_DEFAULT_LED_PIN
+    // A device like Pico that uses a GPIO for the LED will define PICO_DEFAULT_LED_PIN
+    // so we can use normal GPIO functionality to turn the led on and off
+    gpio_init(PICO_DEFAULT_LED_PIN);
+    gpio_set_dir(PICO_DEFAULT_LED_PIN, GPIO_OUT);
+#endif
+}
+
+// Turn the LED on or off
+void pico_set_led(bool b_led_on) {
+#if defined(PICO_DEFAULT_LED_PIN)
+    // Just set the GPIO on or off
+    gpio_put(PICO_DEFAULT_LED_PIN, b_led_on);
+#endif
+}
+
+void gpio_to_EDUB_led_init(uint8_t u8_PIN_NUM) {
+    gpio_init(u8_PIN_NUM);
+    gpio_set_dir(u8_PIN_NUM, GPIO_OUT);
+}
+
+
+void flash_led_gpio_to_EDUB(uint8_t  u8_PIN_NUM){
+    gpio_put(u8_PIN_NUM, true);
+    sleep_ms(LED_DELAY_MS);
+    gpio_put(u8_PIN_NUM, false);
+}
+
+//non blocking write char function based off sdk. Returns true for wrote, returns false for timeout
+inline bool EDUB_RAM_FUNC(uart_putc_nonBlocking)(uart_inst_t *uart, const uint8_t src, uint32_t numAttempts){
+    
+    for (size_t i = 0; i < numAttempts; ++i) {
+            if(!uart_is_writable(uart)){
+                continue;
+            }
+            else{
+                uart_get_hw(uart)->dr = src;
+                return true;
+            }
+    }
+    return false;
+}
+
+inline bool adc_fifo_drain_nonBlocking(uint32_t u32_timeOut) {
+    // Potentially there is still a conversion in progress -- wait for this to complete before draining
+    uint32_t u32_counter = 0;
+    while (!(adc_hw->cs & ADC_CS_READY_BITS) && u32_counter < u32_timeOut){
+        u32_counter++;
+    }
+    if(u32_counter == u32_timeOut){
+        return false;
+    }
+    while (!adc_fifo_is_empty())
+        (void) adc_fifo_get();
+
+    return true;
+}
+
+void edub_gpio_init(void){
+    //LEDs and inputs are set up as two groups instead of one pin at a time
+    gpio_init_mask(PICOEDUB_LED_MASK | PICOEDUB_INPUT_MASK);
+    gpio_clr_mask(PICOEDUB_LED_MASK);
+    gpio_set_dir_out_masked(PICOEDUB_LED_MASK);
+    gpio_set_dir_in_masked(PICOEDUB_INPUT_MASK);
+
+    //The pull downs hold an open switch or column low, which is what the
+    //old read_*() helpers did by driving the pin low before every read.
+    //There is no masked call for the pads, so this is still one per pin.
+    for(uint u_pin = 0; u_pin < 32; u_pin++){
+        if(PICOEDUB_INPUT_MASK & (1u << u_pin)){
+            gpio_pull_down(u_pin);
+        }
+    }
+}
+
+uint32_t edub_read_inputs(void){
+    return gpio_get_all() & PICOEDUB_INPUT_MASK;
+}
+
+void edub_set_leds(uint32_t u32_ledMask){
+    gpio_put_masked(PICOEDUB_LED_MASK, u32_ledMask);
+}
+
+void pico_set_LED0(bool led_on) {
+    // Just set the GPIO on or off
+    gpio_put(PICOEDUB_LED0_PIN, led_on);
+}
+
+void pico_set_LED1(bool led_on) {
+    // Just set the GPIO on or off
+    gpio_put(PICOEDUB_LED1_PIN, led_on);
+}
+
+void pico_set_LED2(bool led_on) {
+    // Just set the GPIO on or off
+    gpio_put(PICOEDUB_LED2_PIN, led_on);
+}
+
+void pico_set_LED3(bool led_on) {
+    // Just set the GPIO on or off
+    gpio_put(PICOEDUB_LED3_PIN, led_on);
+}
+
+
+bool read_sw2r3(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_SW2R3_PIN);
+}
+
+bool read_sw3r2(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_SW3R2_PIN);
+}
+
+bool read_sw4r1(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_SW4R1_PIN);
+}
+
+bool read_sw5r0(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_SW5R0_PIN);
+}
+
+bool read_col0(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_COL0_PIN);
+}
+
+bool read_col1(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_COL1_PIN);
+}
+
+bool read_col2(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_COL2_PIN);
+}
+
+bool read_col3(void){
+    return EDUB_INPUT(edub_read_inputs(), PICOEDUB_COL3_PIN);
+}
@@ -0,0 +1,176 @@
+/**
+ * Board support for the Pico 2 eduboard, shared by the apps.
+ *
+ * picoedub.c, adc_rate.c and cb.c are built once as the picoedub and ringbuf
+ * libraries (CMakeLists.txt in this directory) and every app links them.
+ * The values under "app settings" are the ones the apps have always used.
+ * Each is only a default, so an app can change it with
+ * target_compile_definitions() without touching this file.
+ */
+#ifndef PICOEDUB_H
+#define PICOEDUB_H
+
+#define PICO_ADC_0_PIN         26
+#define PICO_ADC_0_CHANNEL     0
+#define PICO_ADC_1_PIN         27
+#define PICO_ADC_1_CHANNEL     1
+#define PICO_ADC_2_PIN         28
+#define PICO_ADC_2_CHANNEL     2
+
+#define PICO_SPK_PIN           22
+
+#define PICOEDUB_LED0_PIN      1
+#define PICOEDUB_LED1_PIN      0
+#define PICOEDUB_LED2_PIN      2
+#define PICOEDUB_LED3_PIN      3
+
+#define PICOEDUB_ROW0_PIN      6
+#define PICOEDUB_ROW1_PIN      7
+#define PICOEDUB_ROW2_PIN      8
+#define PICOEDUB_ROW3_PIN      9
+
+#define PICOEDUB_SW2_PIN       9
+#define PICOEDUB_SW3_PIN       8
+#define PICOEDUB_SW4_PIN       7
+#define PICOEDUB_SW5_PIN       6
+
+//the same switches, named for the keypad row they share
+#define PICOEDUB_SW2R3_PIN     PICOEDUB_SW2_PIN
+#define PICOEDUB_SW3R2_PIN     PICOEDUB_SW3_PIN
+#define PICOEDUB_SW4R1_PIN     PICOEDUB_SW4_PIN
+#define PICOEDUB_SW5R0_PIN     PICOEDUB_SW5_PIN
+
+#define PICOEDUB_COL0_PIN      10
+#define PICOEDUB_COL1_PIN      11
+#define PICOEDUB_COL2_PIN      12
+#define PICOEDUB_COL3_PIN      13
+
+//first row gpio pin is 6
+#define PICO_ROW_GPIO_OFFSET   6
+#define PICO_COL_GPIO_OFFSET   10
+#define PICO_SW_PIN_OFFSET     6
+
+//Pin masks so whole groups can be set up and read in one register access
+#define PICOEDUB_LED_MASK   ((1u << PICO_DEFAULT_LED_PIN) | (1u << PICOEDUB_LED0_PIN) | (1u << PICOEDUB_LED1_PIN) | \
+                             (1u << PICOEDUB_LED2_PIN) | (1u << PICOEDUB_LED3_PIN))
+#define PICOEDUB_SW_MASK    ((1u << PICOEDUB_SW2R3_PIN) | (1u << PICOEDUB_SW3R2_PIN) | \
+                             (1u << PICOEDUB_SW4R1_PIN) | (1u << PICOEDUB_SW5R0_PIN))
+#define PICOEDUB_COL_MASK   ((1u << PICOEDUB_COL0_PIN) | (1u << PICOEDUB_COL1_PIN) | \
+                             (1u << PICOEDUB_COL2_PIN) | (1u << PICOEDUB_COL3_PIN))
+#define PICOEDUB_INPUT_MASK (PICOEDUB_SW_MASK | PICOEDUB_COL_MASK)
+
+//Bits for edub_set_leds(), e.g. edub_set_leds(EDUB_LED0 | EDUB_LED2)
+#define EDUB_PICO_LED       (1u << PICO_DEFAULT_LED_PIN)
+#define EDUB_LED0           (1u << PICOEDUB_LED0_PIN)
+#define EDUB_LED1           (1u << PICOEDUB_LED1_PIN)
+#define EDUB_LED2           (1u << PICOEDUB_LED2_PIN)
+#define EDUB_LED3           (1u << PICOEDUB_LED3_PIN)
+
+//Tests one pin in a snapshot from edub_read_inputs()
+#define EDUB_INPUT(u32_snapshot, pin) (((u32_snapshot) >> (pin)) & 1u)
+
+/****************************************
+ * app settings
+*****************************************/
+#ifndef LED_DELAY_MS
+#define LED_DELAY_MS 250
+#endif
+
+#ifndef DEFAULT_TIMEOUT_ITERATIONS
+#define DEFAULT_TIMEOUT_ITERATIONS 5000
+#endif
+
+/****************************************
+ * ADC samples a second on each input, set with adc_rate_set() (adc_rate.h).
+ * This used to be DEFUALT_ADC_PERIOD_CYCLES 4800 passed straight to
+ * adc_set_clkdiv(), commented as a sample every ms. The ADC counts 48 MHz
+ * cycles though, not 4.8 MHz, and waits 1 + DIV of them, so that was one
+ * every 4801 cycles or 9997.9 a second. 10000 keeps the rate the apps ran at.
+*****************************************/
+#ifndef ADC_SAMPLE_RATE_HZ
+#define ADC_SAMPLE_RATE_HZ 10000
+#endif
+#ifndef PICO2_FIFO_INTR_SIZE
+#define PICO2_FIFO_INTR_SIZE 1
+#endif
+#define LM45_mV_to_degC 0.010f
+#define C_to_F_scaler (9.0f/5.0f)
+#define C_to_F_offset 32
+#ifndef Buzzer_Threshold
+#define Buzzer_Threshold 75
+#endif
+//EVERY SENSOR IS SLIGHTLY DIFFERENT, THE FOLLOWING DEFININTION CAN BE CHANGED
+//TO CALIBRATE THE SENSOR. THE ONE I HAVE IS ABOUT 6.9 DEGREES OFF
+#ifndef CALIBRATION_FACTOR
+#define CALIBRATION_FACTOR -6.9f
+#endif
+
+#ifndef UART_ID
+#define UART_ID uart0
+#endif
+#ifndef BAUD_RATE
+#define BAUD_RATE 57600
+#endif
+#define DATA_BITS 8
+#define STOP_BITS 1
+#define START_BITS 1
+#ifndef PARITY
+#define PARITY    UART_PARITY_ODD
+#endif
+
+// We are using pins 0 and 1, but see the GPIO function select table in the
+// datasheet for information on which other pins can be used.
+#define UART_TX_PIN 0
+#define UART_RX_PIN 1
+
+
+
+
+//Needed for gpio IRQ
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "cb.h"
+#include "adc_rate.h"
+
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+#include "hardware/irq.h"
+#include "hardware/watchdog.h"
+#include "hardware/adc.h"
+#include "hardware/structs/adc.h"
+#include "hardware/structs/uart.h"
+
+//each app has its own edub_init() for its peripherals
+void edub_init();
+void pico_led_init(void);
+void pico_set_led(bool b_led_on);
+void gpio_to_EDUB_led_init(uint8_t u8_PIN_NUM);
+void flash_led_gpio_to_EDUB(uint8_t  u8_PIN_NUM);
+void gpio_input_reset(uint8_t u8_pin_num);
+bool uart_putc_nonBlocking(uart_inst_t *uart, const uint8_t src, uint32_t numAttempts);
+bool adc_fifo_drain_nonBlocking(uint32_t u32_timeOut);
+
+//LEDs as outputs, switches and columns as inputs with pull downs, in two groups
+void edub_gpio_init(void);
+//All switches, rows and columns in one read of the SIO input register.
+//Use EDUB_INPUT() or the PICOEDUB_*_MASK values to pick bits out.
+uint32_t edub_read_inputs(void);
+//Sets every LED at once. LEDs with their bit clear in u32_ledMask turn off.
+//Pins that are not under SIO control (the UART on LED0/LED1, or PWM) ignore this.
+void edub_set_leds(uint32_t u32_ledMask);
+void pico_set_LED0(bool led_on);
+void pico_set_LED1(bool led_on);
+void pico_set_LED2(bool led_on);
+void pico_set_LED3(bool led_on);
+bool read_sw2r3(void);
+bool read_sw3r2(void);
+bool read_sw4r1(void);
+bool read_sw5r0(void);
+bool read_col0(void);
+bool read_col1(void);
+bool read_col2(void);
+bool read_col3(void);
+
+#endif
@@ -0,0 +1,63 @@
+# Lists every .bss and .data symbol of an ELF, largest first, with the totals.
+# An app includes it and adds the target, make ram_report then runs it:
+#   include(../picoedub/ram_report.cmake)
+#   edub_ram_report(<target>)
+# or by hand:
+#   cmake -DNM=arm-none-eabi-nm -DELF=app.elf -P ram_report.cmake
+
+# included, the target runs this same file as a script
+if (NOT CMAKE_SCRIPT_MODE_FILE)
+    set(EDUB_RAM_REPORT_SCRIPT "${CMAKE_CURRENT_LIST_FILE}")
+    function(edub_ram_report TARGET)
+        add_custom_target(ram_report
+            COMMAND ${CMAKE_COMMAND} -DNM=${CMAKE_NM} -DELF=$<TARGET_FILE:${TARGET}> -P ${EDUB_RAM_REPORT_SCRIPT}
+            DEPENDS ${TARGET}
+            VERBATIM
+        )
+    endfunction()
+    return()
+endif()
+
+if (NOT NM OR NOT ELF)
+    message(FATAL_ERROR "usage: cmake -DNM=<nm> -DELF=<elf> -P ram_report.cmake")
+endif()
+
+execute_process(
+    COMMAND ${NM} --print-size --size-sort --reverse-sort --radix=d ${ELF}
+    OUTPUT_VARIABLE NM_OUTPUT
+    RESULT_VARIABLE NM_RESULT
+)
+if (NOT NM_RESULT EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${ELF}")
+endif()
+
+string(REPLACE "\n" ";" NM_LINES "${NM_OUTPUT}")
+set(BSS_TOTAL 0)
+set(DATA_TOTAL 0)
+set(REPORT "")
+foreach (LINE IN LISTS NM_LINES)
+    # address size type name, sizes are decimal because of --radix=d
+    if (LINE MATCHES "^[0-9]+ ([0-9]+) ([bBdD]) (.+)$")
+        # nm pads the size with zeros, math() drops them
+        math(EXPR SIZE "${CMAKE_MATCH_1}")
+        string(TOLOWER ${CMAKE_MATCH_2} TYPE)
+        if (TYPE STREQUAL "b")
+            math(EXPR BSS_TOTAL "${BSS_TOTAL} + ${SIZE}")
+            set(SECTION ".bss ")
+        else()
+            math(EXPR DATA_TOTAL "${DATA_TOTAL} + ${SIZE}")
+            set(SECTION ".data")
+        endif()
+        string(LENGTH "${SIZE}" SIZE_LEN)
+        set(SIZE_PAD "")
+        if (SIZE_LEN LESS 8)
+            math(EXPR PAD "8 - ${SIZE_LEN}")
+            string(REPEAT " " ${PAD} SIZE_PAD)
+        endif()
+        string(APPEND REPORT "${SIZE_PAD}${SIZE}  ${SECTION}  ${CMAKE_MATCH_3}\n")
+    endif()
+endforeach()
+
+message("    size  section  symbol\n${REPORT}")
+message(".bss  total: ${BSS_TOTAL} bytes")
+message(".data total: ${DATA_TOTAL} bytes")
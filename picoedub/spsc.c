@@ -0,0 +1,51 @@
+#include "spsc.h"
+#include "edub_ram.h"
+
+void spsc_init(spsc_ring *ps_ring){
+    ps_ring->u32_head = 0;
+    ps_ring->u32_tail = 0;
+    ps_ring->u32_drops = 0;
+    ps_ring->u32_highWater = 0;
+}
+
+bool EDUB_RAM_FUNC(spsc_push)(spsc_ring *ps_ring, uint32_t u32_item, bool *pb_wasEmpty){
+    uint32_t u32_head = ps_ring->u32_head;
+    uint32_t u32_count = u32_head - ps_ring->u32_tail;
+    if(pb_wasEmpty != NULL){
+        *pb_wasEmpty = u32_count == 0;
+    }
+    if(u32_count >= SPSC_SIZE){
+        ps_ring->u32_drops++;
+        return false;
+    }
+    ps_ring->au32_data[u32_head & (SPSC_SIZE - 1)] = u32_item;
+    //the item has to be in memory before the consumer can see the new head
+    __dmb();
+    ps_ring->u32_head = u32_head + 1;
+    if(u32_count + 1 > ps_ring->u32_highWater){
+        ps_ring->u32_highWater = u32_count + 1;
+    }
+    return true;
+}
+
+bool EDUB_RAM_FUNC(spsc_pop)(spsc_ring *ps_ring, uint32_t *pu32_item){
+    uint32_t u32_tail = ps_ring->u32_tail;
+    if(ps_ring->u32_head == u32_tail){
+        return false;
+    }
+    //read the item only after seeing the head that published it
+    __dmb();
+    *pu32_item = ps_ring->au32_data[u32_tail & (SPSC_SIZE - 1)];
+    //and be done with it before the producer can reuse the slot
+    __dmb();
+    ps_ring->u32_tail = u32_tail + 1;
+    return true;
+}
+
+uint32_t spsc_count(spsc_ring *ps_ring){
+    return ps_ring->u32_head - ps_ring->u32_tail;
+}
+
+bool spsc_isEmpty(spsc_ring *ps_ring){
+    return ps_ring->u32_head == ps_ring->u32_tail;
+}
@@ -0,0 +1,50 @@
+/**
+ * Single-producer single-consumer ring of 32-bit words, for passing data
+ * from one core to the other.
+ *
+ * cb.c guards every access by disabling interrupts, which only keeps out
+ * the core it runs on. Here the producer only writes u32_head and the
+ * consumer only writes u32_tail, so neither side ever waits on the other
+ * and no lock is needed, as long as there is exactly one of each (one
+ * core's ISR and the other core's loop, say). A __dmb() orders the item
+ * before the index that publishes it.
+ *
+ * The ring only holds the data. To wake the consumer instead of having it
+ * poll, the producer can ring a doorbell, such as a word in the SIO FIFO,
+ * when spsc_push() reports the ring was empty.
+ */
+#ifndef SPSC_H
+#define SPSC_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+//must be a power of 2, the indices run freely and are masked on use
+#ifndef SPSC_SIZE
+    #define SPSC_SIZE 64
+#endif
+
+typedef struct spsc_ring
+{
+    uint32_t au32_data[SPSC_SIZE];
+    volatile uint32_t u32_head;     // items pushed, only the producer writes it
+    volatile uint32_t u32_tail;     // items popped, only the consumer writes it
+    uint32_t u32_drops;             // items lost because the ring was full, producer side
+    uint32_t u32_highWater;         // most items the ring has held, producer side
+} spsc_ring;
+
+void spsc_init(spsc_ring *ps_ring);
+
+//producer side. Returns false and counts a drop when full, the ring
+//keeps the older items. *pb_wasEmpty (may be NULL) says whether the
+//consumer could have been waiting, i.e. whether to ring the doorbell.
+bool spsc_push(spsc_ring *ps_ring, uint32_t u32_item, bool *pb_wasEmpty);
+
+//consumer side. Returns false, leaving *pu32_item alone, when empty.
+bool spsc_pop(spsc_ring *ps_ring, uint32_t *pu32_item);
+
+//either side, a snapshot that the other core may change at any moment
+uint32_t spsc_count(spsc_ring *ps_ring);
+bool spsc_isEmpty(spsc_ring *ps_ring);
+
+#endif
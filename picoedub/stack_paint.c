@@ -0,0 +1,55 @@
+#include "stack_paint.h"
+#include <stdio.h>
+
+//from the SDK's linker script
+extern uint32_t __StackBottom;
+extern uint32_t __StackTop;
+extern uint32_t __StackOneBottom;
+extern uint32_t __StackOneTop;
+extern uint32_t __data_start__;
+extern uint32_t __bss_end__;
+
+//left alone below the stack pointer when painting core 0's live stack,
+//enough for this function's own frame
+#define STACK_PAINT_MARGIN 64
+
+static uint32_t *stack_bottom(stack_id_t stack){
+    return stack == STACK_CORE0 ? &__StackBottom : &__StackOneBottom;
+}
+
+static uint32_t *stack_top(stack_id_t stack){
+    return stack == STACK_CORE0 ? &__StackTop : &__StackOneTop;
+}
+
+void __attribute__((noinline)) stack_paint(void){
+    //core 0 is running on its stack, so only paint below where it is now
+    uint32_t *pu32_sp = (uint32_t *)__builtin_frame_address(0) - STACK_PAINT_MARGIN / sizeof(uint32_t);
+    for(volatile uint32_t *pu32_word = &__StackBottom; pu32_word < pu32_sp; pu32_word++){
+        *pu32_word = STACK_PAINT_WORD;
+    }
+    //core 1 has not been launched yet, all of its stack is free
+    for(volatile uint32_t *pu32_word = &__StackOneBottom; pu32_word < &__StackOneTop; pu32_word++){
+        *pu32_word = STACK_PAINT_WORD;
+    }
+}
+
+uint32_t stack_size(stack_id_t stack){
+    return (uint32_t)((uint8_t *)stack_top(stack) - (uint8_t *)stack_bottom(stack));
+}
+
+uint32_t stack_high_water(stack_id_t stack){
+    volatile uint32_t *pu32_word = stack_bottom(stack);
+    uint32_t *pu32_top = stack_top(stack);
+    //the stack grows down, so the first changed word from the bottom is the deepest point
+    while(pu32_word < pu32_top && *pu32_word == STACK_PAINT_WORD){
+        pu32_word++;
+    }
+    return (uint32_t)((uint8_t *)pu32_top - (uint8_t *)pu32_word);
+}
+
+void stack_format(char *pc_line){
+    snprintf(pc_line, STACK_PAINT_LINE_SIZE, "STACK core0+irq=%lu/%lu core1=%lu/%lu static=%lu\n\r",
+             (unsigned long)stack_high_water(STACK_CORE0), (unsigned long)stack_size(STACK_CORE0),
+             (unsigned long)stack_high_water(STACK_CORE1), (unsigned long)stack_size(STACK_CORE1),
+             (unsigned long)((uint8_t *)&__bss_end__ - (uint8_t *)&__data_start__));
+}
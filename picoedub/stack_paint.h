@@ -0,0 +1,39 @@
+/**
+ * Stack high-water marks.
+ *
+ * stack_paint() fills the unused part of each stack with a known word at
+ * boot. A stack never gives memory back, so the lowest word that no longer
+ * holds the pattern is the deepest it has been.
+ *
+ * The SDK's linker script puts core 0's stack in SCRATCH_Y and core 1's in
+ * SCRATCH_X, both 4 KB by default (PICO_STACK_SIZE / PICO_CORE1_STACK_SIZE
+ * can make them smaller). The M33 runs every IRQ handler on the main stack,
+ * so the core 0 figure covers the IRQ stack too: it is the deepest the
+ * main loop plus any nesting of ISRs on top of it ever went.
+ */
+#ifndef STACK_PAINT_H
+#define STACK_PAINT_H
+
+#include "pico/stdlib.h"
+
+#define STACK_PAINT_WORD      0xDEADBEEFu
+#define STACK_PAINT_LINE_SIZE 128
+
+typedef enum {
+    STACK_CORE0,     // main loop and every IRQ on core 0
+    STACK_CORE1,
+    STACK_COUNT
+} stack_id_t;
+
+//call first thing in main, before core 1 is launched
+void stack_paint(void);
+
+//bytes the stack has
+uint32_t stack_size(stack_id_t stack);
+//most bytes the stack has used since stack_paint()
+uint32_t stack_high_water(stack_id_t stack);
+
+//writes the sizes, high-water marks and static RAM use into pc_line (STACK_PAINT_LINE_SIZE bytes)
+void stack_format(char *pc_line);
+
+#endif
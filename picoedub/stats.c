@@ -0,0 +1,68 @@
+#include "stats.h"
+#include <stdio.h>
+
+volatile uint32_t au32_stats[STAT_COUNT];
+
+typedef struct {
+    const char *pc_name;
+    volatile uint32_t *pu32_drops;
+    volatile uint32_t *pu32_highWater;
+} stats_buffer_t;
+
+static stats_buffer_t as_buffers[STATS_MAX_BUFFERS];
+static uint8_t u8_numBuffers = 0;
+
+//loop rate, latched once a second by stats_loop()
+static uint32_t u32_loopRate = 0;
+static uint32_t u32_rateLoops = 0;
+static uint32_t u32_rateStartUs = 0;
+
+void stats_init(void){
+    for(uint8_t u8_i = 0; u8_i < STAT_COUNT; u8_i++){
+        au32_stats[u8_i] = 0;
+    }
+    u8_numBuffers = 0;
+    u32_loopRate = 0;
+    u32_rateLoops = 0;
+    u32_rateStartUs = time_us_32();
+}
+
+void stats_add_buffer(const char *pc_name, volatile uint32_t *pu32_drops, volatile uint32_t *pu32_highWater){
+    if(u8_numBuffers >= STATS_MAX_BUFFERS){
+        return;
+    }
+    as_buffers[u8_numBuffers].pc_name = pc_name;
+    as_buffers[u8_numBuffers].pu32_drops = pu32_drops;
+    as_buffers[u8_numBuffers].pu32_highWater = pu32_highWater;
+    u8_numBuffers++;
+}
+
+void stats_loop(void){
+    au32_stats[STAT_LOOPS]++;
+    uint32_t u32_elapsedUs = time_us_32() - u32_rateStartUs;
+    if(u32_elapsedUs >= 1000000){
+        uint32_t u32_loops = au32_stats[STAT_LOOPS] - u32_rateLoops;
+        u32_loopRate = (uint32_t)(((uint64_t)u32_loops * 1000000) / u32_elapsedUs);
+        u32_rateLoops = au32_stats[STAT_LOOPS];
+        u32_rateStartUs += u32_elapsedUs;
+    }
+}
+
+void stats_format(char *pc_line){
+    int i_len = snprintf(pc_line, STATS_LINE_SIZE,
+                         "STATS t=%lu adc=%lu/%lu uart=rx:%lu,tx:%lu i2c=%lu/%lu/%lu loop=%lu/s buf=",
+                         (unsigned long)(time_us_64() / 1000000),
+                         (unsigned long)au32_stats[STAT_ADC_SAMPLES], (unsigned long)au32_stats[STAT_ADC_PROCESSED],
+                         (unsigned long)au32_stats[STAT_UART_RX], (unsigned long)au32_stats[STAT_UART_TX],
+                         (unsigned long)au32_stats[STAT_I2C_OK], (unsigned long)au32_stats[STAT_I2C_TIMEOUT],
+                         (unsigned long)au32_stats[STAT_I2C_ERROR], (unsigned long)u32_loopRate);
+    //each buffer as name:drops/highWater
+    for(uint8_t u8_i = 0; u8_i < u8_numBuffers && i_len < STATS_LINE_SIZE; u8_i++){
+        i_len += snprintf(pc_line + i_len, STATS_LINE_SIZE - i_len, "%s%s:%lu/%lu", u8_i == 0 ? "" : ",",
+                          as_buffers[u8_i].pc_name, (unsigned long)*as_buffers[u8_i].pu32_drops,
+                          (unsigned long)*as_buffers[u8_i].pu32_highWater);
+    }
+    if(i_len < STATS_LINE_SIZE){
+        snprintf(pc_line + i_len, STATS_LINE_SIZE - i_len, "\n\r");
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * Runtime counters for each subsystem.
+ *
+ * Every counter has one writer, either one ISR or the main loop, so a plain
+ * increment is safe on a single core and readers only ever see a value that
+ * is a little old. Ring buffers keep their own drop and high-water counts;
+ * stats_add_buffer() lets the record include them.
+ *
+ * stats_format() writes everything as one line, e.g.
+ *   STATS t=12 adc=120000/1200 uart=rx:3,tx:9000 i2c=0/0/0 loop=98/s buf=in:0/1,out:0/187
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include "pico/stdlib.h"
+
+#define STATS_MAX_BUFFERS   4
+#define STATS_LINE_SIZE     160
+
+typedef enum {
+    STAT_ADC_SAMPLES,     // conversions taken out of the ADC FIFO
+    STAT_ADC_PROCESSED,   // conversions turned into a temperature or output
+    STAT_UART_RX,         // bytes received
+    STAT_UART_TX,         // bytes sent
+    STAT_I2C_OK,          // transactions that were ACKed
+    STAT_I2C_TIMEOUT,     // transactions that ran out of time
+    STAT_I2C_ERROR,       // transactions that were NAKed or failed some other way
+    STAT_LOOPS,           // main loop iterations
+    STAT_COUNT
+} stat_id_t;
+
+extern volatile uint32_t au32_stats[STAT_COUNT];
+
+static inline void stats_inc(stat_id_t id){
+    au32_stats[id]++;
+}
+
+static inline void stats_add(stat_id_t id, uint32_t u32_n){
+    au32_stats[id] += u32_n;
+}
+
+void stats_init(void);
+
+//drop and high-water counters of a ring buffer, shown under pc_name
+void stats_add_buffer(const char *pc_name, volatile uint32_t *pu32_drops, volatile uint32_t *pu32_highWater);
+
+//call once per main loop, counts the loop and works out the loops per second
+void stats_loop(void);
+
+//writes the record into pc_line (STATS_LINE_SIZE bytes)
+void stats_format(char *pc_line);
+
+#endif